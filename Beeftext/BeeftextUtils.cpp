@@ -17,7 +17,9 @@
 #include "Preferences/PreferencesManager.h"
 #include "BeeftextGlobals.h"
 #include "Clipboard/ClipboardManagerDefault.h"
-#include <Psapi.h>
+#include "ForegroundApplicationTracker.h"
+#include "KeySynthesizer.h"
+#include "SubstitutionTracer.h"
 #include <XMiLib/SystemUtils.h>
 #include <XMiLib/Exception.h>
 
@@ -30,8 +32,6 @@ namespace {
 
 QString const kPortableModeBeaconFileName = "Portable.bin"; ///< The name of the 'beacon' file used to detect if the application should run in portable mode
 QString const kPortableAppsModeBeaconFileName = "PortableApps.bin"; ///< The name of the 'beacon file used to detect if the app is in PortableApps mode
-QList<quint16> const modifierKeys = { VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU, VK_LSHIFT, VK_RSHIFT, VK_LWIN,
-                                      VK_RWIN }; ///< The modifier keys
 QChar constexpr kObjectReplacementChar(0xfffc); ///< The unicode object replacement character.
 
 
@@ -55,46 +55,13 @@ p, li { white-space: pre-wrap; }
 /// \return true if and only if the application is running in portable mode
 //****************************************************************************************************************************************************
 bool isInPortableModeInternal() {
+#ifdef BEEFTEXT_BENCHMARK
+    return true; // the benchmarks must never read or modify the preferences and combos of the user
+#else
     QDir const appDir(QCoreApplication::applicationDirPath());
     return QFileInfo(appDir.absoluteFilePath(kPortableModeBeaconFileName)).exists() ||
            QFileInfo(appDir.absoluteFilePath(kPortableAppsModeBeaconFileName)).exists();
-}
-
-
-//****************************************************************************************************************************************************
-/// \brief Retrieve the list of currently pressed modifier key and synthesize a key release event for each of them
-///
-/// \return The list of modifier keys that are pressed
-//****************************************************************************************************************************************************
-QList<quint16> backupAndReleaseModifierKeys() {
-    QList<quint16> result;
-    for (quint16 const key: modifierKeys)
-        if (GetKeyState(key) < 0) {
-            result.append(key);
-            synthesizeKeyUp(key);
-        }
-    return result;
-}
-
-
-//****************************************************************************************************************************************************
-/// \brief Restore the specified modifier keys state by generating a key press event for each of them
-///
-/// \param[in] keys The list of modifiers key to restore by generating a key press event
-//****************************************************************************************************************************************************
-void restoreModifierKeys(QList<quint16> const &keys) {
-    for (quint16 const key: keys)
-        synthesizeKeyDown(key);
-}
-
-
-//****************************************************************************************************************************************************
-/// \brief Wait between keystroke, for an amount time defined in the preferences.
-//****************************************************************************************************************************************************
-void waitBetweenKeystrokes() {
-    qint32 const delayMs = PreferencesManager::instance().delayBetweenKeystrokesMs();
-    if (delayMs > 0)
-        qApp->thread()->msleep(static_cast<quint32>(delayMs));
+#endif // #ifdef BEEFTEXT_BENCHMARK
 }
 
 
@@ -130,20 +97,14 @@ bool usePortableAppsFolderLayout() {
 
 
 //****************************************************************************************************************************************************
+/// \note The name is cached by the foreground application tracker, and only retrieved when the foreground window
+/// changes.
+///
 /// \return The name of the currently active application, including its extension (e.g. "explorer.exe")
 /// \return A null string in case of failure
 //****************************************************************************************************************************************************
 QString getActiveExecutableFileName() {
-    WCHAR buffer[MAX_PATH + 1] = { 0 };
-    DWORD processId = 0;
-    GetWindowThreadProcessId(GetForegroundWindow(), &processId);
-    // ReSharper disable once CppLocalVariableMayBeConst
-    HANDLE processHandle = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
-    if (!processHandle)
-        return QString();
-    bool const ok = GetModuleFileNameEx(processHandle, nullptr, buffer, MAX_PATH);
-    CloseHandle(processHandle);
-    return ok ? QFileInfo(QDir::fromNativeSeparators(QString::fromWCharArray(buffer))).fileName() : QString();
+    return ForegroundApplicationTracker::instance().executableFileName();
 }
 
 
@@ -151,9 +112,7 @@ QString getActiveExecutableFileName() {
 /// \return true if and only if Beeftext is the application currently in the foreground
 //****************************************************************************************************************************************************
 bool isBeeftextTheForegroundApplication() {
-    DWORD processId = 0;
-    GetWindowThreadProcessId(GetForegroundWindow(), &processId);
-    return QCoreApplication::applicationPid() == processId;
+    return ForegroundApplicationTracker::instance().isBeeftextInForeground();
 }
 
 
@@ -177,9 +136,8 @@ QString htmlToPlainText(QString const &snippet) {
 /// \param[in] count The number of characters to erase.
 //****************************************************************************************************************************************************
 void eraseChars(qint32 count) {
-    QList<quint16> const pressedModifiers = backupAndReleaseModifierKeys();
-    synthesizeBackspaces(count);
-    restoreModifierKeys(pressedModifiers);
+    TraceSpan const span("eraseChars");
+    KeySynthesizer::instance().eraseChars(count);
 }
 
 
@@ -191,28 +149,36 @@ void eraseChars(qint32 count) {
 /// \param[in] text The text.
 //****************************************************************************************************************************************************
 void insertTextByPasting(QString const &text) {
+    TraceSpan const span("insertTextByPasting");
     // we use the clipboard to and copy/paste the snippet
     ClipboardManager &clipboardManager = ClipboardManager::instance();
     bool const restoreClipboard = PreferencesManager::instance().restoreClipboardAfterSubstitution();
-    if (restoreClipboard)
+    if (restoreClipboard) {
+        TraceSpan const backupSpan("ClipboardManager::backupClipboard");
         clipboardManager.backupClipboard();
+    }
 #ifdef Q_OS_WINDOWS
     QString txt = ensureStringHasCRLFLineEndings(text);
 #else
     QString txt = text;
 #endif
-    clipboardManager.setText(txt);
-    QList<quint16> const pressedModifiers = backupAndReleaseModifierKeys(); ///< We artificially depress the current modifier keys
+    {
+        TraceSpan const setTextSpan("ClipboardManager::setText");
+        clipboardManager.setText(txt);
+    }
+    TraceSpan const pasteSpan("paste");
+    KeySynthesizer &synthesizer = KeySynthesizer::instance();
+    QList<quint16> const pressedModifiers = synthesizer.releaseModifierKeys(); ///< We artificially depress the current modifier keys
     if (PreferencesManager::instance().useShiftInsertForPasting()) {
-        synthesizeKeyDown(VK_LSHIFT);
-        synthesizeKeyDownAndUp(VK_INSERT);
-        synthesizeKeyUp(VK_LSHIFT);
+        synthesizer.keyDown(VK_LSHIFT);
+        synthesizer.keyDownAndUp(VK_INSERT);
+        synthesizer.keyUp(VK_LSHIFT);
     } else {
-        synthesizeKeyDown(VK_LCONTROL);
-        synthesizeKeyDownAndUp('V');
-        synthesizeKeyUp(VK_LCONTROL);
+        synthesizer.keyDown(VK_LCONTROL);
+        synthesizer.keyDownAndUp('V');
+        synthesizer.keyUp(VK_LCONTROL);
     }
-    restoreModifierKeys(pressedModifiers);
+    synthesizer.restoreModifierKeys(pressedModifiers);
 
     // We need to delay clipboard restoration to avoid unexpected behaviours.
     QTimer::singleShot(1000, &clipboardManager, restoreClipboard ? &ClipboardManager::restoreClipboard : &ClipboardManager::clearClipboard);
@@ -227,24 +193,8 @@ void insertTextByPasting(QString const &text) {
 /// \param[in] text The text.
 //****************************************************************************************************************************************************
 void insertTextByTyping(QString const &text) {
-    QList<quint16> pressedModifiers;
-    // we simulate the typing of the snippet text
-    for (QChar c: text) {
-        if (c == QChar::LineFeed)
-            // synthesizeUnicode key down does not handle line feed properly (the problem actually comes from Windows API's SendInput())
-        {
-            pressedModifiers = backupAndReleaseModifierKeys();
-            synthesizeKeyDownAndUp(VK_RETURN);
-            restoreModifierKeys(pressedModifiers);
-            waitBetweenKeystrokes();
-        } else {
-            pressedModifiers = backupAndReleaseModifierKeys();
-            synthesizeUnicodeKeyDownAndUp(c.unicode());
-            restoreModifierKeys(pressedModifiers);
-            waitBetweenKeystrokes();
-        }
-    }
-
+    TraceSpan const span("insertTextByTyping");
+    KeySynthesizer::instance().typeText(text, PreferencesManager::instance().delayBetweenKeystrokesMs());
 }
 
 
@@ -273,8 +223,9 @@ QString ensureStringHasCRLFLineEndings(QString const &str) {
 /// \param[in] text The text
 //****************************************************************************************************************************************************
 void insertText(QString const &text) {
+    TraceSpan const span("insertText");
     QList<quint16> pressedModifiers;
-    if (!globals::sensitiveApplications().filter(getActiveExecutableFileName()))
+    if (!globals::sensitiveApplications().filter(ForegroundApplicationTracker::instance().executableFileName()))
         insertTextByPasting(text);
     else
         insertTextByTyping(text);
@@ -293,28 +244,29 @@ void renderShortcut(SpShortcut const &shortcut) {
         globals::debugLog().addWarning("Tried to render a null shortcut.");
         return;
     }
-    QList<quint16> const pressedModifiers = backupAndReleaseModifierKeys(); ///< We artificially depress the current modifier keys
+    KeySynthesizer &synthesizer = KeySynthesizer::instance();
+    QList<quint16> const pressedModifiers = synthesizer.releaseModifierKeys(); ///< We artificially depress the current modifier keys
     Qt::KeyboardModifiers const mods = shortcut->keyboardModifiers();
     if (mods & Qt::ControlModifier)
-        synthesizeKeyDown(VK_CONTROL);
+        synthesizer.keyDown(VK_CONTROL);
     if (mods & Qt::AltModifier)
-        synthesizeKeyDown(VK_MENU);
+        synthesizer.keyDown(VK_MENU);
     if (mods & Qt::MetaModifier)
-        synthesizeKeyDown(VK_LWIN);
+        synthesizer.keyDown(VK_LWIN);
     if (mods & Qt::ShiftModifier)
-        synthesizeKeyDown(VK_SHIFT);
+        synthesizer.keyDown(VK_SHIFT);
 
-    synthesizeKeyDownAndUp(qint16(KeyboardMapper::instance().qtKeyToVirtualKeyCode(shortcut->key())));
+    synthesizer.keyDownAndUp(quint16(KeyboardMapper::instance().qtKeyToVirtualKeyCode(shortcut->key())));
 
     if (mods & Qt::ControlModifier)
-        synthesizeKeyUp(VK_CONTROL);
+        synthesizer.keyUp(VK_CONTROL);
     if (mods & Qt::AltModifier)
-        synthesizeKeyUp(VK_MENU);
+        synthesizer.keyUp(VK_MENU);
     if (mods & Qt::MetaModifier)
-        synthesizeKeyUp(VK_LWIN);
+        synthesizer.keyUp(VK_LWIN);
     if (mods & Qt::ShiftModifier)
-        synthesizeKeyUp(VK_SHIFT);
-    restoreModifierKeys(pressedModifiers);
+        synthesizer.keyUp(VK_SHIFT);
+    synthesizer.restoreModifierKeys(pressedModifiers);
 }
 
 
@@ -326,10 +278,8 @@ void renderShortcut(SpShortcut const &shortcut) {
 void moveCursorLeft(qint32 count) {
     if (count < 1)
         return;
-    QList<quint16> const pressedModifiers = backupAndReleaseModifierKeys(); ///< We artificially depress the current modifier keys
-    for (qint32 i = 0; i < count; ++i)
-        synthesizeKeyDownAndUp(VK_LEFT);
-    restoreModifierKeys(pressedModifiers);
+    TraceSpan const span("moveCursorLeft");
+    KeySynthesizer::instance().moveCursorLeft(count);
 }
 
 
@@ -0,0 +1,228 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the entry point of the benchmark executable
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "Benchmarks.h"
+#include "SyntheticCorpus.h"
+#include "BeeftextConstants.h"
+#include "MemoryKeySynthesizer.h"
+#ifdef BEEFTEXT_COMBO_BENCHMARKS
+#include "ComboBenchmarks.h"
+#include "BeeftextGlobals.h"
+#include "Combo/ComboManager.h"
+#include "Preferences/PreferencesManager.h"
+#endif // #ifdef BEEFTEXT_COMBO_BENCHMARKS
+#include <XMiLib/Exception.h>
+
+
+using namespace xmilib;
+using namespace bench;
+
+
+namespace {
+
+
+QString const kOptionSizes = "sizes"; ///< The command line option for the sizes of the combo lists
+QString const kOptionSeed = "seed"; ///< The command line option for the seed of the corpus generator
+QString const kOptionKeystrokes = "keystrokes"; ///< The command line option for the number of keystrokes in the typing session
+QString const kOptionRepetitions = "repetitions"; ///< The command line option for the number of repetitions of each benchmark
+QString const kOptionOutput = "output"; ///< The command line option for the path of the output file
+qint32 constexpr kSampleSize = 1000; ///< The number of snippets synthesized, evaluated or split by the benchmarks
+#ifdef BEEFTEXT_COMBO_BENCHMARKS
+qint32 constexpr kPickerQueryCount = 50; ///< The number of queries typed in the combo picker
+qint32 constexpr kLongSnippetLength = 100000; ///< The length of the long snippets split into fragments
+QList<qint32> const kLongSnippetMarkerCounts = { 100, 1000, 5000 }; ///< The numbers of fragment variables in the long snippets
+
+
+//****************************************************************************************************************************************************
+/// \brief The modifications of the combo list schedule the publication of a new snapshot, which happens when the
+/// event loop is processed.
+///
+/// \param[in] previousEpoch The epoch of the snapshot before the modification of the combo list.
+//****************************************************************************************************************************************************
+void waitForSnapshotUpdate(quint64 previousEpoch) {
+    ComboManager const &comboManager = ComboManager::instance();
+    while (comboManager.snapshotEpoch() == previousEpoch)
+        QCoreApplication::processEvents();
+}
+#endif // #ifdef BEEFTEXT_COMBO_BENCHMARKS
+
+
+//****************************************************************************************************************************************************
+/// \param[in] parser The command line parser.
+/// \param[in] option The name of the option.
+/// \param[in] minValue The minimum value for the option.
+/// \return The value of the option.
+/// \throw Exception if the value is not a valid integer or is smaller than minValue.
+//****************************************************************************************************************************************************
+qint64 integerOption(QCommandLineParser const &parser, QString const &option, qint64 minValue) {
+    bool ok = false;
+    qint64 const result = parser.value(option).toLongLong(&ok);
+    if ((!ok) || (result < minValue))
+        throw Exception(QString("Invalid value for option --%1: '%2'.").arg(option, parser.value(option)));
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] parser The command line parser.
+/// \return The sizes of the combo lists.
+/// \throw Exception if the option is invalid.
+//****************************************************************************************************************************************************
+QList<qint32> comboListSizes(QCommandLineParser const &parser) {
+    QList<qint32> result;
+    for (QString const &str: parser.value(kOptionSizes).split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        qint32 const size = str.trimmed().toInt(&ok);
+        if ((!ok) || (size < 1))
+            throw Exception(QString("Invalid combo list size: '%1'.").arg(str));
+        result.append(size);
+    }
+    if (result.isEmpty())
+        throw Exception("No combo list size was specified.");
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The benchmarks of the combo model are only run by the Windows build, where the combo model is available.
+///
+/// \param[in] comboCount The number of combos.
+/// \param[in] seed The seed of the corpus generator.
+/// \param[in] keystrokeCount The number of keystrokes in the typing session.
+/// \param[in] repetitions The number of repetitions of each benchmark.
+/// \return The results of the benchmarks.
+//****************************************************************************************************************************************************
+QList<BenchmarkResult> runBenchmarks(qint32 comboCount, quint32 seed, qint32 keystrokeCount, qint32 repetitions) {
+    SyntheticCorpus corpus(seed);
+    SyntheticComboList const combos = corpus.generateCombos(comboCount);
+    KeystrokeRecording const session = corpus.generateTypingSession(combos, keystrokeCount);
+
+    QList<BenchmarkResult> result;
+    result.append(benchmarkKeystrokeQueue(comboCount, session, repetitions));
+    result.append(benchmarkSubstitutionSynthesis(comboCount, combos, corpus.sampleCombos(combos, kSampleSize, false),
+        repetitions));
+
+#ifdef BEEFTEXT_COMBO_BENCHMARKS
+    // the combos are inserted in the combo list of the combo manager, because variables and the picker read it
+    ComboManager &comboManager = ComboManager::instance();
+    ComboList &list = comboManager.comboListRef();
+    quint64 const epoch = comboManager.snapshotEpoch();
+    fillComboList(list, combos);
+    waitForSnapshotUpdate(epoch);
+
+    result.append(benchmarkKeystrokeMatching(comboCount, comboManager.snapshot(), session, repetitions));
+    VecSpCombo const withVariables = combosAt(list, corpus.sampleCombos(combos, kSampleSize, true));
+    result.append(benchmarkVariableEvaluation(comboCount, withVariables, repetitions, false));
+    result.append(benchmarkVariableEvaluation(comboCount, withVariables, repetitions, true));
+    result.append(benchmarkFragmentSplitting(comboCount, combosAt(list, corpus.sampleCombos(combos, kSampleSize, false)),
+        repetitions));
+    result.append(benchmarkComboListSave(list, repetitions));
+    result.append(benchmarkComboListLoad(list, repetitions));
+    result.append(benchmarkPickerFiltering(comboCount, corpus.generatePickerQueries(combos, kPickerQueryCount),
+        repetitions));
+#endif // #ifdef BEEFTEXT_COMBO_BENCHMARKS
+    return result;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief Entry point of the benchmark executable
+///
+/// The Windows build of the benchmarks runs in portable mode, so the preferences and combos it uses are stored next
+/// to the executable, and the keyboard and mouse hooks are not installed. On other platforms, only the benchmarks of
+/// the portable sources are run.
+///
+/// \param[in] argc The number of command line arguments
+/// \param[in] argv The list of command line arguments
+//****************************************************************************************************************************************************
+int main(int argc, char *argv[]) {
+#ifdef BEEFTEXT_COMBO_BENCHMARKS
+    qRegisterMetaType<SpGroup>(); // required to use SpGroup in a queued signal/slot connection
+#endif // #ifdef BEEFTEXT_COMBO_BENCHMARKS
+    try {
+#ifdef BEEFTEXT_COMBO_BENCHMARKS
+        QApplication app(argc, argv);
+#else
+        QCoreApplication app(argc, argv);
+#endif // #ifdef BEEFTEXT_COMBO_BENCHMARKS
+        QCoreApplication::setOrganizationName(constants::kOrganizationName);
+        QCoreApplication::setApplicationName(constants::kApplicationName);
+
+        QCommandLineParser parser;
+        parser.setApplicationDescription(QString("%1 benchmarks").arg(constants::kApplicationName));
+        parser.addHelpOption();
+        parser.addOptions({
+            { kOptionSizes, "The comma-separated sizes of the combo lists.", "sizes", "1000,10000,100000" },
+            { kOptionSeed, "The seed of the synthetic corpus generator.", "seed", "1" },
+            { kOptionKeystrokes, "The number of keystrokes in the typing session.", "count", "1000000" },
+            { kOptionRepetitions, "The number of repetitions of each benchmark.", "count", "3" },
+            { kOptionOutput, "The path of the JSON output file. If omitted, the results are written to the standard output.", "path" },
+        });
+        parser.process(app);
+        QList<qint32> const sizes = comboListSizes(parser);
+        quint32 const seed = quint32(integerOption(parser, kOptionSeed, 0));
+        qint32 const keystrokeCount = qint32(integerOption(parser, kOptionKeystrokes, 1));
+        qint32 const repetitions = qint32(integerOption(parser, kOptionRepetitions, 1));
+
+#ifdef BEEFTEXT_COMBO_BENCHMARKS
+        // the preferences are reset, so that every run uses the default values
+        QDir().mkpath(globals::appDataDir());
+        QFile::remove(globals::portableModeSettingsFilePath());
+        (void) PreferencesManager::instance();
+#endif // #ifdef BEEFTEXT_COMBO_BENCHMARKS
+        MemoryKeySynthesizer synthesizer; // nothing is ever sent to the system, even if a substitution is triggered
+        KeySynthesizer::setInstance(&synthesizer);
+
+        QJsonArray results;
+        for (qint32 const size: sizes)
+            for (BenchmarkResult const &benchmarkResult: runBenchmarks(size, seed, keystrokeCount, repetitions))
+                results.append(benchmarkResult.toJsonObject());
+#ifdef BEEFTEXT_COMBO_BENCHMARKS
+        SyntheticCorpus corpus(seed);
+        for (qint32 const markerCount: kLongSnippetMarkerCounts)
+            results.append(benchmarkLongSnippetSplitting(corpus.generateLongSnippet(kLongSnippetLength, markerCount),
+                markerCount, repetitions).toJsonObject());
+#endif // #ifdef BEEFTEXT_COMBO_BENCHMARKS
+        KeySynthesizer::setInstance(nullptr);
+
+        QJsonObject rootObject;
+        rootObject["application"] = constants::kApplicationName;
+        rootObject["version"] = constants::kVersionNumber.toString();
+        rootObject["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        rootObject["seed"] = qint64(seed);
+        rootObject["keystrokes"] = keystrokeCount;
+        rootObject["results"] = results;
+        QByteArray const data = QJsonDocument(rootObject).toJson(QJsonDocument::Indented);
+
+        QString const outputPath = parser.value(kOptionOutput);
+        QFile file;
+        if (outputPath.isEmpty()) {
+            if (!file.open(stdout, QIODevice::WriteOnly))
+                throw Exception("Could not open the standard output for writing.");
+        } else {
+            file.setFileName(outputPath);
+            if (!file.open(QIODevice::WriteOnly))
+                throw Exception(QString("Could not open file for writing: '%1'").arg(QDir::toNativeSeparators(outputPath)));
+        }
+        if (data.size() != file.write(data))
+            throw Exception("Could not write the benchmark results.");
+        return 0;
+    }
+    catch (Exception const &e) {
+        QTextStream(stderr) << QString("Error: %1").arg(e.qwhat()) << Qt::endl;
+    }
+    catch (std::exception const &e) {
+        QTextStream(stderr) << QString("Error: %1").arg(e.what()) << Qt::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,205 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of benchmark functions
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "Benchmarks.h"
+#include "KeystrokeReplayer.h"
+#include "MemoryKeySynthesizer.h"
+#include "Combo/TypedTextBuffer.h"
+
+
+namespace bench {
+
+
+namespace {
+
+
+QString const kKeyName = "name"; ///< The JSON key for the name of a benchmark
+QString const kKeyComboCount = "comboCount"; ///< The JSON key for the number of combos
+QString const kKeyOperationCount = "operationCount"; ///< The JSON key for the number of operations per repetition
+QString const kKeyRepetitions = "repetitions"; ///< The JSON key for the number of repetitions
+QString const kKeyMinNs = "minNs"; ///< The JSON key for the duration of the fastest repetition
+QString const kKeyMedianNs = "medianNs"; ///< The JSON key for the duration of the median repetition
+QString const kKeyNsPerOperation = "nsPerOperation"; ///< The JSON key for the median duration of an operation
+QString const kKeyOperationsPerSecond = "operationsPerSecond"; ///< The JSON key for the median number of operations per second
+
+
+//****************************************************************************************************************************************************
+/// \brief A consumer of the keystroke queue that applies the events to a typed text buffer, like the combo matcher
+/// thread does before looking for matching combos
+//****************************************************************************************************************************************************
+class TypedTextConsumer : public QThread {
+public: // member functions
+    explicit TypedTextConsumer(KeystrokeQueue &queue); ///< Default constructor
+    TypedTextConsumer(TypedTextConsumer const &) = delete; ///< Disabled copy constructor
+    TypedTextConsumer(TypedTextConsumer &&) = delete; ///< Disabled move constructor
+    ~TypedTextConsumer() override = default; ///< Default destructor
+    TypedTextConsumer &operator=(TypedTextConsumer const &) = delete; ///< Disabled assignment operator
+    TypedTextConsumer &operator=(TypedTextConsumer &&) = delete; ///< Disabled move assignment operator
+    void stop(); ///< Stop the thread. Must be called from the producer thread of the queue
+
+protected: // member functions
+    void run() override; ///< Process the events of the queue until a stop event is received
+
+private: // data members
+    KeystrokeQueue &queue_; ///< The keystroke queue
+    TypedTextBuffer buffer_; ///< The typed text
+};
+
+
+//****************************************************************************************************************************************************
+/// \param[in] queue The keystroke queue.
+//****************************************************************************************************************************************************
+TypedTextConsumer::TypedTextConsumer(KeystrokeQueue &queue)
+    : queue_(queue) {
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TypedTextConsumer::stop() {
+    KeystrokeEvent event;
+    event.type = EKeystrokeEventType::Stop;
+    while (!queue_.push(event))
+        QThread::yieldCurrentThread();
+    this->wait();
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TypedTextConsumer::run() {
+    KeystrokeEvent event;
+    while (true) {
+        queue_.waitForEvent();
+        while (queue_.pop(event)) {
+            switch (event.type) {
+            case EKeystrokeEventType::Stop:
+                queue_.markProcessed();
+                return;
+            case EKeystrokeEventType::Character:
+                buffer_.append(event.character);
+                break;
+            case EKeystrokeEventType::Backspace:
+                buffer_.removeLast();
+                break;
+            default:
+                buffer_.clear();
+                break;
+            }
+            queue_.markProcessed();
+        }
+    }
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \return The JSON object for the result.
+//****************************************************************************************************************************************************
+QJsonObject BenchmarkResult::toJsonObject() const {
+    QList<qint64> sorted = durationsNs;
+    std::sort(sorted.begin(), sorted.end());
+    qint64 const minNs = sorted.isEmpty() ? 0 : sorted.front();
+    qint64 const medianNs = sorted.isEmpty() ? 0 : sorted[sorted.size() / 2];
+    QJsonObject result;
+    result[kKeyName] = name;
+    result[kKeyComboCount] = comboCount;
+    result[kKeyOperationCount] = operationCount;
+    result[kKeyRepetitions] = qint32(durationsNs.size());
+    result[kKeyMinNs] = minNs;
+    result[kKeyMedianNs] = medianNs;
+    result[kKeyNsPerOperation] = operationCount > 0 ? double(medianNs) / double(operationCount) : 0.0;
+    result[kKeyOperationsPerSecond] = medianNs > 0 ? 1.0e9 * double(operationCount) / double(medianNs) : 0.0;
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] name The name of the benchmark.
+/// \param[in] comboCount The number of combos in the combo list.
+/// \param[in] operationCount The number of operations performed by each repetition.
+/// \param[in] repetitions The number of repetitions.
+/// \param[in] operation The function performing the operations of one repetition.
+/// \param[in] prepare If not empty, a function called before each repetition. Its duration is not measured.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult measure(QString const &name, qint32 comboCount, qint64 operationCount, qint32 repetitions,
+    std::function<void()> const &operation, std::function<void()> const &prepare) {
+    BenchmarkResult result { name, comboCount, operationCount, {} };
+    QElapsedTimer timer;
+    for (qint32 i = 0; i < qMax(1, repetitions); ++i) {
+        if (prepare)
+            prepare();
+        timer.start();
+        operation();
+        result.durationsNs.append(timer.nsecsElapsed());
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The session is pushed by the current thread, as the input manager does, to a consumer thread that only
+/// maintains the typed text, so the benchmark measures the transfer of events between threads, not the matching.
+///
+/// \param[in] comboCount The number of combos in the combo list the session was generated from.
+/// \param[in] session The typing session.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkKeystrokeQueue(qint32 comboCount, KeystrokeRecording const &session, qint32 repetitions) {
+    BenchmarkResult result { "keystrokeQueue", comboCount, qint64(session.size()), {} };
+    for (qint32 i = 0; i < qMax(1, repetitions); ++i) {
+        std::unique_ptr<KeystrokeQueue> const queue = std::make_unique<KeystrokeQueue>();
+        TypedTextConsumer consumer(*queue);
+        consumer.start();
+        KeystrokeReplayer replayer(session);
+        QElapsedTimer timer;
+        timer.start();
+        (void) feedKeystrokeQueue(replayer, *queue, KeystrokeQueue::capacity / 2);
+        result.durationsNs.append(timer.nsecsElapsed());
+        consumer.stop();
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Each substitution erases the keyword and the trigger, and types the raw snippet, using the key sequences of
+/// the application. The operations are the typed characters.
+///
+/// \param[in] comboCount The number of combos in the combo list.
+/// \param[in] combos The combo list.
+/// \param[in] sample The indexes of the substituted combos in the list.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkSubstitutionSynthesis(qint32 comboCount, SyntheticComboList const &combos,
+    QList<qint32> const &sample, qint32 repetitions) {
+    qint64 charCount = 0;
+    for (qint32 const index: sample)
+        charCount += combos[index].snippet.size();
+    MemoryKeySynthesizer synthesizer;
+    return measure("substitutionSynthesis", comboCount, charCount, repetitions, [&]() {
+        for (qint32 const index: sample) {
+            SyntheticCombo const &combo = combos[index];
+            synthesizer.setText(combo.keyword + ' ');
+            synthesizer.eraseChars(qint32(combo.keyword.size()) + 1);
+            synthesizer.typeText(combo.snippet);
+        }
+    }, [&synthesizer]() { synthesizer.clear(); });
+}
+
+
+} // namespace bench
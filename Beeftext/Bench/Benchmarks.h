@@ -0,0 +1,47 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of benchmark functions
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_BENCHMARKS_H
+#define BEEFTEXT_BENCHMARKS_H
+
+
+#include "SyntheticCorpus.h"
+#include "KeystrokeQueue.h"
+#include <functional>
+
+
+namespace bench {
+
+
+//****************************************************************************************************************************************************
+/// \brief The result of a benchmark
+///
+/// A benchmark runs the same operations several times. The fastest and median repetitions are reported, the slowest
+/// ones being usually perturbed by the warm-up of caches or by other processes.
+//****************************************************************************************************************************************************
+struct BenchmarkResult {
+    QString name; ///< The name of the benchmark
+    qint32 comboCount { 0 }; ///< The number of combos in the combo list
+    qint64 operationCount { 0 }; ///< The number of operations performed by each repetition
+    QList<qint64> durationsNs; ///< The duration of each repetition, in nanoseconds
+    QJsonObject toJsonObject() const; ///< Return the JSON object for the result
+};
+
+
+BenchmarkResult measure(QString const &name, qint32 comboCount, qint64 operationCount, qint32 repetitions,
+    std::function<void()> const &operation, std::function<void()> const &prepare = {}); ///< Measure the duration of repeated operations
+BenchmarkResult benchmarkKeystrokeQueue(qint32 comboCount, KeystrokeRecording const &session, qint32 repetitions); ///< Measure the transfer of a typing session through the keystroke queue
+BenchmarkResult benchmarkSubstitutionSynthesis(qint32 comboCount, SyntheticComboList const &combos,
+    QList<qint32> const &sample, qint32 repetitions); ///< Measure the synthesis of the key strokes of substitutions
+
+
+} // namespace bench
+
+
+#endif // #ifndef BEEFTEXT_BENCHMARKS_H
@@ -0,0 +1,219 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of combo benchmark functions
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ComboBenchmarks.h"
+#include "KeystrokeReplayer.h"
+#include "Combo/ComboManager.h"
+#include "Combo/ComboMatcherThread.h"
+#include "Picker/PickerModel.h"
+#include "Picker/PickerSortFilterProxyModel.h"
+#include "Snippet/SnippetFragment.h"
+#include <XMiLib/Exception.h>
+
+
+using namespace xmilib;
+
+
+namespace bench {
+
+
+//****************************************************************************************************************************************************
+/// \param[out] outList The combo list.
+/// \param[in] combos The synthetic combos.
+//****************************************************************************************************************************************************
+void fillComboList(ComboList &outList, SyntheticComboList const &combos) {
+    outList.clear();
+    GroupList &groups = outList.groupListRef();
+    for (qint32 i = 0; i < SyntheticCorpus::groupCount; ++i)
+        groups.append(Group::create(QString("Group %1").arg(i + 1)));
+    for (SyntheticCombo const &synthetic: combos) {
+        SpCombo const combo = Combo::create(synthetic.name, synthetic.keyword, synthetic.snippet, QString(),
+            synthetic.strictMatching ? EMatchingMode::Strict : EMatchingMode::Loose,
+            synthetic.caseSensitive ? ECaseSensitivity::CaseSensitive : ECaseSensitivity::CaseInsensitive, synthetic.enabled);
+        combo->setGroup(groups[synthetic.group]);
+        outList.push_back(combo);
+    }
+    outList.ensureCorrectGrouping();
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] list The combo list.
+/// \param[in] indexes The indexes.
+/// \return The combos.
+//****************************************************************************************************************************************************
+VecSpCombo combosAt(ComboList const &list, QList<qint32> const &indexes) {
+    VecSpCombo result;
+    result.reserve(indexes.size());
+    for (qint32 const index: indexes)
+        result.push_back(list[index]);
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief A dedicated keystroke queue and matcher thread are used, and the matches are only counted, so the benchmark
+/// measures the matching alone, not the substitutions.
+///
+/// \param[in] comboCount The number of combos in the combo list.
+/// \param[in] snapshot The combo snapshot used for matching.
+/// \param[in] session The typing session.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkKeystrokeMatching(qint32 comboCount, SpComboSnapshot const &snapshot,
+    KeystrokeRecording const &session, qint32 repetitions) {
+    BenchmarkResult result { "keystrokeMatching", comboCount, qint64(session.size()), {} };
+    std::atomic<qint64> matchCount { 0 };
+    for (qint32 i = 0; i < qMax(1, repetitions); ++i) {
+        KeystrokeQueue queue;
+        ComboMatcherThread thread(queue);
+        QObject::connect(&thread, &ComboMatcherThread::comboMatched, [&matchCount](VecSpCombo const &, QString const &) {
+            matchCount.fetch_add(1, std::memory_order_relaxed);
+        }, Qt::DirectConnection);
+        thread.setSnapshot(snapshot);
+        thread.start();
+        KeystrokeReplayer replayer(session);
+        QElapsedTimer timer;
+        timer.start();
+        (void) feedKeystrokeQueue(replayer, queue, KeystrokeQueue::capacity / 2);
+        result.durationsNs.append(timer.nsecsElapsed());
+        thread.stop();
+    }
+    if (0 == matchCount.load())
+        throw Exception("The typing session did not trigger any combo.");
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The expansions of pure combos are cached by the combo manager. Without the cache, the expansion cache is
+/// cleared before each repetition, so that every repetition measures the evaluation of the variables. With the cache,
+/// the combos are evaluated once before the measure, so that every repetition measures cache hits.
+///
+/// \param[in] comboCount The number of combos in the combo list.
+/// \param[in] combos The combos to evaluate. They must belong to the combo list of the combo manager, as the
+/// variables they contain can reference other combos.
+/// \param[in] repetitions The number of repetitions.
+/// \param[in] useCache Should the expansion cache be populated before each repetition.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkVariableEvaluation(qint32 comboCount, VecSpCombo const &combos, qint32 repetitions,
+    bool useCache) {
+    std::function<void()> const evaluate = [&combos]() {
+        bool cancelled = false;
+        for (SpCombo const &combo: combos)
+            (void) combo->evaluatedSnippet(cancelled);
+    };
+    ComboExpansionCache &cache = ComboManager::instance().expansionCache();
+    cache.clear();
+    if (!useCache)
+        return measure("variableEvaluation/cold", comboCount, qint64(combos.size()), repetitions, evaluate,
+            [&cache]() { cache.clear(); });
+    evaluate();
+    return measure("variableEvaluation/cached", comboCount, qint64(combos.size()), repetitions, evaluate);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] comboCount The number of combos in the combo list.
+/// \param[in] combos The combos whose snippet is split.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkFragmentSplitting(qint32 comboCount, VecSpCombo const &combos, qint32 repetitions) {
+    QStringList snippets;
+    for (SpCombo const &combo: combos)
+        snippets.append(combo->snippet());
+    return measure("fragmentSplitting", comboCount, qint64(snippets.size()), repetitions, [&snippets]() {
+        for (QString const &snippet: snippets)
+            (void) splitStringIntoSnippetFragments(snippet);
+    });
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The operations are the characters of the snippet, so the duration per operation does not depend on the
+/// length of the snippet if the splitting runs in linear time.
+///
+/// \param[in] snippet The snippet.
+/// \param[in] markerCount The number of #{key:}, #{shortcut:} or #{delay:} variables in the snippet.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkLongSnippetSplitting(QString const &snippet, qint32 markerCount, qint32 repetitions) {
+    return measure(QString("longSnippetSplitting/%1markers").arg(markerCount), 0, qint64(snippet.size()), repetitions,
+        [&snippet]() { (void) splitStringIntoSnippetFragments(snippet); });
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combos The combo list.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkComboListSave(ComboList const &combos, qint32 repetitions) {
+    QTemporaryDir const dir;
+    if (!dir.isValid())
+        throw Exception("Could not create a temporary folder.");
+    QString const path = dir.filePath(ComboList::defaultFileName);
+    return measure("comboListSave", combos.size(), combos.size(), repetitions, [&]() {
+        QString errorMsg;
+        if (!combos.save(path, true, &errorMsg))
+            throw Exception(errorMsg);
+    });
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combos The combo list.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkComboListLoad(ComboList const &combos, qint32 repetitions) {
+    QTemporaryDir const dir;
+    if (!dir.isValid())
+        throw Exception("Could not create a temporary folder.");
+    QString const path = dir.filePath(ComboList::defaultFileName);
+    QString errorMsg;
+    if (!combos.save(path, true, &errorMsg))
+        throw Exception(errorMsg);
+    return measure("comboListLoad", combos.size(), combos.size(), repetitions, [&]() {
+        ComboList list;
+        if (!list.load(path, nullptr, &errorMsg))
+            throw Exception(errorMsg);
+    });
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The picker model reads the combo list of the combo manager, whose snapshot must be up to date.
+///
+/// \param[in] comboCount The number of combos in the combo list.
+/// \param[in] queries The search strings.
+/// \param[in] repetitions The number of repetitions.
+/// \return The result of the benchmark.
+//****************************************************************************************************************************************************
+BenchmarkResult benchmarkPickerFiltering(qint32 comboCount, QStringList const &queries, qint32 repetitions) {
+    PickerModel model;
+    PickerSortFilterProxyModel proxyModel;
+    proxyModel.setSourceModel(&model);
+    proxyModel.sort(0, Qt::DescendingOrder);
+    return measure("pickerFiltering", comboCount, qint64(queries.size()), repetitions, [&]() {
+        for (QString const &query: queries) {
+            proxyModel.setFilterFixedString(query);
+            (void) proxyModel.rowCount();
+        }
+        proxyModel.setFilterFixedString(QString());
+    });
+}
+
+
+} // namespace bench
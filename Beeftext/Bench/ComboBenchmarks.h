@@ -0,0 +1,38 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of combo benchmark functions
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_COMBO_BENCHMARKS_H
+#define BEEFTEXT_COMBO_BENCHMARKS_H
+
+
+#include "Benchmarks.h"
+#include "Combo/ComboList.h"
+#include "Combo/ComboSnapshot.h"
+
+
+namespace bench {
+
+
+void fillComboList(ComboList &outList, SyntheticComboList const &combos); ///< Replace the content of a combo list with synthetic combos
+VecSpCombo combosAt(ComboList const &list, QList<qint32> const &indexes); ///< Return the combos found at some indexes of a combo list
+BenchmarkResult benchmarkKeystrokeMatching(qint32 comboCount, SpComboSnapshot const &snapshot,
+    KeystrokeRecording const &session, qint32 repetitions); ///< Measure the matching of combos against a typing session
+BenchmarkResult benchmarkVariableEvaluation(qint32 comboCount, VecSpCombo const &combos, qint32 repetitions,
+    bool useCache); ///< Measure the evaluation of snippets containing variables
+BenchmarkResult benchmarkFragmentSplitting(qint32 comboCount, VecSpCombo const &combos, qint32 repetitions); ///< Measure the splitting of snippets into fragments
+BenchmarkResult benchmarkLongSnippetSplitting(QString const &snippet, qint32 markerCount, qint32 repetitions); ///< Measure the splitting of a long snippet into fragments
+BenchmarkResult benchmarkComboListSave(ComboList const &combos, qint32 repetitions); ///< Measure the saving of the combo list
+BenchmarkResult benchmarkComboListLoad(ComboList const &combos, qint32 repetitions); ///< Measure the loading of the combo list
+BenchmarkResult benchmarkPickerFiltering(qint32 comboCount, QStringList const &queries, qint32 repetitions); ///< Measure the filtering of the combo picker
+
+
+} // namespace bench
+
+
+#endif // #ifndef BEEFTEXT_COMBO_BENCHMARKS_H
@@ -0,0 +1,130 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of random generator class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "RandomGenerator.h"
+
+
+namespace {
+
+
+qint64 constexpr kFixedOne = 1 << 16; ///< The value 1 in the 16.16 fixed-point format used by the log-normal distribution
+double constexpr kLn2 = 0.69314718055994530942; ///< The natural logarithm of 2
+qint32 constexpr kExp2StepBits = 4; ///< The base 2 logarithm of the number of steps in the table of powers of 2
+std::array<qint64, 17> constexpr kExp2Table = { 65536, 68438, 71468, 74632, 77936, 81386, 84990, 88752, 92682, 96785,
+    101070, 105545, 110218, 115098, 120194, 125515, 131072 }; ///< The values of 2^(i/16) for i in [0, 16], in 16.16 fixed-point format
+
+
+//****************************************************************************************************************************************************
+/// \brief The fractional part of the exponent is used to interpolate linearly between the values of kExp2Table.
+///
+/// \param[in] exponent The exponent, in 16.16 fixed-point format.
+/// \return The integer part of 2 raised to the power of exponent, saturated to the range of qint32.
+//****************************************************************************************************************************************************
+qint32 exp2Fixed(qint64 exponent) {
+    if (exponent < 0)
+        return 0;
+    qint64 const integerPart = exponent >> 16;
+    if (integerPart >= 31)
+        return std::numeric_limits<qint32>::max();
+    qint64 const fraction = exponent & (kFixedOne - 1);
+    qint64 const index = fraction >> (16 - kExp2StepBits);
+    qint64 const remainder = fraction & ((1 << (16 - kExp2StepBits)) - 1);
+    qint64 const mantissa = kExp2Table[index]
+        + (((kExp2Table[index + 1] - kExp2Table[index]) * remainder) >> (16 - kExp2StepBits));
+    return qint32(qMin<qint64>((mantissa << integerPart) >> 16, std::numeric_limits<qint32>::max()));
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \param[in] seed The seed.
+//****************************************************************************************************************************************************
+RandomGenerator::RandomGenerator(quint32 seed)
+    : state_(seed) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The 32 most significant bits of the next value of the generator.
+//****************************************************************************************************************************************************
+quint32 RandomGenerator::generate() {
+    return quint32(this->next() >> 32);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The value is obtained by multiplication and shift rather than by modulo. The bias is negligible for the
+/// small bounds used by the corpus generator.
+///
+/// \param[in] highest The exclusive upper bound. Must be in [1, 2^31 - 1].
+/// \return A value in [0, highest).
+//****************************************************************************************************************************************************
+qint32 RandomGenerator::bounded(qsizetype highest) {
+    Q_ASSERT((highest > 0) && (highest <= std::numeric_limits<qint32>::max()));
+    return qint32((quint64(this->generate()) * quint64(highest)) >> 32);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return A value in [0, 1), with 53 bits of randomness.
+//****************************************************************************************************************************************************
+double RandomGenerator::generateDouble() {
+    return double(this->next() >> 11) * (1.0 / 9007199254740992.0); // multiplying by 2^-53 is exact
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] weights The weights. They must be positive or zero, and their sum must be positive.
+/// \return An index in the list of weights.
+//****************************************************************************************************************************************************
+qint32 RandomGenerator::weightedIndex(QList<qint32> const &weights) {
+    qint64 total = 0;
+    for (qint32 const weight: weights)
+        total += weight;
+    qint64 draw = this->bounded(total);
+    for (qint32 i = 0; i < weights.size(); ++i) {
+        draw -= weights[i];
+        if (draw < 0)
+            return i;
+    }
+    return qint32(weights.size()) - 1;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The standard normal distribution is approximated by the sum of 12 uniform values (Irwin-Hall distribution),
+/// and the exponential is computed in fixed-point arithmetic, so that no function of the math library is used.
+///
+/// \param[in] logMean The mean of the natural logarithm of the values.
+/// \param[in] logStdDev The standard deviation of the natural logarithm of the values.
+/// \param[in] highest The inclusive upper bound.
+/// \return A value in [1, highest].
+//****************************************************************************************************************************************************
+qint32 RandomGenerator::boundedLogNormal(double logMean, double logStdDev, qint32 highest) {
+    qint64 normal = -6 * (kFixedOne - 1); // the 16-bit uniform values have a mean of (2^16 - 1) / 2
+    for (qint32 i = 0; i < 12; ++i)
+        normal += qint64(this->generate() >> 16);
+    qint64 const log2Mean = qint64(logMean / kLn2 * double(kFixedOne));
+    qint64 const log2StdDev = qint64(logStdDev / kLn2 * double(kFixedOne));
+    return qBound(1, exp2Fixed(log2Mean + ((log2StdDev * normal) >> 16)), qMax(1, highest));
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The next value of the SplitMix64 sequence.
+//****************************************************************************************************************************************************
+quint64 RandomGenerator::next() {
+    quint64 result = (state_ += 0x9e3779b97f4a7c15ULL);
+    result = (result ^ (result >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    result = (result ^ (result >> 27)) * 0x94d049bb133111ebULL;
+    return result ^ (result >> 31);
+}
@@ -0,0 +1,43 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of random generator class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_RANDOM_GENERATOR_H
+#define BEEFTEXT_RANDOM_GENERATOR_H
+
+
+//****************************************************************************************************************************************************
+/// \brief A self-contained pseudo-random number generator for the synthetic corpus of the benchmarks
+///
+/// The distributions of the standard library are implementation-defined, so the same seed does not give the same
+/// values with every compiler. This generator is based on SplitMix64, and its distributions only use integer
+/// arithmetic and exactly rounded floating-point operations, so a seed gives the same sequence on every platform.
+//****************************************************************************************************************************************************
+class RandomGenerator {
+public: // member functions
+    explicit RandomGenerator(quint32 seed); ///< Default constructor
+    RandomGenerator(RandomGenerator const &) = delete; ///< Disabled copy constructor
+    RandomGenerator(RandomGenerator &&) = delete; ///< Disabled move constructor
+    ~RandomGenerator() = default; ///< Default destructor
+    RandomGenerator &operator=(RandomGenerator const &) = delete; ///< Disabled assignment operator
+    RandomGenerator &operator=(RandomGenerator &&) = delete; ///< Disabled move assignment operator
+    quint32 generate(); ///< Generate a 32-bit value
+    qint32 bounded(qsizetype highest); ///< Generate a value in [0, highest)
+    double generateDouble(); ///< Generate a value in [0, 1)
+    qint32 weightedIndex(QList<qint32> const &weights); ///< Generate an index in a list of weights, with a probability proportional to its weight
+    qint32 boundedLogNormal(double logMean, double logStdDev, qint32 highest); ///< Generate a value in [1, highest] following an approximate log-normal distribution
+
+private: // member functions
+    quint64 next(); ///< Advance the state of the generator and return a 64-bit value
+
+private: // data members
+    quint64 state_ { 0 }; ///< The state of the generator
+};
+
+
+#endif // #ifndef BEEFTEXT_RANDOM_GENERATOR_H
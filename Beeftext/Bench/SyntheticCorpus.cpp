@@ -0,0 +1,249 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of synthetic corpus class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "SyntheticCorpus.h"
+#include "KeystrokeReplayer.h"
+
+
+namespace {
+
+
+qint32 constexpr kMinKeywordLength = 2; ///< The length of the shortest keywords, not including the prefix
+QList<qint32> const kKeywordLengthWeights = { 4, 14, 20, 19, 14, 10, 7, 5, 3, 2, 2 }; ///< The relative frequency of keyword lengths, starting at kMinKeywordLength
+qint32 constexpr kMaxSnippetLength = 20000; ///< The maximum length of a snippet
+double constexpr kSnippetLengthLogMean = 4.4; ///< The mean of the logarithm of snippet lengths, i.e. a median length of about 80 characters
+double constexpr kSnippetLengthLogStdDev = 1.1; ///< The standard deviation of the logarithm of snippet lengths
+double constexpr kVariableProbability = 0.15; ///< The probability for a snippet to contain variables
+double constexpr kMultilineProbability = 0.2; ///< The probability for a snippet to span multiple lines
+double constexpr kKeywordTypingProbability = 0.06; ///< The probability for a typed word to be a combo keyword
+double constexpr kTypoProbability = 0.02; ///< The probability for a typed word to contain a typo fixed using backspace
+QStringList const kKeywordPrefixes = { "", "", "", "", "", ";", ";", ";", "::", "//" }; ///< The prefixes of keywords, empty ones being more frequent
+QStringList const kSyllables = { "ba", "be", "bi", "bo", "ca", "ce", "co", "da", "de", "di", "do", "fa", "fe", "fi", "ga", "ge",
+    "go", "la", "le", "li", "lo", "ma", "me", "mi", "mo", "na", "ne", "no", "pa", "pe", "pi", "po", "ra", "re", "ri", "ro", "sa",
+    "se", "si", "so", "ta", "te", "ti", "to", "tion", "ment", "ing", "er", "est", "al" }; ///< The syllables used to build random words
+QStringList const kPlainVariables = { "date", "time", "dateTime", "dateTime:yyyy-MM-dd HH:mm", "envVar:PATH" }; ///< The variables that do not reference another combo
+QStringList const kComboVariablePrefixes = { "combo:", "upper:", "lower:", "trim:" }; ///< The prefixes of variables referencing another combo
+QStringList const kFragmentVariables = { "key:tab", "key:left:3", "key:enter", "shortcut:Ctrl+Shift+A", "delay:5" }; ///< The variables splitting snippets into fragments
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \param[in] seed The seed of the random number generator.
+//****************************************************************************************************************************************************
+SyntheticCorpus::SyntheticCorpus(quint32 seed)
+    : rng_(seed) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Keywords are unique, and variables only reference the keywords of previously generated combos, so the
+/// generated combos never reference each other recursively.
+///
+/// \param[in] comboCount The number of combos.
+/// \return The combos.
+//****************************************************************************************************************************************************
+SyntheticComboList SyntheticCorpus::generateCombos(qint32 comboCount) {
+    SyntheticComboList result;
+    result.reserve(comboCount);
+    QSet<QString> usedKeywords;
+    usedKeywords.reserve(comboCount);
+    QStringList keywords;
+    keywords.reserve(comboCount);
+    for (qint32 i = 0; i < comboCount; ++i) {
+        SyntheticCombo combo;
+        combo.keyword = this->randomKeyword();
+        if (usedKeywords.contains(combo.keyword))
+            combo.keyword += QString::number(i, 36);
+        usedKeywords.insert(combo.keyword);
+        // the random values are drawn in separate statements, so that the order of the draws is always the same
+        combo.snippet = this->randomSnippet(keywords);
+        combo.name = rng_.bounded(2) ? this->randomWord() : QString();
+        combo.strictMatching = rng_.bounded(4) != 0;
+        combo.caseSensitive = rng_.bounded(3) == 0;
+        combo.enabled = rng_.bounded(20) != 0;
+        combo.group = rng_.bounded(groupCount);
+        keywords.append(combo.keyword);
+        result.append(combo);
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The session is made of random words separated by spaces, some of them being combo keywords, and some of
+/// them containing typos corrected using backspace.
+///
+/// \param[in] combos The combo list.
+/// \param[in] keystrokeCount The number of keystrokes.
+/// \return The recording of the typing session.
+//****************************************************************************************************************************************************
+KeystrokeRecording SyntheticCorpus::generateTypingSession(SyntheticComboList const &combos, qint32 keystrokeCount) {
+    QString text;
+    text.reserve(keystrokeCount + 32);
+    while (text.size() < keystrokeCount) {
+        if (rng_.generateDouble() < kTypoProbability)
+            text += QChar(u'a' + rng_.bounded(26)) + QString("\b");
+        if ((!combos.isEmpty()) && (rng_.generateDouble() < kKeywordTypingProbability))
+            text += combos[rng_.bounded(combos.size())].keyword;
+        else
+            text += this->randomWord();
+        text += ' ';
+    }
+    text.truncate(keystrokeCount);
+    return KeystrokeReplayer::recordingFromText(text);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combos The combo list.
+/// \param[in] queryCount The number of queries.
+/// \return The queries, made of keyword prefixes, of words found in combos, and of random strings.
+//****************************************************************************************************************************************************
+QStringList SyntheticCorpus::generatePickerQueries(SyntheticComboList const &combos, qint32 queryCount) {
+    QStringList result;
+    for (qint32 i = 0; i < queryCount; ++i) {
+        SyntheticCombo const *combo = combos.isEmpty() ? nullptr : &combos[rng_.bounded(combos.size())];
+        switch (combo ? rng_.bounded(3) : 2) {
+        case 0:
+            result.append(combo->keyword.left(2 + rng_.bounded(2)));
+            break;
+        case 1:
+            result.append(combo->snippet.section(' ', 0, 0).left(6));
+            break;
+        default: {
+            // the order of evaluation of the operands of an expression is unspecified, so each value is drawn in its own statement
+            QString const first = kSyllables[rng_.bounded(kSyllables.size())];
+            result.append(first + kSyllables[rng_.bounded(kSyllables.size())]);
+            break;
+        }
+        }
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combos The combo list.
+/// \param[in] sampleSize The number of combos to pick. Combos may be picked several times.
+/// \param[in] withVariablesOnly Should only the combos whose snippet contains variables be picked.
+/// \return The indexes of the combos in the list.
+//****************************************************************************************************************************************************
+QList<qint32> SyntheticCorpus::sampleCombos(SyntheticComboList const &combos, qint32 sampleSize, bool withVariablesOnly) {
+    QList<qint32> candidates;
+    for (qint32 i = 0; i < combos.size(); ++i)
+        if ((!withVariablesOnly) || combos[i].snippet.contains("#{"))
+            candidates.append(i);
+    QList<qint32> result;
+    if (candidates.isEmpty())
+        return result;
+    result.reserve(sampleSize);
+    for (qint32 i = 0; i < sampleSize; ++i)
+        result.append(candidates[rng_.bounded(candidates.size())]);
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The variables are spread evenly in the snippet, which is made of random words.
+///
+/// \param[in] length The approximate length of the snippet, in characters.
+/// \param[in] markerCount The number of #{key:}, #{shortcut:} or #{delay:} variables in the snippet.
+/// \return The snippet.
+//****************************************************************************************************************************************************
+QString SyntheticCorpus::generateLongSnippet(qint32 length, qint32 markerCount) {
+    QString result;
+    result.reserve(length + 64);
+    qint32 const interval = qMax(1, length / qMax(1, markerCount + 1));
+    qint32 markers = 0;
+    qint32 nextMarkerPos = interval;
+    while ((result.size() < length) || (markers < markerCount)) {
+        if ((markers < markerCount) && (result.size() >= nextMarkerPos)) {
+            result += QString("#{%1}").arg(kFragmentVariables[rng_.bounded(kFragmentVariables.size())]);
+            ++markers;
+            nextMarkerPos += interval;
+        } else
+            result += this->randomWord();
+        result += rng_.bounded(12) ? ' ' : '\n';
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return A random word made of 1 to 4 syllables.
+//****************************************************************************************************************************************************
+QString SyntheticCorpus::randomWord() {
+    QString result;
+    qint32 const syllableCount = 1 + rng_.bounded(4);
+    for (qint32 i = 0; i < syllableCount; ++i)
+        result += kSyllables[rng_.bounded(kSyllables.size())];
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return A random keyword. The keyword may already be in use.
+//****************************************************************************************************************************************************
+QString SyntheticCorpus::randomKeyword() {
+    qint32 const length = kMinKeywordLength + rng_.weightedIndex(kKeywordLengthWeights);
+    QString result = kKeywordPrefixes[rng_.bounded(kKeywordPrefixes.size())];
+    for (qint32 i = 0; i < length; ++i)
+        result += rng_.bounded(10) ? QChar(u'a' + rng_.bounded(26)) : QChar(u'0' + rng_.bounded(10));
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keywords The keywords that can be referenced by the variable.
+/// \return A random variable, including the enclosing #{}.
+//****************************************************************************************************************************************************
+QString SyntheticCorpus::randomVariable(QStringList const &keywords) {
+    switch (rng_.bounded(3)) {
+    case 0:
+        if (!keywords.isEmpty()) {
+            QString const prefix = kComboVariablePrefixes[rng_.bounded(kComboVariablePrefixes.size())];
+            return QString("#{%1%2}").arg(prefix, keywords[rng_.bounded(keywords.size())]);
+        }
+        [[fallthrough]];
+    case 1:
+        return QString("#{%1}").arg(kPlainVariables[rng_.bounded(kPlainVariables.size())]);
+    default:
+        return QString("#{%1}").arg(kFragmentVariables[rng_.bounded(kFragmentVariables.size())]);
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keywords The keywords that can be referenced by variables in the snippet.
+/// \return A random snippet.
+//****************************************************************************************************************************************************
+QString SyntheticCorpus::randomSnippet(QStringList const &keywords) {
+    qint32 const length = rng_.boundedLogNormal(kSnippetLengthLogMean, kSnippetLengthLogStdDev, kMaxSnippetLength);
+    bool const multiline = rng_.generateDouble() < kMultilineProbability;
+    bool const hasVariables = rng_.generateDouble() < kVariableProbability;
+    QString result;
+    result.reserve(length + 16);
+    qint32 lineLength = 0;
+    while (result.size() < length) {
+        QString const word = (hasVariables && (rng_.bounded(8) == 0)) ? this->randomVariable(keywords) : this->randomWord();
+        result += word;
+        lineLength += qint32(word.size());
+        if (multiline && (lineLength > 60)) {
+            result += '\n';
+            lineLength = 0;
+        } else
+            result += ' ';
+    }
+    if (hasVariables && !result.contains("#{"))
+        result += this->randomVariable(keywords);
+    return result.trimmed();
+}
@@ -0,0 +1,73 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of synthetic corpus class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_SYNTHETIC_CORPUS_H
+#define BEEFTEXT_SYNTHETIC_CORPUS_H
+
+
+#include "RandomGenerator.h"
+#include "KeystrokeQueue.h"
+
+
+//****************************************************************************************************************************************************
+/// \brief The properties of a synthetic combo
+///
+/// The combos are described by plain values, so that the corpus does not depend on the combo model, which is only
+/// available in the Windows build.
+//****************************************************************************************************************************************************
+struct SyntheticCombo {
+    QString name; ///< The name of the combo
+    QString keyword; ///< The keyword of the combo
+    QString snippet; ///< The snippet of the combo
+    bool strictMatching { true }; ///< Does the combo use the strict matching mode
+    bool caseSensitive { false }; ///< Is the keyword of the combo case sensitive
+    bool enabled { true }; ///< Is the combo enabled
+    qint32 group { 0 }; ///< The index of the group of the combo, in [0, SyntheticCorpus::groupCount)
+};
+typedef QList<SyntheticCombo> SyntheticComboList; ///< Type definition for lists of synthetic combos
+
+
+//****************************************************************************************************************************************************
+/// \brief A generator of reproducible synthetic combo lists and typing sessions for benchmarks
+///
+/// Keyword lengths follow a distribution peaking at 4 to 5 characters, and some keywords use a common prefix
+/// such as ';' or '::'. Snippet lengths follow a log-normal distribution, so most snippets are a few words long
+/// while a few are several kilobytes long. Some snippets contain variables, including references to the keywords of
+/// previously generated combos, and #{key:}, #{shortcut:} or #{delay:} fragments. The output only depends on the
+/// seed, and is the same on every platform.
+//****************************************************************************************************************************************************
+class SyntheticCorpus {
+public: // static data members
+    static qint32 constexpr groupCount = 12; ///< The number of groups in a synthetic combo list
+
+public: // member functions
+    explicit SyntheticCorpus(quint32 seed); ///< Default constructor
+    SyntheticCorpus(SyntheticCorpus const &) = delete; ///< Disabled copy constructor
+    SyntheticCorpus(SyntheticCorpus &&) = delete; ///< Disabled move constructor
+    ~SyntheticCorpus() = default; ///< Default destructor
+    SyntheticCorpus &operator=(SyntheticCorpus const &) = delete; ///< Disabled assignment operator
+    SyntheticCorpus &operator=(SyntheticCorpus &&) = delete; ///< Disabled move assignment operator
+    SyntheticComboList generateCombos(qint32 comboCount); ///< Generate a list of synthetic combos
+    KeystrokeRecording generateTypingSession(SyntheticComboList const &combos, qint32 keystrokeCount); ///< Generate the keystrokes of a typing session
+    QStringList generatePickerQueries(SyntheticComboList const &combos, qint32 queryCount); ///< Generate search strings typed in the combo picker
+    QList<qint32> sampleCombos(SyntheticComboList const &combos, qint32 sampleSize, bool withVariablesOnly); ///< Pick random combos from a list
+    QString generateLongSnippet(qint32 length, qint32 markerCount); ///< Generate a long snippet containing many #{key:}, #{shortcut:} or #{delay:} variables
+
+private: // member functions
+    QString randomWord(); ///< Generate a random word
+    QString randomKeyword(); ///< Generate a random keyword
+    QString randomVariable(QStringList const &keywords); ///< Generate a random variable
+    QString randomSnippet(QStringList const &keywords); ///< Generate a random snippet
+
+private: // data members
+    RandomGenerator rng_; ///< The random number generator
+};
+
+
+#endif // #ifndef BEEFTEXT_SYNTHETIC_CORPUS_H
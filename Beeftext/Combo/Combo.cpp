@@ -18,6 +18,7 @@
 #include "Preferences/PreferencesManager.h"
 #include "BeeftextGlobals.h"
 #include "BeeftextConstants.h"
+#include "SubstitutionTracer.h"
 #include "XMiLib/Exception.h"
 #include <utility>
 
@@ -47,6 +48,7 @@ QString const kPropEnabled = "enabled"; ///< The JSON property name for the enab
 QString const kCursorVariable = "#{cursor}"; ///< The cursor position variable.
 qint32 const kPlaceholderMaxLength = 50; ///< The maximum length of the placeholder name.
 QString const kPlaceholderElision = "..."; ///< The elision text for placeholder (used if placeholder name is too long.
+quint64 matchDescriptorRevision = 1; ///< The current revision of the settings used to compute match descriptors.
 
 
 } // anonymous namespace
@@ -69,6 +71,15 @@ QString Combo::placeholderName(QString const &keyword, QString const &snippet) {
 }
 
 
+//****************************************************************************************************************************************************
+/// \brief This function must be called when a setting that is not stored in the combos but affects their matching
+/// changes, i.e. the default matching mode, the default case sensitivity or the enabled state of a group.
+//****************************************************************************************************************************************************
+void Combo::invalidateMatchDescriptors() {
+    ++matchDescriptorRevision;
+}
+
+
 //****************************************************************************************************************************************************
 /// \param[in] name The display name of the combo
 /// \param[in] keyword The keyword
@@ -203,6 +214,7 @@ QString Combo::keyword() const {
 void Combo::setKeyword(QString const &keyword) {
     if (keyword_ != keyword) {
         keyword_ = keyword;
+        matchDescriptor_.revision = 0;
         this->touch();
     }
 }
@@ -222,11 +234,24 @@ QString Combo::snippet() const {
 void Combo::setSnippet(QString const &snippet) {
     if (snippet_ != snippet) {
         snippet_ = snippet;
+        compiledSnippet_.reset();
         this->touch();
     }
 }
 
 
+//****************************************************************************************************************************************************
+/// \note The snippet is compiled on first use after it was modified.
+///
+/// \return The compiled snippet.
+//****************************************************************************************************************************************************
+SnippetTemplate const &Combo::compiledSnippet() const {
+    if (!compiledSnippet_)
+        compiledSnippet_ = std::make_shared<SnippetTemplate const>(snippet_);
+    return *compiledSnippet_;
+}
+
+
 //****************************************************************************************************************************************************
 /// \return The description.
 //****************************************************************************************************************************************************
@@ -264,6 +289,7 @@ EMatchingMode Combo::matchingMode(bool resolveDefault) const {
 void Combo::setMatchingMode(EMatchingMode mode) {
     if (matchingMode_ != mode) {
         matchingMode_ = mode;
+        matchDescriptor_.revision = 0;
         this->touch();
     }
 }
@@ -287,6 +313,7 @@ ECaseSensitivity Combo::caseSensitivity(bool resolveDefault) const {
 void Combo::setCaseSensitivity(ECaseSensitivity caseSensitivity) {
     if (caseSensitivity_ != caseSensitivity) {
         caseSensitivity_ = caseSensitivity;
+        matchDescriptor_.revision = 0;
         this->touch();
     }
 }
@@ -339,6 +366,7 @@ SpGroup Combo::group() const {
 void Combo::setGroup(SpGroup const &group) {
     if (group != group_) {
         group_ = group;
+        matchDescriptor_.revision = 0;
         this->touch();
     }
 }
@@ -350,6 +378,7 @@ void Combo::setGroup(SpGroup const &group) {
 void Combo::setEnabled(bool enabled) {
     // Note that enabling / disabling an item does not change its last modification date/time
     enabled_ = enabled;
+    matchDescriptor_.revision = 0;
 }
 
 
@@ -366,7 +395,7 @@ bool Combo::isEnabled() const {
 /// not member of a group).
 //****************************************************************************************************************************************************
 bool Combo::isUsable() const {
-    return enabled_ && ((!group()) || group_->enabled());
+    return this->matchDescriptor().usable;
 }
 
 
@@ -375,22 +404,42 @@ bool Combo::isUsable() const {
 /// \return true if and only if the input is a match for the combo
 //****************************************************************************************************************************************************
 bool Combo::matchesForInput(QString const &input) const {
-    if (keyword_.isEmpty())
+    if (keyword_.isEmpty() || (input.size() < keyword_.size()))
         return false;
-    Qt::CaseSensitivity const cs = (this->caseSensitivity(true) == ECaseSensitivity::CaseInsensitive)
-                                   ? Qt::CaseInsensitive : Qt::CaseSensitive;
-    return (this->matchingMode(true) == EMatchingMode::Loose) ? input.endsWith(keyword_, cs) :
-           (input.compare(keyword_, cs) == 0);
+    MatchDescriptor const &descriptor = this->matchDescriptor();
+    return (descriptor.matchingMode == EMatchingMode::Loose) ? input.endsWith(keyword_, descriptor.caseSensitivity) :
+           (input.compare(keyword_, descriptor.caseSensitivity) == 0);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The descriptor is recomputed only if the combo or the settings it depends on were modified since it was last
+/// computed, so in most cases this function does not access the preferences or the group of the combo.
+///
+/// \return The match descriptor of the combo.
+//****************************************************************************************************************************************************
+Combo::MatchDescriptor const &Combo::matchDescriptor() const {
+    if (matchDescriptor_.revision != matchDescriptorRevision)
+        this->refreshMatchDescriptor();
+    return matchDescriptor_;
 }
 
 
 //****************************************************************************************************************************************************
 /// \brief compute the number of time the cursor must be shifted to the left to reach the position of the cursor
 /// variable.
+///
+/// \note The evaluated text is used rather than the compiled snippet, as the #{cursor} variable may come from a
+/// referenced combo, and the #{key:} and #{delay:} variables that follow it may come from referenced combos or input
+/// variables.
 //****************************************************************************************************************************************************
 qint32 computeCursorLeftShift(QString const &str) {
+    if (!str.contains(kCursorVariable)) // most snippets have no cursor variable, so the variables are not removed
+        return -1;
+    static QRegularExpression const keyAndDelayRegExp(QString(R"((%1)|(%2))").arg(constants::kDelayVariableRegExpStr,
+        constants::kKeyVariableRegExpStr)); // not an anonymous namespace constant, as it depends on constants from another translation unit
     QString s = str;
-    s.remove(QRegularExpression(QString(R"((%1)|(%2))").arg(constants::kDelayVariableRegExpStr, constants::kKeyVariableRegExpStr)));
+    s.remove(keyAndDelayRegExp);
     qsizetype const index = s.lastIndexOf(kCursorVariable);
     if (index < 0)
         return -1;
@@ -404,15 +453,18 @@ qint32 computeCursorLeftShift(QString const &str) {
 /// dismissing a variable input dialog.
 //****************************************************************************************************************************************************
 bool Combo::performSubstitution(bool triggeredByPicker) {
+    TraceSpan const span("Combo::performSubstitution");
     bool cancelled = false;
     QMap<QString, QString> knownInputVariables;
-    QSet<QString> const forbiddenSubcombos;
-    QString newText = this->evaluatedSnippet(cancelled, forbiddenSubcombos, knownInputVariables);
+    ComboReferenceStack referenceStack;
+    referenceStack.isTracking = ComboManager::instance().isRecursionGuardNeeded();
+    QString newText = this->evaluatedSnippet(cancelled, referenceStack, knownInputVariables);
     if (cancelled)
         return false;
     if (!knownInputVariables.isEmpty()) {
         // we displayed the input variable dialog at least once. Some slow/heavy application (Electron-based stuff like
         // Slack & al. for instance) will need some time to properly regain focus.
+        TraceSpan const focusSpan("Combo::waitForFocusAfterInputDialog");
         qApp->thread()->msleep(300);
     }
 
@@ -538,38 +590,69 @@ void Combo::touch() {
 }
 
 
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void Combo::refreshMatchDescriptor() const {
+    matchDescriptor_.foldedKeyword = keyword_.toCaseFolded();
+    matchDescriptor_.matchingMode = this->matchingMode(true);
+    matchDescriptor_.caseSensitivity = (this->caseSensitivity(true) == ECaseSensitivity::CaseInsensitive)
+                                       ? Qt::CaseInsensitive : Qt::CaseSensitive;
+    matchDescriptor_.usable = enabled_ && ((!group_) || group_->enabled());
+    matchDescriptor_.revision = matchDescriptorRevision;
+}
+
+
 //****************************************************************************************************************************************************
 ///  This function does not process the #{cursor} variable.
 ///
 /// \param[out] outCancelled Did the user cancel user input
-/// \param[in] forbiddenSubCombos The text of the combos that are not allowed to be substituted using #{combo:}, to 
-/// avoid endless recursion
+/// \param[in,out] referenceStack The keywords of the combos being expanded by nested #{combo:} variables, which
+/// are not allowed to be substituted again, to avoid endless recursion. The stack is restored before the function returns.
 /// \param[in,out] knownInputVariables The list of know input variables.
+/// \param[out] outPure If not null, on exit the value pointed to indicates whether the evaluation is pure, i.e. whether
+/// evaluating the snippet again would give the same text as long as the combo list is not modified.
 /// \return The snippet text once it has been evaluated
 //****************************************************************************************************************************************************
-QString Combo::evaluatedSnippet(bool &outCancelled, QSet<QString> const &forbiddenSubCombos,
-    QMap<QString, QString> &knownInputVariables) const {
+QString Combo::evaluatedSnippet(bool &outCancelled, ComboReferenceStack &referenceStack,
+    QMap<QString, QString> &knownInputVariables, bool *outPure) const {
+    TraceSpan const span("Combo::evaluatedSnippet"); // sub-combos are traced as nested spans
     outCancelled = false;
-    QString remainingText = snippet_;
+    ComboManager &comboManager = ComboManager::instance();
+    ComboExpansionCache &cache = comboManager.expansionCache();
     QString result;
+    if (cache.find(*this, result)) {
+        if (outPure)
+            *outPure = true;
+        return result;
+    }
 
-    while (true) {
-        QRegularExpressionMatch match = constants::kVariableRegExp.match(remainingText);
-        if (!match.hasMatch())
-            return result += remainingText;
-
-        QString variable = match.captured(1);
-        qint32 const pos = qint32(match.capturedStart(0));
-        if (pos > 0)
-            result += remainingText.left(pos);
-        remainingText = remainingText.right(remainingText.size() - pos - match.capturedLength(0));
-
-        variable.replace("\\}", "}");
-        result += evaluateVariable(variable, forbiddenSubCombos, knownInputVariables, outCancelled);
-
-        if (outCancelled)
+    SnippetTemplate const &compiled = this->compiledSnippet();
+    bool pure = compiled.isPure();
+    result.reserve(compiled.literalLength());
+    for (SnippetTemplate::Node const &node: compiled.nodes()) {
+        if (ESnippetNodeType::Literal == node.type) {
+            result += node.text;
+            continue;
+        }
+        result += evaluateVariable(node, referenceStack, knownInputVariables, outCancelled, pure);
+        if (outCancelled) {
+            if (outPure)
+                *outPure = false;
             return QString();
+        }
+    }
+
+    // references are resolved using the snapshot, so we do not cache expansions computed with an outdated snapshot,
+    // nor expansions of combos that are not in the list, which the cache would not be notified about.
+    if (pure && comboManager.isSnapshotUpToDate()) {
+        SpComboSnapshot const snapshot = comboManager.snapshot();
+        if (snapshot && snapshot->searchEntry(this))
+            cache.insert(*this, result, compiled.referencedKeywords());
     }
+    if (outPure)
+        *outPure = pure;
+    return result;
 }
 
 
@@ -578,7 +661,8 @@ QString Combo::evaluatedSnippet(bool &outCancelled, QSet<QString> const &forbidd
 /// \return The snippet text once it has been evaluated
 //****************************************************************************************************************************************************
 QString Combo::evaluatedSnippet(bool &outCancelled) const {
-    QSet<QString> const forbiddenSubCombos;
+    ComboReferenceStack referenceStack;
+    referenceStack.isTracking = ComboManager::instance().isRecursionGuardNeeded();
     QMap<QString, QString> knownInputVariables;
-    return evaluatedSnippet(outCancelled, forbiddenSubCombos, knownInputVariables);
+    return evaluatedSnippet(outCancelled, referenceStack, knownInputVariables);
 }
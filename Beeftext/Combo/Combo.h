@@ -14,6 +14,7 @@
 #include "Group/GroupList.h"
 #include "MatchingMode.h"
 #include "CaseSensitivity.h"
+#include "Snippet/SnippetTemplate.h"
 #include <memory>
 #include <vector>
 
@@ -25,12 +26,36 @@ typedef std::shared_ptr<Combo> SpCombo; ///< Type definition for shared pointer
 typedef std::vector<SpCombo> VecSpCombo; ///< Type definition for vector of SpCombo
 
 
+//****************************************************************************************************************************************************
+/// \brief The keywords of the combos being expanded by nested #{combo:} variables, used to avoid endless recursion
+///
+/// Tracking is disabled when the combo reference graph is known to contain no cycle, as the recursion is then bounded.
+/// The nesting depth is always counted and capped, as a safety net in case the graph is wrong.
+//****************************************************************************************************************************************************
+struct ComboReferenceStack {
+    static qint32 constexpr maxDepth = 64; ///< The maximum nesting depth of #{combo:} variables
+    QVarLengthArray<QString, 16> keywords; ///< The keywords, from the outermost to the innermost reference
+    bool isTracking { true }; ///< Are the keywords tracked
+    qint32 depth { 0 }; ///< The current nesting depth, counted even when the keywords are not tracked
+};
+
+
 //****************************************************************************************************************************************************
 /// \brief The combo class that link a combo keyword and a snippet
 //****************************************************************************************************************************************************
 class Combo {
+public: // data types
+    struct MatchDescriptor {
+        QString foldedKeyword; ///< The case-folded keyword
+        EMatchingMode matchingMode { EMatchingMode::Strict }; ///< The matching mode, with 'Default' resolved
+        Qt::CaseSensitivity caseSensitivity { Qt::CaseSensitive }; ///< The case sensitivity, with 'Default' resolved
+        bool usable { false }; ///< Is the combo usable
+        quint64 revision { 0 }; ///< The revision of the matching settings the descriptor was computed for. 0 means outdated
+    }; ///< Type definition for the pre-resolved information used to check whether a combo matches an input
+
 public: // static member functions
     static QString placeholderName(QString const &keyword, QString const &snippet);
+    static void invalidateMatchDescriptors(); ///< Mark the match descriptors of all combos as outdated
 
 public: // member functions
     Combo(QString name, QString keyword, QString snippet, QString description, EMatchingMode matchingMode,
@@ -51,6 +76,7 @@ public: // member functions
     void setKeyword(QString const &keyword); ///< Set the keyword
     QString snippet() const; ///< Retrieve the snippet
     void setSnippet(QString const &snippet); ///< Set the snippet
+    SnippetTemplate const &compiledSnippet() const; ///< Return the compiled snippet, compiling it if necessary
     QString description() const; ///< Retrieve the description of the snippet.
     void setDescription(QString const &description); ///< Set the description of the snippet.
     EMatchingMode matchingMode(bool resolveDefault) const; ///< Get the matching mode of the combo.
@@ -64,12 +90,13 @@ public: // member functions
     SpGroup group() const; ///< Get the combo group the combo belongs to
     void setGroup(SpGroup const &group); ///< Set the group this combo belongs to
     QString evaluatedSnippet(bool &outCancelled) const; ///< Retrieve the the snippet after having evaluated it, but leave the #{cursor} variable in place.
-    QString evaluatedSnippet(bool &outCancelled, const QSet<QString> &forbiddenSubCombos,
-        QMap<QString, QString> &knownInputVariables) const; ///< Retrieve the the snippet after having evaluated it, but leave the #{cursor} variable in place.
+    QString evaluatedSnippet(bool &outCancelled, ComboReferenceStack &referenceStack,
+        QMap<QString, QString> &knownInputVariables, bool *outPure = nullptr) const; ///< Retrieve the the snippet after having evaluated it, but leave the #{cursor} variable in place.
     void setEnabled(bool enabled); ///< Set the combo as enabled or not
     bool isEnabled() const; ///< Check whether the combo is enabled
     bool isUsable() const; ///< Check if the combo is usable, i.e. if it is enabled and member of a group that is enabled.
     bool matchesForInput(QString const &input) const; ///< Check if the combo is a match for the given input
+    MatchDescriptor const &matchDescriptor() const; ///< Return the match descriptor of the combo, refreshing it if it is outdated
     bool performSubstitution(bool triggeredByPicker); ///< Perform the combo substitution
     QJsonObject toJsonObject(bool includeGroup) const; ///< Serialize the combo in a JSon object
     void changeUuid(); ///< Get a new Uuid for the combo
@@ -85,6 +112,7 @@ public: // static functions
 
 private: // member functions
     void touch(); ///< set the modification date/time to now
+    void refreshMatchDescriptor() const; ///< Recompute the match descriptor of the combo
 
 private: // data member
     QUuid uuid_; ///< The UUID of the combo
@@ -99,9 +127,14 @@ private: // data member
     QDateTime modificationDateTime_; ///< The date/time of the last modification of the combo
     QDateTime lastUseDateTime_; ///< The last use date/time
     bool enabled_ { true }; ///< Is the combo enabled
+    mutable MatchDescriptor matchDescriptor_; ///< The match descriptor, lazily refreshed
+    mutable SpSnippetTemplate compiledSnippet_; ///< The compiled snippet, lazily compiled. Null if outdated
 };
 
 
+Q_DECLARE_METATYPE(VecSpCombo)
+
+
 extern QString const kPropUseHtml; ///< The JSON property for the "Use HTML" property, introduced in file format v7
 
 
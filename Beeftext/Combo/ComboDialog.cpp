@@ -16,6 +16,7 @@
 #include "BeeftextConstants.h"
 #include "Group/GroupDialog.h"
 #include "Preferences/PreferencesManager.h"
+#include "Snippet/SnippetTemplate.h"
 #include <XMiLib/Exception.h>
 #include <XMiLib/XMiLibConstants.h>
 
@@ -168,6 +169,32 @@ bool ComboDialog::checkAndReportInvalidCombo() {
 }
 
 
+//****************************************************************************************************************************************************
+/// \brief The references are checked against the combo reference graph, as if the combo had already been modified.
+///
+/// \return true if and only if the references are valid or the user decided to proceed anyway.
+//****************************************************************************************************************************************************
+bool ComboDialog::checkAndReportInvalidReferences() {
+    SnippetTemplate const compiled(ui_.comboEditor->plainText());
+    QStringList const references = compiled.referencedKeywords();
+    if (references.isEmpty())
+        return true;
+    QString const keyword = ui_.editKeyword->text().trimmed();
+    ComboReferenceGraph const &graph = ComboManager::instance().referenceGraph();
+    QStringList const cycle = graph.findCycle(combo_.get(), keyword, references);
+    if ((!cycle.isEmpty()) && (!questionDialog(this, tr("Circular reference"), tr("This combo is part of a circular "
+        "reference: %1\n\nWhen a combo is referenced while it is being expanded, the variable is inserted as plain "
+        "text.").arg(QString("'%1'").arg(cycle.join("' -> '"))), tr("&Continue"), tr("C&ancel"))))
+        return false;
+    QStringList const unresolved = graph.unresolvedReferences(combo_.get(), keyword, references);
+    if ((!unresolved.isEmpty()) && (!questionDialog(this, tr("Unresolved reference"), tr("No combo uses the "
+        "following referenced keywords: %1\n\nThe variables referencing them will be inserted as plain text.")
+        .arg(QString("'%1'").arg(unresolved.join("', '"))), tr("&Continue"), tr("C&ancel"))))
+        return false;
+    return true;
+}
+
+
 //****************************************************************************************************************************************************
 // 
 //****************************************************************************************************************************************************
@@ -183,6 +210,8 @@ void ComboDialog::onActionOk() {
     } else if ((keyword.size() < 3) && prefs.warnAboutShortComboKeywords()
                && (!showShortKeywordConfirmationDialog(keyword, this)))
         return;
+    if (!this->checkAndReportInvalidReferences())
+        return;
     combo_->setName(ui_.editName->text().trimmed());
     combo_->setGroup(ui_.comboGroup->currentGroup());
     combo_->setMatchingMode(selectedMatchingModeInCombo(*ui_.comboMatching));
@@ -33,6 +33,7 @@ public: // member functions
 
 private: // member functions
     bool checkAndReportInvalidCombo(); ///< Check the keyword against existing combos and report conflicts
+    bool checkAndReportInvalidReferences(); ///< Check the references to other combos and report cycles and unresolved references
 
 private slots:
     void onActionOk(); ///< Slot for the 'OK' action
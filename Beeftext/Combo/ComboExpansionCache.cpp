@@ -0,0 +1,104 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of combo expansion cache class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ComboExpansionCache.h"
+#include "Combo.h"
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \param[out] outText The cached expansion of the combo. If the function returns false, the value of this parameter is
+/// unchanged.
+/// \return true if and only if the expansion of the combo is cached.
+//****************************************************************************************************************************************************
+bool ComboExpansionCache::find(Combo const &combo, QString &outText) const {
+    QHash<Combo const *, Entry>::const_iterator const it = entries_.constFind(&combo);
+    if ((it == entries_.constEnd()) || (it.value().uuid != combo.uuid()))
+        return false;
+    outText = it.value().text;
+    return true;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo, which must be pure.
+/// \param[in] text The expanded snippet of the combo.
+/// \param[in] referencedKeywords The keywords directly referenced by the snippet of the combo.
+//****************************************************************************************************************************************************
+void ComboExpansionCache::insert(Combo const &combo, QString const &text, QStringList const &referencedKeywords) {
+    this->removeEntry(&combo);
+    entries_.insert(&combo, { combo.uuid(), text, combo.keyword(), referencedKeywords });
+    for (QString const &keyword: referencedKeywords)
+        dependents_[keyword].insert(&combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The combos that reference the keyword of the combo before or after its modification are invalidated, as
+/// the modification may have changed the combo a reference resolves to.
+///
+/// \param[in] combo The modified combo.
+//****************************************************************************************************************************************************
+void ComboExpansionCache::invalidateCombo(Combo const &combo) {
+    this->removeEntry(&combo);
+    this->invalidateKeyword(combo.keyword());
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keyword The keyword.
+//****************************************************************************************************************************************************
+void ComboExpansionCache::invalidateKeyword(QString const &keyword) {
+    QHash<QString, QSet<Combo const *>>::iterator const it = dependents_.find(keyword);
+    if (it == dependents_.end())
+        return;
+    QSet<Combo const *> const dependents = it.value();
+    dependents_.erase(it);
+    for (Combo const *dependent: dependents)
+        this->removeEntry(dependent);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboExpansionCache::clear() {
+    entries_.clear();
+    dependents_.clear();
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of cached expansions.
+//****************************************************************************************************************************************************
+qsizetype ComboExpansionCache::size() const {
+    return entries_.size();
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo. If the expansion of the combo is not cached, the function does nothing.
+//****************************************************************************************************************************************************
+void ComboExpansionCache::removeEntry(Combo const *combo) {
+    QHash<Combo const *, Entry>::iterator const it = entries_.find(combo);
+    if (it == entries_.end())
+        return;
+    Entry const entry = it.value();
+    entries_.erase(it);
+    for (QString const &keyword: entry.referencedKeywords) {
+        QHash<QString, QSet<Combo const *>>::iterator const dependentsIt = dependents_.find(keyword);
+        if (dependentsIt == dependents_.end())
+            continue;
+        dependentsIt.value().remove(combo);
+        if (dependentsIt.value().isEmpty())
+            dependents_.erase(dependentsIt);
+    }
+    this->invalidateKeyword(entry.keyword); // the entry is removed first, so the recursion always terminates
+}
@@ -0,0 +1,65 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of combo expansion cache class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_COMBO_EXPANSION_CACHE_H
+#define BEEFTEXT_COMBO_EXPANSION_CACHE_H
+
+
+class Combo;
+
+
+//****************************************************************************************************************************************************
+/// \brief A cache of the fully expanded snippets of pure combos
+///
+/// A combo is pure if its compiled snippet is pure, and every combo it references is unambiguous (a single combo uses
+/// the keyword), pure, and does not lead back to a combo being expanded. The expansion of a pure combo is the same
+/// every time it is evaluated, until a combo it depends on, directly or not, is modified.
+///
+/// The cache keeps a reverse dependency graph, from each keyword to the cached combos that reference it. When a combo
+/// is modified, its cached expansion is dropped, as well as the expansions of the combos that reference its old or
+/// new keyword, and so on recursively. Deep template hierarchies are then expanded with a single lookup.
+///
+/// Combos are identified by their address. An entry whose combo was deleted without being removed from the cache
+/// (e.g. when a combo is replaced in the list) is ignored, as its UUID does not match the combo found at the address.
+///
+/// The cache is not thread-safe, and must only be used from the main thread, like the combos it references.
+//****************************************************************************************************************************************************
+class ComboExpansionCache {
+public: // member functions
+    ComboExpansionCache() = default; ///< Default constructor
+    ComboExpansionCache(ComboExpansionCache const &) = delete; ///< Disabled copy constructor
+    ComboExpansionCache(ComboExpansionCache &&) = delete; ///< Disabled move constructor
+    ~ComboExpansionCache() = default; ///< Default destructor
+    ComboExpansionCache &operator=(ComboExpansionCache const &) = delete; ///< Disabled assignment operator
+    ComboExpansionCache &operator=(ComboExpansionCache &&) = delete; ///< Disabled move assignment operator
+    bool find(Combo const &combo, QString &outText) const; ///< Retrieve the cached expansion of a combo
+    void insert(Combo const &combo, QString const &text, QStringList const &referencedKeywords); ///< Cache the expansion of a pure combo
+    void invalidateCombo(Combo const &combo); ///< Drop the expansions that depend on a modified combo
+    void invalidateKeyword(QString const &keyword); ///< Drop the expansions that depend on a keyword
+    void clear(); ///< Drop all the expansions
+    qsizetype size() const; ///< Return the number of cached expansions
+
+private: // data types
+    struct Entry {
+        QUuid uuid; ///< The UUID of the combo, used to detect a combo allocated at the address of a deleted one
+        QString text; ///< The expanded snippet
+        QString keyword; ///< The keyword of the combo when it was expanded
+        QStringList referencedKeywords; ///< The keywords directly referenced by the snippet
+    }; ///< Type definition for a cached expansion
+
+private: // member functions
+    void removeEntry(Combo const *combo); ///< Remove an entry and its dependencies, then invalidate the entries depending on it
+
+private: // data members
+    QHash<Combo const *, Entry> entries_; ///< The cached expansions
+    QHash<QString, QSet<Combo const *>> dependents_; ///< The reverse dependency graph: for each keyword, the cached combos referencing it
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_EXPANSION_CACHE_H
@@ -199,7 +199,7 @@ void ComboImportDialog::performFinalImport(qint32 &outFailureCount) {
             continue;
         }
         combo->setGroup(group);
-        *it = combo;
+        comboList.replace(static_cast<qint32>(it - comboList.begin()), combo);
     }
 }
 
@@ -0,0 +1,938 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of combo keyword index class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ComboKeywordIndex.h"
+#include <atomic>
+
+
+namespace {
+
+
+std::atomic<quint64> lastRevision { 0 }; ///< The last revision number given to an index
+qint32 constexpr kMinDeadNodeCountForCompaction = 1024; ///< The number of pruned nodes below which the automaton is never rebuilt
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+ComboKeywordIndex::ComboKeywordIndex() {
+    this->clear();
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::clear() {
+    caseSensitiveKeywords_ = KeywordTable();
+    caseInsensitiveKeywords_ = KeywordTable();
+    caseInsensitiveComboCount_ = 0;
+    nodeChunks_.clear();
+    nodeCount_ = 0;
+    this->appendNode(Node()); // the root node
+    entries_ = EntryTable();
+    emojiShortcodes_.clear();
+    emojiLeftDelimiter_.clear();
+    emojiRightDelimiter_.clear();
+    emojiNodes_.clear();
+    deadNodeCount_ = 0;
+    linksAreOutdated_ = false;
+    keywordLengthCounts_.clear();
+    maxEmojiTriggerLength_ = 0;
+    maxKeywordLength_ = 0;
+    rootFailureChildren_.clear();
+    linkVisitCount_ = 0;
+    ++generation_;
+    this->markAsModified();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The emoji triggers of the index are kept.
+///
+/// \param[in] combos The list of combos.
+/// \param[in] defaultMatchingMode The default matching mode, used for combos whose matching mode is 'Default'.
+/// \param[in] defaultCaseSensitivity The default case sensitivity, used for combos whose case sensitivity is 'Default'.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::build(VecSpCombo const &combos, EMatchingMode defaultMatchingMode,
+    ECaseSensitivity defaultCaseSensitivity) {
+    QStringList const emojiShortcodes = emojiShortcodes_;
+    QString const emojiLeftDelimiter = emojiLeftDelimiter_;
+    QString const emojiRightDelimiter = emojiRightDelimiter_;
+    this->clear();
+    linksAreOutdated_ = true; // the links are computed once all the triggers are inserted
+    defaultMatchingMode_ = defaultMatchingMode;
+    defaultCaseSensitivity_ = defaultCaseSensitivity;
+    for (SpCombo const &combo: combos)
+        this->insert(combo);
+    emojiShortcodes_ = emojiShortcodes;
+    emojiLeftDelimiter_ = emojiLeftDelimiter;
+    emojiRightDelimiter_ = emojiRightDelimiter;
+    this->insertEmojiTriggers();
+    this->updateMaxKeywordLength();
+    this->updateLinks();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the combo is already in the index, its entry is updated.
+///
+/// \param[in] combo The combo.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::addCombo(SpCombo const &combo) {
+    this->updateCombo(combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The combo is located using the entry recorded when it was inserted, so the function works even if the
+/// keyword or the matching options of the combo have been modified since. The nodes of the automaton that no longer
+/// lead to any trigger are pruned.
+///
+/// \param[in] combo The combo.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::removeCombo(SpCombo const &combo) {
+    if (!combo)
+        return;
+    QHash<Combo const *, Entry> const &entries = entries_[shardIndex(combo.get())];
+    if (!entries.contains(combo.get())) // checked on the const table, so that a shared shard is not copied
+        return;
+    Entry const entry = entries.value(combo.get());
+    if (entry.node >= 0) {
+        Node &node = this->mutableNodeAt(entry.node);
+        removeFromList(node.combos, combo.get());
+        if (!hasTriggers(node))
+            this->updateOutputLinks(entry.node); // the output links may point to the node
+        this->pruneBranch(entry.node);
+    }
+    else {
+        QHash<quint64, VecSpCombo> &keywords = (entry.caseInsensitive ? caseInsensitiveKeywords_ : caseSensitiveKeywords_)[shardIndex(entry.key)];
+        QHash<quint64, VecSpCombo>::iterator const bucket = keywords.find(entry.key);
+        if (bucket != keywords.end()) {
+            removeFromList(bucket.value(), combo.get());
+            if (bucket.value().empty())
+                keywords.erase(bucket);
+        }
+        if (entry.caseInsensitive)
+            --caseInsensitiveComboCount_;
+    }
+    QMap<qint32, qint32>::iterator const length = keywordLengthCounts_.find(static_cast<qint32>(entry.keyword.size()));
+    if ((length != keywordLengthCounts_.end()) && (--length.value() <= 0))
+        keywordLengthCounts_.erase(length);
+    entries_[shardIndex(combo.get())].remove(combo.get());
+    this->updateMaxKeywordLength();
+    this->compactAutomatonIfNeeded();
+    this->updateLinks();
+    this->markAsModified();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the keyword, matching options and usability of the combo are the ones it was indexed with, e.g. if only
+/// its snippet was modified, the index is left untouched.
+///
+/// \param[in] combo The combo.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::updateCombo(SpCombo const &combo) {
+    if (this->isEntryUpToDate(combo))
+        return;
+    this->removeCombo(combo);
+    this->insert(combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the shortcodes and delimiters are identical to the current ones, the function does nothing. Emoji triggers
+/// are disabled by passing an empty list of shortcodes, or an empty left delimiter. Since all the emoji triggers are
+/// replaced, the links of the automaton are recomputed as a whole rather than patched for each trigger.
+///
+/// \param[in] shortcodes The shortcodes of the emojis.
+/// \param[in] leftDelimiter The left delimiter for emoji shortcodes.
+/// \param[in] rightDelimiter The right delimiter for emoji shortcodes.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::setEmojiTriggers(QStringList const &shortcodes, QString const &leftDelimiter,
+    QString const &rightDelimiter) {
+    if ((leftDelimiter == emojiLeftDelimiter_) && (rightDelimiter == emojiRightDelimiter_) && (shortcodes == emojiShortcodes_))
+        return;
+    linksAreOutdated_ = true;
+    this->removeEmojiTriggers();
+    emojiShortcodes_ = shortcodes;
+    emojiLeftDelimiter_ = leftDelimiter;
+    emojiRightDelimiter_ = rightDelimiter;
+    this->insertEmojiTriggers();
+    this->updateMaxKeywordLength();
+    this->compactAutomatonIfNeeded();
+    this->updateLinks();
+    this->markAsModified();
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The left delimiter of the emoji triggers.
+//****************************************************************************************************************************************************
+QString ComboKeywordIndex::emojiLeftDelimiter() const {
+    return emojiLeftDelimiter_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The right delimiter of the emoji triggers.
+//****************************************************************************************************************************************************
+QString ComboKeywordIndex::emojiRightDelimiter() const {
+    return emojiRightDelimiter_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] defaultMatchingMode The default matching mode.
+/// \param[in] defaultCaseSensitivity The default case sensitivity.
+/// \return true if and only if the index was built using the specified default matching mode and case sensitivity.
+//****************************************************************************************************************************************************
+bool ComboKeywordIndex::isBuiltForDefaults(EMatchingMode defaultMatchingMode, ECaseSensitivity defaultCaseSensitivity) const {
+    return (defaultMatchingMode == defaultMatchingMode_) && (defaultCaseSensitivity == defaultCaseSensitivity_);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The generation of the index. States of the automaton obtained from a previous generation are invalid.
+/// Adding nodes to the automaton or pruning nodes from it changes the generation.
+//****************************************************************************************************************************************************
+quint64 ComboKeywordIndex::generation() const {
+    return generation_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note Revision numbers are unique among all indexes, so two indexes with the same revision have the same content,
+/// the one being a copy of the other.
+///
+/// \return The revision of the index.
+//****************************************************************************************************************************************************
+quint64 ComboKeywordIndex::revision() const {
+    return revision_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The length of the longest keyword or emoji trigger in the index.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::maxKeywordLength() const {
+    return maxKeywordLength_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The function does not allocate memory unless a candidate is found.
+///
+/// \param[in] input The input text.
+/// \return The list of strict matching combos whose keyword may be equal to the input, ignoring case for
+/// case-insensitive combos. Since combos are indexed by hash, the candidates must be confirmed using isMatch().
+//****************************************************************************************************************************************************
+VecSpCombo ComboKeywordIndex::findStrictCandidates(QStringView input) const {
+    if (input.isEmpty() || (input.size() > maxKeywordLength_)) // no need to hash an input that is longer than any keyword
+        return VecSpCombo();
+    quint64 const key = keywordHash(input, false);
+    VecSpCombo result = caseSensitiveKeywords_[shardIndex(key)].value(key);
+    if (caseInsensitiveComboCount_ > 0) {
+        quint64 const foldedKey = keywordHash(input, true);
+        VecSpCombo const combos = caseInsensitiveKeywords_[shardIndex(foldedKey)].value(foldedKey);
+        result.insert(result.end(), combos.begin(), combos.end());
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The code point is case-folded as a whole, like the keywords of case-insensitive strict matching combos (see
+/// keywordHash()), so characters outside the Basic Multilingual Plane are folded too.
+///
+/// \param[in] state The current state of the automaton.
+/// \param[in] codePoint The typed code point. An unpaired surrogate is processed as a code point of its own.
+/// \return The new state of the automaton.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::nextState(qint32 state, char32_t codePoint) const {
+    char32_t const folded = QChar::toCaseFolded(codePoint);
+    while (true) {
+        qint32 const child = this->childNode(state, folded);
+        if (child >= 0)
+            return child;
+        if (rootState == state)
+            return rootState;
+        state = this->nodeAt(state).failure;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note Only the last characters of the text can have an influence on the state, so the cost of this function
+/// depends on the length of the longest keyword, not on the length of the text. A high surrogate at the end of the
+/// text is not processed, as its low surrogate has not been typed yet (see ComboMatcher).
+///
+/// \param[in] text The text.
+/// \return The state of the automaton after the text has been typed, starting from the root state.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::stateForText(QStringView text) const {
+    if ((!text.isEmpty()) && text.back().isHighSurrogate())
+        text.chop(1);
+    QStringView const tail = text.last(qMin<qsizetype>(text.size(), maxKeywordLength_));
+    qint32 state = rootState;
+    for (qsizetype i = 0; i < tail.size();)
+        state = this->nextState(state, nextCodePoint(tail, i));
+    return state;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The combos and the emojis are collected in a single walk of the output chain, from the longest trigger to the
+/// shortest.
+///
+/// \param[in] state The state of the automaton.
+/// \param[out] outCandidates The candidates, to which the loose matching combos whose case-folded keyword is a suffix
+/// of the case-folded typed text, and the emojis whose case-folded delimited shortcode is a suffix of the case-folded
+/// typed text, are appended.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::appendCandidates(qint32 state, Candidates &outCandidates) const {
+    if ((state < 0) || (state >= nodeCount_))
+        return;
+    for (qint32 index = state; index >= 0; index = this->nodeAt(index).output) {
+        Node const &node = this->nodeAt(index);
+        outCandidates.combos.insert(outCandidates.combos.end(), node.combos.begin(), node.combos.end());
+        outCandidates.emojiShortcodes.append(node.emojiShortcodes);
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note This function does not access the combo, so it can be used by a thread that does not own the combos.
+///
+/// \param[in] combo The combo.
+/// \param[in] input The input text.
+/// \return true if and only if the combo is in the index and matches the input.
+//****************************************************************************************************************************************************
+bool ComboKeywordIndex::isMatch(Combo const *combo, QStringView input) const {
+    QHash<Combo const *, Entry> const &entries = entries_[shardIndex(combo)];
+    QHash<Combo const *, Entry>::const_iterator const it = entries.constFind(combo);
+    if (it == entries.constEnd())
+        return false;
+    Entry const &entry = it.value();
+    Qt::CaseSensitivity const cs = entry.caseInsensitive ? Qt::CaseInsensitive : Qt::CaseSensitive;
+    return (entry.node >= 0) ? input.endsWith(entry.keyword, cs) : (0 == input.compare(entry.keyword, cs));
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The count is meant to check the cost of the incremental update of the links. It is zero if the trigger did
+/// not add any node, or if the links are computed as a whole.
+///
+/// \return The number of existing nodes visited to update the failure links when the last trigger was inserted.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::linkVisitCount() const {
+    return linkVisitCount_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::insert(SpCombo const &combo) {
+    if (!combo)
+        return;
+    QString const keyword = combo->keyword();
+    if ((!combo->matchDescriptor().usable) || keyword.isEmpty())
+        return;
+    ++keywordLengthCounts_[static_cast<qint32>(keyword.size())];
+    maxKeywordLength_ = qMax(maxKeywordLength_, static_cast<qint32>(keyword.size()));
+    Entry entry;
+    entry.keyword = keyword;
+    entry.caseInsensitive = this->isCaseInsensitive(*combo);
+    if (this->isLoose(*combo)) {
+        entry.node = this->insertInAutomaton(keyword);
+        Node &node = this->mutableNodeAt(entry.node);
+        bool const hadTriggers = hasTriggers(node);
+        node.combos.push_back(combo);
+        if (!hadTriggers)
+            this->updateOutputLinks(entry.node); // the output links of the failure subtree may now point to the node
+    }
+    else {
+        entry.key = keywordHash(keyword, entry.caseInsensitive);
+        (entry.caseInsensitive ? caseInsensitiveKeywords_ : caseSensitiveKeywords_)[shardIndex(entry.key)][entry.key].push_back(combo);
+        if (entry.caseInsensitive)
+            ++caseInsensitiveComboCount_;
+    }
+    entries_[shardIndex(combo.get())].insert(combo.get(), entry);
+    this->markAsModified();
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return true if and only if updating the entry of the combo would leave the index unchanged.
+//****************************************************************************************************************************************************
+bool ComboKeywordIndex::isEntryUpToDate(SpCombo const &combo) const {
+    if (!combo)
+        return true;
+    QHash<Combo const *, Entry> const &entries = entries_[shardIndex(combo.get())];
+    QHash<Combo const *, Entry>::const_iterator const it = entries.constFind(combo.get());
+    QString const keyword = combo->keyword();
+    if ((!combo->matchDescriptor().usable) || keyword.isEmpty())
+        return it == entries.constEnd();
+    if (it == entries.constEnd())
+        return false;
+    Entry const &entry = it.value();
+    // the node of a loose matching combo only depends on its keyword, and the key of a strict one on its keyword and case sensitivity
+    return (entry.keyword == keyword) && (entry.caseInsensitive == this->isCaseInsensitive(*combo))
+        && ((entry.node >= 0) == this->isLoose(*combo));
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return true if and only if the combo is indexed as case-insensitive, taking the default case sensitivity into account.
+//****************************************************************************************************************************************************
+bool ComboKeywordIndex::isCaseInsensitive(Combo const &combo) const {
+    ECaseSensitivity sensitivity = combo.caseSensitivity(false);
+    if (ECaseSensitivity::Default == sensitivity)
+        sensitivity = defaultCaseSensitivity_;
+    return ECaseSensitivity::CaseInsensitive == sensitivity;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return true if and only if the combo uses loose matching, taking the default matching mode into account.
+//****************************************************************************************************************************************************
+bool ComboKeywordIndex::isLoose(Combo const &combo) const {
+    EMatchingMode mode = combo.matchingMode(false);
+    if (EMatchingMode::Default == mode)
+        mode = defaultMatchingMode_;
+    return EMatchingMode::Loose == mode;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::markAsModified() {
+    revision_ = ++lastRevision;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The trigger is case-folded one code point at a time, like the typed text (see nextState()).
+///
+/// \param[in] trigger The trigger, i.e. the keyword of a loose matching combo or a delimited emoji shortcode.
+/// \return The node for the trigger. The caller is responsible for attaching the combo or emoji to the node.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::insertInAutomaton(QString const &trigger) {
+    qint32 const firstNewNode = nodeCount_;
+    qint32 node = rootState;
+    for (qsizetype i = 0; i < trigger.size();) {
+        char32_t const folded = QChar::toCaseFolded(nextCodePoint(trigger, i));
+        qint32 const existingChild = this->childNode(node, folded);
+        if (existingChild >= 0) {
+            node = existingChild;
+            continue;
+        }
+        Node child;
+        child.parent = node;
+        child.character = folded;
+        child.depth = this->nodeAt(node).depth + 1;
+        qint32 const newNode = this->appendNode(child);
+        NodeChunk &parentChunk = this->mutableChunkOf(node);
+        ++parentChunk.nodes[static_cast<quint32>(node) % nodeChunkSize].childCount;
+        parentChunk.edges.insert(edgeKey(node, folded), newNode);
+        node = newNode;
+        ++generation_; // the states previously computed may not be the longest matching prefix anymore
+    }
+    linkVisitCount_ = 0;
+    if ((!linksAreOutdated_) && (nodeCount_ > firstNewNode))
+        this->linkNewNodes(firstNewNode);
+    return node;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note An empty left delimiter would make any typed text a candidate, so no trigger is inserted in this case.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::insertEmojiTriggers() {
+    if (emojiLeftDelimiter_.isEmpty())
+        return;
+    emojiNodes_.reserve(emojiShortcodes_.size());
+    for (QString const &shortcode: emojiShortcodes_) {
+        if (shortcode.isEmpty())
+            continue;
+        QString const trigger = emojiLeftDelimiter_ + shortcode + emojiRightDelimiter_;
+        qint32 const node = this->insertInAutomaton(trigger);
+        this->mutableNodeAt(node).emojiShortcodes.append(shortcode);
+        emojiNodes_.append(node);
+        maxEmojiTriggerLength_ = qMax(maxEmojiTriggerLength_, static_cast<qint32>(trigger.size()));
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The nodes of the automaton that no longer lead to any trigger are pruned.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::removeEmojiTriggers() {
+    maxEmojiTriggerLength_ = 0;
+    if (emojiNodes_.isEmpty())
+        return;
+    for (qint32 const node: std::as_const(emojiNodes_)) {
+        if (this->nodeAt(node).emojiShortcodes.isEmpty())
+            continue; // several shortcodes may share a node
+        Node &current = this->mutableNodeAt(node);
+        current.emojiShortcodes.clear();
+        if (!hasTriggers(current))
+            this->updateOutputLinks(node);
+    }
+    for (qint32 const node: std::as_const(emojiNodes_))
+        this->pruneBranch(node);
+    emojiNodes_.clear();
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The node is removed if it has no trigger attached and no child, and the same goes for its ancestors.
+///
+/// \note Pruned nodes stay in the storage of the automaton until it is compacted (see compactAutomatonIfNeeded()).
+/// The nodes whose failure link points to a pruned node now fail to the failure node of the pruned node, which is
+/// their next longest suffix. Since the pruned node has no trigger, their output links are unchanged.
+///
+/// \param[in] node The node.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::pruneBranch(qint32 node) {
+    while (node != rootState) {
+        Node const &current = this->nodeAt(node);
+        if (current.isDead || (current.childCount > 0) || hasTriggers(current))
+            return;
+        qint32 const parent = current.parent;
+        char32_t const character = current.character;
+        if (!linksAreOutdated_) {
+            qint32 const failure = current.failure;
+            qint32 child = current.firstFailureChild;
+            while (child >= 0) {
+                qint32 const next = this->nodeAt(child).nextFailureSibling;
+                this->linkFailure(child, failure);
+                child = next;
+            }
+            this->mutableNodeAt(node).firstFailureChild = -1;
+            this->unlinkFailure(node);
+        }
+        NodeChunk &parentChunk = this->mutableChunkOf(parent);
+        parentChunk.edges.remove(edgeKey(parent, character));
+        --parentChunk.nodes[static_cast<quint32>(parent) % nodeChunkSize].childCount;
+        Node &pruned = this->mutableNodeAt(node);
+        pruned = Node();
+        pruned.isDead = true;
+        ++deadNodeCount_;
+        ++generation_; // a state may be the pruned node
+        node = parent;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief When pruned nodes make up more than half of the storage, the combos and emoji triggers are inserted in a new
+/// automaton.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::compactAutomatonIfNeeded() {
+    if ((deadNodeCount_ < kMinDeadNodeCountForCompaction) || (2 * deadNodeCount_ <= nodeCount_))
+        return;
+    linksAreOutdated_ = true; // the links are computed by the caller, once all the triggers are inserted
+    std::vector<SpNodeChunk> const oldChunks = std::move(nodeChunks_);
+    nodeChunks_.clear();
+    nodeCount_ = 0;
+    this->appendNode(Node()); // the root node
+    emojiNodes_.clear();
+    deadNodeCount_ = 0;
+    for (SpNodeChunk const &oldChunk: oldChunks)
+        for (Node const &oldNode: oldChunk->nodes)
+            for (SpCombo const &combo: oldNode.combos) {
+                Entry &entry = entries_[shardIndex(combo.get())][combo.get()];
+                entry.node = this->insertInAutomaton(entry.keyword);
+                this->mutableNodeAt(entry.node).combos.push_back(combo);
+            }
+    this->insertEmojiTriggers();
+    ++generation_;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::updateLinks() {
+    if (!linksAreOutdated_)
+        return;
+    this->computeFailureLinks();
+    linksAreOutdated_ = false;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The new nodes are processed in order of increasing depth. The failure link of a new node is computed as
+/// usual, from the failure chain of its parent. Then, the existing nodes whose longest proper suffix is now the new
+/// node are relinked. The failure node of the new node is a suffix of these nodes, and no longer suffix was in the
+/// automaton before the new node was inserted, so they are failure children of the same node as the new node. They
+/// are the failure children whose character is the character of the new node, and whose parent has the parent of the
+/// new node as a suffix. Only the failure children with the character of the new node are visited, rather than the
+/// failure subtree of the parent, which is the whole automaton when the parent is the root.
+///
+/// \note The new nodes do not have triggers yet, so the output links of the relinked nodes are unchanged.
+///
+/// \param[in] firstNewNode The first node added by the trigger. The new nodes are the last nodes of the automaton, and
+/// each of them is the parent of the next one.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::linkNewNodes(qint32 firstNewNode) {
+    std::vector<qint32> relinkedNodes;
+    for (qint32 index = firstNewNode; index < nodeCount_; ++index) {
+        Node const &node = this->nodeAt(index);
+        qint32 const parent = node.parent;
+        char32_t const character = node.character;
+        qint32 const failure = this->longestSuffixNode(parent, character);
+
+        relinkedNodes.clear();
+        for (qint32 child = this->firstFailureChild(failure, character); child >= 0; child = this->nodeAt(child).nextFailureSibling) {
+            ++linkVisitCount_;
+            if ((child < firstNewNode) && this->hasSuffix(this->nodeAt(child).parent, parent))
+                relinkedNodes.push_back(child);
+        }
+
+        this->linkFailure(index, failure);
+        Node const &failureNode = this->nodeAt(failure);
+        qint32 const output = hasTriggers(failureNode) ? failure : failureNode.output;
+        this->mutableNodeAt(index).output = output;
+        for (qint32 const relinkedNode: relinkedNodes)
+            this->linkFailure(relinkedNode, index);
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the node already has a failure link, it is removed from the failure children of its previous failure node.
+///
+/// \param[in] node The node.
+/// \param[in] failure The failure node.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::linkFailure(qint32 node, qint32 failure) {
+    this->unlinkFailure(node);
+    char32_t const character = this->nodeAt(node).character;
+    qint32 const nextSibling = this->firstFailureChild(failure, character);
+    Node &current = this->mutableNodeAt(node);
+    current.failure = failure;
+    current.previousFailureSibling = -1;
+    current.nextFailureSibling = nextSibling;
+    if (nextSibling >= 0)
+        this->mutableNodeAt(nextSibling).previousFailureSibling = node;
+    this->setFirstFailureChild(failure, character, node);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] node The node.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::unlinkFailure(qint32 node) {
+    Node &current = this->mutableNodeAt(node);
+    qint32 const previousSibling = current.previousFailureSibling;
+    qint32 const nextSibling = current.nextFailureSibling;
+    current.previousFailureSibling = -1;
+    current.nextFailureSibling = -1;
+    if (previousSibling >= 0)
+        this->mutableNodeAt(previousSibling).nextFailureSibling = nextSibling;
+    else if (this->firstFailureChild(current.failure, current.character) == node)
+        this->setFirstFailureChild(current.failure, current.character, nextSibling);
+    if (nextSibling >= 0)
+        this->mutableNodeAt(nextSibling).previousFailureSibling = previousSibling;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The output link of a node only depends on the triggers and output link of its failure node, so the nodes
+/// of the subtree are updated from top to bottom. The output link of the node itself is unchanged, and so is the
+/// subtree of a node whose output link is unchanged, which avoids copying the chunks of that subtree.
+///
+/// \param[in] node The node.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::updateOutputLinks(qint32 node) {
+    if (linksAreOutdated_)
+        return;
+    std::vector<qint32> stack { node };
+    while (!stack.empty()) {
+        qint32 const index = stack.back();
+        stack.pop_back();
+        Node const &current = this->nodeAt(index);
+        qint32 const output = hasTriggers(current) ? index : current.output;
+        for (qint32 child = current.firstFailureChild; child >= 0; child = this->nodeAt(child).nextFailureSibling) {
+            if (this->nodeAt(child).output == output)
+                continue;
+            this->mutableNodeAt(child).output = output;
+            stack.push_back(child);
+        }
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The failure children of a node other than the root all have the character of the node, as the node is a
+/// suffix of them, so the character is only used for the root.
+///
+/// \param[in] node The node.
+/// \param[in] folded The case-folded code point of the failure children.
+/// \return The first node whose failure link points to the node and whose character is folded.
+/// \return -1 if there is no such node.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::firstFailureChild(qint32 node, char32_t folded) const {
+    return (rootState == node) ? rootFailureChildren_.value(folded, -1) : this->nodeAt(node).firstFailureChild;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] node The node.
+/// \param[in] folded The case-folded code point of the failure child.
+/// \param[in] child The first failure child of the node for the character, or -1.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::setFirstFailureChild(qint32 node, char32_t folded, qint32 child) {
+    if (rootState != node)
+        this->mutableNodeAt(node).firstFailureChild = child;
+    else if (child < 0)
+        rootFailureChildren_.remove(folded);
+    else
+        rootFailureChildren_.insert(folded, child);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The links of the node must be up to date. The cost of the function is at most the difference of depth of the
+/// nodes.
+///
+/// \param[in] node The node.
+/// \param[in] suffix The suffix node.
+/// \return true if and only if the keyword prefix of suffix is a suffix of the keyword prefix of node.
+//****************************************************************************************************************************************************
+bool ComboKeywordIndex::hasSuffix(qint32 node, qint32 suffix) const {
+    qint32 const suffixDepth = this->nodeAt(suffix).depth;
+    while (this->nodeAt(node).depth > suffixDepth)
+        node = this->nodeAt(node).failure;
+    return node == suffix;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::updateMaxKeywordLength() {
+    maxKeywordLength_ = qMax(keywordLengthCounts_.isEmpty() ? 0 : keywordLengthCounts_.lastKey(), maxEmojiTriggerLength_);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The links are computed in order of increasing depth, so that the links of a node's parent are always known
+/// when processing the node. The nodes are ordered by depth using a counting sort, so the cost of the function is
+/// linear in the number of nodes.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::computeFailureLinks() {
+    rootFailureChildren_.clear();
+    std::vector<qint32> depthStarts;
+    for (qint32 i = 0; i < nodeCount_; ++i) {
+        Node &node = this->mutableNodeAt(i);
+        node.failure = rootState;
+        node.firstFailureChild = node.nextFailureSibling = node.previousFailureSibling = -1;
+        if (node.isDead)
+            continue;
+        if (static_cast<std::size_t>(node.depth) + 1 >= depthStarts.size())
+            depthStarts.resize(static_cast<std::size_t>(node.depth) + 2, 0);
+        ++depthStarts[static_cast<std::size_t>(node.depth) + 1];
+    }
+    for (std::size_t i = 1; i < depthStarts.size(); ++i)
+        depthStarts[i] += depthStarts[i - 1];
+    std::vector<qint32> order(static_cast<std::size_t>(nodeCount_));
+    for (qint32 i = 0; i < nodeCount_; ++i) {
+        Node const &node = this->nodeAt(i);
+        if (!node.isDead)
+            order[static_cast<std::size_t>(depthStarts[static_cast<std::size_t>(node.depth)]++)] = i;
+    }
+    order.resize(static_cast<std::size_t>(depthStarts.empty() ? 0 : depthStarts.back()));
+
+    for (qint32 const index: order) {
+        if (rootState == index)
+            continue;
+        Node const &node = this->nodeAt(index);
+        qint32 const failure = this->longestSuffixNode(node.parent, node.character);
+        this->linkFailure(index, failure);
+        Node const &failureNode = this->nodeAt(failure);
+        this->mutableNodeAt(index).output = hasTriggers(failureNode) ? failure : failureNode.output;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The links of the parent node and of all the nodes of lower depth must be up to date.
+///
+/// \param[in] parent The parent of the node.
+/// \param[in] folded The case-folded code point on the edge from the parent to the node.
+/// \return The node for the longest proper suffix of the node that is also a keyword prefix.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::longestSuffixNode(qint32 parent, char32_t folded) const {
+    if (rootState == parent)
+        return rootState;
+    qint32 state = this->nodeAt(parent).failure;
+    while (true) {
+        qint32 const child = this->childNode(state, folded);
+        if (child >= 0)
+            return child;
+        if (rootState == state)
+            return rootState;
+        state = this->nodeAt(state).failure;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] node The index of the parent node.
+/// \param[in] folded The case-folded code point.
+/// \return The index of the child node.
+/// \return -1 if the node has no child for the code point.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::childNode(qint32 node, char32_t folded) const {
+    return nodeChunks_[static_cast<quint32>(node) / nodeChunkSize]->edges.value(edgeKey(node, folded), -1);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] node The index of the node.
+/// \return The node.
+//****************************************************************************************************************************************************
+ComboKeywordIndex::Node const &ComboKeywordIndex::nodeAt(qint32 node) const {
+    return nodeChunks_[static_cast<quint32>(node) / nodeChunkSize]->nodes[static_cast<quint32>(node) % nodeChunkSize];
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The reference stays valid until the index is copied, but a reference previously obtained using nodeAt()
+/// for a node of the same chunk may now refer to the chunk of another copy of the index.
+///
+/// \param[in] node The index of the node.
+/// \return The node.
+//****************************************************************************************************************************************************
+ComboKeywordIndex::Node &ComboKeywordIndex::mutableNodeAt(qint32 node) {
+    return this->mutableChunkOf(node).nodes[static_cast<quint32>(node) % nodeChunkSize];
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Copies of the index are only made by the thread that modifies the index, so no other thread can start
+/// sharing a chunk that is not shared. If the chunk is not shared, the threads that held it have released it, and the
+/// acquire fence makes their reads of the chunk happen before its modification.
+///
+/// \param[in] node The index of a node of the chunk.
+/// \return The chunk, that is not shared with any other index.
+//****************************************************************************************************************************************************
+ComboKeywordIndex::NodeChunk &ComboKeywordIndex::mutableChunkOf(qint32 node) {
+    SpNodeChunk &chunk = nodeChunks_[static_cast<quint32>(node) / nodeChunkSize];
+    if (chunk.use_count() > 1)
+        chunk = std::make_shared<NodeChunk>(*chunk);
+    else
+        std::atomic_thread_fence(std::memory_order_acquire);
+    return *chunk;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] node The node.
+/// \return The index of the node.
+//****************************************************************************************************************************************************
+qint32 ComboKeywordIndex::appendNode(Node const &node) {
+    qint32 const index = nodeCount_++;
+    if (0 == static_cast<quint32>(index) % nodeChunkSize)
+        nodeChunks_.push_back(std::make_shared<NodeChunk>());
+    this->mutableNodeAt(index) = node;
+    return index;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] node The index of the parent node.
+/// \param[in] folded The case-folded code point.
+/// \return The key for the edge.
+//****************************************************************************************************************************************************
+quint64 ComboKeywordIndex::edgeKey(qint32 node, char32_t folded) {
+    return (static_cast<quint64>(static_cast<quint32>(node)) << 21) | folded; // code points use at most 21 bits
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The hash is a 64-bit FNV-1a hash of the UTF-16 code units of the text, or of its case-folded code points
+/// for case-insensitive keywords, so that texts that are equal ignoring case have the same hash.
+///
+/// \param[in] text The text.
+/// \param[in] caseInsensitive Is the hash computed for a case-insensitive keyword.
+/// \return The hash of the text.
+//****************************************************************************************************************************************************
+quint64 ComboKeywordIndex::keywordHash(QStringView text, bool caseInsensitive) {
+    quint64 hash = 14695981039346656037ULL;
+    for (qsizetype i = 0; i < text.size();) {
+        char32_t const c = caseInsensitive ? QChar::toCaseFolded(nextCodePoint(text, i)) : text[i++].unicode();
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] text The text.
+/// \param[in,out] ioIndex The index of the first UTF-16 code unit of the code point in the text. On exit, the index of
+/// the code unit following the code point.
+/// \return The code point. An unpaired surrogate is returned as a code point of its own.
+//****************************************************************************************************************************************************
+char32_t ComboKeywordIndex::nextCodePoint(QStringView text, qsizetype &ioIndex) {
+    QChar const c = text[ioIndex++];
+    if (c.isHighSurrogate() && (ioIndex < text.size()) && text[ioIndex].isLowSurrogate())
+        return QChar::surrogateToUcs4(c, text[ioIndex++]);
+    return c.unicode();
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combos The list of combos.
+/// \param[in] combo The combo to remove from the list.
+//****************************************************************************************************************************************************
+void ComboKeywordIndex::removeFromList(VecSpCombo &combos, Combo const *combo) {
+    combos.erase(std::remove_if(combos.begin(), combos.end(), [&](SpCombo const &c) -> bool { return c.get() == combo; }),
+        combos.end());
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] node The node.
+/// \return true if and only if combos or emojis are attached to the node.
+//****************************************************************************************************************************************************
+bool ComboKeywordIndex::hasTriggers(Node const &node) {
+    return (!node.combos.empty()) || (!node.emojiShortcodes.isEmpty());
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] key The key of a strict matching keyword.
+/// \return The index of the shard of the keyword.
+//****************************************************************************************************************************************************
+quint32 ComboKeywordIndex::shardIndex(quint64 key) {
+    return static_cast<quint32>(key % shardCount);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return The index of the shard of the entry of the combo.
+//****************************************************************************************************************************************************
+quint32 ComboKeywordIndex::shardIndex(Combo const *combo) {
+    return static_cast<quint32>(qHash(combo) % shardCount);
+}
@@ -0,0 +1,188 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of combo keyword index class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_COMBO_KEYWORD_INDEX_H
+#define BEEFTEXT_COMBO_KEYWORD_INDEX_H
+
+
+#include "Combo.h"
+
+
+//****************************************************************************************************************************************************
+/// \brief An index used to quickly find the combos and emojis that may be triggered by the typed text
+///
+/// Strict mode combos are stored in hash tables, in separate buckets for case-sensitive and case-insensitive combos.
+/// The tables are keyed by a hash of the keyword, case-folded for case-insensitive combos, that is computed on the fly
+/// from a view on the typed text, so looking up the typed text does not require building a string.
+/// Loose mode combos and emoji shortcodes surrounded by their delimiters are compiled into a single Aho-Corasick
+/// automaton over the code points of case-folded triggers. The automaton is meant to be driven one code point at a time
+/// (see ComboMatcher), and the combos and emojis whose trigger is a suffix of the text typed so far are attached to the
+/// current state. In both cases, the cost of a lookup does not depend on the number of combos or emojis. Only usable
+/// combos are indexed, and candidates from the automaton may differ in case from the input, so candidates must be
+/// confirmed using isMatch() for combos, or by comparing the delimited shortcode with the input for emojis.
+///
+/// The index can be patched one combo at a time using addCombo(), removeCombo() and updateCombo(). The index keeps
+/// track of where each combo was stored, so a combo can be removed or updated after its keyword or matching options
+/// have been modified. When a combo or an emoji trigger is removed, the branch of the automaton that no longer leads to
+/// any trigger is pruned, and the automaton is rebuilt from scratch when the pruned nodes make up most of its storage.
+/// The emoji triggers are replaced as a whole using setEmojiTriggers(), and are kept when the index is rebuilt.
+///
+/// The failure and output links are maintained incrementally, using the tree formed by the failure links. When a
+/// trigger adds nodes to the automaton, only the nodes whose longest suffix becomes one of the new nodes are relinked,
+/// and they are found among the failure children of the failure node of each new node. The failure children of the
+/// root are grouped by character, so that only the failure children with the character of the new node are visited.
+/// When a node is pruned, the nodes linked to it are relinked to its own failure node. When triggers are added or
+/// removed, only the output links in the failure subtree of their node are updated. The links of the whole automaton
+/// are only computed, in a single breadth-first pass, when the index is built or compacted, or when the emoji triggers
+/// are replaced.
+///
+/// Copies of the index share their storage. The nodes of the automaton, along with the edges leaving them, are stored
+/// in fixed-size chunks, and the hash tables are split into shards. Copying the index only copies references to the
+/// chunks and shards, and a chunk or shard is copied the first time it is modified while shared, so the cost of
+/// publishing a modified copy of the index is proportional to the part of the index that was modified, not to its
+/// size. The revision of the index changes every time its content is modified, so that a copy of the index can be
+/// shared as a whole until the index is modified again (see ComboSnapshot).
+///
+/// \note Only the thread that modifies the index may copy it. Other threads may read and release their copies.
+//****************************************************************************************************************************************************
+class ComboKeywordIndex {
+public: // static data members
+    static qint32 constexpr rootState = 0; ///< The initial state of the automaton
+
+public: // data types
+    struct Candidates {
+        VecSpCombo combos; ///< The combos that may be triggered by the typed text
+        QStringList emojiShortcodes; ///< The shortcodes of the emojis that may be triggered, the one with the shortest trigger last
+    }; ///< Type definition for the combos and emojis that may be triggered by the typed text
+
+public: // member functions
+    ComboKeywordIndex(); ///< Default constructor
+    ComboKeywordIndex(ComboKeywordIndex const &) = default; ///< Default copy constructor
+    ComboKeywordIndex(ComboKeywordIndex &&) = default; ///< Default move constructor
+    ~ComboKeywordIndex() = default; ///< Default destructor
+    ComboKeywordIndex &operator=(ComboKeywordIndex const &) = default; ///< Default assignment operator
+    ComboKeywordIndex &operator=(ComboKeywordIndex &&) = default; ///< Default move assignment operator
+    void clear(); ///< Clear the index
+    void build(VecSpCombo const &combos, EMatchingMode defaultMatchingMode, ECaseSensitivity defaultCaseSensitivity); ///< Build the index from a list of combos
+    void addCombo(SpCombo const &combo); ///< Add a combo to the index
+    void removeCombo(SpCombo const &combo); ///< Remove a combo from the index
+    void updateCombo(SpCombo const &combo); ///< Update the entry of a combo whose keyword, matching options or usability may have changed
+    void setEmojiTriggers(QStringList const &shortcodes, QString const &leftDelimiter, QString const &rightDelimiter); ///< Replace the emoji triggers of the automaton
+    QString emojiLeftDelimiter() const; ///< Return the left delimiter of the emoji triggers
+    QString emojiRightDelimiter() const; ///< Return the right delimiter of the emoji triggers
+    bool isBuiltForDefaults(EMatchingMode defaultMatchingMode, ECaseSensitivity defaultCaseSensitivity) const; ///< Check whether the index was built using the given default matching mode and case sensitivity
+    quint64 generation() const; ///< Return the generation of the index, that changes every time the states of the automaton are invalidated
+    quint64 revision() const; ///< Return the revision of the index, that changes every time the index is modified
+    qint32 maxKeywordLength() const; ///< Return the length of the longest keyword or emoji trigger in the index
+    VecSpCombo findStrictCandidates(QStringView input) const; ///< Retrieve the strict matching combos that may be a match for the input
+    qint32 nextState(qint32 state, char32_t codePoint) const; ///< Return the state of the automaton after a code point has been typed
+    qint32 stateForText(QStringView text) const; ///< Return the state of the automaton after a text has been typed
+    void appendCandidates(qint32 state, Candidates &outCandidates) const; ///< Append the loose matching combos and the emojis attached to a state of the automaton
+    bool isMatch(Combo const *combo, QStringView input) const; ///< Check whether an indexed combo matches an input, using the keyword and options it was indexed with
+    qint32 linkVisitCount() const; ///< Return the number of existing nodes visited to update the failure links when the last trigger was inserted
+
+private: // static data members
+    static quint32 constexpr nodeChunkSize = 64; ///< The number of nodes in a chunk of the automaton storage
+    static quint32 constexpr shardCount = 64; ///< The number of shards of the hash tables of the index
+
+private: // data types
+    struct Node {
+        VecSpCombo combos; ///< The loose matching combos whose case-folded keyword ends on this node
+        QStringList emojiShortcodes; ///< The shortcodes of the emojis whose case-folded delimited shortcode ends on this node
+        qint32 parent { rootState }; ///< The parent node
+        char32_t character { 0 }; ///< The case-folded code point on the edge from the parent node
+        qint32 depth { 0 }; ///< The depth of the node, i.e. the number of code points of the keyword prefix it represents
+        qint32 childCount { 0 }; ///< The number of children of the node
+        bool isDead { false }; ///< Was the node pruned from the automaton
+        qint32 failure { rootState }; ///< The node for the longest proper suffix that is also a keyword prefix
+        qint32 output { -1 }; ///< The nearest node in the failure chain that has combos or emojis attached, or -1
+        qint32 firstFailureChild { -1 }; ///< The first node whose failure link points to this node, or -1. Unused for the root (see rootFailureChildren_)
+        qint32 nextFailureSibling { -1 }; ///< The next node whose failure link points to the same node, or -1
+        qint32 previousFailureSibling { -1 }; ///< The previous node whose failure link points to the same node, or -1
+    }; ///< Type definition for automaton nodes
+
+    struct Entry {
+        QString keyword; ///< The keyword of the combo when it was inserted
+        quint64 key { 0 }; ///< The key of the combo in its hash table. Unused for loose matching combos
+        bool caseInsensitive { false }; ///< Is the combo case-insensitive
+        qint32 node { -1 }; ///< The automaton node the combo is attached to, or -1 for strict matching combos
+    }; ///< Type definition for the location of a combo in the index
+
+    struct NodeChunk {
+        std::array<Node, nodeChunkSize> nodes; ///< The nodes of the chunk
+        QHash<quint64, qint32> edges; ///< The edges leaving the nodes of the chunk, keyed by parent node and case-folded code point
+    }; ///< Type definition for a chunk of the automaton storage, shared between copies of the index until one of them modifies it
+
+    typedef std::shared_ptr<NodeChunk> SpNodeChunk; ///< Type definition for shared pointer to a chunk of the automaton storage
+    typedef std::array<QHash<quint64, VecSpCombo>, shardCount> KeywordTable; ///< Type definition for strict matching combos indexed by hash of their keyword, split into shards
+    typedef std::array<QHash<Combo const *, Entry>, shardCount> EntryTable; ///< Type definition for the location of the combos, split into shards
+
+private: // member functions
+    void insert(SpCombo const &combo); ///< Insert a combo in the index
+    bool isEntryUpToDate(SpCombo const &combo) const; ///< Check whether the entry of a combo matches its current keyword, matching options and usability
+    bool isCaseInsensitive(Combo const &combo) const; ///< Check whether a combo is indexed as case-insensitive
+    bool isLoose(Combo const &combo) const; ///< Check whether a combo is indexed in the automaton
+    void markAsModified(); ///< Give a new revision number to the index
+    qint32 insertInAutomaton(QString const &trigger); ///< Insert a trigger in the automaton and return its final node
+    void insertEmojiTriggers(); ///< Insert the emoji triggers in the automaton
+    void removeEmojiTriggers(); ///< Remove the emoji triggers from the automaton
+    void pruneBranch(qint32 node); ///< Remove a node and its ancestors from the automaton if they no longer lead to any trigger
+    void compactAutomatonIfNeeded(); ///< Rebuild the automaton from scratch if too many of its nodes were pruned
+    void updateLinks(); ///< Compute the failure and output links of the whole automaton if they are outdated
+    void linkNewNodes(qint32 firstNewNode); ///< Compute the links of the nodes added by a trigger, and relink the nodes affected by their insertion
+    void linkFailure(qint32 node, qint32 failure); ///< Set the failure link of a node
+    void unlinkFailure(qint32 node); ///< Remove a node from the failure children of its failure node
+    void updateOutputLinks(qint32 node); ///< Update the output links of the failure subtree of a node whose triggers have changed
+    qint32 firstFailureChild(qint32 node, char32_t folded) const; ///< Return the first failure child of a node with a given case-folded code point
+    void setFirstFailureChild(qint32 node, char32_t folded, qint32 child); ///< Set the first failure child of a node with a given case-folded code point
+    bool hasSuffix(qint32 node, qint32 suffix) const; ///< Check whether the keyword prefix of a node ends with the keyword prefix of another node
+    void updateMaxKeywordLength(); ///< Recompute the length of the longest keyword or emoji trigger
+    void computeFailureLinks(); ///< Compute the failure and output links of the whole automaton
+    qint32 longestSuffixNode(qint32 parent, char32_t folded) const; ///< Return the failure node of a node, given its parent and code point
+    qint32 childNode(qint32 node, char32_t folded) const; ///< Return the child of a node for a given case-folded code point
+    Node const &nodeAt(qint32 node) const; ///< Return a node of the automaton
+    Node &mutableNodeAt(qint32 node); ///< Return a node of the automaton that can be modified
+    NodeChunk &mutableChunkOf(qint32 node); ///< Return the chunk containing a node, copying it first if it is shared with another index
+    qint32 appendNode(Node const &node); ///< Append a node to the automaton storage and return its index
+
+private: // static member functions
+    static quint64 edgeKey(qint32 node, char32_t folded); ///< Compute the key used to store an edge of the automaton
+    static quint64 keywordHash(QStringView text, bool caseInsensitive); ///< Compute the key used to store a strict matching keyword
+    static char32_t nextCodePoint(QStringView text, qsizetype &ioIndex); ///< Return the code point at an index of a text, and move the index to the next code point
+    static void removeFromList(VecSpCombo &combos, Combo const *combo); ///< Remove a combo from a list of combos
+    static bool hasTriggers(Node const &node); ///< Check whether combos or emojis are attached to a node
+    static quint32 shardIndex(quint64 key); ///< Return the index of the shard of a strict matching keyword
+    static quint32 shardIndex(Combo const *combo); ///< Return the index of the shard of the entry of a combo
+
+private: // data members
+    KeywordTable caseSensitiveKeywords_; ///< The case-sensitive strict matching combos, indexed by hash of their keyword
+    KeywordTable caseInsensitiveKeywords_; ///< The case-insensitive strict matching combos, indexed by hash of their case-folded keyword
+    qint32 caseInsensitiveComboCount_ { 0 }; ///< The number of case-insensitive strict matching combos
+    std::vector<SpNodeChunk> nodeChunks_; ///< The storage of the nodes of the automaton. Node 0 is the root
+    qint32 nodeCount_ { 0 }; ///< The number of nodes in the automaton storage, including pruned ones
+    EntryTable entries_; ///< The location of each combo in the index
+    QStringList emojiShortcodes_; ///< The shortcodes of the emoji triggers
+    QString emojiLeftDelimiter_; ///< The left delimiter of the emoji triggers
+    QString emojiRightDelimiter_; ///< The right delimiter of the emoji triggers
+    QList<qint32> emojiNodes_; ///< The nodes the emoji triggers are attached to
+    QHash<char32_t, qint32> rootFailureChildren_; ///< The first node whose failure link points to the root, for each case-folded code point
+    qint32 linkVisitCount_ { 0 }; ///< The number of existing nodes visited to update the failure links when the last trigger was inserted
+    qint32 deadNodeCount_ { 0 }; ///< The number of nodes pruned from the automaton since it was last rebuilt
+    bool linksAreOutdated_ { false }; ///< Are the links of the automaton left outdated while the automaton is rebuilt, to be recomputed as a whole
+    QMap<qint32, qint32> keywordLengthCounts_; ///< The number of indexed combos for each keyword length
+    qint32 maxEmojiTriggerLength_ { 0 }; ///< The length of the longest emoji trigger
+    qint32 maxKeywordLength_ { 0 }; ///< The length of the longest keyword or emoji trigger in the index
+    quint64 generation_ { 0 }; ///< The generation of the index
+    quint64 revision_ { 0 }; ///< The revision of the index
+    EMatchingMode defaultMatchingMode_ { EMatchingMode::Default }; ///< The default matching mode used when building the index
+    ECaseSensitivity defaultCaseSensitivity_ { ECaseSensitivity::Default }; ///< The default case sensitivity used when building the index
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_KEYWORD_INDEX_H
@@ -12,6 +12,7 @@
 #include "MimeDataUtils.h"
 #include "BeeftextGlobals.h"
 #include "BeeftextConstants.h"
+#include "Preferences/PreferencesManager.h"
 #include <XMiLib/File/CsvIO.h>
 #include <XMiLib/Exception.h>
 
@@ -64,6 +65,8 @@ bool comboFileContainsRichTextCombos(QString const &path) {
 void swap(ComboList &first, ComboList &second) noexcept {
     first.combos_.swap(second.combos_);
     swap(first.groups_, second.groups_);
+    first.invalidateKeywordIndex();
+    second.invalidateKeywordIndex();
 }
 
 
@@ -72,6 +75,7 @@ void swap(ComboList &first, ComboList &second) noexcept {
 //****************************************************************************************************************************************************
 ComboList::ComboList(QObject *parent)
     : QAbstractTableModel(parent) {
+    this->connectKeywordIndexSignals();
 }
 
 
@@ -80,6 +84,7 @@ ComboList::ComboList(QObject *parent)
 //****************************************************************************************************************************************************
 ComboList::ComboList(ComboList const &ref)
     : QAbstractTableModel(ref.parent()), combos_(ref.combos_), groups_(ref.groups_) {
+    this->connectKeywordIndexSignals();
 }
 
 
@@ -88,6 +93,7 @@ ComboList::ComboList(ComboList const &ref)
 //****************************************************************************************************************************************************
 ComboList::ComboList(ComboList &&ref) noexcept
     : QAbstractTableModel(ref.parent()), combos_(std::move(ref.combos_)), groups_(std::move(ref.groups_)) {
+    this->connectKeywordIndexSignals();
 }
 
 
@@ -98,6 +104,7 @@ ComboList &ComboList::operator=(ComboList const &ref) {
     if (&ref != this) {
         combos_ = ref.combos_;
         groups_ = ref.groups_;
+        this->invalidateKeywordIndex();
     }
     return *this;
 }
@@ -110,6 +117,8 @@ ComboList &ComboList::operator=(ComboList &&ref) noexcept {
     if (&ref != this) {
         combos_ = std::move(ref.combos_);
         groups_ = std::move(ref.groups_);
+        this->invalidateKeywordIndex();
+        ref.invalidateKeywordIndex();
     }
     return *this;
 }
@@ -224,6 +233,19 @@ void ComboList::erase(qint32 index) {
 }
 
 
+//****************************************************************************************************************************************************
+/// \param[in] index The index of the combo to replace.
+/// \param[in] combo The new combo.
+//****************************************************************************************************************************************************
+void ComboList::replace(qint32 index, SpCombo const &combo) {
+    Q_ASSERT((index >= 0) && (index < qint32(combos_.size())));
+    SpCombo &current = combos_[static_cast<quint32>(index)];
+    this->removeFromKeywordIndex(current);
+    current = combo;
+    this->markComboAsEdited(index);
+}
+
+
 //****************************************************************************************************************************************************
 /// \param[in] group The group
 //****************************************************************************************************************************************************
@@ -549,7 +571,7 @@ bool ComboList::exportCheatSheet(QString const &path, QString *outErrorMessage)
 //****************************************************************************************************************************************************
 void ComboList::markComboAsEdited(qint32 index) {
     Q_ASSERT((index >= 0) && (index < qint32(combos_.size())));
-    emit dataChanged(this->index(0, 0), this->index(0, this->rowCount(QModelIndex()) - 1), QVector<int>() << Qt::DisplayRole);
+    emit dataChanged(this->index(index, 0), this->index(index, this->columnCount(QModelIndex()) - 1), QVector<int>() << Qt::DisplayRole);
 }
 
 
@@ -564,6 +586,7 @@ void ComboList::ensureCorrectGrouping(bool *outWasInvalid) {
         SpGroup const group = combo->group();
         if ((!group) || (groups_.end() == groups_.findByUuid(group->uuid()))) {
             combo->setGroup(groups_[0]);
+            this->markComboAsDirty(combo); // the usability of the combo may have changed
             wasInvalid = true;
         }
     }
@@ -572,6 +595,53 @@ void ComboList::ensureCorrectGrouping(bool *outWasInvalid) {
 }
 
 
+//****************************************************************************************************************************************************
+/// \note The index is rebuilt if it is outdated, including when the default matching mode or case sensitivity
+/// has changed since it was built. Otherwise, only the entries of the combos that were inserted or modified since the
+/// last call are updated.
+///
+/// \return A constant reference to the keyword index.
+//****************************************************************************************************************************************************
+ComboKeywordIndex const &ComboList::keywordIndex() const {
+    PreferencesManager const &prefs = PreferencesManager::instance();
+    EMatchingMode const defaultMatchingMode = prefs.defaultMatchingMode();
+    ECaseSensitivity const defaultCaseSensitivity = prefs.defaultCaseSensitivity();
+    if ((!keywordIndexIsValid_) || (!keywordIndex_.isBuiltForDefaults(defaultMatchingMode, defaultCaseSensitivity))) {
+        keywordIndex_.build(combos_, defaultMatchingMode, defaultCaseSensitivity);
+        keywordIndexIsValid_ = true;
+        dirtyCombos_.clear();
+        return keywordIndex_;
+    }
+    for (SpCombo const &combo: dirtyCombos_)
+        keywordIndex_.updateCombo(combo);
+    dirtyCombos_.clear();
+    return keywordIndex_;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboList::invalidateKeywordIndex() const {
+    keywordIndexIsValid_ = false;
+    dirtyCombos_.clear();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The emoji triggers are kept when the keyword index is rebuilt, and the automaton is only patched if the
+/// triggers have changed.
+///
+/// \param[in] shortcodes The shortcodes of the emojis. An empty list disables emoji triggers.
+/// \param[in] leftDelimiter The left delimiter for emoji shortcodes.
+/// \param[in] rightDelimiter The right delimiter for emoji shortcodes.
+//****************************************************************************************************************************************************
+void ComboList::setEmojiTriggers(QStringList const &shortcodes, QString const &leftDelimiter,
+    QString const &rightDelimiter) {
+    keywordIndex_.setEmojiTriggers(shortcodes, leftDelimiter, rightDelimiter);
+}
+
+
 //****************************************************************************************************************************************************
 /// \return The number of rows in the table model
 //****************************************************************************************************************************************************
@@ -730,3 +800,104 @@ QMimeData *ComboList::mimeData(const QModelIndexList &indexes) const {
         return nullptr;
     return uuidListToMimeData(uuids);
 }
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboList::connectKeywordIndexSignals() {
+    connect(this, &ComboList::rowsInserted, this, &ComboList::onRowsInserted);
+    connect(this, &ComboList::rowsAboutToBeRemoved, this, &ComboList::onRowsAboutToBeRemoved);
+    connect(this, &ComboList::dataChanged, this, &ComboList::onDataChanged);
+    connect(this, &ComboList::modelReset, this, &ComboList::invalidateKeywordIndex);
+    connect(&groups_, &GroupList::dataChanged, this, &ComboList::onGroupDataChanged);
+    connect(&groups_, &GroupList::combosChangedGroup, this, &ComboList::onCombosChangedGroup);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the index is not valid, it will be fully rebuilt on next use, so there is no need to track the combo.
+///
+/// \param[in] combo The combo.
+//****************************************************************************************************************************************************
+void ComboList::markComboAsDirty(SpCombo const &combo) const {
+    if (keywordIndexIsValid_ && combo)
+        dirtyCombos_.push_back(combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+//****************************************************************************************************************************************************
+void ComboList::removeFromKeywordIndex(SpCombo const &combo) const {
+    if ((!keywordIndexIsValid_) || (!combo))
+        return;
+    keywordIndex_.removeCombo(combo);
+    std::erase(dirtyCombos_, combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] first The index of the first inserted row.
+/// \param[in] last The index of the last inserted row.
+//****************************************************************************************************************************************************
+void ComboList::onRowsInserted(QModelIndex const &, int first, int last) const {
+    for (qint32 row = first; row <= last; ++row)
+        this->markComboAsDirty(combos_[static_cast<quint32>(row)]);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] first The index of the first row to be removed.
+/// \param[in] last The index of the last row to be removed.
+//****************************************************************************************************************************************************
+void ComboList::onRowsAboutToBeRemoved(QModelIndex const &, int first, int last) const {
+    for (qint32 row = first; row <= last; ++row)
+        this->removeFromKeywordIndex(combos_[static_cast<quint32>(row)]);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] topLeft The top left index of the changed data.
+/// \param[in] bottomRight The bottom right index of the changed data.
+//****************************************************************************************************************************************************
+void ComboList::onDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight) const {
+    qint32 const last = qMin(bottomRight.row(), this->size() - 1);
+    for (qint32 row = qMax(0, topLeft.row()); row <= last; ++row)
+        this->markComboAsDirty(combos_[static_cast<quint32>(row)]);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The enabled state of a group affects the usability of its combos.
+///
+/// \param[in] topLeft The top left index of the changed data.
+/// \param[in] bottomRight The bottom right index of the changed data.
+//****************************************************************************************************************************************************
+void ComboList::onGroupDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight) const {
+    if (!keywordIndexIsValid_)
+        return;
+    std::set<SpGroup> groups;
+    qint32 const last = qMin(bottomRight.row(), groups_.size()); // row 0 is the special entry "<All combos>"
+    for (qint32 row = qMax(1, topLeft.row()); row <= last; ++row)
+        groups.insert(groups_[row - 1]);
+    if (groups.empty())
+        return;
+    for (SpCombo const &combo: combos_)
+        if (combo && groups.contains(combo->group()))
+            this->markComboAsDirty(combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] uuids The UUIDs of the combos whose group has changed.
+//****************************************************************************************************************************************************
+void ComboList::onCombosChangedGroup(QList<QUuid> const &uuids) const {
+    if (!keywordIndexIsValid_)
+        return;
+    for (QUuid const &uuid: uuids) {
+        const_iterator const it = this->findByUuid(uuid);
+        if (it != this->end())
+            this->markComboAsDirty(*it);
+    }
+}
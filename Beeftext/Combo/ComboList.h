@@ -12,6 +12,7 @@
 
 
 #include "Combo.h"
+#include "ComboKeywordIndex.h"
 #include "Group/GroupList.h"
 
 
@@ -58,6 +59,7 @@ public: // member functions
     // ReSharper disable once CppInconsistentNaming
     void push_back(SpCombo const &combo); ///< Append a combo at the end of the list
     void erase(qint32 index); ///< Erase a combo from the list
+    void replace(qint32 index, SpCombo const &combo); ///< Replace the combo at a given position in the list
     void eraseCombosOfGroup(SpGroup const &group); ///< Erase all the combos of a given group
     const_iterator findByKeyword(QString const &keyword) const; ///< Find a combo by its keyword
     iterator findByKeyword(QString const &keyword); ///< Find a combo by its keyword
@@ -82,6 +84,9 @@ public: // member functions
     bool load(QString const &path, bool *outInOlderFileFormat = nullptr, QString *outErrorMessage = nullptr); /// Load a combo list from a JSON file
     void markComboAsEdited(qint32 index); ///< Mark a combo as edited
     void ensureCorrectGrouping(bool *outWasInvalid = nullptr); ///< make sure every combo is affected to a group (and that there is at least one group
+    ComboKeywordIndex const &keywordIndex() const; ///< Return the keyword index of the list, updating it if necessary
+    void invalidateKeywordIndex() const; ///< Mark the keyword index as outdated, it will be rebuilt on next use
+    void setEmojiTriggers(QStringList const &shortcodes, QString const &leftDelimiter, QString const &rightDelimiter); ///< Set the emoji triggers compiled in the automaton of the keyword index
 
     /// \name Table model member functions
     ///\{
@@ -96,9 +101,24 @@ public: // member functions
     //bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent); ///< process the dropping of MIME data
     ///\}
 
+private: // member functions
+    void connectKeywordIndexSignals(); ///< Connect the signals used to keep the keyword index up to date
+    void markComboAsDirty(SpCombo const &combo) const; ///< Schedule the update of the entry of a combo in the keyword index
+    void removeFromKeywordIndex(SpCombo const &combo) const; ///< Remove a combo from the keyword index
+
+private slots:
+    void onRowsInserted(QModelIndex const &parent, int first, int last) const; ///< Slot for the insertion of rows in the model
+    void onRowsAboutToBeRemoved(QModelIndex const &parent, int first, int last) const; ///< Slot for the imminent removal of rows from the model
+    void onDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight) const; ///< Slot for the change of data in the model
+    void onGroupDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight) const; ///< Slot for the change of data in the group list
+    void onCombosChangedGroup(QList<QUuid> const &uuids) const; ///< Slot for the change of the group of some combos
+
 private: // data members
     VecSpCombo combos_; ///< The list of combos
     GroupList groups_; ///< The list of groups
+    mutable ComboKeywordIndex keywordIndex_; ///< The keyword index, lazily rebuilt
+    mutable bool keywordIndexIsValid_ { false }; ///< Is the keyword index up to date
+    mutable VecSpCombo dirtyCombos_; ///< The combos whose entry in the keyword index must be updated
 };
 
 
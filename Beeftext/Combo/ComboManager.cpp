@@ -17,6 +17,7 @@
 #include "BeeftextGlobals.h"
 #include "Backup/BackupManager.h"
 #include "Emoji/EmojiManager.h"
+#include "SubstitutionTracer.h"
 
 
 using namespace xmilib;
@@ -50,13 +51,37 @@ ComboList const &ComboManager::comboListRef() const {
 //****************************************************************************************************************************************************
 // 
 //****************************************************************************************************************************************************
-ComboManager::ComboManager() {
-    // We used queued connections to minimize the time spent in the keyboard hook
+ComboManager::ComboManager()
+    : matcherThread_(InputManager::instance().keystrokeQueue()) {
+    // Keystrokes are sent by the keyboard hook to the matcher thread using a lock-free queue, and only the matches are
+    // sent back to the main thread
     InputManager const &inputManager = InputManager::instance();
-    connect(&inputManager, &InputManager::comboBreakerTyped, this, &ComboManager::onComboBreakerTyped, Qt::QueuedConnection);
-    connect(&inputManager, &InputManager::characterTyped, this, &ComboManager::onCharacterTyped, Qt::QueuedConnection);
-    connect(&inputManager, &InputManager::backspaceTyped, this, &ComboManager::onBackspaceTyped, Qt::QueuedConnection);
     connect(&inputManager, &InputManager::substitutionShortcutTriggered, this, &ComboManager::onSubstitutionTriggerShortcut, Qt::QueuedConnection);
+    connect(&matcherThread_, &ComboMatcherThread::comboMatched, this, &ComboManager::onComboMatched);
+    connect(&matcherThread_, &ComboMatcherThread::emojiShortcodeTyped, this, &ComboManager::onEmojiShortcodeTyped);
+
+    // the snapshot is published once per batch of modifications of the combos or preferences
+    snapshotUpdateTimer_.setSingleShot(true);
+    snapshotUpdateTimer_.setInterval(0);
+    connect(&snapshotUpdateTimer_, &QTimer::timeout, this, &ComboManager::publishSnapshot);
+    connect(&comboList_, &ComboList::rowsInserted, this, &ComboManager::scheduleSnapshotUpdate);
+    connect(&comboList_, &ComboList::rowsRemoved, this, &ComboManager::scheduleSnapshotUpdate);
+    connect(&comboList_, &ComboList::dataChanged, this, &ComboManager::scheduleSnapshotUpdate);
+    connect(&comboList_, &ComboList::modelReset, this, &ComboManager::scheduleSnapshotUpdate);
+    connect(&comboList_, &ComboList::rowsInserted, this, &ComboManager::onComboListRowsInserted);
+    connect(&comboList_, &ComboList::rowsAboutToBeRemoved, this, &ComboManager::onComboListRowsAboutToBeRemoved);
+    connect(&comboList_, &ComboList::dataChanged, this, &ComboManager::onComboListDataChanged);
+    connect(&comboList_, &ComboList::modelAboutToBeReset, this, &ComboManager::onComboListAboutToBeReset);
+    connect(&comboList_, &ComboList::modelReset, this, &ComboManager::onComboListReset);
+    GroupList const &groups = comboList_.groupListRef();
+    connect(&groups, &GroupList::dataChanged, this, &ComboManager::scheduleSnapshotUpdate);
+    connect(&groups, &GroupList::combosChangedGroup, this, &ComboManager::scheduleSnapshotUpdate);
+    connect(&groups, &GroupList::dataChanged, this, &ComboManager::onGroupListDataChanged);
+    connect(&groups, &GroupList::combosChangedGroup, this, &ComboManager::onCombosChangedGroup);
+    PreferencesManager const &prefs = PreferencesManager::instance();
+    connect(&prefs, &PreferencesManager::defaultMatchingOptionsChanged, this, &ComboManager::scheduleSnapshotUpdate);
+    connect(&prefs, &PreferencesManager::emojiPreferencesChanged, this, &ComboManager::invalidateEmojiTriggers);
+    connect(&EmojiManager::instance().emojiListRef(), &EmojiList::modelReset, this, &ComboManager::invalidateEmojiTriggers);
     QString errMsg;
 
     if (QFileInfo(QDir(PreferencesManager::instance().comboListFolderPath())
@@ -67,6 +92,8 @@ ComboManager::ComboManager() {
     } else
         comboList_.ensureCorrectGrouping();
     this->loadSoundFromPreferences();
+    this->publishSnapshot(); // the snapshot is available as soon as the manager is constructed
+    matcherThread_.start();
 }
 
 
@@ -179,124 +206,289 @@ void ComboManager::playSound() const {
 
 
 //****************************************************************************************************************************************************
-//
+/// \note This function can be called from any thread. The snapshot may not reflect modifications of the combo list
+/// performed since the last time the main thread processed its events.
+///
+/// \return The latest published combo snapshot.
 //****************************************************************************************************************************************************
-void ComboManager::checkAndPerformSubstitution() {
-    if (!this->checkAndPerformComboSubstitution())
-        this->checkAndPerformEmojiSubstitution();
+SpComboSnapshot ComboManager::snapshot() const {
+    return snapshot_.load(std::memory_order_acquire);
 }
 
 
 //****************************************************************************************************************************************************
-/// \return true if a substitution was available and it was performed or cancelled because Beeftext is the active 
-/// application.
+/// \note This function can be called from any thread, and is cheaper than retrieving the snapshot. It can be used by
+/// caches to detect that they are outdated.
+///
+/// \return The epoch of the latest published combo snapshot.
 //****************************************************************************************************************************************************
-bool ComboManager::checkAndPerformComboSubstitution() {
-    PreferencesManager const &prefs = PreferencesManager::instance();
-    bool const triggersOnSpace = (prefs.useAutomaticSubstitution() && prefs.comboTriggersOnSpace());
-
-    if (triggersOnSpace) {
-        bool const cond = (!currentText_.isEmpty()) && currentText_.back().isSpace();
-        Q_ASSERT(cond);
-        if (!cond)
-            return false;
-        currentText_.chop(1); // the last character is a space, and we want to remove it before matching keywords
-    }
+quint64 ComboManager::snapshotEpoch() const {
+    return snapshotEpoch_.load(std::memory_order_acquire);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The snapshot is published once per batch of modifications, when the event loop is processed.
+///
+/// \return true if and only if no modification of the combo list is waiting for the publication of a new snapshot.
+//****************************************************************************************************************************************************
+bool ComboManager::isSnapshotUpToDate() const {
+    return !snapshotUpdateTimer_.isActive();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The cache must only be used from the main thread.
+///
+/// \return The cache of the expanded snippets of pure combos.
+//****************************************************************************************************************************************************
+ComboExpansionCache &ComboManager::expansionCache() {
+    return expansionCache_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The graph of the references between combos.
+//****************************************************************************************************************************************************
+ComboReferenceGraph const &ComboManager::referenceGraph() const {
+    return referenceGraph_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief If the reference graph contains no cycle, an expansion can never reach a combo being expanded, so nested
+/// references do not need to be tracked. The snapshot used to resolve references must match the graph.
+///
+/// \return true if and only if the expansion of combos must keep track of nested references.
+//****************************************************************************************************************************************************
+bool ComboManager::isRecursionGuardNeeded() const {
+    return !(this->isSnapshotUpToDate() && referenceGraph_.isAcyclic());
+}
+
 
+//****************************************************************************************************************************************************
+/// \note The combos may have been modified since the matcher thread found them, so they are checked again.
+///
+/// \param[in] combos The combos matching the typed text.
+/// \param[in] text The typed text.
+//****************************************************************************************************************************************************
+void ComboManager::onComboMatched(VecSpCombo const &combos, QString const &text) {
+    TraceSpan const span("ComboManager::onComboMatched");
     VecSpCombo result;
-    for (SpCombo const &combo: comboList_)
-        if (combo && combo->isUsable() && combo->matchesForInput(currentText_))
+    for (SpCombo const &combo: combos)
+        if (combo && combo->isUsable() && combo->matchesForInput(text))
             result.push_back(combo);
-
-    if (result.empty()) {
-        if (triggersOnSpace)
-            this->onComboBreakerTyped();
-        return false;
-    }
+    if (result.empty())
+        return;
 
     SpCombo const combo = result[result.size() > 1 ? static_cast<quint32>(rng_.get()) % result.size() : 0];
     if ((!isBeeftextTheForegroundApplication()) &&
         (combo->performSubstitution(false) && PreferencesManager::instance().playSoundOnCombo()) && sound_)
         sound_->play(); // in Beeftext windows, substitution is disabled
-    this->onComboBreakerTyped();
-    return true;
 }
 
 
 //****************************************************************************************************************************************************
-/// \return true if a substitution was available and it was performed or cancelled because Beeftext is the active 
-/// application.
+/// \param[in] shortcode The shortcode.
+/// \param[in] charCount The number of characters of the shortcode, including its delimiters.
 //****************************************************************************************************************************************************
-bool ComboManager::checkAndPerformEmojiSubstitution() {
-    QString currentText = currentText_;
-    PreferencesManager const &prefs = PreferencesManager::instance();
-    if (!prefs.emojiShortcodesEnabled())
-        return false;
-    QString const leftDelimiter = prefs.emojiLeftDelimiter();
-    QString const rightDelimiter = prefs.emojiRightDelimiter();
-
-    // first we validate the right delimiter, if any
-    if (!currentText.endsWith(rightDelimiter))
-        return false;
-    currentText = currentText.chopped(rightDelimiter.size());
-
-    // we try to locate the left delimiter
-    qsizetype const index = currentText.lastIndexOf(leftDelimiter);
-    if (-1 == index) // not found
-        return false;
-
-    // finally we isolate the keyword and perform the substitution, if any
-    QString const keyword = currentText.right(currentText.size() - (index + leftDelimiter.size()));
+void ComboManager::onEmojiShortcodeTyped(QString const &shortcode, qint32 charCount) {
+    TraceSpan const span("ComboManager::onEmojiShortcodeTyped");
     EmojiManager const &emojisManager = EmojiManager::instance();
-    SpEmoji const emoji = emojisManager.find(keyword);
+    SpEmoji const emoji = emojisManager.find(shortcode);
     if (!emoji)
-        return false;
-    bool result = false;
-    if ((!isBeeftextTheForegroundApplication()) &&
-        !EmojiManager::instance().isExcludedApplication(getActiveExecutableFileName())) {
-        performTextSubstitution(qint32(keyword.size() + rightDelimiter.size() + leftDelimiter.size()), emoji->value(), -1, ETriggerSource::Keyword);
+        return;
+    if ((!isBeeftextTheForegroundApplication()) && !emojisManager.isForegroundApplicationExcluded()) {
+        performTextSubstitution(charCount, emoji->value(), -1, ETriggerSource::Keyword);
         emoji->setlastUseDateTime(QDateTime::currentDateTime());
         if (PreferencesManager::instance().playSoundOnCombo() && sound_)
             sound_->play();
-        result = true;
     }
-    this->onComboBreakerTyped();
-    return result;
 }
 
 
 //****************************************************************************************************************************************************
 // 
 //****************************************************************************************************************************************************
-void ComboManager::onComboBreakerTyped() {
-    currentText_ = QString();
+void ComboManager::onSubstitutionTriggerShortcut() {
+    if (!PreferencesManager::instance().useAutomaticSubstitution())
+        InputManager::instance().pushKeystrokeEvent(EKeystrokeEventType::SubstitutionShortcut);
 }
 
 
 //****************************************************************************************************************************************************
-/// \param[in] c The character that was typed
+//
 //****************************************************************************************************************************************************
-void ComboManager::onCharacterTyped(QChar c) {
-    PreferencesManager const &prefs = PreferencesManager::instance();
-    currentText_.append(c);
-    if ((!prefs.useAutomaticSubstitution()) || (prefs.comboTriggersOnSpace() && (!c.isSpace())))
-        return;
-    this->checkAndPerformSubstitution();
+void ComboManager::scheduleSnapshotUpdate() {
+    snapshotUpdateTimer_.start();
 }
 
 
 //****************************************************************************************************************************************************
-// 
+/// \param[in] combo The combo.
 //****************************************************************************************************************************************************
-void ComboManager::onBackspaceTyped() {
-    currentText_.chop(1);
+void ComboManager::markComboAsModified(SpCombo const &combo) {
+    if ((!snapshotNeedsRebuild_) && combo)
+        snapshotModifiedCombos_.push_back(combo);
 }
 
 
 //****************************************************************************************************************************************************
-// 
+/// \note The snapshot is immutable, so readers, including the matcher thread, can keep using the previous snapshot
+/// while the new one is published. Unless the list was reset, the new snapshot is obtained by patching the previous
+/// one with the combos that were inserted, removed or modified since.
 //****************************************************************************************************************************************************
-void ComboManager::onSubstitutionTriggerShortcut() {
-    if (!PreferencesManager::instance().useAutomaticSubstitution())
-        this->checkAndPerformSubstitution();
+void ComboManager::publishSnapshot() {
+    snapshotUpdateTimer_.stop(); // in case the function was called directly while an update was pending
+    if (emojiTriggersAreOutdated_) {
+        // emoji shortcodes are compiled in the same automaton as combo keywords
+        PreferencesManager const &prefs = PreferencesManager::instance();
+        QStringList shortcodes;
+        if (prefs.emojiShortcodesEnabled()) {
+            EmojiList const &emojis = EmojiManager::instance().emojiListRef();
+            shortcodes.reserve(emojis.size());
+            for (SpEmoji const &emoji: emojis)
+                if (emoji)
+                    shortcodes.append(emoji->shortcode());
+        }
+        comboList_.setEmojiTriggers(shortcodes, prefs.emojiLeftDelimiter(), prefs.emojiRightDelimiter());
+        emojiTriggersAreOutdated_ = false;
+    }
+    quint64 const epoch = snapshotEpoch_.load(std::memory_order_relaxed) + 1;
+    SpComboSnapshot const previous = snapshot_.load(std::memory_order_relaxed);
+    SpComboSnapshot const snapshot = (snapshotNeedsRebuild_ || (!previous))
+        ? std::make_shared<ComboSnapshot const>(comboList_, epoch)
+        : std::make_shared<ComboSnapshot const>(*previous, comboList_, snapshotRemovedCombos_, snapshotModifiedCombos_, epoch);
+    snapshotRemovedCombos_.clear();
+    snapshotModifiedCombos_.clear();
+    snapshotNeedsRebuild_ = false;
+    snapshot_.store(snapshot, std::memory_order_release);
+    snapshotEpoch_.store(epoch, std::memory_order_release);
+    matcherThread_.setSnapshot(snapshot);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboManager::invalidateEmojiTriggers() {
+    emojiTriggersAreOutdated_ = true;
+    this->scheduleSnapshotUpdate();
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The combos referencing the keywords of the new combos may now resolve differently.
+///
+/// \param[in] parent The parent index.
+/// \param[in] first The index of the first inserted combo.
+/// \param[in] last The index of the last inserted combo.
+//****************************************************************************************************************************************************
+void ComboManager::onComboListRowsInserted(QModelIndex const &parent, int first, int last) {
+    Q_UNUSED(parent)
+    for (qint32 i = first; i <= last; ++i)
+        if ((i >= 0) && (i < comboList_.size()) && comboList_[i]) {
+            expansionCache_.invalidateKeyword(comboList_[i]->keyword());
+            referenceGraph_.addCombo(*comboList_[i]);
+            this->markComboAsModified(comboList_[i]);
+        }
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The cache is updated before the combos are removed, as it identifies combos by their address.
+///
+/// \param[in] parent The parent index.
+/// \param[in] first The index of the first removed combo.
+/// \param[in] last The index of the last removed combo.
+//****************************************************************************************************************************************************
+void ComboManager::onComboListRowsAboutToBeRemoved(QModelIndex const &parent, int first, int last) {
+    Q_UNUSED(parent)
+    for (qint32 i = first; i <= last; ++i)
+        if ((i >= 0) && (i < comboList_.size()) && comboList_[i]) {
+            SpCombo const &combo = comboList_[i];
+            expansionCache_.invalidateCombo(*combo);
+            referenceGraph_.removeCombo(*combo);
+            if (!snapshotNeedsRebuild_) {
+                std::erase(snapshotModifiedCombos_, combo);
+                snapshotRemovedCombos_.push_back(combo); // keeps the combo alive, so its address is not reused before the next snapshot
+            }
+        }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] topLeft The top left index of the modified area.
+/// \param[in] bottomRight The bottom right index of the modified area.
+//****************************************************************************************************************************************************
+void ComboManager::onComboListDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight) {
+    for (qint32 i = topLeft.row(); i <= bottomRight.row(); ++i) {
+        if ((i < 0) || (i >= comboList_.size()) || (!comboList_[i]))
+            continue;
+        Combo const &combo = *comboList_[i];
+        if (!referenceGraph_.contains(combo)) {
+            // the combo replaced another one in place, and the previous combo cannot be identified anymore
+            expansionCache_.clear();
+            referenceGraph_.rebuild(comboList_);
+            snapshotNeedsRebuild_ = true;
+            return;
+        }
+        expansionCache_.invalidateCombo(combo);
+        referenceGraph_.updateCombo(combo);
+        this->markComboAsModified(comboList_[i]);
+    }
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboManager::onComboListAboutToBeReset() {
+    expansionCache_.clear();
+    referenceGraph_.clear();
+    snapshotNeedsRebuild_ = true;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboManager::onComboListReset() {
+    referenceGraph_.rebuild(comboList_);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The name and enabled state of a group are part of the searchable data of its combos.
+///
+/// \param[in] topLeft The top left index of the changed data.
+/// \param[in] bottomRight The bottom right index of the changed data.
+//****************************************************************************************************************************************************
+void ComboManager::onGroupListDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight) {
+    if (snapshotNeedsRebuild_)
+        return;
+    GroupList const &groups = comboList_.groupListRef();
+    std::set<SpGroup> changedGroups;
+    qint32 const last = qMin(bottomRight.row(), groups.size()); // row 0 is the special entry "<All combos>"
+    for (qint32 row = qMax(1, topLeft.row()); row <= last; ++row)
+        changedGroups.insert(groups[row - 1]);
+    if (changedGroups.empty())
+        return;
+    for (SpCombo const &combo: comboList_)
+        if (combo && changedGroups.contains(combo->group()))
+            this->markComboAsModified(combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] uuids The UUIDs of the combos whose group has changed.
+//****************************************************************************************************************************************************
+void ComboManager::onCombosChangedGroup(QList<QUuid> const &uuids) {
+    if (snapshotNeedsRebuild_)
+        return;
+    for (QUuid const &uuid: uuids) {
+        ComboList::const_iterator const it = comboList_.findByUuid(uuid);
+        if (it != comboList_.end())
+            this->markComboAsModified(*it);
+    }
 }
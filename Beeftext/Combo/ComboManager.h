@@ -12,9 +12,14 @@
 
 
 #include "ComboList.h"
+#include "ComboMatcherThread.h"
+#include "ComboSnapshot.h"
+#include "ComboExpansionCache.h"
+#include "ComboReferenceGraph.h"
 #include "Group/GroupList.h"
 #include "WaveSound.h"
 #include <XMiLib/RandomNumberGenerator.h>
+#include <atomic>
 #include <memory>
 
 
@@ -41,6 +46,12 @@ public: // member functions
     bool restoreBackup(QString const &backupFilePath); /// Restore the combo list from a backup file
     void loadSoundFromPreferences(); ///< Load the combo sound to be played from the preferences
     void playSound() const; ///< Play the combo substitution sound.
+    SpComboSnapshot snapshot() const; ///< Return the latest published combo snapshot
+    quint64 snapshotEpoch() const; ///< Return the epoch of the latest published combo snapshot
+    bool isSnapshotUpToDate() const; ///< Check whether the latest published snapshot reflects all modifications of the combo list
+    ComboExpansionCache &expansionCache(); ///< Return the cache of the expanded snippets of pure combos
+    ComboReferenceGraph const &referenceGraph() const; ///< Return the graph of the references between combos
+    bool isRecursionGuardNeeded() const; ///< Check whether the expansion of combos must keep track of nested references
 signals:
     void comboListWasLoaded() const; ///< Signal emitted when the combo list has been loaded
     void comboListWasSaved() const;  ///< Signal emitted when the combo list has been saved
@@ -48,19 +59,35 @@ signals:
 
 private: // member functions
     ComboManager(); ///< Default constructor
-    void checkAndPerformSubstitution(); ///< Check if a combo or emoji substitution is possible and if so performs it
-    bool checkAndPerformComboSubstitution(); ///< check if a combo substitution is possible and if so performs it
-    bool checkAndPerformEmojiSubstitution(); ///< check if an emoji substitution is possible and if so performs it
+    void scheduleSnapshotUpdate(); ///< Schedule the publication of a new combo snapshot
+    void markComboAsModified(SpCombo const &combo); ///< Schedule the update of the data of a combo in the next snapshot
 
 private slots:
-    void onComboBreakerTyped(); ///< Slot for the "Combo Breaker Typed" signal
-    void onCharacterTyped(QChar c); ///< Slot for the "Character Typed" signal
-    void onBackspaceTyped(); ///< Slot for the 'Backspace typed" signal
+    void onComboMatched(VecSpCombo const &combos, QString const &text); ///< Slot for the matching of combos by the matcher thread
+    void onEmojiShortcodeTyped(QString const &shortcode, qint32 charCount); ///< Slot for the typing of an emoji shortcode
     void onSubstitutionTriggerShortcut(); ///< Slot for the triggering of the substitution shortcut
+    void publishSnapshot(); ///< Publish a new combo snapshot, and send it to the matcher thread
+    void invalidateEmojiTriggers(); ///< Mark the emoji triggers of the automaton as outdated and schedule a snapshot update
+    void onComboListRowsInserted(QModelIndex const &parent, int first, int last); ///< Slot for the insertion of combos in the list
+    void onComboListRowsAboutToBeRemoved(QModelIndex const &parent, int first, int last); ///< Slot for the upcoming removal of combos from the list
+    void onComboListDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight); ///< Slot for the modification of combos in the list
+    void onComboListAboutToBeReset(); ///< Slot for the upcoming reset of the combo list
+    void onComboListReset(); ///< Slot for the reset of the combo list
+    void onGroupListDataChanged(QModelIndex const &topLeft, QModelIndex const &bottomRight); ///< Slot for the modification of groups in the list
+    void onCombosChangedGroup(QList<QUuid> const &uuids); ///< Slot for the change of the group of some combos
 
 private: // data member
-    QString currentText_; ///< The current string
     ComboList comboList_; ///< The list of combos
+    ComboMatcherThread matcherThread_; ///< The thread that matches the typed text against the combo keywords
+    QTimer snapshotUpdateTimer_; ///< The timer used to publish a new snapshot once per batch of modifications
+    std::atomic<SpComboSnapshot> snapshot_; ///< The latest published combo snapshot
+    std::atomic<quint64> snapshotEpoch_ { 0 }; ///< The epoch of the latest published combo snapshot
+    VecSpCombo snapshotRemovedCombos_; ///< The combos removed from the list since the latest snapshot
+    VecSpCombo snapshotModifiedCombos_; ///< The combos inserted in the list or modified since the latest snapshot
+    bool snapshotNeedsRebuild_ { true }; ///< Must the next snapshot be built from the whole list rather than by patching the latest snapshot
+    ComboExpansionCache expansionCache_; ///< The cache of the expanded snippets of pure combos
+    ComboReferenceGraph referenceGraph_; ///< The graph of the references between combos
+    bool emojiTriggersAreOutdated_ { true }; ///< Must the emoji triggers of the automaton be updated before publishing the next snapshot
     std::unique_ptr<WaveSound> sound_; ///< The sound to play when a combo is executed
     xmilib::RandomNumberGenerator rng_; ///< The RNG used to pick combos when multiple occurences are found
 };
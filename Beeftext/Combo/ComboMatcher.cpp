@@ -0,0 +1,116 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of combo matcher class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ComboMatcher.h"
+
+
+namespace {
+
+
+//****************************************************************************************************************************************************
+/// \param[in] text The typed text.
+/// \return The high surrogate at the end of the text, whose low surrogate has not been typed yet.
+/// \return 0 if the text does not end with a high surrogate.
+//****************************************************************************************************************************************************
+char16_t trailingHighSurrogate(TypedTextBuffer const &text) {
+    return ((!text.isEmpty()) && text.last().isHighSurrogate()) ? text.last().unicode() : 0;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboMatcher::reset() {
+    state_ = ComboKeywordIndex::rootState;
+    historySize_ = 0;
+    highSurrogate_ = 0;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief If the index was rebuilt since the matcher state was computed, the state is recomputed from the text.
+///
+/// \param[in] index The keyword index.
+/// \param[in] text The text typed since the last reset.
+//****************************************************************************************************************************************************
+void ComboMatcher::synchronize(ComboKeywordIndex const &index, TypedTextBuffer const &text) {
+    if (index.generation() == generation_)
+        return;
+    generation_ = index.generation();
+    historySize_ = 0;
+    state_ = index.stateForText(text.view());
+    highSurrogate_ = trailingHighSurrogate(text);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The automaton works on code points, so a high surrogate is kept until the next character is typed. If this
+/// character is not a low surrogate, the high surrogate is processed as a code point of its own, as
+/// ComboKeywordIndex::stateForText() does.
+///
+/// \param[in] index The keyword index.
+/// \param[in] c The typed character.
+//****************************************************************************************************************************************************
+void ComboMatcher::advance(ComboKeywordIndex const &index, QChar c) {
+    history_[static_cast<std::size_t>(historyEnd_)] = state_; // when the ring is full, the oldest state is overwritten
+    historyEnd_ = (historyEnd_ + 1) % maxHistorySize;
+    historySize_ = qMin(historySize_ + 1, maxHistorySize);
+    char16_t const highSurrogate = highSurrogate_;
+    highSurrogate_ = 0;
+    if ((0 != highSurrogate) && c.isLowSurrogate()) {
+        state_ = index.nextState(state_, QChar::surrogateToUcs4(highSurrogate, c.unicode()));
+        return;
+    }
+    if (0 != highSurrogate)
+        state_ = index.nextState(state_, highSurrogate);
+    if (c.isHighSurrogate())
+        highSurrogate_ = c.unicode();
+    else
+        state_ = index.nextState(state_, c.unicode());
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] index The keyword index.
+/// \param[in] text The typed text, after the removal of the erased character. It is used to retrieve a high surrogate
+/// whose low surrogate was erased, and to recompute the state when the history is exhausted.
+//****************************************************************************************************************************************************
+void ComboMatcher::backspace(ComboKeywordIndex const &index, TypedTextBuffer const &text) {
+    highSurrogate_ = trailingHighSurrogate(text);
+    if (0 == historySize_) {
+        state_ = index.stateForText(text.view());
+        return;
+    }
+    historyEnd_ = (historyEnd_ + maxHistorySize - 1) % maxHistorySize;
+    --historySize_;
+    state_ = history_[static_cast<std::size_t>(historyEnd_)];
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] index The keyword index.
+/// \param[in] text The text typed since the last reset.
+/// \param[in] isTextTruncated Is the text only the end of the text typed since the last reset. In this case, no strict
+/// matching combo can be a match.
+/// \return The strict matching combos whose keyword is the typed text, the loose matching combos whose keyword is a
+/// suffix of the typed text, and the emojis whose delimited shortcode is a suffix of the typed text. The candidates must
+/// still be validated, as explained in the documentation of ComboKeywordIndex.
+//****************************************************************************************************************************************************
+ComboKeywordIndex::Candidates ComboMatcher::candidates(ComboKeywordIndex const &index, QStringView text,
+    bool isTextTruncated) const {
+    ComboKeywordIndex::Candidates result;
+    if (!isTextTruncated)
+        result.combos = index.findStrictCandidates(text);
+    index.appendCandidates(state_, result);
+    return result;
+}
@@ -0,0 +1,54 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of combo matcher class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_COMBO_MATCHER_H
+#define BEEFTEXT_COMBO_MATCHER_H
+
+
+#include "ComboKeywordIndex.h"
+#include "TypedTextBuffer.h"
+
+
+//****************************************************************************************************************************************************
+/// \brief A streaming matcher that follows the typed text through the automaton of a combo keyword index
+///
+/// The matcher advances by one transition per typed code point, so the cost of a keystroke does not depend on the
+/// number of combos nor on the length of the text typed since the last combo breaker. A high surrogate is kept until
+/// its low surrogate is typed, so that characters outside the Basic Multilingual Plane are case-folded as a whole. A
+/// bounded stack of previous states, stored in a fixed-size ring, is used to handle backspace, so that the matcher
+/// never allocates memory.
+//****************************************************************************************************************************************************
+class ComboMatcher {
+public: // static data members
+    static qint32 constexpr maxHistorySize = 256; ///< The maximum number of previous states kept to handle backspace
+
+public: // member functions
+    ComboMatcher() = default; ///< Default constructor
+    ComboMatcher(ComboMatcher const &) = delete; ///< Disabled copy constructor
+    ComboMatcher(ComboMatcher &&) = delete; ///< Disabled move constructor
+    ~ComboMatcher() = default; ///< Default destructor
+    ComboMatcher &operator=(ComboMatcher const &) = delete; ///< Disabled assignment operator
+    ComboMatcher &operator=(ComboMatcher &&) = delete; ///< Disabled move assignment operator
+    void reset(); ///< Reset the matcher to its initial state
+    void synchronize(ComboKeywordIndex const &index, TypedTextBuffer const &text); ///< Make sure the state of the matcher is valid for the index
+    void advance(ComboKeywordIndex const &index, QChar c); ///< Advance the matcher after a character has been typed
+    void backspace(ComboKeywordIndex const &index, TypedTextBuffer const &text); ///< Revert the matcher after a backspace has been typed
+    ComboKeywordIndex::Candidates candidates(ComboKeywordIndex const &index, QStringView text, bool isTextTruncated) const; ///< Retrieve the combos and emojis that may be triggered by the typed text
+
+private: // data members
+    qint32 state_ { ComboKeywordIndex::rootState }; ///< The current state in the automaton
+    std::array<qint32, maxHistorySize> history_ {}; ///< The ring of previous states, used to handle backspace
+    qint32 historyEnd_ { 0 }; ///< The index in the ring following the most recent previous state
+    qint32 historySize_ { 0 }; ///< The number of previous states in the ring
+    quint64 generation_ { 0 }; ///< The generation of the index the state belongs to
+    char16_t highSurrogate_ { 0 }; ///< The high surrogate typed last, whose low surrogate has not been typed yet, or 0
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_MATCHER_H
@@ -0,0 +1,240 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of combo matcher thread class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ComboMatcherThread.h"
+#include "SubstitutionTracer.h"
+
+
+namespace {
+
+
+qint32 constexpr kCurrentTextExtraCapacity = 32; ///< The number of characters kept in the current text buffer in addition to the longest keyword, so that a few backspaces do not discard useful characters
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \param[in] queue The keystroke queue. The thread is its only consumer.
+/// \param[in] parent The parent object of the thread.
+//****************************************************************************************************************************************************
+ComboMatcherThread::ComboMatcherThread(KeystrokeQueue &queue, QObject *parent)
+    : QThread(parent), queue_(queue) {
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+ComboMatcherThread::~ComboMatcherThread() {
+    this->stop();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note This function can be called from any thread. The thread picks up the new snapshot before processing its next
+/// keystroke event.
+///
+/// \param[in] snapshot The combo snapshot.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::setSnapshot(SpComboSnapshot const &snapshot) {
+    publishedSnapshot_.store(snapshot, std::memory_order_release);
+    hasNewSnapshot_.store(true, std::memory_order_release);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note This function must be called from the producer thread of the keystroke queue.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::stop() {
+    if (!this->isRunning())
+        return;
+    KeystrokeEvent event;
+    event.type = EKeystrokeEventType::Stop;
+    while (!queue_.push(event)) // the queue can only be full if the thread is busy consuming it
+        QThread::yieldCurrentThread();
+    this->wait();
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboMatcherThread::run() {
+    KeystrokeEvent event;
+    while (true) {
+        while (queue_.pop(event)) {
+            if (EKeystrokeEventType::Stop == event.type)
+                return;
+            this->processEvent(event);
+            queue_.markProcessed();
+        }
+        queue_.waitForEvent();
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the automaton of the new snapshot differs from the previous one, its generation is different and the
+/// state of the matcher is recomputed from the typed text on next use.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::updateSnapshot() {
+    if (hasNewSnapshot_.exchange(false, std::memory_order_acq_rel))
+        snapshot_ = publishedSnapshot_.load(std::memory_order_acquire);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The buffer must be able to hold the longest trigger, combo keyword or delimited emoji shortcode, followed by
+/// a space.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::updateCurrentTextCapacity() {
+    currentText_.setCapacity(snapshot_->keywordIndex().maxKeywordLength() + 1 + kCurrentTextExtraCapacity);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] event The event.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::processEvent(KeystrokeEvent const &event) {
+    eventStartNs_ = SubstitutionTracer::instance().isEnabled() ? SubstitutionTracer::now() : -1;
+    this->updateSnapshot();
+    if (!snapshot_) {
+        this->onComboBreakerTyped();
+        return;
+    }
+    switch (event.type) {
+    case EKeystrokeEventType::Character:
+        this->onCharacterTyped(event);
+        break;
+    case EKeystrokeEventType::Backspace:
+        this->onBackspaceTyped();
+        break;
+    case EKeystrokeEventType::SubstitutionShortcut:
+        if (!event.useAutomaticSubstitution)
+            this->checkSubstitution(false);
+        break;
+    default:
+        this->onComboBreakerTyped();
+        break;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboMatcherThread::onComboBreakerTyped() {
+    currentText_.clear();
+    matcher_.reset();
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] event The keystroke event.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::onCharacterTyped(KeystrokeEvent const &event) {
+    ComboKeywordIndex const &index = snapshot_->keywordIndex();
+    QChar const c = event.character;
+    bool const triggersOnSpace = event.useAutomaticSubstitution && event.comboTriggersOnSpace;
+    this->updateCurrentTextCapacity();
+    matcher_.synchronize(index, currentText_);
+    currentText_.append(c);
+    // when combos are triggered by space, the space is not part of the keyword, so it is not fed to the matcher
+    if (!(triggersOnSpace && c.isSpace()))
+        matcher_.advance(index, c);
+    if ((!event.useAutomaticSubstitution) || (event.comboTriggersOnSpace && (!c.isSpace())))
+        return;
+    this->checkSubstitution(triggersOnSpace);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboMatcherThread::onBackspaceTyped() {
+    if (currentText_.isEmpty()) {
+        currentText_.removeLast(); // the backspace may erase a character that was discarded when the buffer was full
+        return;
+    }
+    ComboKeywordIndex const &index = snapshot_->keywordIndex();
+    matcher_.synchronize(index, currentText_);
+    currentText_.removeLast();
+    matcher_.backspace(index, currentText_);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The combos and the emojis are retrieved in a single query of the automaton. Combos have priority over
+/// emojis, and when combos are triggered by space, emojis are never triggered.
+///
+/// \note The typed text is matched through a view on the buffer, and a string is only built when a combo is
+/// triggered, so typing does not allocate memory. The emoji list is not thread-safe, so the shortcode is looked up by
+/// the GUI thread.
+///
+/// \param[in] triggersOnSpace Are combos triggered by space.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::checkSubstitution(bool triggersOnSpace) {
+    if (triggersOnSpace) {
+        bool const cond = (!currentText_.isEmpty()) && currentText_.last().isSpace();
+        Q_ASSERT(cond);
+        if (!cond)
+            return;
+        currentText_.removeLast(); // the last character is a space, and we want to remove it before matching keywords
+    }
+
+    // the matcher gives us the few combos and emojis that may match the input, we then check them individually
+    QStringView const currentText = currentText_.view();
+    ComboKeywordIndex const &index = snapshot_->keywordIndex();
+    matcher_.synchronize(index, currentText_);
+    ComboKeywordIndex::Candidates const candidates = matcher_.candidates(index, currentText, currentText_.isTruncated());
+    VecSpCombo combos;
+    for (SpCombo const &combo: candidates.combos)
+        if (combo && index.isMatch(combo.get(), currentText))
+            combos.push_back(combo);
+    if (!combos.empty()) {
+        this->traceMatch();
+        emit comboMatched(combos, currentText.toString());
+        this->onComboBreakerTyped();
+        return;
+    }
+    if (triggersOnSpace) {
+        this->onComboBreakerTyped();
+        return;
+    }
+
+    // the candidates are sorted by decreasing length, and the shortest trigger is the one starting at the last left
+    // delimiter. The automaton ignores case, but shortcodes are case-sensitive, so the delimiters and the shortcode are
+    // compared with the end of the text one after the other
+    QString const leftDelimiter = index.emojiLeftDelimiter();
+    QString const rightDelimiter = index.emojiRightDelimiter();
+    if (candidates.emojiShortcodes.isEmpty() || (!currentText.endsWith(rightDelimiter)))
+        return;
+    QStringView const beforeRightDelimiter = currentText.chopped(rightDelimiter.size());
+    for (qsizetype i = candidates.emojiShortcodes.size() - 1; i >= 0; --i) {
+        QString const &shortcode = candidates.emojiShortcodes[i];
+        if (beforeRightDelimiter.endsWith(shortcode) && beforeRightDelimiter.chopped(shortcode.size()).endsWith(leftDelimiter)) {
+            this->traceMatch();
+            emit emojiShortcodeTyped(shortcode, static_cast<qint32>(leftDelimiter.size() + shortcode.size() + rightDelimiter.size()));
+            this->onComboBreakerTyped();
+            return;
+        }
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Only the events that trigger a substitution are traced, so that typing does not evict the substitution
+/// spans from the ring buffer of the tracer.
+//****************************************************************************************************************************************************
+void ComboMatcherThread::traceMatch() const {
+    if (eventStartNs_ >= 0)
+        SubstitutionTracer::instance().addSpan("ComboMatcherThread::match", eventStartNs_, SubstitutionTracer::now());
+}
@@ -0,0 +1,69 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of combo matcher thread class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_COMBO_MATCHER_THREAD_H
+#define BEEFTEXT_COMBO_MATCHER_THREAD_H
+
+
+#include "ComboMatcher.h"
+#include "ComboSnapshot.h"
+#include "TypedTextBuffer.h"
+#include "KeystrokeQueue.h"
+#include <atomic>
+
+
+//****************************************************************************************************************************************************
+/// \brief A thread that consumes the keystroke events and looks for combos and emojis triggered by the typed text
+///
+/// The thread never accesses the combo list, the preferences or the emoji list: it works on an immutable combo
+/// snapshot, whose automaton also contains the emoji triggers, published by the GUI thread using setSnapshot(). When a
+/// combo or an emoji is triggered by the typed text, it is sent back to the GUI thread using the comboMatched() or
+/// emojiShortcodeTyped() signal, and the substitution is performed there.
+//****************************************************************************************************************************************************
+class ComboMatcherThread : public QThread {
+Q_OBJECT
+public: // member functions
+    explicit ComboMatcherThread(KeystrokeQueue &queue, QObject *parent = nullptr); ///< Default constructor
+    ComboMatcherThread(ComboMatcherThread const &) = delete; ///< Disabled copy constructor
+    ComboMatcherThread(ComboMatcherThread &&) = delete; ///< Disabled move constructor
+    ~ComboMatcherThread() override; ///< Destructor
+    ComboMatcherThread &operator=(ComboMatcherThread const &) = delete; ///< Disabled assignment operator
+    ComboMatcherThread &operator=(ComboMatcherThread &&) = delete; ///< Disabled move assignment operator
+    void setSnapshot(SpComboSnapshot const &snapshot); ///< Set the combo snapshot used for matching
+    void stop(); ///< Stop the thread and wait for it to finish
+
+signals:
+    void comboMatched(VecSpCombo const &combos, QString const &text); ///< Signal emitted when some combos match the typed text
+    void emojiShortcodeTyped(QString const &shortcode, qint32 charCount); ///< Signal emitted when the typed text ends with a delimited emoji shortcode
+
+protected: // member functions
+    void run() override; ///< The main function of the thread
+
+private: // member functions
+    void updateSnapshot(); ///< Retrieve the latest snapshot published by the GUI thread
+    void updateCurrentTextCapacity(); ///< Adjust the capacity of the current text buffer to the keywords and emojis
+    void processEvent(KeystrokeEvent const &event); ///< Process a keystroke event
+    void onComboBreakerTyped(); ///< Process the typing of a combo breaker
+    void onCharacterTyped(KeystrokeEvent const &event); ///< Process the typing of a character
+    void onBackspaceTyped(); ///< Process the typing of backspace
+    void checkSubstitution(bool triggersOnSpace); ///< Check if a combo or emoji substitution is possible
+    void traceMatch() const; ///< Record the processing of the current event in the substitution tracer
+
+private: // data members
+    KeystrokeQueue &queue_; ///< The keystroke queue
+    std::atomic<SpComboSnapshot> publishedSnapshot_; ///< The snapshot published by the GUI thread
+    std::atomic<bool> hasNewSnapshot_ { false }; ///< Has a new snapshot been published since the thread last retrieved it
+    SpComboSnapshot snapshot_; ///< The snapshot used by the thread
+    TypedTextBuffer currentText_; ///< The last typed characters
+    ComboMatcher matcher_; ///< The streaming keyword matcher, following the typed characters
+    qint64 eventStartNs_ { -1 }; ///< The time the processing of the current event started, or -1 if it is not traced
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_MATCHER_THREAD_H
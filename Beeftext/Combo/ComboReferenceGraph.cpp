@@ -0,0 +1,275 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of combo reference graph class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ComboReferenceGraph.h"
+#include "ComboList.h"
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combos The combo list.
+//****************************************************************************************************************************************************
+void ComboReferenceGraph::rebuild(ComboList const &combos) {
+    this->clear();
+    acyclicIsOutdated_ = true; // the whole graph is searched once, rather than after each combo
+    vertices_.reserve(combos.size());
+    for (SpCombo const &combo: combos)
+        if (combo)
+            this->addCombo(*combo);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ComboReferenceGraph::clear() {
+    vertices_.clear();
+    combosByKeyword_.clear();
+    edges_.clear();
+    acyclic_ = true;
+    acyclicIsOutdated_ = false;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo. If the combo is already in the graph, its data is updated.
+//****************************************************************************************************************************************************
+void ComboReferenceGraph::addCombo(Combo const &combo) {
+    this->removeCombo(combo);
+    Vertex const vertex { combo.keyword(), combo.compiledSnippet().referencedKeywords() };
+    combosByKeyword_[vertex.keyword].insert(&combo);
+    vertices_.insert(&combo, vertex);
+    this->insertEdges(vertex);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+//****************************************************************************************************************************************************
+void ComboReferenceGraph::updateCombo(Combo const &combo) {
+    this->addCombo(combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo. If the combo is not in the graph, the function does nothing.
+//****************************************************************************************************************************************************
+void ComboReferenceGraph::removeCombo(Combo const &combo) {
+    QHash<Combo const *, Vertex>::iterator const it = vertices_.find(&combo);
+    if (it == vertices_.end())
+        return;
+    QHash<QString, QSet<Combo const *>>::iterator const keywordIt = combosByKeyword_.find(it.value().keyword);
+    if (keywordIt != combosByKeyword_.end()) {
+        keywordIt.value().remove(&combo);
+        if (keywordIt.value().isEmpty())
+            combosByKeyword_.erase(keywordIt);
+    }
+    this->removeEdges(it.value());
+    vertices_.erase(it);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return true if and only if the combo is in the graph.
+//****************************************************************************************************************************************************
+bool ComboReferenceGraph::contains(Combo const &combo) const {
+    return vertices_.contains(&combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the graph contains no cycle.
+//****************************************************************************************************************************************************
+bool ComboReferenceGraph::isAcyclic() const {
+    if (acyclicIsOutdated_) {
+        acyclic_ = !this->hasCycle();
+        acyclicIsOutdated_ = false;
+    }
+    return acyclic_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The graph is searched as if the combo had the given keyword and references. The function is intended for
+/// checking a combo before the modifications made in the combo dialog are applied.
+///
+/// \param[in] combo The combo. It may be null or not be in the graph, for instance if the combo is being created.
+/// \param[in] keyword The keyword of the combo.
+/// \param[in] referencedKeywords The keywords referenced by the snippet of the combo.
+/// \return The shortest sequence of keywords leading from the keyword back to itself, the first and last items being
+/// the keyword.
+/// \return An empty list if the combo would not be part of a cycle.
+//****************************************************************************************************************************************************
+QStringList ComboReferenceGraph::findCycle(Combo const *combo, QString const &keyword,
+    QStringList const &referencedKeywords) const {
+    // breadth-first search from the keyword, where the combo is replaced by its new version
+    QHash<QString, QString> parents; // for each visited keyword, the keyword it was reached from
+    QList<QString> queue;
+    auto const visit = [&](QString const &from, QString const &to) -> bool {
+        if (to == keyword)
+            return true;
+        if (!parents.contains(to)) {
+            parents.insert(to, from);
+            queue.append(to);
+        }
+        return false;
+    };
+    QString last;
+    bool found = false;
+    for (QString const &reference: referencedKeywords)
+        if (visit(keyword, reference)) {
+            last = keyword;
+            found = true;
+            break;
+        }
+    for (qsizetype i = 0; (!found) && (i < queue.size()); ++i) {
+        QString const current = queue[i];
+        for (Combo const *other: combosByKeyword_.value(current)) {
+            if (other == combo)
+                continue;
+            for (QString const &reference: vertices_.value(other).referencedKeywords)
+                if (visit(current, reference)) {
+                    last = current;
+                    found = true;
+                    break;
+                }
+            if (found)
+                break;
+        }
+    }
+    if (!found)
+        return QStringList();
+
+    QStringList result = { keyword };
+    for (QString k = last; k != keyword; k = parents.value(k))
+        result.prepend(k);
+    result.prepend(keyword);
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo. It may be null or not be in the graph, for instance if the combo is being created.
+/// \param[in] keyword The keyword of the combo.
+/// \param[in] referencedKeywords The keywords referenced by the snippet of the combo.
+/// \return The referenced keywords that are not used by any other combo, nor by the combo itself.
+//****************************************************************************************************************************************************
+QStringList ComboReferenceGraph::unresolvedReferences(Combo const *combo, QString const &keyword,
+    QStringList const &referencedKeywords) const {
+    QStringList result;
+    for (QString const &reference: referencedKeywords) {
+        if (reference == keyword)
+            continue;
+        QSet<Combo const *> const combos = combosByKeyword_.value(reference);
+        if (combos.isEmpty() || ((combos.size() == 1) && combos.contains(combo)))
+            result.append(reference);
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the graph is known to be acyclic, the function checks whether each new edge closes a cycle.
+///
+/// \param[in] vertex The data of the combo.
+//****************************************************************************************************************************************************
+void ComboReferenceGraph::insertEdges(Vertex const &vertex) {
+    if (vertex.referencedKeywords.isEmpty())
+        return;
+    QHash<QString, qint32> &targets = edges_[vertex.keyword];
+    for (QString const &reference: vertex.referencedKeywords) {
+        if (targets[reference]++ > 0)
+            continue; // another combo with the same keyword already makes the reference
+        if ((!acyclicIsOutdated_) && acyclic_ && this->isReachable(reference, vertex.keyword))
+            acyclic_ = false;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \note Removing edges cannot create a cycle, but it may break the cycles of the graph, in which case the graph will
+/// be searched as a whole the next time isAcyclic() is called.
+///
+/// \param[in] vertex The data of the combo.
+//****************************************************************************************************************************************************
+void ComboReferenceGraph::removeEdges(Vertex const &vertex) {
+    QHash<QString, QHash<QString, qint32>>::iterator const it = edges_.find(vertex.keyword);
+    if (it == edges_.end())
+        return;
+    QHash<QString, qint32> &targets = it.value();
+    for (QString const &reference: vertex.referencedKeywords) {
+        QHash<QString, qint32>::iterator const target = targets.find(reference);
+        if ((target == targets.end()) || (--target.value() > 0))
+            continue;
+        targets.erase(target);
+        if (!acyclic_)
+            acyclicIsOutdated_ = true;
+    }
+    if (targets.isEmpty())
+        edges_.erase(it);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The function performs a depth-first search, so its cost is proportional to the part of the graph reachable
+/// from the starting keyword.
+///
+/// \param[in] from The starting keyword.
+/// \param[in] to The keyword to reach.
+/// \return true if and only if there is a path from the starting keyword to the other keyword.
+//****************************************************************************************************************************************************
+bool ComboReferenceGraph::isReachable(QString const &from, QString const &to) const {
+    QSet<QString> visited { from };
+    QStringList stack { from };
+    while (!stack.isEmpty()) {
+        QString const keyword = stack.takeLast();
+        if (keyword == to)
+            return true;
+        QHash<QString, QHash<QString, qint32>>::const_iterator const it = edges_.constFind(keyword);
+        if (it == edges_.constEnd())
+            continue;
+        for (QHash<QString, qint32>::const_iterator target = it.value().constBegin(); target != it.value().constEnd(); ++target)
+            if (!visited.contains(target.key())) {
+                visited.insert(target.key());
+                stack.append(target.key());
+            }
+    }
+    return false;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The function uses Kahn's algorithm: keywords that are not referenced are removed one after the other, along
+/// with their outgoing edges. The graph contains a cycle if and only if some keywords cannot be removed.
+///
+/// \return true if and only if the graph contains a cycle.
+//****************************************************************************************************************************************************
+bool ComboReferenceGraph::hasCycle() const {
+    QHash<QString, qint32> inDegrees;
+    for (QHash<QString, QHash<QString, qint32>>::const_iterator it = edges_.constBegin(); it != edges_.constEnd(); ++it) {
+        inDegrees.insert(it.key(), inDegrees.value(it.key(), 0));
+        for (QHash<QString, qint32>::const_iterator target = it.value().constBegin(); target != it.value().constEnd(); ++target)
+            ++inDegrees[target.key()];
+    }
+    QStringList ready;
+    for (QHash<QString, qint32>::const_iterator it = inDegrees.constBegin(); it != inDegrees.constEnd(); ++it)
+        if (0 == it.value())
+            ready.append(it.key());
+    qsizetype removedCount = 0;
+    while (!ready.isEmpty()) {
+        QString const keyword = ready.takeLast();
+        ++removedCount;
+        QHash<QString, qint32> const targets = edges_.value(keyword);
+        for (QHash<QString, qint32>::const_iterator target = targets.constBegin(); target != targets.constEnd(); ++target)
+            if (0 == --inDegrees[target.key()])
+                ready.append(target.key());
+    }
+    return removedCount < inDegrees.size();
+}
@@ -0,0 +1,73 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of combo reference graph class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_COMBO_REFERENCE_GRAPH_H
+#define BEEFTEXT_COMBO_REFERENCE_GRAPH_H
+
+
+class Combo;
+class ComboList;
+
+
+//****************************************************************************************************************************************************
+/// \brief The graph of the references between combos made by #{combo:}, #{upper:}, #{lower:} and #{trim:} variables
+///
+/// The vertices of the graph are keywords, and there is an edge from a keyword to every keyword referenced by a combo
+/// using it. As a reference to a keyword shared by several combos may resolve to any of them, a cycle in this graph
+/// is a cycle that an expansion may run into. The edges are built from the compiled snippets, and only the edges of a
+/// combo are updated when it is inserted, modified or removed. Each edge counts the combos making the reference, so
+/// that it is removed with the last of them.
+///
+/// While the graph is acyclic, an edge can only create a cycle if its source is reachable from its target, so only the
+/// part of the graph reachable from the target of a new edge is searched. Removing edges cannot create a cycle, so the
+/// graph is only searched as a whole, in linear time, when it is rebuilt, or when edges were removed while it contained
+/// a cycle.
+///
+/// The graph is not thread-safe, and must only be used from the main thread.
+//****************************************************************************************************************************************************
+class ComboReferenceGraph {
+public: // member functions
+    ComboReferenceGraph() = default; ///< Default constructor
+    ComboReferenceGraph(ComboReferenceGraph const &) = delete; ///< Disabled copy constructor
+    ComboReferenceGraph(ComboReferenceGraph &&) = delete; ///< Disabled move constructor
+    ~ComboReferenceGraph() = default; ///< Default destructor
+    ComboReferenceGraph &operator=(ComboReferenceGraph const &) = delete; ///< Disabled assignment operator
+    ComboReferenceGraph &operator=(ComboReferenceGraph &&) = delete; ///< Disabled move assignment operator
+    void rebuild(ComboList const &combos); ///< Rebuild the graph from a combo list
+    void clear(); ///< Remove all combos from the graph
+    void addCombo(Combo const &combo); ///< Add a combo to the graph
+    void updateCombo(Combo const &combo); ///< Update the graph after a combo was modified
+    void removeCombo(Combo const &combo); ///< Remove a combo from the graph
+    bool contains(Combo const &combo) const; ///< Check whether a combo is in the graph
+    bool isAcyclic() const; ///< Check whether the graph contains no cycle
+    QStringList findCycle(Combo const *combo, QString const &keyword, QStringList const &referencedKeywords) const; ///< Find a cycle that a combo would create with a given keyword and references
+    QStringList unresolvedReferences(Combo const *combo, QString const &keyword, QStringList const &referencedKeywords) const; ///< Find the references of a combo that would not match any combo
+
+private: // data types
+    struct Vertex {
+        QString keyword; ///< The keyword of the combo
+        QStringList referencedKeywords; ///< The keywords referenced by the snippet of the combo
+    }; ///< Type definition for the data of a combo in the graph
+
+private: // member functions
+    void insertEdges(Vertex const &vertex); ///< Insert the references of a combo in the edges of the graph
+    void removeEdges(Vertex const &vertex); ///< Remove the references of a combo from the edges of the graph
+    bool isReachable(QString const &from, QString const &to) const; ///< Check whether a keyword can be reached from another one
+    bool hasCycle() const; ///< Check whether the graph contains a cycle
+
+private: // data members
+    QHash<Combo const *, Vertex> vertices_; ///< The keyword and references of each combo in the graph
+    QHash<QString, QSet<Combo const *>> combosByKeyword_; ///< The combos in the graph, indexed by keyword
+    QHash<QString, QHash<QString, qint32>> edges_; ///< For each keyword, the referenced keywords, with the number of combos making the reference
+    mutable bool acyclic_ { true }; ///< Is the graph acyclic. Only valid if acyclicIsOutdated_ is false
+    mutable bool acyclicIsOutdated_ { false }; ///< Must acyclic_ be recomputed by searching the whole graph
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_REFERENCE_GRAPH_H
@@ -0,0 +1,203 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of combo snapshot class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ComboSnapshot.h"
+#include "ComboList.h"
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combos The combo list.
+/// \param[in] epoch The epoch of the snapshot.
+//****************************************************************************************************************************************************
+ComboSnapshot::ComboSnapshot(ComboList const &combos, quint64 epoch)
+    : epoch_(epoch), keywordIndex_(std::make_shared<ComboKeywordIndex const>(combos.keywordIndex())) {
+    Patch patch;
+    for (quint32 i = 0; i < shardCount; ++i) {
+        keywordShards_[i] = patch.keywordShards[i] = std::make_shared<KeywordShard>();
+        searchShards_[i] = patch.searchShards[i] = std::make_shared<SearchShard>();
+    }
+    for (SpCombo const &combo: combos)
+        this->insertCombo(combo, patch);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The cost of the construction is proportional to the number of modified combos, not to the size of the list.
+/// The caller is responsible for listing every combo that was inserted, removed or modified since the previous
+/// snapshot. A combo removed from the list and inserted again must appear in both lists.
+///
+/// \param[in] previous The previous snapshot.
+/// \param[in] combos The combo list.
+/// \param[in] removedCombos The combos that were removed from the list since the previous snapshot.
+/// \param[in] modifiedCombos The combos that were inserted in the list or modified since the previous snapshot, and
+/// are still in the list.
+/// \param[in] epoch The epoch of the snapshot.
+//****************************************************************************************************************************************************
+ComboSnapshot::ComboSnapshot(ComboSnapshot const &previous, ComboList const &combos, VecSpCombo const &removedCombos,
+    VecSpCombo const &modifiedCombos, quint64 epoch)
+    : epoch_(epoch), keywordShards_(previous.keywordShards_), searchShards_(previous.searchShards_) {
+    ComboKeywordIndex const &keywordIndex = combos.keywordIndex();
+    keywordIndex_ = (keywordIndex.revision() == previous.keywordIndex_->revision()) ? previous.keywordIndex_
+        : std::make_shared<ComboKeywordIndex const>(keywordIndex);
+    Patch patch;
+    for (SpCombo const &combo: removedCombos)
+        this->removeCombo(combo.get(), patch);
+    for (SpCombo const &combo: modifiedCombos) {
+        this->removeCombo(combo.get(), patch);
+        this->insertCombo(combo, patch);
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The epoch of the snapshot.
+//****************************************************************************************************************************************************
+quint64 ComboSnapshot::epoch() const {
+    return epoch_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The keyword index.
+//****************************************************************************************************************************************************
+ComboKeywordIndex const &ComboSnapshot::keywordIndex() const {
+    return *keywordIndex_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keyword The keyword.
+/// \return The combos whose keyword is exactly the given keyword, in no particular order.
+//****************************************************************************************************************************************************
+VecSpCombo const &ComboSnapshot::combosWithKeyword(QString const &keyword) const {
+    static VecSpCombo const noCombo;
+    KeywordShard const &shard = *keywordShards_[shardIndex(keyword)];
+    KeywordShard::const_iterator const it = shard.constFind(keyword);
+    return (it == shard.constEnd()) ? noCombo : it.value();
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return The searchable data of the combo.
+/// \return A null pointer if the combo was not in the list when the snapshot was taken.
+//****************************************************************************************************************************************************
+ComboSnapshot::SearchEntry const *ComboSnapshot::searchEntry(Combo const *combo) const {
+    SearchShard const &shard = *searchShards_[shardIndex(combo)];
+    SearchShard::const_iterator const it = shard.constFind(combo);
+    return (it == shard.constEnd()) ? nullptr : &it.value();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The shard is copied the first time it is modified by the patch, as it may be shared with other snapshots.
+///
+/// \param[in] keyword The keyword.
+/// \param[in] patch The shards already copied by the snapshot under construction.
+/// \return A mutable reference to the shard of the keyword.
+//****************************************************************************************************************************************************
+ComboSnapshot::KeywordShard &ComboSnapshot::mutableKeywordShard(QString const &keyword, Patch &patch) {
+    quint32 const index = shardIndex(keyword);
+    std::shared_ptr<KeywordShard> &shard = patch.keywordShards[index];
+    if (!shard) {
+        shard = std::make_shared<KeywordShard>(*keywordShards_[index]);
+        keywordShards_[index] = shard;
+    }
+    return *shard;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The shard is copied the first time it is modified by the patch, as it may be shared with other snapshots.
+///
+/// \param[in] combo The combo.
+/// \param[in] patch The shards already copied by the snapshot under construction.
+/// \return A mutable reference to the shard of the searchable data of the combo.
+//****************************************************************************************************************************************************
+ComboSnapshot::SearchShard &ComboSnapshot::mutableSearchShard(Combo const *combo, Patch &patch) {
+    quint32 const index = shardIndex(combo);
+    std::shared_ptr<SearchShard> &shard = patch.searchShards[index];
+    if (!shard) {
+        shard = std::make_shared<SearchShard>(*searchShards_[index]);
+        searchShards_[index] = shard;
+    }
+    return *shard;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \param[in] patch The shards already copied by the snapshot under construction.
+//****************************************************************************************************************************************************
+void ComboSnapshot::insertCombo(SpCombo const &combo, Patch &patch) {
+    if (!combo)
+        return;
+    SearchEntry const entry = searchEntryForCombo(*combo);
+    this->mutableKeywordShard(entry.keyword, patch)[entry.keyword].push_back(combo);
+    this->mutableSearchShard(combo.get(), patch).insert(combo.get(), entry);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The combo is located using its searchable data, so the function works even if the keyword of the combo has
+/// been modified since it was inserted.
+///
+/// \param[in] combo The combo.
+/// \param[in] patch The shards already copied by the snapshot under construction.
+//****************************************************************************************************************************************************
+void ComboSnapshot::removeCombo(Combo const *combo, Patch &patch) {
+    SearchEntry const *entry = this->searchEntry(combo);
+    if (!entry)
+        return;
+    QString const keyword = entry->keyword;
+    KeywordShard &keywords = this->mutableKeywordShard(keyword, patch);
+    KeywordShard::iterator const bucket = keywords.find(keyword);
+    if (bucket != keywords.end()) {
+        std::erase_if(bucket.value(), [&](SpCombo const &c) -> bool { return c.get() == combo; });
+        if (bucket.value().empty())
+            keywords.erase(bucket);
+    }
+    this->mutableSearchShard(combo, patch).remove(combo);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keyword The keyword.
+/// \return The index of the shard containing the combos with the given keyword.
+//****************************************************************************************************************************************************
+quint32 ComboSnapshot::shardIndex(QString const &keyword) {
+    return static_cast<quint32>(qHash(keyword) % shardCount);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return The index of the shard containing the searchable data of the combo.
+//****************************************************************************************************************************************************
+quint32 ComboSnapshot::shardIndex(Combo const *combo) {
+    return static_cast<quint32>(qHash(combo) % shardCount);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] combo The combo.
+/// \return The searchable data of the combo.
+//****************************************************************************************************************************************************
+ComboSnapshot::SearchEntry ComboSnapshot::searchEntryForCombo(Combo const &combo) {
+    SearchEntry entry;
+    entry.name = combo.displayName();
+    entry.keyword = combo.keyword();
+    entry.snippet = combo.snippet();
+    entry.description = combo.description();
+    SpGroup const group = combo.group();
+    entry.groupName = group ? group->name() : QString();
+    entry.usable = combo.isUsable();
+    return entry;
+}
@@ -0,0 +1,97 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of combo snapshot class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_COMBO_SNAPSHOT_H
+#define BEEFTEXT_COMBO_SNAPSHOT_H
+
+
+#include "ComboKeywordIndex.h"
+
+
+class ComboList;
+
+
+//****************************************************************************************************************************************************
+/// \brief An immutable snapshot of the data used to find combos
+///
+/// A snapshot is built by the combo manager after each batch of modifications of the combo list, and published
+/// using an atomic pointer swap. Since a snapshot is never modified, it can be used without locking while the combo
+/// list is being edited. Each snapshot has an epoch, which is increased every time a snapshot is published, so that
+/// caches can cheaply detect that they are outdated.
+///
+/// The snapshot holds copies of the keywords, matching options and searchable text of the combos. The combos it
+/// references are still owned by the combo list, and must only be dereferenced from the main thread.
+///
+/// To keep the cost of publishing a snapshot proportional to the number of modified combos, the immutable parts of a
+/// snapshot are shared with the next one. The keyword index is shared as a whole if it was not modified since the
+/// previous snapshot. Otherwise it is copied, and the copy shares the parts of the index that were not modified
+/// (see ComboKeywordIndex). The maps of the combos by keyword and of the searchable data are split into shards, so
+/// that only the shards containing modified combos are copied and patched.
+//****************************************************************************************************************************************************
+class ComboSnapshot {
+public: // static data members
+    static quint32 constexpr shardCount = 64; ///< The number of shards of the maps of the snapshot
+
+public: // data types
+    struct SearchEntry {
+        QString name; ///< The display name of the combo
+        QString keyword; ///< The keyword of the combo
+        QString snippet; ///< The snippet of the combo
+        QString description; ///< The description of the combo
+        QString groupName; ///< The name of the group of the combo
+        bool usable { false }; ///< Is the combo usable
+    }; ///< Type definition for the searchable data of a combo
+
+public: // member functions
+    ComboSnapshot(ComboList const &combos, quint64 epoch); ///< Default constructor
+    ComboSnapshot(ComboSnapshot const &previous, ComboList const &combos, VecSpCombo const &removedCombos,
+        VecSpCombo const &modifiedCombos, quint64 epoch); ///< Constructor patching the previous snapshot
+    ComboSnapshot(ComboSnapshot const &) = delete; ///< Disabled copy constructor
+    ComboSnapshot(ComboSnapshot &&) = delete; ///< Disabled move constructor
+    ~ComboSnapshot() = default; ///< Default destructor
+    ComboSnapshot &operator=(ComboSnapshot const &) = delete; ///< Disabled assignment operator
+    ComboSnapshot &operator=(ComboSnapshot &&) = delete; ///< Disabled move assignment operator
+    quint64 epoch() const; ///< Return the epoch of the snapshot
+    ComboKeywordIndex const &keywordIndex() const; ///< Return the keyword index
+    VecSpCombo const &combosWithKeyword(QString const &keyword) const; ///< Return the combos whose keyword is exactly the given keyword
+    SearchEntry const *searchEntry(Combo const *combo) const; ///< Return the searchable data of a combo
+
+private: // data types
+    typedef QHash<QString, VecSpCombo> KeywordShard; ///< Type definition for a shard of the combos indexed by keyword
+    typedef QHash<Combo const *, SearchEntry> SearchShard; ///< Type definition for a shard of the searchable data of the combos
+    typedef std::array<std::shared_ptr<KeywordShard const>, shardCount> KeywordShards; ///< Type definition for the shards of the combos indexed by keyword
+    typedef std::array<std::shared_ptr<SearchShard const>, shardCount> SearchShards; ///< Type definition for the shards of the searchable data of the combos
+    struct Patch {
+        std::array<std::shared_ptr<KeywordShard>, shardCount> keywordShards; ///< The shards of the combos by keyword copied by the patch
+        std::array<std::shared_ptr<SearchShard>, shardCount> searchShards; ///< The shards of the searchable data copied by the patch
+    }; ///< Type definition for the shards owned by a snapshot under construction, that can be modified
+
+private: // member functions
+    KeywordShard &mutableKeywordShard(QString const &keyword, Patch &patch); ///< Return a shard of the combos by keyword that can be modified
+    SearchShard &mutableSearchShard(Combo const *combo, Patch &patch); ///< Return a shard of the searchable data that can be modified
+    void insertCombo(SpCombo const &combo, Patch &patch); ///< Insert a combo in the maps of the snapshot
+    void removeCombo(Combo const *combo, Patch &patch); ///< Remove a combo from the maps of the snapshot
+
+private: // static member functions
+    static quint32 shardIndex(QString const &keyword); ///< Return the index of the shard of a keyword
+    static quint32 shardIndex(Combo const *combo); ///< Return the index of the shard of the searchable data of a combo
+    static SearchEntry searchEntryForCombo(Combo const &combo); ///< Build the searchable data of a combo
+
+private: // data members
+    quint64 const epoch_; ///< The epoch of the snapshot
+    std::shared_ptr<ComboKeywordIndex const> keywordIndex_; ///< The keyword index, shared with the other snapshots of the same revision of the index
+    KeywordShards keywordShards_; ///< All the combos, including disabled ones, indexed by keyword. Unmodified shards are shared with the previous snapshot
+    SearchShards searchShards_; ///< The searchable data of the combos. Unmodified shards are shared with the previous snapshot
+};
+
+
+typedef std::shared_ptr<ComboSnapshot const> SpComboSnapshot; ///< Type definition for shared pointer to combo snapshot
+
+
+#endif // #ifndef BEEFTEXT_COMBO_SNAPSHOT_H
@@ -718,9 +718,13 @@ void ComboTableWidget::onMoveToGroupMenuTriggered(QAction const *action) {
     SpGroup const group = action->data().value<SpGroup>();
     if (!group)
         throw xmilib::Exception(QString("Internal error: %1(): could not retrieve group.").arg(__FUNCTION__));
-    QList<SpCombo> const combos = this->getSelectedCombos();
-    for (SpCombo const &combo: combos)
-        if (combo && (group != combo->group()))
-            combo->setGroup(group);
-    this->onComboChangedGroup();
+    GroupList &groups = ComboManager::instance().groupListRef();
+    GroupList::iterator const it = groups.findByUuid(group->uuid());
+    if (it == groups.end())
+        throw xmilib::Exception(QString("Internal error: %1(): could not find group.").arg(__FUNCTION__));
+    QList<QUuid> uuids;
+    for (SpCombo const &combo: this->getSelectedCombos())
+        if (combo)
+            uuids.append(combo->uuid());
+    groups.processComboListDrop(uuids, static_cast<qint32>(it - groups.begin())); // will trigger onComboChangedGroup()
 }
@@ -18,31 +18,6 @@
 namespace {
 
 
-enum class ECaseChange {
-    NoChange, ///< Do not change case
-    ToUpper, ///< Convert to upper case
-    ToLower ///< Conver to lower case
-}; ///< Enumeration for case change
-
-
-QString const kCustomDateTimeVariable = "dateTime:"; ///< The dateTime variable.
-QString const kInputVariable = "input:"; ///< The input variable.
-QString const kEnvVarVariable = "envVar:"; ///< The envVar variable.
-QString const kPowershellVariable = "powershell:"; ///< The execute variable.
-
-
-//****************************************************************************************************************************************************
-/// \brief Resolve the escaped characters ( \\} and \\\\ in a variable parameter.
-/// \param[in] paramStr The variable parameter.
-/// \return The parameter where the escaped characters have been resolved.
-//****************************************************************************************************************************************************
-QString resolveEscapingInVariableParameter(QString paramStr) {
-    paramStr.replace(R"(\\)", R"(\)");
-    paramStr.replace(R"(\})", R"(})");
-    return paramStr;
-}
-
-
 //****************************************************************************************************************************************************
 /// \brief Converts a character to a Discord emoji. 
 ///
@@ -88,49 +63,16 @@ QString discordEmojisFromClipboard() {
 
 
 //****************************************************************************************************************************************************
-/// \brief Split a timeshift string (e.g. +1d-4w+11h), into individual shifts (e.g. { +1d, -4w, +11h)
+/// \brief Returns the current date shifted according to the time shifts of a #{dateTime:} variable.
 ///
-/// \param[in] shiftStr The timeshift string
-/// \return a string list containing the individual shifts
-//****************************************************************************************************************************************************
-QStringList splitTimeShiftString(QString const &shiftStr) {
-    QStringList result;
-    QString acc;
-    for (QChar const c: shiftStr) {
-        if (('+' == c) || ('-' == c)) {
-            if (!acc.isEmpty()) {
-                result.append(acc);
-                acc = QString();
-            }
-        }
-        acc += c;
-    }
-    if (!acc.isEmpty())
-        result.append(acc);
-    return result;
-}
-
-
+/// \param[in] shifts The time shifts.
+/// \return The current date shifted according to the time shifts.
 //****************************************************************************************************************************************************
-/// \brief Returns the current date shifted according to the instructions in the shift string.
-/// \param[in] shiftStr The string describing the timeshift (as defined in the dateTime: variable documentation.
-/// \return The current date shifted according to the instructions in the shift string.
-//****************************************************************************************************************************************************
-QDateTime shiftedDateTime(QString const &shiftStr) {
+QDateTime shiftedDateTime(QList<SnippetTemplate::TimeShift> const &shifts) {
     QDateTime result = QDateTime::currentDateTime();
-
-    QStringList const shifts = splitTimeShiftString(shiftStr);
-    for (QString const &shift: shifts) {
-        QRegularExpressionMatch const match = QRegularExpression(R"(([+-])(\d+)([yMwdhmsz]))").match(shift);
-        if (!match.hasMatch())
-            continue;
-        bool ok = false;
-        qint64 value = match.captured(2).toLongLong(&ok);
-        if (!ok)
-            continue;
-        if (match.captured(1) == "-")
-            value = -value;
-        switch (match.captured(3)[0].toLatin1()) {
+    for (SnippetTemplate::TimeShift const &shift: shifts) {
+        qint64 const value = shift.value;
+        switch (shift.unit) {
         case 'y':
             result = result.addYears(static_cast<qint32>(value));
             break;
@@ -164,21 +106,14 @@ QDateTime shiftedDateTime(QString const &shiftStr) {
 
 
 //****************************************************************************************************************************************************
-/// \brief Evaluate a #[dateTime:} variable
-/// \param[in] variable The variable.
+/// \brief Evaluate a #{dateTime} or #[dateTime:} variable
+///
+/// \param[in] node The node of the variable.
 /// \return the result of the evaluation.
 //****************************************************************************************************************************************************
-QString evaluateDateTimeVariable(QString const &variable) {
-    QString const formatString = resolveEscapingInVariableParameter(variable.right(variable.size()
-                                                                                   - kCustomDateTimeVariable.size()));
-
-    QRegularExpression const regExp(R"(^dateTime(:(([+-]\d+[yMwdhmsz])+))?:(.*)$)");
-    QRegularExpressionMatch const match = regExp.match(variable);
-    if (!match.hasMatch())
-        return QString();
-    QDateTime const dateTime = match.captured(1).isEmpty() ? QDateTime::currentDateTime() :
-                               shiftedDateTime(match.captured(2));
-    QString formatStr = match.captured(4);
+QString evaluateDateTimeVariable(SnippetTemplate::Node const &node) {
+    QDateTime const dateTime = node.timeShifts.isEmpty() ? QDateTime::currentDateTime() : shiftedDateTime(node.timeShifts);
+    QString formatStr = node.parameter;
     if (formatStr.isEmpty())
         return QLocale::system().toString(dateTime);
 
@@ -193,32 +128,42 @@ QString evaluateDateTimeVariable(QString const &variable) {
 //****************************************************************************************************************************************************
 /// \brief Evaluate a #{combo:} variable.
 ///
-/// \param[in] variable The variable, without the enclosing #{}.
-/// \param[in] caseChange The change of case (uppercase, lowercase) to apply to the evaluated variable.
-/// \param[in] forbiddenSubCombos The text of the combos that are not allowed to be substituted using #{combo:}, to 
-/// avoid endless recursion.
+/// \param[in] node The node of the variable.
+/// \param[in,out] referenceStack The keywords of the combos being expanded by nested #{combo:} variables, which
+/// are not allowed to be substituted again, to avoid endless recursion.
 /// \param[in,out] knownInputVariables The list of know input variables.
 /// \param[out] outCancelled Was the input variable cancelled by the user.
+/// \param[in,out] pure Set to false if the result may change between evaluations: the keyword is used by several
+/// combos, one of them being picked randomly, the referenced combo is impure, or the reference leads back to a combo
+/// being evaluated, in which case the result depends on where the evaluation started.
 /// \return The result of evaluating the variable.
 //****************************************************************************************************************************************************
-QString evaluateComboVariable(QString const &variable, ECaseChange caseChange, QSet<QString> forbiddenSubCombos,
-    QMap<QString, QString> &knownInputVariables, bool &outCancelled) {
-    QString fallbackResult = QString("#{%1}").arg(variable);
-    qint32 const varNameLength = qint32(variable.indexOf(':'));
-    if (varNameLength < 0)
-        return QString();
-    QString const comboName = resolveEscapingInVariableParameter(variable.right(variable.size() - varNameLength - 1));
-    if (forbiddenSubCombos.contains(comboName))
+QString evaluateComboVariable(SnippetTemplate::Node const &node, ComboReferenceStack &referenceStack,
+    QMap<QString, QString> &knownInputVariables, bool &outCancelled, bool &pure) {
+    QString const &fallbackResult = node.text;
+    QString const &comboName = node.parameter;
+    // the nesting depth is small, so a linear search in the stack is faster than maintaining a set
+    QVarLengthArray<QString, 16> &keywords = referenceStack.keywords;
+    bool const isTracking = referenceStack.isTracking;
+    if (isTracking && (std::find(keywords.cbegin(), keywords.cend(), comboName) != keywords.cend())) {
+        pure = false;
         return fallbackResult;
+    }
+    if (referenceStack.depth >= ComboReferenceStack::maxDepth) { // cheap guard, in case the reference graph is wrong
+        pure = false;
+        return fallbackResult;
+    }
 
-    ComboList results;
-    for (SpCombo const &combo: ComboManager::instance().comboListRef())
-        if (combo->keyword() == comboName)
-            results.push_back(combo);
-
+    // the snapshot gives us the combos with the given keyword without iterating over the whole combo list
+    SpComboSnapshot const snapshot = ComboManager::instance().snapshot();
+    if (!snapshot) {
+        pure = false;
+        return fallbackResult;
+    }
+    VecSpCombo const &results = snapshot->combosWithKeyword(comboName);
 
-    qint32 const resultCount = results.size();
-    ComboList::const_iterator it;
+    qint32 const resultCount = qint32(results.size());
+    VecSpCombo::const_iterator it;
     switch (resultCount) {
     case 0:
         return fallbackResult;
@@ -226,18 +171,29 @@ QString evaluateComboVariable(QString const &variable, ECaseChange caseChange, Q
         it = results.begin();
         break;
     default: {
-        xmilib::RandomNumberGenerator rng(0, results.size() - 1);
+        xmilib::RandomNumberGenerator rng(0, resultCount - 1);
         it = results.begin() + rng.get();
+        pure = false;
         break;
     }
     }
 
-    QString str = (*it)->evaluatedSnippet(outCancelled, forbiddenSubCombos << comboName, knownInputVariables); // forbiddenSubcombos is intended at avoiding endless recursion
-    switch (caseChange) {
+    if (isTracking)
+        keywords.push_back(comboName);
+    ++referenceStack.depth;
+    bool subComboIsPure = false;
+    QString str = (*it)->evaluatedSnippet(outCancelled, referenceStack, knownInputVariables, &subComboIsPure);
+    --referenceStack.depth;
+    if (isTracking)
+        keywords.pop_back();
+    pure = pure && subComboIsPure;
+    switch (node.caseChange) {
     case ECaseChange::ToUpper:
         return str.toUpper();
     case ECaseChange::ToLower:
         return str.toLower();
+    case ECaseChange::Trim:
+        return str.trimmed();
     case ECaseChange::NoChange:
     default:
         return str;
@@ -248,14 +204,13 @@ QString evaluateComboVariable(QString const &variable, ECaseChange caseChange, Q
 //****************************************************************************************************************************************************
 /// \brief Evaluate an #{input:} variable.
 ///
-/// \param[in] variable The variable, without the enclosing #{}.
+/// \param[in] description The description of the input, i.e. the parameter of the variable.
 /// \param[in,out] knownInputVariables The list of know input variables.
 /// \param[out] outCancelled Was the input variable cancelled by the user.
 /// \return The result of evaluating the variable.
 //****************************************************************************************************************************************************
-QString evaluateInputVariable(QString const &variable, QMap<QString, QString> &knownInputVariables, bool &outCancelled) {
+QString evaluateInputVariable(QString const &description, QMap<QString, QString> &knownInputVariables, bool &outCancelled) {
     // check if we already add the user input for the given description
-    QString const description = variable.right(variable.size() - kInputVariable.size());
     if (knownInputVariables.contains(description))
         return knownInputVariables[description];
 
@@ -273,25 +228,24 @@ QString evaluateInputVariable(QString const &variable, QMap<QString, QString> &k
 //****************************************************************************************************************************************************
 /// \brief Evaluate an #{envvar:} variable.
 ///
-/// \param[in] variable The variable, without the enclosing #{}.
+/// \param[in] name The name of the environment variable, i.e. the parameter of the variable.
 /// \return The result of evaluating the variable.
 //****************************************************************************************************************************************************
-QString evaluateEnvVarVariable(QString const &variable) {
-    return QProcessEnvironment::systemEnvironment().value(variable.right(variable.size() -
-                                                                         kEnvVarVariable.size()));
+QString evaluateEnvVarVariable(QString const &name) {
+    return QProcessEnvironment::systemEnvironment().value(name);
 }
 
 
 //****************************************************************************************************************************************************
 /// \brief Evaluate an #{execute:} variable.
 ///
-/// \param[in] variable The variable, without the enclosing #{}.
+/// \param[in] parameter The parameter of the variable, i.e. the path of the script, optionally followed by a timeout.
 /// \return The result of evaluating the variable.
 //****************************************************************************************************************************************************
-QString evaluatePowershellVariable(QString const &variable) {
+QString evaluatePowershellVariable(QString const &parameter) {
     try {
-        QRegularExpression const rx(QString(R"(^%1(.+?)(?>:(\d+))?$)").arg(kPowershellVariable));
-        QRegularExpressionMatch const match = rx.match(variable);
+        QRegularExpression const rx(R"(^(.+?)(?>:(\d+))?$)");
+        QRegularExpressionMatch const match = rx.match(parameter);
         if (!match.hasMatch())
             throw xmilib::Exception("An unexpected error occurred while parsing a powershell variable.");
         QString const path = match.captured(1);
@@ -327,8 +281,7 @@ QString evaluatePowershellVariable(QString const &variable) {
         return QString::fromUtf8(p.readAllStandardOutput());
     }
     catch (xmilib::Exception const &e) {
-        globals::debugLog().addWarning(QString("Evaluation of #{%1} variable failed: %2").arg(kPowershellVariable)
-            .arg(e.qwhat()));
+        globals::debugLog().addWarning(QString("Evaluation of #{powershell:} variable failed: %1").arg(e.qwhat()));
         return QString();
     }
 }
@@ -338,57 +291,57 @@ QString evaluatePowershellVariable(QString const &variable) {
 
 
 //****************************************************************************************************************************************************
-/// \param[in] variable The variable, without the enclosing #{}.
-/// \param[in] forbiddenSubCombos The text of the combos that are not allowed to be substituted using #{combo:}, to 
-/// avoid endless recursion.
+/// \param[in] paramStr The variable parameter.
+/// \return The parameter where the escaped characters ( \\} and \\\\ ) have been resolved.
+//****************************************************************************************************************************************************
+QString resolveEscapingInVariableParameter(QString paramStr) {
+    paramStr.replace(R"(\\)", R"(\)");
+    paramStr.replace(R"(\})", R"(})");
+    return paramStr;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The #{key:}, #{shortcut:}, #{delay:} and #{cursor} variables are left in place, as they are processed when
+/// the substitution is performed.
+///
+/// \param[in] node The node of the variable in the compiled snippet.
+/// \param[in,out] referenceStack The keywords of the combos being expanded by nested #{combo:} variables, which
+/// are not allowed to be substituted again, to avoid endless recursion.
 /// \param[in,out] knownInputVariables The list of know input variables.
 /// \param[out] outCancelled Was the input variable cancelled by the user.
+/// \param[in,out] pure Set to false if the variable references a combo whose expansion may change between evaluations.
+/// The purity of the other variables is given by the compiled snippet.
 /// \return The result of evaluating the variable.
 //****************************************************************************************************************************************************
-QString evaluateVariable(QString const &variable, QSet<QString> const &forbiddenSubCombos,
-    QMap<QString, QString> &knownInputVariables, bool &outCancelled) {
+QString evaluateVariable(SnippetTemplate::Node const &node, ComboReferenceStack &referenceStack,
+    QMap<QString, QString> &knownInputVariables, bool &outCancelled, bool &pure) {
     outCancelled = false;
-    QLocale const systemLocale = QLocale::system();
-    if (variable == "clipboard")
+    switch (node.type) {
+    case ESnippetNodeType::Clipboard:
         return ClipboardManager::instance().text();
-
-    if (variable == "discordemoji") //secret variable that create text in Discord emoji from the clipboard text
+    case ESnippetNodeType::DiscordEmoji: //secret variable that create text in Discord emoji from the clipboard text
         return discordEmojisFromClipboard();
-
-    if (variable == "date")
-        return systemLocale.toString(QDate::currentDate());
-
-    if (variable == "time")
-        return systemLocale.toString(QTime::currentTime());
-
-    if (variable == "dateTime")
-        return systemLocale.toString(QDateTime::currentDateTime());
-
-    if (variable.startsWith(kCustomDateTimeVariable))
-        return evaluateDateTimeVariable(variable);
-
-    if (variable.startsWith("combo:"))
-        return evaluateComboVariable(variable, ECaseChange::NoChange, forbiddenSubCombos, knownInputVariables, outCancelled);
-
-    if (variable.startsWith("upper:"))
-        return evaluateComboVariable(variable, ECaseChange::ToUpper, forbiddenSubCombos, knownInputVariables, outCancelled);
-
-    if (variable.startsWith("lower:"))
-        return evaluateComboVariable(variable, ECaseChange::ToLower, forbiddenSubCombos, knownInputVariables, outCancelled);
-
-    if (variable.startsWith("trim:")) {
-        QString const var = evaluateComboVariable(variable, ECaseChange::NoChange, forbiddenSubCombos, knownInputVariables, outCancelled);
-        return var.trimmed();
+    case ESnippetNodeType::Date:
+        return QLocale::system().toString(QDate::currentDate());
+    case ESnippetNodeType::Time:
+        return QLocale::system().toString(QTime::currentTime());
+    case ESnippetNodeType::DateTime:
+        return evaluateDateTimeVariable(node);
+    case ESnippetNodeType::ComboReference:
+        return evaluateComboVariable(node, referenceStack, knownInputVariables, outCancelled, pure);
+    case ESnippetNodeType::Input:
+        return evaluateInputVariable(node.parameter, knownInputVariables, outCancelled);
+    case ESnippetNodeType::EnvVar:
+        return evaluateEnvVarVariable(node.parameter);
+    case ESnippetNodeType::Powershell:
+        return evaluatePowershellVariable(node.parameter);
+    case ESnippetNodeType::Literal:
+    case ESnippetNodeType::Key:
+    case ESnippetNodeType::Shortcut:
+    case ESnippetNodeType::Delay:
+    case ESnippetNodeType::Cursor:
+    default:
+        return node.text;
     }
-
-    if (variable.startsWith(kInputVariable))
-        return evaluateInputVariable(variable, knownInputVariables, outCancelled);
-
-    if (variable.startsWith(kEnvVarVariable))
-        return evaluateEnvVarVariable(variable);
-
-    if (variable.startsWith(kPowershellVariable))
-        return evaluatePowershellVariable(variable);
-
-    return QString("#{%1}").arg(variable); // we could not recognize the variable, so we put it back in the result
 }
@@ -8,8 +8,12 @@
 #define BEEFTEXT_COMBO_VARIABLE_H
 
 
-QString evaluateVariable(QString const &variable, QSet<QString> const &forbiddenSubCombos,
-    QMap<QString, QString> &knownInputVariables, bool &outCancelled); ///< Compute the value of a variable.
+#include "Combo.h"
+
+
+QString resolveEscapingInVariableParameter(QString paramStr); ///< Resolve the escaped characters in a variable parameter.
+QString evaluateVariable(SnippetTemplate::Node const &node, ComboReferenceStack &referenceStack,
+    QMap<QString, QString> &knownInputVariables, bool &outCancelled, bool &pure); ///< Compute the value of a variable.
 
 
 #endif // #ifndef BEEFTEXT_COMBO_VARIABLE_H
@@ -0,0 +1,137 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of typed text buffer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "TypedTextBuffer.h"
+
+
+//****************************************************************************************************************************************************
+/// \param[in] capacity The capacity of the buffer.
+//****************************************************************************************************************************************************
+TypedTextBuffer::TypedTextBuffer(qint32 capacity)
+    : chars_(2 * static_cast<std::size_t>(qMax(1, capacity))) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The capacity of the buffer.
+//****************************************************************************************************************************************************
+qint32 TypedTextBuffer::capacity() const {
+    return static_cast<qint32>(chars_.size() / 2);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note If the buffer contains more characters than the new capacity, the oldest ones are discarded.
+///
+/// \param[in] capacity The new capacity of the buffer.
+//****************************************************************************************************************************************************
+void TypedTextBuffer::setCapacity(qint32 capacity) {
+    capacity = qMax(1, capacity);
+    if (capacity == this->capacity())
+        return;
+    QString const text = this->toString();
+    qint64 const typedLength = typedLength_;
+    chars_.assign(2 * static_cast<std::size_t>(capacity), QChar());
+    this->clear();
+    for (QChar const c: text)
+        this->append(c);
+    typedLength_ = typedLength;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TypedTextBuffer::clear() {
+    start_ = 0;
+    size_ = 0;
+    typedLength_ = 0;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] c The character.
+//****************************************************************************************************************************************************
+void TypedTextBuffer::append(QChar c) {
+    qint32 const capacity = this->capacity();
+    std::size_t const position = static_cast<std::size_t>((start_ + size_) % capacity);
+    chars_[position] = c;
+    chars_[position + static_cast<std::size_t>(capacity)] = c; // the mirror keeps the content contiguous
+    if (size_ < capacity)
+        ++size_;
+    else
+        start_ = (start_ + 1) % capacity; // the oldest character was overwritten
+    ++typedLength_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The characters discarded when the buffer was full cannot be restored, so after a removal the buffer may
+/// contain only the end of the typed text (see isTruncated()). Backspace keeps erasing the discarded characters once
+/// the buffer is empty, so the typed length is decremented even then, and the buffer is no longer truncated once all
+/// the typed characters have been erased.
+//****************************************************************************************************************************************************
+void TypedTextBuffer::removeLast() {
+    if (size_ > 0)
+        --size_;
+    if (typedLength_ > 0)
+        --typedLength_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the buffer is empty.
+//****************************************************************************************************************************************************
+bool TypedTextBuffer::isEmpty() const {
+    return 0 == size_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of characters in the buffer.
+//****************************************************************************************************************************************************
+qint32 TypedTextBuffer::size() const {
+    return size_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The last character of the buffer.
+/// \return A null character if the buffer is empty.
+//****************************************************************************************************************************************************
+QChar TypedTextBuffer::last() const {
+    return size_ ? chars_[static_cast<std::size_t>(start_ + size_ - 1)] : QChar();
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the buffer does not contain the whole text typed since the last clear.
+//****************************************************************************************************************************************************
+bool TypedTextBuffer::isTruncated() const {
+    return typedLength_ > size_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The view is invalidated by any modification of the buffer.
+///
+/// \return A view on the content of the buffer.
+//****************************************************************************************************************************************************
+QStringView TypedTextBuffer::view() const {
+    return QStringView(chars_.data() + start_, size_);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The content of the buffer.
+//****************************************************************************************************************************************************
+QString TypedTextBuffer::toString() const {
+    return this->view().toString();
+}
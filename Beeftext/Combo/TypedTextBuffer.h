@@ -0,0 +1,52 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of typed text buffer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_TYPED_TEXT_BUFFER_H
+#define BEEFTEXT_TYPED_TEXT_BUFFER_H
+
+
+//****************************************************************************************************************************************************
+/// \brief A fixed-capacity ring buffer containing the last characters typed by the user
+///
+/// When the buffer is full, appending a character discards the oldest one. The buffer keeps track of the total number
+/// of characters typed since it was last cleared, so that users of the class can tell whether the buffer contains the
+/// whole typed text or only its end.
+///
+/// Every character is stored twice, at its position in the ring and one capacity further, so the content of the buffer
+/// is always contiguous in memory and can be accessed through a view, without building a string.
+//****************************************************************************************************************************************************
+class TypedTextBuffer {
+public: // member functions
+    explicit TypedTextBuffer(qint32 capacity = 64); ///< Default constructor
+    TypedTextBuffer(TypedTextBuffer const &) = delete; ///< Disabled copy constructor
+    TypedTextBuffer(TypedTextBuffer &&) = delete; ///< Disabled move constructor
+    ~TypedTextBuffer() = default; ///< Default destructor
+    TypedTextBuffer &operator=(TypedTextBuffer const &) = delete; ///< Disabled assignment operator
+    TypedTextBuffer &operator=(TypedTextBuffer &&) = delete; ///< Disabled move assignment operator
+    qint32 capacity() const; ///< Return the capacity of the buffer
+    void setCapacity(qint32 capacity); ///< Set the capacity of the buffer
+    void clear(); ///< Clear the buffer
+    void append(QChar c); ///< Append a character to the buffer
+    void removeLast(); ///< Remove the last character of the buffer
+    bool isEmpty() const; ///< Check if the buffer is empty
+    qint32 size() const; ///< Return the number of characters in the buffer
+    QChar last() const; ///< Return the last character of the buffer
+    bool isTruncated() const; ///< Check whether some of the typed characters were discarded from the buffer
+    QStringView view() const; ///< Return a view on the content of the buffer
+    QString toString() const; ///< Return the content of the buffer as a string
+
+private: // data members
+    std::vector<QChar> chars_; ///< The storage for the characters, twice the capacity of the buffer
+    qint32 start_ { 0 }; ///< The index of the first character in the storage
+    qint32 size_ { 0 }; ///< The number of characters in the buffer
+    qint64 typedLength_ { 0 }; ///< The number of characters typed since the last clear, including discarded ones
+};
+
+
+#endif // #ifndef BEEFTEXT_TYPED_TEXT_BUFFER_H
@@ -74,7 +74,10 @@ EmojiList::const_iterator EmojiList::end() const {
 //
 //****************************************************************************************************************************************************
 void EmojiList::clear() {
+    this->beginResetModel();
     list_.clear();
+    shortcodeIndex_.clear();
+    this->endResetModel();
 }
 
 
@@ -82,7 +85,7 @@ void EmojiList::clear() {
 /// \param[in] shortcode The shortcode.
 //****************************************************************************************************************************************************
 bool EmojiList::contains(QString const &shortcode) const {
-    return list_.end() != std::find_if(list_.begin(), list_.end(), [&](SpEmoji const &emoji) -> bool { return emoji && (emoji->shortcode() == shortcode); });
+    return shortcodeIndex_.contains(shortcode);
 }
 
 
@@ -92,8 +95,7 @@ bool EmojiList::contains(QString const &shortcode) const {
 /// \return A null pointer if there is no emoji with this shortcode.
 //****************************************************************************************************************************************************
 SpEmoji EmojiList::find(QString const &shortcode) const {
-    const_iterator const it = std::find_if(list_.begin(), list_.end(), [&](SpEmoji const &emoji) -> bool { return emoji && (emoji->shortcode() == shortcode); });
-    return (it == list_.end()) ? SpEmoji() : *it;
+    return shortcodeIndex_.value(shortcode);
 }
 
 
@@ -102,6 +104,29 @@ SpEmoji EmojiList::find(QString const &shortcode) const {
 //****************************************************************************************************************************************************
 void EmojiList::append(SpEmoji const &emoji) {
     list_.push_back(emoji);
+    if (!emoji)
+        return;
+    QString const shortcode = emoji->shortcode();
+    if (!shortcodeIndex_.contains(shortcode)) // in case of duplicates, the first emoji in the list is the one found
+        shortcodeIndex_.insert(shortcode, emoji);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The shortcode index is rebuilt, and a model reset is signaled, so that users of the list, like the
+/// combo manager, can update the data they derived from it.
+///
+/// \param[in] emojis The emojis.
+//****************************************************************************************************************************************************
+void EmojiList::assign(QList<SpEmoji> const &emojis) {
+    this->beginResetModel();
+    list_.clear();
+    shortcodeIndex_.clear();
+    list_.reserve(emojis.size());
+    shortcodeIndex_.reserve(emojis.size());
+    for (SpEmoji const &emoji: emojis)
+        this->append(emoji);
+    this->endResetModel();
 }
 
 
@@ -41,6 +41,7 @@ public: // member functions
     bool contains(QString const &shortcode) const; ///< Check if the list contains an emoji with the given shortcode.
     SpEmoji find(QString const &shortcode) const; ///< Retrieve an emoji given its shortcode.
     void append(SpEmoji const &emoji); ///< Add an emoji at the end of the list
+    void assign(QList<SpEmoji> const &emojis); ///< Replace the content of the list
     qsizetype size() const; ///< Return the number of emojis in the list.
     bool isEmpty() const; ///< Check if the list is empty.
 
@@ -51,6 +52,7 @@ public: // member functions
 
 private: // data members
     QList<SpEmoji> list_; ///<Type definition for a list of emojis.
+    QHash<QString, SpEmoji> shortcodeIndex_; ///< The emojis indexed by shortcode.
 };
 
 
@@ -11,6 +11,7 @@
 #include "EmojiManager.h"
 #include "BeeftextGlobals.h"
 #include "LastUse/EmojiLastUseFile.h"
+#include "ForegroundApplicationTracker.h"
 #include <XMiLib/Exception.h>
 
 
@@ -90,10 +91,10 @@ EmojiManager::~EmojiManager() {
 
 
 //****************************************************************************************************************************************************
-/// \param[in] appExeName The application executable name.
+/// \return true if and only if the foreground application is excluded from emoji substitution.
 //****************************************************************************************************************************************************
-bool EmojiManager::isExcludedApplication(QString const &appExeName) const {
-    return excludedApps_.filter(appExeName);
+bool EmojiManager::isForegroundApplicationExcluded() const {
+    return excludedApps_.filter(ForegroundApplicationTracker::instance().executableFileName());
 }
 
 
@@ -146,6 +147,8 @@ bool EmojiManager::load(QString const &path) {
             throw Exception("The emoji list file is invalid.");
         QJsonObject const rootObject = doc.object();
 
+        QList<SpEmoji> emojis;
+        emojis.reserve(rootObject.size());
         for (QJsonObject::const_iterator it = rootObject.begin(); it != rootObject.end(); ++it) {
             QJsonValue const value = it.value();
             if (!value.isObject())
@@ -155,8 +158,9 @@ bool EmojiManager::load(QString const &path) {
             if (chars.isEmpty())
                 throw Exception();
             QString const shortcode = it.key();
-            emojis_.append(std::make_shared<Emoji>(shortcode, chars, object["category"].toString()));
+            emojis.append(std::make_shared<Emoji>(shortcode, chars, object["category"].toString()));
         }
+        emojis_.assign(emojis); // the shortcode index of the list is built here
         loadEmojiLastUseDateTimes(emojis_);
     }
     catch (Exception const &e) {
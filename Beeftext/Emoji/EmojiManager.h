@@ -31,7 +31,7 @@ public: // member functions
     ~EmojiManager(); ///< Destructor
     EmojiManager &operator=(EmojiManager const &) = delete; ///< Disabled assignment operator
     EmojiManager &operator=(EmojiManager &&) = delete; ///< Disabled move assignment operator
-    bool isExcludedApplication(QString const &appExeName) const; ///< Check whether the application is excluded from emoji substitution.
+    bool isForegroundApplicationExcluded() const; ///< Check whether the foreground application is excluded from emoji substitution.
     bool runDialog(QWidget *parent = nullptr); ///< Run the sensitive application dialog
     EmojiList const &emojiListRef() const; ///< Return a constant reference the list of emojis.
 
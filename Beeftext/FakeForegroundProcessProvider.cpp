@@ -0,0 +1,103 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of fake foreground process provider class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "FakeForegroundProcessProvider.h"
+
+
+//****************************************************************************************************************************************************
+/// \return The identifier of the foreground window.
+/// \return 0 if there is no foreground window.
+//****************************************************************************************************************************************************
+quintptr FakeForegroundProcessProvider::foregroundWindow() const {
+    ++foregroundWindowQueryCount_;
+    return foregroundWindow_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] window The identifier of the window.
+/// \return The identifier of the process owning the window.
+/// \return 0 if the process owning the window was not set.
+//****************************************************************************************************************************************************
+quint32 FakeForegroundProcessProvider::processIdForWindow(quintptr window) const {
+    ++processIdQueryCount_;
+    return processIds_.value(window, 0);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] processId The identifier of the process.
+/// \return The executable file name of the process.
+/// \return A null string if the executable file name of the process was not set.
+//****************************************************************************************************************************************************
+QString FakeForegroundProcessProvider::executableFileName(quint32 processId) const {
+    ++executableFileNameQueryCount_;
+    return executableFileNames_.value(processId);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] window The identifier of the window. 0 means there is no foreground window.
+//****************************************************************************************************************************************************
+void FakeForegroundProcessProvider::setForegroundWindow(quintptr window) {
+    foregroundWindow_ = window;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] window The identifier of the window.
+/// \param[in] processId The identifier of the process owning the window.
+//****************************************************************************************************************************************************
+void FakeForegroundProcessProvider::setWindowProcessId(quintptr window, quint32 processId) {
+    processIds_.insert(window, processId);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] processId The identifier of the process.
+/// \param[in] fileName The executable file name of the process. A null string simulates a failure to retrieve it.
+//****************************************************************************************************************************************************
+void FakeForegroundProcessProvider::setExecutableFileName(quint32 processId, QString const &fileName) {
+    executableFileNames_.insert(processId, fileName);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of calls to foregroundWindow() since the provider was created or the counters were reset.
+//****************************************************************************************************************************************************
+qint32 FakeForegroundProcessProvider::foregroundWindowQueryCount() const {
+    return foregroundWindowQueryCount_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of calls to processIdForWindow() since the provider was created or the counters were reset.
+//****************************************************************************************************************************************************
+qint32 FakeForegroundProcessProvider::processIdQueryCount() const {
+    return processIdQueryCount_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of calls to executableFileName() since the provider was created or the counters were reset.
+//****************************************************************************************************************************************************
+qint32 FakeForegroundProcessProvider::executableFileNameQueryCount() const {
+    return executableFileNameQueryCount_;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void FakeForegroundProcessProvider::resetQueryCounts() {
+    foregroundWindowQueryCount_ = 0;
+    processIdQueryCount_ = 0;
+    executableFileNameQueryCount_ = 0;
+}
@@ -0,0 +1,53 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of fake foreground process provider class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_FAKE_FOREGROUND_PROCESS_PROVIDER_H
+#define BEEFTEXT_FAKE_FOREGROUND_PROCESS_PROVIDER_H
+
+
+#include "ForegroundProcessProvider.h"
+
+
+//****************************************************************************************************************************************************
+/// \brief A foreground process provider returning windows and processes registered by the caller
+///
+/// The provider counts the queries it receives, so that the caching of its results can be checked. A process whose
+/// executable file name was not set, or was set to a null string, simulates a process whose name cannot be retrieved
+/// (e.g. an elevated process). The class does not depend on the Windows API.
+//****************************************************************************************************************************************************
+class FakeForegroundProcessProvider : public ForegroundProcessProvider {
+public: // member functions
+    FakeForegroundProcessProvider() = default; ///< Default constructor
+    FakeForegroundProcessProvider(FakeForegroundProcessProvider const &) = delete; ///< Disabled copy constructor
+    FakeForegroundProcessProvider(FakeForegroundProcessProvider &&) = delete; ///< Disabled move constructor
+    ~FakeForegroundProcessProvider() override = default; ///< Default destructor
+    FakeForegroundProcessProvider &operator=(FakeForegroundProcessProvider const &) = delete; ///< Disabled assignment operator
+    FakeForegroundProcessProvider &operator=(FakeForegroundProcessProvider &&) = delete; ///< Disabled move assignment operator
+    quintptr foregroundWindow() const override; ///< Return the identifier of the foreground window
+    quint32 processIdForWindow(quintptr window) const override; ///< Return the identifier of the process owning a window
+    QString executableFileName(quint32 processId) const override; ///< Return the executable file name of a process
+    void setForegroundWindow(quintptr window); ///< Set the foreground window
+    void setWindowProcessId(quintptr window, quint32 processId); ///< Set the identifier of the process owning a window
+    void setExecutableFileName(quint32 processId, QString const &fileName); ///< Set the executable file name of a process
+    qint32 foregroundWindowQueryCount() const; ///< Return the number of calls to foregroundWindow()
+    qint32 processIdQueryCount() const; ///< Return the number of calls to processIdForWindow()
+    qint32 executableFileNameQueryCount() const; ///< Return the number of calls to executableFileName()
+    void resetQueryCounts(); ///< Reset the query counters
+
+private: // data members
+    quintptr foregroundWindow_ { 0 }; ///< The foreground window
+    QHash<quintptr, quint32> processIds_; ///< The identifier of the process owning each window
+    QHash<quint32, QString> executableFileNames_; ///< The executable file name of each process
+    mutable qint32 foregroundWindowQueryCount_ { 0 }; ///< The number of calls to foregroundWindow()
+    mutable qint32 processIdQueryCount_ { 0 }; ///< The number of calls to processIdForWindow()
+    mutable qint32 executableFileNameQueryCount_ { 0 }; ///< The number of calls to executableFileName()
+};
+
+
+#endif // #ifndef BEEFTEXT_FAKE_FOREGROUND_PROCESS_PROVIDER_H
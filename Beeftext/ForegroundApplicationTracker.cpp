@@ -0,0 +1,89 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of foreground application tracker class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ForegroundApplicationTracker.h"
+#include "FakeForegroundProcessProvider.h"
+
+
+//****************************************************************************************************************************************************
+/// \return A reference to the only allowed instance of the class. On Windows, it uses the Windows API, otherwise it
+/// uses a fake provider that reports no foreground window.
+//****************************************************************************************************************************************************
+ForegroundApplicationTracker &ForegroundApplicationTracker::instance() {
+#ifdef Q_OS_WINDOWS
+    static ForegroundApplicationTracker instance(std::make_unique<WindowsForegroundProcessProvider>());
+#else
+    static ForegroundApplicationTracker instance(std::make_unique<FakeForegroundProcessProvider>());
+#endif // #ifdef Q_OS_WINDOWS
+    return instance;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] provider The foreground process provider. Must not be null.
+//****************************************************************************************************************************************************
+ForegroundApplicationTracker::ForegroundApplicationTracker(std::unique_ptr<ForegroundProcessProvider> provider)
+    : provider_(std::move(provider)) {
+    Q_ASSERT(provider_);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The name of the executable file of the foreground application, including its extension (e.g.
+/// "explorer.exe").
+/// \return A null string if the name could not be retrieved.
+//****************************************************************************************************************************************************
+QString ForegroundApplicationTracker::executableFileName() {
+    this->update();
+    return executableFileName_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The identifier of the process owning the foreground window.
+/// \return 0 if there is no foreground window.
+//****************************************************************************************************************************************************
+quint32 ForegroundApplicationTracker::processId() {
+    this->update();
+    return processId_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if Beeftext is the foreground application.
+//****************************************************************************************************************************************************
+bool ForegroundApplicationTracker::isBeeftextInForeground() {
+    return QCoreApplication::applicationPid() == this->processId();
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The information will be retrieved again on next use, even if the foreground window has not changed.
+//****************************************************************************************************************************************************
+void ForegroundApplicationTracker::invalidate() {
+    isValid_ = false;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void ForegroundApplicationTracker::update() {
+    quintptr const window = provider_->foregroundWindow();
+    if (isValid_ && (window == window_))
+        return;
+    window_ = window;
+    quint32 const processId = provider_->processIdForWindow(window);
+    if (isValid_ && (processId == processId_) && (!executableFileName_.isNull())) // another window of the same application
+        return;
+    processId_ = processId;
+    executableFileName_ = provider_->executableFileName(processId);
+    isValid_ = true;
+}
@@ -0,0 +1,57 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of foreground application tracker class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_FOREGROUND_APPLICATION_TRACKER_H
+#define BEEFTEXT_FOREGROUND_APPLICATION_TRACKER_H
+
+
+#include "ForegroundProcessProvider.h"
+#include <memory>
+
+
+//****************************************************************************************************************************************************
+/// \brief A class keeping track of the application in the foreground
+///
+/// Retrieving the executable file name of a process is expensive, and it is needed for every keystroke processed by
+/// the keyboard hook. The tracker only queries the foreground window on each call, and retrieves the process and its
+/// executable file name when the foreground window changes. When the new foreground window belongs to the same
+/// process as the previous one, the executable file name is reused.
+///
+/// The tracker is not thread-safe, and the instance must only be used from the main thread, where the keyboard hook
+/// runs.
+//****************************************************************************************************************************************************
+class ForegroundApplicationTracker {
+public: // static member functions
+    static ForegroundApplicationTracker &instance(); ///< Return the only allowed instance of the class
+
+public: // member functions
+    explicit ForegroundApplicationTracker(std::unique_ptr<ForegroundProcessProvider> provider); ///< Default constructor
+    ForegroundApplicationTracker(ForegroundApplicationTracker const &) = delete; ///< Disabled copy constructor
+    ForegroundApplicationTracker(ForegroundApplicationTracker &&) = delete; ///< Disabled move constructor
+    ~ForegroundApplicationTracker() = default; ///< Default destructor
+    ForegroundApplicationTracker &operator=(ForegroundApplicationTracker const &) = delete; ///< Disabled assignment operator
+    ForegroundApplicationTracker &operator=(ForegroundApplicationTracker &&) = delete; ///< Disabled move assignment operator
+    QString executableFileName(); ///< Return the executable file name of the foreground application
+    quint32 processId(); ///< Return the identifier of the foreground process
+    bool isBeeftextInForeground(); ///< Check whether Beeftext is the foreground application
+    void invalidate(); ///< Discard the cached information
+
+private: // member functions
+    void update(); ///< Update the cached information if the foreground window has changed
+
+private: // data members
+    std::unique_ptr<ForegroundProcessProvider> provider_; ///< The foreground process provider
+    bool isValid_ { false }; ///< Is the cached information valid
+    quintptr window_ { 0 }; ///< The foreground window
+    quint32 processId_ { 0 }; ///< The identifier of the process owning the foreground window
+    QString executableFileName_; ///< The executable file name of the foreground process
+};
+
+
+#endif // #ifndef BEEFTEXT_FOREGROUND_APPLICATION_TRACKER_H
@@ -0,0 +1,58 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of foreground process provider classes
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ForegroundProcessProvider.h"
+
+
+#ifdef Q_OS_WINDOWS
+
+
+#include <Psapi.h>
+
+
+//****************************************************************************************************************************************************
+/// \return The identifier of the foreground window.
+/// \return 0 if there is no foreground window.
+//****************************************************************************************************************************************************
+quintptr WindowsForegroundProcessProvider::foregroundWindow() const {
+    return reinterpret_cast<quintptr>(GetForegroundWindow());
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] window The identifier of the window.
+/// \return The identifier of the process owning the window.
+/// \return 0 if the window is invalid.
+//****************************************************************************************************************************************************
+quint32 WindowsForegroundProcessProvider::processIdForWindow(quintptr window) const {
+    DWORD processId = 0;
+    GetWindowThreadProcessId(reinterpret_cast<HWND>(window), &processId); // NOLINT(performance-no-int-to-ptr)
+    return processId;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] processId The identifier of the process.
+/// \return The name of the executable file of the process, including its extension (e.g. "explorer.exe").
+/// \return A null string in case of failure.
+//****************************************************************************************************************************************************
+QString WindowsForegroundProcessProvider::executableFileName(quint32 processId) const {
+    WCHAR buffer[MAX_PATH + 1] = { 0 };
+    // ReSharper disable once CppLocalVariableMayBeConst
+    HANDLE processHandle = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
+    if (!processHandle)
+        return QString();
+    bool const ok = GetModuleFileNameEx(processHandle, nullptr, buffer, MAX_PATH);
+    CloseHandle(processHandle);
+    return ok ? QFileInfo(QDir::fromNativeSeparators(QString::fromWCharArray(buffer))).fileName() : QString();
+}
+
+
+#endif // #ifdef Q_OS_WINDOWS
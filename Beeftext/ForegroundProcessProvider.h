@@ -0,0 +1,57 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of foreground process provider classes
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_FOREGROUND_PROCESS_PROVIDER_H
+#define BEEFTEXT_FOREGROUND_PROCESS_PROVIDER_H
+
+
+//****************************************************************************************************************************************************
+/// \brief Abstract interface for the retrieval of information about the foreground window and its process
+///
+/// Windows are identified by an opaque integer value, so that the interface does not depend on the Windows API and
+/// can be replaced by a fake implementation.
+//****************************************************************************************************************************************************
+class ForegroundProcessProvider {
+public: // member functions
+    ForegroundProcessProvider() = default; ///< Default constructor
+    ForegroundProcessProvider(ForegroundProcessProvider const &) = delete; ///< Disabled copy constructor
+    ForegroundProcessProvider(ForegroundProcessProvider &&) = delete; ///< Disabled move constructor
+    virtual ~ForegroundProcessProvider() = default; ///< Default destructor
+    ForegroundProcessProvider &operator=(ForegroundProcessProvider const &) = delete; ///< Disabled assignment operator
+    ForegroundProcessProvider &operator=(ForegroundProcessProvider &&) = delete; ///< Disabled move assignment operator
+    virtual quintptr foregroundWindow() const = 0; ///< Return the identifier of the foreground window
+    virtual quint32 processIdForWindow(quintptr window) const = 0; ///< Return the identifier of the process owning a window
+    virtual QString executableFileName(quint32 processId) const = 0; ///< Return the executable file name of a process
+};
+
+
+#ifdef Q_OS_WINDOWS
+
+
+//****************************************************************************************************************************************************
+/// \brief Foreground process provider using the Windows API
+//****************************************************************************************************************************************************
+class WindowsForegroundProcessProvider : public ForegroundProcessProvider {
+public: // member functions
+    WindowsForegroundProcessProvider() = default; ///< Default constructor
+    WindowsForegroundProcessProvider(WindowsForegroundProcessProvider const &) = delete; ///< Disabled copy constructor
+    WindowsForegroundProcessProvider(WindowsForegroundProcessProvider &&) = delete; ///< Disabled move constructor
+    ~WindowsForegroundProcessProvider() override = default; ///< Default destructor
+    WindowsForegroundProcessProvider &operator=(WindowsForegroundProcessProvider const &) = delete; ///< Disabled assignment operator
+    WindowsForegroundProcessProvider &operator=(WindowsForegroundProcessProvider &&) = delete; ///< Disabled move assignment operator
+    quintptr foregroundWindow() const override; ///< Return the identifier of the foreground window
+    quint32 processIdForWindow(quintptr window) const override; ///< Return the identifier of the process owning a window
+    QString executableFileName(quint32 processId) const override; ///< Return the executable file name of a process
+};
+
+
+#endif // #ifdef Q_OS_WINDOWS
+
+
+#endif // #ifndef BEEFTEXT_FOREGROUND_PROCESS_PROVIDER_H
@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "Group.h"
+#include "Combo/Combo.h"
 #include <utility>
 #include "BeeftextConstants.h"
 
@@ -117,6 +118,8 @@ bool Group::enabled() const {
 /// \param[in] enable The enabled/disabled state of the group.
 //****************************************************************************************************************************************************
 void Group::setEnabled(bool enable) {
+    if (enabled_ != enable)
+        Combo::invalidateMatchDescriptors(); // the usability of the combos of the group changes
     enabled_ = enable;
     this->touch();
 }
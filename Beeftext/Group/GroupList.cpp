@@ -365,17 +365,18 @@ bool GroupList::processComboListDrop(QList<QUuid> const &uuids, qint32 index) {
         return false;
     SpGroup const &group = groups_[static_cast<quint32>(index)];
     ComboList &comboList = ComboManager::instance().comboListRef();
-    bool changed = false;
+    QList<QUuid> changedUuids;
     for (QUuid const &uuid: uuids) {
         ComboList::iterator const it = comboList.findByUuid(uuid);
         if ((it == comboList.end()) || ((*it)->group() == group))
             continue;
         (*it)->setGroup(group);
-        changed = true;
+        changedUuids.append(uuid);
     }
 
+    bool const changed = !changedUuids.isEmpty();
     if (changed)
-        emit combosChangedGroup();
+        emit combosChangedGroup(changedUuids);
     return changed;
 }
 
@@ -417,6 +418,16 @@ bool GroupList::processGroupDrop(qint32 groupIndex, qint32 dropIndex) {
 }
 
 
+//****************************************************************************************************************************************************
+/// \param[in] index The index of the group in the list.
+//****************************************************************************************************************************************************
+void GroupList::markGroupAsEdited(qint32 index) {
+    Q_ASSERT((index >= 0) && (index < qint32(groups_.size())));
+    qint32 const row = index + 1; // row + 1 because entry at index 0 is special entry "<All combos>"
+    emit dataChanged(this->index(row, 0), this->index(row, 0), QVector<int>() << Qt::DisplayRole << Qt::ForegroundRole);
+}
+
+
 //****************************************************************************************************************************************************
 //
 //****************************************************************************************************************************************************
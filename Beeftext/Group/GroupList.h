@@ -74,6 +74,7 @@ public: // member functions
     void setDropType(EDropType dropType); ///< Set the drop type
     bool processComboListDrop(QList<QUuid> const &uuids, qint32 index); ///< Process the dropping of a combo list
     bool processGroupDrop(qint32 groupIndex, qint32 dropIndex); ///< Process the dropping of a combo list
+    void markGroupAsEdited(qint32 index); ///< Mark a group as edited
     /// \name List model member functions
     /// \{
     int rowCount(QModelIndex const &) const override; ///< Returns the number of rows in the model
@@ -87,7 +88,7 @@ public: // member functions
 
 signals:
     void groupMoved(SpGroup group, qint32 newIndex); ///< Signal for the moving of a group in the list.
-    void combosChangedGroup(); ///< Signal for the changing of combo groups.
+    void combosChangedGroup(QList<QUuid> const &uuids); ///< Signal for the changing of combo groups.
 
 private: // data members
     VecSpGroup groups_; ///< The list of groups
@@ -341,13 +341,15 @@ void GroupListWidget::onActionEnableDisableGroup() {
         if (!group)
             return;
         group->setEnabled(!group->enabled());
+        qint32 const index = this->selectedGroupIndex();
+        GroupList &groups = ComboManager::instance().groupListRef();
+        if ((index >= 0) && (index < groups.size()))
+            groups.markGroupAsEdited(index);
         this->updateGui();
         QString errorMessage;
         if (!ComboManager::instance().saveComboListToFile(&errorMessage))
             throw xmilib::Exception(errorMessage);
 
-        qint32 const index = this->selectedGroupIndex();
-        GroupList &groups = ComboManager::instance().groupListRef();
         emit selectedGroupChanged(((index < 0) || (index >= groups.size())) ? nullptr : groups[index]);
     }
     catch (xmilib::Exception const &e) {
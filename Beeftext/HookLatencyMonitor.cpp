@@ -0,0 +1,194 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of hook latency monitor class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "HookLatencyMonitor.h"
+#include <bit>
+
+
+//****************************************************************************************************************************************************
+/// \param[in] thresholdUs The threshold for the 99th percentile of the durations, in microseconds.
+/// \param[in] recoveryThresholdUs The threshold the 99th percentile of the durations must fall under to leave
+/// degraded mode, in microseconds. It should be lower than thresholdUs.
+//****************************************************************************************************************************************************
+HookLatencyMonitor::HookLatencyMonitor(qint64 thresholdUs, qint64 recoveryThresholdUs)
+    : thresholdUs_(thresholdUs)
+    , recoveryThresholdUs_(qMin(recoveryThresholdUs, thresholdUs)) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] durationUs The duration of the call, in microseconds.
+/// \return true if and only if the monitor entered or left degraded mode because of this sample.
+//****************************************************************************************************************************************************
+bool HookLatencyMonitor::addSample(qint64 durationUs) {
+    qint32 const bucket = bucketIndex(durationUs);
+    if (sampleCount_ < windowSize)
+        ++sampleCount_;
+    else
+        --histogram_[window_[windowPos_]]; // the window is full, we evict the oldest sample
+    window_[windowPos_] = static_cast<quint8>(bucket);
+    windowPos_ = (windowPos_ + 1) % windowSize;
+    ++histogram_[bucket];
+    ++totalSampleCount_;
+    maxDurationUs_ = qMax(maxDurationUs_, durationUs);
+
+    if ((sampleCount_ < minSampleCount) || (!degradationEnabled_))
+        return false;
+    if (degraded_) {
+        // the upper bound of the percentile is used, so that the monitor only recovers if the percentile is known to be under the recovery threshold
+        degraded_ = this->percentile(0.99) >= recoveryThresholdUs_;
+        return !degraded_;
+    }
+    // the lower bound of the bucket is used, so that the monitor only degrades if the percentile is known to exceed the threshold
+    degraded_ = bucketLowerBound(this->percentileBucket(0.99)) > thresholdUs_;
+    return degraded_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the monitor is in degraded mode.
+//****************************************************************************************************************************************************
+bool HookLatencyMonitor::isDegraded() const {
+    return degraded_;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void HookLatencyMonitor::reset() {
+    histogram_.fill(0);
+    windowPos_ = 0;
+    sampleCount_ = 0;
+    totalSampleCount_ = 0;
+    maxDurationUs_ = 0;
+    degraded_ = false;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note Forbidding degraded mode makes the monitor leave it, but the histogram is kept.
+///
+/// \param[in] enabled Can the monitor enter degraded mode.
+//****************************************************************************************************************************************************
+void HookLatencyMonitor::setDegradationEnabled(bool enabled) {
+    degradationEnabled_ = enabled;
+    if (!enabled)
+        degraded_ = false;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the monitor can enter degraded mode.
+//****************************************************************************************************************************************************
+bool HookLatencyMonitor::isDegradationEnabled() const {
+    return degradationEnabled_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The threshold for the 99th percentile of the durations, in microseconds.
+//****************************************************************************************************************************************************
+qint64 HookLatencyMonitor::threshold() const {
+    return thresholdUs_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The threshold the 99th percentile of the durations must fall under to leave degraded mode, in microseconds.
+//****************************************************************************************************************************************************
+qint64 HookLatencyMonitor::recoveryThreshold() const {
+    return recoveryThresholdUs_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of calls accounted for in the histogram.
+//****************************************************************************************************************************************************
+qint32 HookLatencyMonitor::sampleCount() const {
+    return sampleCount_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of calls since the monitor was created or reset.
+//****************************************************************************************************************************************************
+quint64 HookLatencyMonitor::totalSampleCount() const {
+    return totalSampleCount_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The longest duration since the monitor was created or reset, in microseconds.
+//****************************************************************************************************************************************************
+qint64 HookLatencyMonitor::maxDuration() const {
+    return maxDurationUs_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] p The percentile, between 0 and 1.
+/// \return An upper bound for the percentile of the durations in the histogram, in microseconds.
+/// \return 0 if the histogram is empty.
+//****************************************************************************************************************************************************
+qint64 HookLatencyMonitor::percentile(double p) const {
+    if (!sampleCount_)
+        return 0;
+    qint32 const bucket = this->percentileBucket(p);
+    return bucket < bucketCount - 1 ? qMin(bucketLowerBound(bucket + 1), maxDurationUs_) : maxDurationUs_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return A human readable summary of the statistics.
+//****************************************************************************************************************************************************
+QString HookLatencyMonitor::summary() const {
+    return QString("%1 calls, p50 <= %2 us, p99 <= %3 us, max %4 us%5").arg(totalSampleCount_).arg(this->percentile(0.5))
+        .arg(this->percentile(0.99)).arg(maxDurationUs_).arg(degraded_ ? ", degraded mode" : "");
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] p The percentile, between 0 and 1.
+/// \return The index of the bucket containing the percentile.
+//****************************************************************************************************************************************************
+qint32 HookLatencyMonitor::percentileBucket(double p) const {
+    qint64 const rank = qMax<qint64>(1, qint64(std::ceil(qBound(0.0, p, 1.0) * sampleCount_)));
+    qint64 count = 0;
+    for (qint32 i = 0; i < bucketCount; ++i) {
+        count += histogram_[i];
+        if (count >= rank)
+            return i;
+    }
+    return bucketCount - 1;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Bucket 0 contains durations shorter than 1 microsecond, and bucket i > 0 contains durations in
+/// [2^(i-1), 2^i[ microseconds. The last bucket contains all longer durations.
+///
+/// \param[in] durationUs The duration, in microseconds.
+/// \return The index of the bucket.
+//****************************************************************************************************************************************************
+qint32 HookLatencyMonitor::bucketIndex(qint64 durationUs) {
+    if (durationUs <= 0)
+        return 0;
+    return qMin<qint32>(bucketCount - 1, qint32(std::bit_width(quint64(durationUs))));
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] bucket The index of the bucket.
+/// \return The lower bound of the bucket, in microseconds.
+//****************************************************************************************************************************************************
+qint64 HookLatencyMonitor::bucketLowerBound(qint32 bucket) {
+    return bucket <= 0 ? 0 : (qint64(1) << (bucket - 1));
+}
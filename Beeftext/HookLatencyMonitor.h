@@ -0,0 +1,77 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of hook latency monitor class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_HOOK_LATENCY_MONITOR_H
+#define BEEFTEXT_HOOK_LATENCY_MONITOR_H
+
+
+//****************************************************************************************************************************************************
+/// \brief A monitor for the duration of the keyboard hook callback
+///
+/// Windows silently removes a low level keyboard hook whose callback takes longer than the LowLevelHooksTimeout
+/// registry value. The monitor keeps a histogram of the durations of the most recent calls, using buckets whose
+/// bounds are powers of 2 in microseconds. When the 99th percentile of the durations is known to exceed a threshold,
+/// the monitor enters degraded mode. It leaves this mode when the 99th percentile is known to be back under a lower
+/// recovery threshold, so that a single burst of slow calls (e.g. while the system boots) does not degrade the
+/// processing for the rest of the session, and the mode does not flip back and forth around a single threshold.
+/// Degraded mode can be disabled, e.g. when the processing cannot be moved out of the hook, in which case the monitor
+/// only keeps statistics.
+///
+/// The class does not depend on the Windows API, and does not allocate memory when samples are added.
+//****************************************************************************************************************************************************
+class HookLatencyMonitor {
+public: // static data members
+    static qint32 constexpr bucketCount = 24; ///< The number of buckets in the histogram. The last bucket has no upper bound
+    static qint32 constexpr windowSize = 1024; ///< The number of recent calls accounted for in the histogram
+    static qint32 constexpr minSampleCount = 100; ///< The number of calls required before the monitor can enter degraded mode
+    static qint64 constexpr defaultThresholdUs = 100000; ///< The default threshold for the 99th percentile, in microseconds
+    static qint64 constexpr defaultRecoveryThresholdUs = 25000; ///< The default threshold the 99th percentile must fall under to leave degraded mode, in microseconds
+
+public: // member functions
+    explicit HookLatencyMonitor(qint64 thresholdUs = defaultThresholdUs, qint64 recoveryThresholdUs = defaultRecoveryThresholdUs); ///< Default constructor
+    HookLatencyMonitor(HookLatencyMonitor const &) = delete; ///< Disabled copy constructor
+    HookLatencyMonitor(HookLatencyMonitor &&) = delete; ///< Disabled move constructor
+    ~HookLatencyMonitor() = default; ///< Default destructor
+    HookLatencyMonitor &operator=(HookLatencyMonitor const &) = delete; ///< Disabled assignment operator
+    HookLatencyMonitor &operator=(HookLatencyMonitor &&) = delete; ///< Disabled move assignment operator
+    bool addSample(qint64 durationUs); ///< Add the duration of a call to the monitor
+    bool isDegraded() const; ///< Check whether the monitor is in degraded mode
+    void reset(); ///< Clear the histogram and leave degraded mode
+    void setDegradationEnabled(bool enabled); ///< Allow or forbid the monitor to enter degraded mode
+    bool isDegradationEnabled() const; ///< Check whether the monitor can enter degraded mode
+    qint64 threshold() const; ///< Return the threshold for the 99th percentile, in microseconds
+    qint64 recoveryThreshold() const; ///< Return the threshold the 99th percentile must fall under to leave degraded mode, in microseconds
+    qint32 sampleCount() const; ///< Return the number of calls accounted for in the histogram
+    quint64 totalSampleCount() const; ///< Return the number of calls since the monitor was created or reset
+    qint64 maxDuration() const; ///< Return the longest duration since the monitor was created or reset
+    qint64 percentile(double p) const; ///< Return an upper bound for a percentile of the durations in the histogram
+    QString summary() const; ///< Return a human readable summary of the statistics
+
+private: // member functions
+    qint32 percentileBucket(double p) const; ///< Return the bucket containing a percentile of the durations in the histogram
+
+private: // static member functions
+    static qint32 bucketIndex(qint64 durationUs); ///< Return the index of the bucket for a duration
+    static qint64 bucketLowerBound(qint32 bucket); ///< Return the lower bound of a bucket, in microseconds
+
+private: // data members
+    qint64 thresholdUs_ { defaultThresholdUs }; ///< The threshold for the 99th percentile, in microseconds
+    qint64 recoveryThresholdUs_ { defaultRecoveryThresholdUs }; ///< The threshold the 99th percentile must fall under to leave degraded mode, in microseconds
+    std::array<qint32, bucketCount> histogram_ {}; ///< The number of recent calls in each bucket
+    std::array<quint8, windowSize> window_ {}; ///< The bucket of each recent call, used as a ring buffer
+    qint32 windowPos_ { 0 }; ///< The position of the next sample in the window
+    qint32 sampleCount_ { 0 }; ///< The number of samples in the window
+    quint64 totalSampleCount_ { 0 }; ///< The number of samples since the monitor was created or reset
+    qint64 maxDurationUs_ { 0 }; ///< The longest duration since the monitor was created or reset
+    bool degraded_ { false }; ///< Is the monitor in degraded mode
+    bool degradationEnabled_ { true }; ///< Can the monitor enter degraded mode
+};
+
+
+#endif // #ifndef BEEFTEXT_HOOK_LATENCY_MONITOR_H
@@ -15,6 +15,7 @@
 #include "BeeftextGlobals.h"
 #include "BeeftextUtils.h"
 #include "KeyboardMapper.h"
+#include "ForegroundApplicationTracker.h"
 #include <XMiLib/Exception.h>
 
 
@@ -23,8 +24,29 @@ using namespace xmilib;
 
 namespace {
 
-qint32 constexpr kTextBufferSize = 10;
-///< The size of the buffer that will receive the text resulting from the processing of the key stroke
+
+typedef std::array<bool, InputManager::KeyboardStateSize> VirtualKeySet; ///< Type definition for a set of virtual keys
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keys The virtual keys.
+/// \return The set containing the virtual keys.
+//****************************************************************************************************************************************************
+constexpr VirtualKeySet makeVirtualKeySet(std::initializer_list<quint32> keys) {
+    VirtualKeySet result {};
+    for (quint32 const key: keys)
+        result[key] = true;
+    return result;
+}
+
+
+std::array<quint8, 12> constexpr kModifierVirtualKeys = {
+    VK_SHIFT, VK_LSHIFT, VK_RSHIFT, VK_CONTROL, VK_LCONTROL,
+    VK_RCONTROL, VK_MENU, VK_LMENU, VK_RMENU, VK_RWIN, VK_LWIN, VK_CAPITAL
+}; ///< The virtual keys whose state is required to process key strokes
+VirtualKeySet constexpr kComboBreakerVirtualKeys = makeVirtualKeySet({
+    VK_UP, VK_RIGHT, VK_DOWN, VK_LEFT, VK_PRIOR, VK_NEXT, VK_HOME, VK_END, VK_INSERT, VK_DELETE
+}); ///< The virtual keys that break combos without being processed
 
 
 //****************************************************************************************************************************************************
@@ -45,64 +67,57 @@ bool getForegroundWindowInputLocale(HKL &outHkl) {
 
 
 //****************************************************************************************************************************************************
-/// \brief Check if a keystroke is the manual substitution shortcut.
-///
-/// \return true if and only if keystroke correspond to the shortcut.
-//****************************************************************************************************************************************************
-bool isComboTriggerShortcut(SpShortcut const &shortcut) {
-    SpShortcut const comboTriggerShortcut = PreferencesManager::instance().comboTriggerShortcut();
-    return shortcut && comboTriggerShortcut && (*shortcut == *comboTriggerShortcut);
-}
-
-
-//****************************************************************************************************************************************************
-/// \brief Check if a shortcut is the enable/disable shortcut.
-///
-/// \return true if and only if keystroke correspond to the shortcut
+/// \param[in] keyStroke The key stroke.
+/// \param[in] vkCode The virtual key code.
+/// \return true if the key was pressed when the keystroke occurred.
 //****************************************************************************************************************************************************
-bool isAppEnableDisableShortcut(SpShortcut const &shortcut) {
-    SpShortcut const appEnableDisableShortcut = PreferencesManager::instance().appEnableDisableShortcut();
-    return shortcut && appEnableDisableShortcut && (*shortcut == *appEnableDisableShortcut);
+bool isKeyPressed(InputManager::KeyStroke const &keyStroke, quint8 vkCode) {
+    return keyStroke.keyboardState[vkCode] & 0x80;
 }
 
 
 //****************************************************************************************************************************************************
-/// \param[in] vkCode The virtual key code.
-/// \return true if the key is currently pressed.
+/// \param[in] key The key.
+/// \return true if and only if the key is a modifier key.
 //****************************************************************************************************************************************************
-bool isKeyPressed(quint16 vkCode) {
-    return GetKeyState(vkCode) & 0x80;
+bool isModifierKey(Qt::Key key) {
+    switch (key) {
+    case Qt::Key_Shift:
+    case Qt::Key_Control:
+    case Qt::Key_Meta:
+    case Qt::Key_Alt:
+    case Qt::Key_CapsLock:
+        return true;
+    default:
+        return false;
+    }
 }
 
 
 //****************************************************************************************************************************************************
-/// \param[in] keyEvent The Windows-specific key event.
-/// \return A null shortcut if the event is produce by a modifier key
-/// \return The shortcut.
+/// \param[in] keyStroke The key stroke.
+/// \param[out] outKeyCombination If the function returns true, the key combination for the key stroke. Otherwise the
+/// value of this variable is undetermined on exit.
+/// \return false if the key stroke is produced by a modifier key, or if no modifier other than shift is pressed.
 //****************************************************************************************************************************************************
-SpShortcut shortcutFromWindowsKeyEvent(KBDLLHOOKSTRUCT const *keyEvent) {
-    if (!keyEvent)
-        return nullptr;
+bool keyCombinationFromKeyStroke(InputManager::KeyStroke const &keyStroke, QKeyCombination &outKeyCombination) {
     Qt::KeyboardModifiers mods = Qt::NoModifier;
-    if (isKeyPressed(VK_SHIFT) || isKeyPressed(VK_LSHIFT) || isKeyPressed(VK_RSHIFT))
+    if (isKeyPressed(keyStroke, VK_SHIFT) || isKeyPressed(keyStroke, VK_LSHIFT) || isKeyPressed(keyStroke, VK_RSHIFT))
         mods |= Qt::ShiftModifier;
-    if (isKeyPressed(VK_CONTROL) || isKeyPressed(VK_LCONTROL) || isKeyPressed(VK_RCONTROL))
+    if (isKeyPressed(keyStroke, VK_CONTROL) || isKeyPressed(keyStroke, VK_LCONTROL) || isKeyPressed(keyStroke, VK_RCONTROL))
         mods |= Qt::ControlModifier;
-    if (isKeyPressed(VK_MENU) || isKeyPressed(VK_LMENU) || isKeyPressed(VK_RMENU))
+    if (isKeyPressed(keyStroke, VK_MENU) || isKeyPressed(keyStroke, VK_LMENU) || isKeyPressed(keyStroke, VK_RMENU))
         mods |= Qt::AltModifier;
-    if (isKeyPressed(VK_RWIN) || isKeyPressed(VK_LWIN))
+    if (isKeyPressed(keyStroke, VK_RWIN) || isKeyPressed(keyStroke, VK_LWIN))
         mods |= Qt::MetaModifier;
     if (!((mods & Qt::ControlModifier) || (mods & Qt::AltModifier) || (mods & Qt::MetaModifier)))
-        return nullptr;
+        return false;
 
-    Qt::Key const key = KeyboardMapper::instance().virtualKeyCodeToQtKey(keyEvent->vkCode);
-    if (key == Qt::Key_unknown)
-        return nullptr;
-    QList<Qt::Key> const modKeys = { Qt::Key_Shift, Qt::Key_Control, Qt::Key_Meta, Qt::Key_Alt, Qt::Key_CapsLock };
-    for (Qt::Key const modKey: modKeys)
-        if (key == modKey)
-            return nullptr;
-    return Shortcut::fromModifiersAndKey(mods, key);
+    Qt::Key const key = KeyboardMapper::instance().virtualKeyCodeToQtKey(keyStroke.virtualKey);
+    if ((key == Qt::Key_unknown) || isModifierKey(key))
+        return false;
+    outKeyCombination = QKeyCombination(mods, key);
+    return true;
 }
 
 
@@ -110,48 +125,30 @@ SpShortcut shortcutFromWindowsKeyEvent(KBDLLHOOKSTRUCT const *keyEvent) {
 
 
 //****************************************************************************************************************************************************
-/// This static member function is registered to be called whenever a key event occurs.
+/// This static member function is registered to be called whenever a key event occurs. Once the foreground
+/// application is known, the processing of a key event does not allocate memory: key tables are constant, and the text
+/// resulting from the key stroke is stored in a buffer on the stack.
+///
+/// The duration of each call is measured, because Windows silently removes the hook if the callback is too slow. In
+/// degraded mode, the callback only defers the key stroke, and the duration of its deferred processing is measured
+/// instead, so that the monitor can tell when processing in the hook is fast enough again.
 /// 
 /// \param[in] nCode A code the hook procedure uses to determine how to process the message
 /// \param[in] wParam The identifier of the keyboard message
 /// \param[in] lParam A pointer to a KBDLLHOOKSTRUCT structure.
 //****************************************************************************************************************************************************
 LRESULT CALLBACK InputManager::keyboardProcedure(int nCode, WPARAM wParam, LPARAM lParam) {
-    static ProcessListManager const &processListManager = globals::excludedApplications();
-    if (processListManager.filter(getActiveExecutableFileName()))
-        return CallNextHookEx(nullptr, nCode, wParam, lParam); // The active app is listed as excluded
-
-    if ((WM_KEYDOWN != wParam) && (WM_SYSKEYDOWN != wParam))
-        return CallNextHookEx(nullptr, nCode, wParam, lParam);
-    KeyStroke keyStroke = { 0, 0, { 0 }};
-    KBDLLHOOKSTRUCT const *keyEvent = reinterpret_cast<KBDLLHOOKSTRUCT *>(lParam); // NOLINT(performance-no-int-to-ptr)
-    if (!keyEvent)
-        return CallNextHookEx(nullptr, nCode, wParam, lParam);
-    SpShortcut const shortcut = shortcutFromWindowsKeyEvent(keyEvent);
-    if (shortcut && shortcut->isValid())
-        emit instance().shortcutPressed(shortcut); // note that we do not return here, as some combination (e.g. Ctrl+Alt+5 or AltGr+5) may actually lead to some text
-
-    if (!PreferencesManager::instance().beeftextEnabled())
-        return CallNextHookEx(nullptr, nCode, wParam, lParam);
-
-    // we ignore shift / caps lock key events
-    if ((keyEvent->vkCode == VK_LSHIFT) || (keyEvent->vkCode == VK_RSHIFT) || (keyEvent->vkCode == VK_CAPITAL))
-        return CallNextHookEx(nullptr, nCode, wParam, lParam);
-    keyStroke.virtualKey = keyEvent->vkCode;
-    keyStroke.scanCode = keyEvent->scanCode;
-    // GetKeyboardState() do not properly report state for modifier keys if the key event in a window other that one
-    // from the current process, so we need to manually fetch the valid states manually using GetKeyState()
-    // We do not actually need the state of the other key, so we do not event bother calling GetKeyboardState()
-    QList<quint32> keyList = {
-        VK_SHIFT, VK_LSHIFT, VK_RSHIFT, VK_CONTROL, VK_LCONTROL,
-        VK_RCONTROL, VK_MENU, VK_LMENU, VK_RMENU, VK_RWIN, VK_LWIN, VK_CAPITAL
-    };
-    for (quint32 const key: keyList)
-        keyStroke.keyboardState[key] = static_cast<quint8>(GetKeyState(static_cast<quint16>(key)));
+    QElapsedTimer timer;
+    timer.start();
+    InputManager &inputManager = instance();
+    bool const isDegraded = inputManager.hookLatencyMonitor_.isDegraded();
+    bool const passToNextHook = inputManager.onKeyboardHookEvent(wParam, reinterpret_cast<KBDLLHOOKSTRUCT const *>(lParam)); // NOLINT(performance-no-int-to-ptr)
+    if (!isDegraded)
+        inputManager.recordHookLatency(timer.nsecsElapsed() / 1000);
 
     // our event handler will return false if we want to 'intercept' the keystroke and not pass it to the next hook,
     // but the MSDN documentation says we MUST do it if nCode < 0
-    if ((!instance().onKeyboardEvent(keyStroke)) && (nCode >= 0))
+    if ((!passToNextHook) && (nCode >= 0))
         return 0;
     return CallNextHookEx(nullptr, nCode, wParam, lParam);
 }
@@ -186,24 +183,46 @@ InputManager &InputManager::instance() {
 
 
 //****************************************************************************************************************************************************
-/// \
+/// \brief A shortcut object is only allocated and sent through the shortcutPressed() signal if the signal is
+/// connected, i.e. when a shortcut dialog is open. The action for the shortcut is retrieved using a single lookup in
+/// the table of shortcut actions.
+///
+/// \param[in] keyCombination The key combination.
 //****************************************************************************************************************************************************
-void InputManager::onShortcut(SpShortcut const &shortcut) {
-    if ((!shortcut) || (!isShortcutProcessingEnabled_))
+void InputManager::onShortcut(QKeyCombination const &keyCombination) {
+    static QMetaMethod const shortcutPressedSignal = QMetaMethod::fromSignal(&InputManager::shortcutPressed);
+    if (this->isSignalConnected(shortcutPressedSignal))
+        emit shortcutPressed(Shortcut::fromKeyCombination(keyCombination));
+
+    if (!isShortcutProcessingEnabled_)
         return;
-    PreferencesManager const &prefs = PreferencesManager::instance();
-    if (prefs.enableAppEnableDisableShortcut() && isAppEnableDisableShortcut(shortcut)) {
-        emit appEnableDisableShortcutTriggered();
+    QHash<qint32, EShortcutAction>::const_iterator const it = shortcutActions_.constFind(keyCombination.toCombined());
+    if (it == shortcutActions_.constEnd())
         return;
+    switch (it.value()) {
+    case EShortcutAction::AppEnableDisable:
+        emit appEnableDisableShortcutTriggered();
+        break;
+    case EShortcutAction::ComboTrigger:
+        if (PreferencesManager::instance().beeftextEnabled())
+            emit substitutionShortcutTriggered();
+        break;
     }
+}
 
-    if (!prefs.beeftextEnabled())
-        return;
 
-    if ((!prefs.useAutomaticSubstitution()) && isComboTriggerShortcut(shortcut)) {
-        emit substitutionShortcutTriggered();
-        return;
-    }
+//****************************************************************************************************************************************************
+/// \brief The combo picker shortcut is not part of the table, as it is registered as a system-wide hot key.
+//****************************************************************************************************************************************************
+void InputManager::updateShortcutActions() {
+    PreferencesManager const &prefs = PreferencesManager::instance();
+    shortcutActions_.clear();
+    SpShortcut const comboTriggerShortcut = prefs.comboTriggerShortcut();
+    if ((!prefs.useAutomaticSubstitution()) && comboTriggerShortcut)
+        shortcutActions_.insert(comboTriggerShortcut->toCombined(), EShortcutAction::ComboTrigger);
+    SpShortcut const appEnableDisableShortcut = prefs.appEnableDisableShortcut();
+    if (prefs.enableAppEnableDisableShortcut() && appEnableDisableShortcut) // takes precedence over the combo trigger shortcut
+        shortcutActions_.insert(appEnableDisableShortcut->toCombined(), EShortcutAction::AppEnableDisable);
 }
 
 
@@ -212,13 +231,20 @@ void InputManager::onShortcut(SpShortcut const &shortcut) {
 //****************************************************************************************************************************************************
 InputManager::InputManager()
     : QObject(nullptr), useLegacyKeyProcessing_(!isAppRunningOnWindows10OrHigher()) {
+    // the legacy processing restores the dead key state of the keyboard with ToUnicode(), which is only valid in the
+    // keyboard hook, before the key stroke reaches the application, so it cannot be deferred
+    hookLatencyMonitor_.setDegradationEnabled(!useLegacyKeyProcessing_);
+    this->updateShortcutActions();
+    connect(&PreferencesManager::instance(), &PreferencesManager::shortcutPreferencesChanged, this,
+        &InputManager::updateShortcutActions);
+#ifndef BEEFTEXT_BENCHMARK // the benchmarks replay recorded keystrokes, and must not capture the input of the user
     this->enableKeyboardHook();
-    connect(this, &InputManager::shortcutPressed, this, &InputManager::onShortcut);
 #ifdef NDEBUG
     // to avoid being locked with all input unresponsive when in debug (because one forgot that breakpoints should be
     // avoided, for instance), we only enable the low level mouse hook in release configuration
     this->enableMouseHook();
 #endif
+#endif // #ifndef BEEFTEXT_BENCHMARK
 }
 
 
@@ -231,6 +257,118 @@ InputManager::~InputManager() {
 }
 
 
+//****************************************************************************************************************************************************
+/// \brief When the keyboard hook callback has become too slow, the monitor is in degraded mode, and the hook only
+/// captures the key stroke and defers its processing.
+///
+/// \param[in] wParam The identifier of the keyboard message
+/// \param[in] keyEvent The Windows-specific key event.
+/// \return true if the event can be passed down to the keyboard hooked chain, and false it it should be removed
+//****************************************************************************************************************************************************
+bool InputManager::onKeyboardHookEvent(WPARAM wParam, KBDLLHOOKSTRUCT const *keyEvent) {
+    if (((WM_KEYDOWN != wParam) && (WM_SYSKEYDOWN != wParam)) || (!keyEvent))
+        return true;
+    KeyStroke keyStroke = { keyEvent->vkCode, keyEvent->scanCode, { 0 }};
+    // GetKeyboardState() do not properly report state for modifier keys if the key event in a window other that one
+    // from the current process, so we need to manually fetch the valid states manually using GetKeyState()
+    // We do not actually need the state of the other key, so we do not event bother calling GetKeyboardState()
+    for (quint8 const key: kModifierVirtualKeys)
+        keyStroke.keyboardState[key] = static_cast<quint8>(GetKeyState(key));
+
+    if (hookLatencyMonitor_.isDegraded()) {
+        this->deferKeyStroke(keyStroke);
+        return true;
+    }
+    return this->processKeyStroke(keyStroke);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Once the foreground application is known, the function does not allocate memory. This is checked by the
+/// hook allocation test, which replays recorded key strokes through it.
+///
+/// \param[in] keyStroke The key stroke
+/// \return true if the event can be passed down to the keyboard hooked chain, and false it it should be removed
+//****************************************************************************************************************************************************
+bool InputManager::processKeyStroke(KeyStroke const &keyStroke) {
+    static ProcessListManager const &processListManager = globals::excludedApplications();
+    static ForegroundApplicationTracker &foregroundApplication = ForegroundApplicationTracker::instance();
+    if (processListManager.filter(foregroundApplication.executableFileName())) // the name is only retrieved when the foreground window changes
+        return true; // The active app is listed as excluded
+
+    QKeyCombination keyCombination;
+    if (keyCombinationFromKeyStroke(keyStroke, keyCombination) && Shortcut::isValidKeyCombination(keyCombination))
+        this->onShortcut(keyCombination); // note that we do not return here, as some combination (e.g. Ctrl+Alt+5 or AltGr+5) may actually lead to some text
+
+    if (!PreferencesManager::instance().beeftextEnabled())
+        return true;
+
+    // we ignore shift / caps lock key events
+    if ((keyStroke.virtualKey == VK_LSHIFT) || (keyStroke.virtualKey == VK_RSHIFT) || (keyStroke.virtualKey == VK_CAPITAL))
+        return true;
+    return this->onKeyboardEvent(keyStroke);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The key stroke is processed by the event loop after the keyboard hook has returned. As a consequence, it
+/// cannot be removed from the keyboard hook chain.
+///
+/// \param[in] keyStroke The key stroke
+//****************************************************************************************************************************************************
+void InputManager::deferKeyStroke(KeyStroke const &keyStroke) {
+    if (deferredKeyStrokeCount_ >= DeferredKeyStrokeCapacity) {
+        deferredKeyStrokesOverflowed_ = true;
+        return;
+    }
+    deferredKeyStrokes_[deferredKeyStrokeCount_++] = keyStroke;
+    if (deferredProcessingIsScheduled_)
+        return;
+    deferredProcessingIsScheduled_ = true;
+    QMetaObject::invokeMethod(this, &InputManager::processDeferredKeyStrokes, Qt::QueuedConnection);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The duration of the processing of each key stroke is recorded by the hook latency monitor, as it is the
+/// duration the keyboard hook callback would have if the key stroke had not been deferred.
+//****************************************************************************************************************************************************
+void InputManager::processDeferredKeyStrokes() {
+    deferredProcessingIsScheduled_ = false;
+    if (deferredKeyStrokesOverflowed_) {
+        deferredKeyStrokesOverflowed_ = false;
+        this->pushKeystrokeEvent(EKeystrokeEventType::ComboBreaker);
+    }
+    QElapsedTimer timer;
+    for (qint32 i = 0; i < deferredKeyStrokeCount_; ++i) { // key strokes deferred during processing are processed too
+        KeyStroke const keyStroke = deferredKeyStrokes_[i];
+        timer.start();
+        this->processKeyStroke(keyStroke);
+        this->recordHookLatency(timer.nsecsElapsed() / 1000);
+    }
+    deferredKeyStrokeCount_ = 0;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note When the monitor enters or leaves degraded mode, the hookLatencyModeChanged() signal is emitted from the
+/// keyboard hook, so receivers must use a queued connection.
+///
+/// \param[in] durationUs The duration of the call, in microseconds.
+//****************************************************************************************************************************************************
+void InputManager::recordHookLatency(qint64 durationUs) {
+    if (!hookLatencyMonitor_.addSample(durationUs))
+        return;
+    emit hookLatencyModeChanged(hookLatencyMonitor_.isDegraded());
+    if (hookLatencyMonitor_.isDegraded())
+        globals::debugLog().addWarning(QString("The keyboard hook callback is too slow (%1). Key strokes are now "
+            "processed outside of the keyboard hook.").arg(hookLatencyMonitor_.summary()));
+    else
+        globals::debugLog().addInfo(QString("The processing of key strokes is fast enough again (%1). Key strokes are "
+            "now processed in the keyboard hook.").arg(hookLatencyMonitor_.summary()));
+}
+
+
 //****************************************************************************************************************************************************
 /// \param[in] keyStroke The key stroke
 /// \return true if the event can be passed down to the keyboard hooked chain, and false it it should be removed
@@ -239,38 +377,36 @@ bool InputManager::onKeyboardEvent(KeyStroke const &keyStroke) {
     // on some layout (e.g. US International, direction key + alt lead to garbage char if ToUnicode is pressed, so
     // we bypass normal processing for those keys(note this is different for the dead key issue described in
     // processKey().
-    QList<quint32> const breakers = {
-        VK_UP, VK_RIGHT, VK_DOWN, VK_LEFT, VK_PRIOR, VK_NEXT, VK_HOME, VK_END, VK_INSERT,
-        VK_DELETE
-    };
-    if (breakers.contains(keyStroke.virtualKey)) {
-        emit comboBreakerTyped();
+    if ((keyStroke.virtualKey < KeyboardStateSize) && kComboBreakerVirtualKeys[keyStroke.virtualKey]) {
+        this->pushKeystrokeEvent(EKeystrokeEventType::ComboBreaker);
         return true;
     }
 
     bool isDeadKey = false;
-    QString text = this->processKey(keyStroke, isDeadKey);
-    if (text.isEmpty())
+    KeyTextBuffer text;
+    qint32 const size = this->processKey(keyStroke, text, isDeadKey);
+    if (size <= 0)
         return true;
 
     PreferencesManager const &prefs = PreferencesManager::instance();
-    for (QChar c: text) {
+    for (qint32 i = 0; i < size; ++i) {
+        QChar const c(static_cast<char16_t>(text[i]));
         if (QChar('\b') == c) {
-            emit backspaceTyped();
+            this->pushKeystrokeEvent(EKeystrokeEventType::Backspace);
             continue;
         }
         if (!c.isPrint()) {
-            emit comboBreakerTyped();
+            this->pushKeystrokeEvent(EKeystrokeEventType::ComboBreaker);
             continue;
         }
         if (c.isSpace()) {
             if (prefs.comboTriggersOnSpace() && prefs.useAutomaticSubstitution())
-                emit characterTyped(c);
+                this->pushKeystrokeEvent(EKeystrokeEventType::Character, c);
             else
-                emit comboBreakerTyped();
+                this->pushKeystrokeEvent(EKeystrokeEventType::ComboBreaker);
             continue;
         }
-        emit characterTyped(c);
+        this->pushKeystrokeEvent(EKeystrokeEventType::Character, c);
     }
     return true;
 }
@@ -278,72 +414,74 @@ bool InputManager::onKeyboardEvent(KeyStroke const &keyStroke) {
 
 //****************************************************************************************************************************************************
 /// \param[in] keyStroke The key stroke
+/// \param[out] outText The buffer receiving the text resulting of the keystroke
 /// \param[out] outIsDeadKey Is the key a dead key
-/// \return The text resulting of the keystroke
+/// \return The number of characters in the text resulting of the keystroke
 //****************************************************************************************************************************************************
-QString InputManager::processKey(KeyStroke const &keyStroke, bool &outIsDeadKey) {
+qint32 InputManager::processKey(KeyStroke const &keyStroke, KeyTextBuffer &outText, bool &outIsDeadKey) {
     // Windows version before Windows 10 build 1607, there is not option to ensure that ToUnicode() / ToUnicodeEx does
     // not modify the keyboard state, which forces us to perform a special treatment for dead keys.
-    return useLegacyKeyProcessing_ ? processKeyLegacy(keyStroke, outIsDeadKey) : processKeyModern(keyStroke);
+    return useLegacyKeyProcessing_ ? processKeyLegacy(keyStroke, outText, outIsDeadKey) : processKeyModern(keyStroke, outText);
 }
 
 
 //****************************************************************************************************************************************************
 /// \param[in] keyStroke The key stroke
-/// \return The text resulting of the keystroke
+/// \param[out] outText The buffer receiving the text resulting of the keystroke
+/// \return The number of characters in the text resulting of the keystroke
 //****************************************************************************************************************************************************
-QString InputManager::processKeyModern(KeyStroke const &keyStroke) {
+qint32 InputManager::processKeyModern(KeyStroke const &keyStroke, KeyTextBuffer &outText) {
     // Windows allow each window to have its own input locale, so we try to obtain the locale (HKL) of the active window
     // and pass it to ToUnicodeEx(). If we fail to do so we call ToUnicode instead, which use the system-wide locale
-    WCHAR textBuffer[kTextBufferSize];
     HKL hkl = nullptr;
     qint32 const size = getForegroundWindowInputLocale(hkl)
-                        ? ToUnicodeEx(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer, kTextBufferSize
-            , 1 << 2, hkl) : ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer
-            , kTextBufferSize, 1 << 2);
-    return size > 0 ? QString::fromWCharArray(textBuffer, size) : QString();
+                        ? ToUnicodeEx(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, outText.data(), KeyTextBufferSize
+            , 1 << 2, hkl) : ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, outText.data()
+            , KeyTextBufferSize, 1 << 2);
+    return qMax(size, 0);
 }
 
 
 //****************************************************************************************************************************************************
 /// \param[in] keyStroke The key stroke
+/// \param[out] outText The buffer receiving the text resulting of the keystroke
 /// \param[out] outIsDeadKey Is the key a dead key
-/// \return The text resulting of the keystroke
+/// \return The number of characters in the text resulting of the keystroke
 //****************************************************************************************************************************************************
-QString InputManager::processKeyLegacy(KeyStroke const &keyStroke, bool &outIsDeadKey) {
+qint32 InputManager::processKeyLegacy(KeyStroke const &keyStroke, KeyTextBuffer &outText, bool &outIsDeadKey) {
     // The core of this function is the call to ToUnicodeEx() - or ToUnicode() - who transforms a keystroke into
     // an actual text output, taking into account the current input locale (a.k.a. keyboard layout).
     // now the tricky part: ToUnicode() "consumes" the dead key that may be stored in the kernel-mode keyboard buffer
     // so we need to manually restore the dead key by calling ToUnicode() again
-    WCHAR textBuffer[kTextBufferSize] = { 0 };
+    outText.fill(0);
     outIsDeadKey = false;
     // for some unkown reasons, in this legacy code ToUnicodeEx cause failures with dead keys in some locales.
-    qint32 const size = ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer, kTextBufferSize, 0);
+    qint32 const size = ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, outText.data(), KeyTextBufferSize, 0);
 
     if (-1 == size) {
         // the key is a dead key. We have consumed it so we need to:
         // 1 - Restore it by repeating the call to ToUnicode()
         // 2 - Save the key because we will need to apply it again before the next 'normal' keystroke
-        ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer, kTextBufferSize, 0);
+        ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, outText.data(), KeyTextBufferSize, 0);
         deadKey_ = keyStroke;
         outIsDeadKey = true;
-        return QString();
+        return 0;
     }
 
     if (size > 0) {
         // The key is a normal key that will result in text output.
         // if the previous key was a dead key, we have already consumed the dead key so we must restore it
-        QString result = QString::fromWCharArray(textBuffer, size);
         if (0 != deadKey_.virtualKey) {
-            ToUnicode(deadKey_.virtualKey, deadKey_.scanCode, deadKey_.keyboardState, textBuffer, kTextBufferSize, 0);
+            KeyTextBuffer deadKeyText; // the result of the call is discarded, so we must not overwrite the output text
+            ToUnicode(deadKey_.virtualKey, deadKey_.scanCode, deadKey_.keyboardState, deadKeyText.data(), KeyTextBufferSize, 0);
             deadKey_.virtualKey = 0;
         }
-        return result;
+        return size;
     }
 
     // final case: size is 0, the key is a modifier, we do nothing
     // values of size < -1 also lead here but should not happen according to the documentation for ToUnicode()
-    return QString();
+    return 0;
 }
 
 
@@ -351,7 +489,7 @@ QString InputManager::processKeyLegacy(KeyStroke const &keyStroke, bool &outIsDe
 // 
 //****************************************************************************************************************************************************
 void InputManager::onMouseClickEvent(int, WPARAM, LPARAM) {
-    emit comboBreakerTyped();
+    this->pushKeystrokeEvent(EKeystrokeEventType::ComboBreaker);
 }
 
 
@@ -417,6 +555,70 @@ bool InputManager::isShortcutProcessingEnabled() const {
 }
 
 
+//****************************************************************************************************************************************************
+/// \return A reference to the queue of keystroke events.
+//****************************************************************************************************************************************************
+KeystrokeQueue &InputManager::keystrokeQueue() {
+    return keystrokeQueue_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The keyboard and mouse hooks run in the main thread, which is therefore the only producer for the queue.
+///
+/// \param[in] type The type of event.
+/// \param[in] c The typed character, for events of type EKeystrokeEventType::Character.
+//****************************************************************************************************************************************************
+void InputManager::pushKeystrokeEvent(EKeystrokeEventType type, QChar c) {
+    PreferencesManager const &prefs = PreferencesManager::instance();
+    KeystrokeEvent event;
+    event.type = type;
+    event.character = c;
+    event.useAutomaticSubstitution = prefs.useAutomaticSubstitution();
+    event.comboTriggersOnSpace = prefs.comboTriggersOnSpace();
+    keystrokeQueue_.push(event);
+    if (recording_)
+        recording_->push_back(event);
+}
+
+
+//****************************************************************************************************************************************************
+/// \note Recording allocates memory in the keyboard hook callback, and should only be enabled to capture keystroke
+/// streams for later replay (see KeystrokeReplayer). The caller keeps ownership of the recording.
+///
+/// \param[in] recording The recording. If null, recording is disabled.
+//****************************************************************************************************************************************************
+void InputManager::setKeystrokeRecording(KeystrokeRecording *recording) {
+    recording_ = recording;
+}
+
+
+//****************************************************************************************************************************************************
+/// \note The keyboard hook is disabled during the replay, so that the main thread remains the only producer for the
+/// keystroke queue and the input of the user is not mixed with the replayed events. The combo matcher thread must be
+/// running.
+///
+/// \param[in] source The keystroke source.
+/// \param[in] batchSize The number of events pushed between two synchronizations with the combo matcher thread (see
+/// feedKeystrokeQueue()).
+/// \return The number of events pushed in the queue.
+//****************************************************************************************************************************************************
+qint64 InputManager::replay(KeystrokeSource &source, qint32 batchSize) {
+    bool const wasKeyboardHookEnabled = this->setKeyboardHookEnabled(false);
+    qint64 const result = feedKeystrokeQueue(source, keystrokeQueue_, batchSize);
+    this->setKeyboardHookEnabled(wasKeyboardHookEnabled);
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return A reference to the monitor for the duration of the keyboard hook callback.
+//****************************************************************************************************************************************************
+HookLatencyMonitor const &InputManager::hookLatencyMonitor() const {
+    return hookLatencyMonitor_;
+}
+
+
 //****************************************************************************************************************************************************
 /// \return true if and only if the mouse hook is enabled
 //****************************************************************************************************************************************************
@@ -12,6 +12,8 @@
 
 
 #include "Shortcut.h"
+#include "KeystrokeSource.h"
+#include "HookLatencyMonitor.h"
 
 
 //****************************************************************************************************************************************************
@@ -22,12 +24,15 @@ Q_OBJECT
 public: // data types
     enum {
         KeyboardStateSize = 256, ///< The size of the keyboard state array
+        KeyTextBufferSize = 10, ///< The size of the buffer that receives the text resulting from the processing of a key stroke
+        DeferredKeyStrokeCapacity = 64, ///< The maximum number of key strokes waiting to be processed outside of the keyboard hook
     };
     struct KeyStroke {
         quint32 virtualKey; ///< The virtual keyCode
         quint32 scanCode; ///< The scanCode
         quint8 keyboardState[KeyboardStateSize]; ///< The state of the keyboard at the moment the keystroke occurred
     };
+    typedef std::array<WCHAR, KeyTextBufferSize> KeyTextBuffer; ///< Type definition for the buffer receiving the text resulting from a key stroke
 public: // static member functions
     static InputManager &instance(); ///< Return the only allowed instance of the class
 
@@ -40,25 +45,40 @@ public: // member functions
     bool setKeyboardHookEnabled(bool enabled); ///< Enable or disable the keyboard hook
     void setShortcutsProcessingEnabled(bool enabled); ///< Enable disable shortcuts.
     bool isShortcutProcessingEnabled() const; ///< Check whether shortcut processing is enabled.
+    KeystrokeQueue &keystrokeQueue(); ///< Return a reference to the queue of keystroke events
+    void pushKeystrokeEvent(EKeystrokeEventType type, QChar c = QChar()); ///< Push an event in the keystroke queue. Must be called from the main thread
+    void setKeystrokeRecording(KeystrokeRecording *recording); ///< Set the recording receiving a copy of the events pushed in the keystroke queue
+    qint64 replay(KeystrokeSource &source, qint32 batchSize = 1); ///< Push the events of a keystroke source in the keystroke queue. Must be called from the main thread
+    HookLatencyMonitor const &hookLatencyMonitor() const; ///< Return a reference to the monitor for the duration of the keyboard hook callback
+    bool processKeyStroke(KeyStroke const &keyStroke); ///< Process a key stroke. Must be called from the main thread
 
 signals:
     void shortcutPressed(SpShortcut const &shortcut); ///< shortcut for the typing of a key combination.
-    void comboBreakerTyped(); ///< Signal for combo breaking events
-    void characterTyped(QChar c); ///< Signal for character typed
-    void backspaceTyped(); ///< Signal for backspace typed
     void substitutionShortcutTriggered();  ///< Signal emitted when the manual substitution shortcut is triggered
     void comboMenuShortcutTriggered(); ///< Signal emitted when the combo menu shortcut is triggered.
     void appEnableDisableShortcutTriggered(); ///< Signal emitted when the app enable/disable shortcut has been triggered.
+    void hookLatencyModeChanged(bool degraded); ///< Signal emitted from the keyboard hook when the hook latency monitor enters or leaves degraded mode. Connect using a queued connection
+
+private: // data types
+    enum class EShortcutAction {
+        ComboTrigger, ///< The manual substitution shortcut
+        AppEnableDisable, ///< The app enable/disable shortcut
+    }; ///< Enumeration for the actions that can be triggered by a shortcut
 
 private slots:
-    void onShortcut(SpShortcut const &shortcut); ///< Slot for shortcuts
+    void updateShortcutActions(); ///< Rebuild the table of shortcut actions from the preferences
+    void processDeferredKeyStrokes(); ///< Process the key strokes that were deferred by the keyboard hook
 
 private: // member functions
     InputManager(); ///< Default constructor
+    void onShortcut(QKeyCombination const &keyCombination); ///< Process a key combination that may be a shortcut
+    bool onKeyboardHookEvent(WPARAM wParam, KBDLLHOOKSTRUCT const *keyEvent); ///< Process an event received by the keyboard hook
+    void deferKeyStroke(KeyStroke const &keyStroke); ///< Defer the processing of a key stroke until the keyboard hook has returned
+    void recordHookLatency(qint64 durationUs); ///< Record the duration of a call to the keyboard hook callback
     bool onKeyboardEvent(KeyStroke const &keyStroke); ///< The callback function called at every key event
-    QString processKey(KeyStroke const &keyStroke, bool &outIsDeadKey); ///< Process a ky stroke and return the generated characters
-    static QString processKeyModern(KeyStroke const &keyStroke); ///< Process a key stroke and return the generated characters
-    QString processKeyLegacy(KeyStroke const &keyStroke, bool &outIsDeadKey); ///< Process a key stroke and return the generated characters
+    qint32 processKey(KeyStroke const &keyStroke, KeyTextBuffer &outText, bool &outIsDeadKey); ///< Process a ky stroke and return the number of generated characters
+    static qint32 processKeyModern(KeyStroke const &keyStroke, KeyTextBuffer &outText); ///< Process a key stroke and return the number of generated characters
+    qint32 processKeyLegacy(KeyStroke const &keyStroke, KeyTextBuffer &outText, bool &outIsDeadKey); ///< Process a key stroke and return the number of generated characters
     void onMouseClickEvent(int, WPARAM, LPARAM); ///< Process a mouse click event
     bool isKeyboardHookEnable() const; ///< Is the keyboard hook enabled
     void enableKeyboardHook(); ///< Enable the keyboard hook
@@ -78,6 +98,14 @@ private: // data members
     KeyStroke deadKey_ = { 0, 0, { 0 }}; ///< The currently active dead key
     bool useLegacyKeyProcessing_ { false }; ///< Should we use the legacy key processing code
     bool isShortcutProcessingEnabled_ { true }; ///< Is shortcut processing enabled?
+    KeystrokeQueue keystrokeQueue_; ///< The queue of keystroke events, consumed by the combo matcher thread
+    QHash<qint32, EShortcutAction> shortcutActions_; ///< The actions triggered by shortcuts, indexed by packed key combination
+    HookLatencyMonitor hookLatencyMonitor_; ///< The monitor for the duration of the keyboard hook callback
+    std::array<KeyStroke, DeferredKeyStrokeCapacity> deferredKeyStrokes_; ///< The key strokes waiting to be processed outside of the keyboard hook
+    qint32 deferredKeyStrokeCount_ { 0 }; ///< The number of key strokes waiting to be processed outside of the keyboard hook
+    bool deferredKeyStrokesOverflowed_ { false }; ///< Were key strokes dropped because too many were waiting to be processed
+    bool deferredProcessingIsScheduled_ { false }; ///< Is the processing of the deferred key strokes scheduled
+    KeystrokeRecording *recording_ { nullptr }; ///< The recording receiving a copy of the events pushed in the keystroke queue, or null
 };
 
 
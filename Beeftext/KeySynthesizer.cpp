@@ -0,0 +1,202 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of key synthesizer classes
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "KeySynthesizer.h"
+#include "MemoryKeySynthesizer.h"
+#ifdef Q_OS_WINDOWS
+#include <XMiLib/SystemUtils.h>
+#endif // #ifdef Q_OS_WINDOWS
+
+
+#ifdef Q_OS_WINDOWS
+static_assert((KeySynthesizer::backspaceKey == VK_BACK) && (KeySynthesizer::returnKey == VK_RETURN)
+    && (KeySynthesizer::shiftKey == VK_SHIFT) && (KeySynthesizer::controlKey == VK_CONTROL)
+    && (KeySynthesizer::leftKey == VK_LEFT) && (KeySynthesizer::insertKey == VK_INSERT)
+    && (KeySynthesizer::leftWindowsKey == VK_LWIN) && (KeySynthesizer::rightWindowsKey == VK_RWIN)
+    && (KeySynthesizer::leftShiftKey == VK_LSHIFT) && (KeySynthesizer::rightShiftKey == VK_RSHIFT)
+    && (KeySynthesizer::leftControlKey == VK_LCONTROL) && (KeySynthesizer::rightControlKey == VK_RCONTROL)
+    && (KeySynthesizer::leftAltKey == VK_LMENU) && (KeySynthesizer::rightAltKey == VK_RMENU),
+    "The virtual key codes of the key synthesizer do not match the Windows API.");
+#endif // #ifdef Q_OS_WINDOWS
+
+
+namespace {
+
+
+KeySynthesizer *currentSynthesizer = nullptr; ///< The key synthesizer set using setInstance(), or null to use the default one
+QList<quint16> const kModifierKeys = { KeySynthesizer::leftControlKey, KeySynthesizer::rightControlKey,
+    KeySynthesizer::leftAltKey, KeySynthesizer::rightAltKey, KeySynthesizer::leftShiftKey, KeySynthesizer::rightShiftKey,
+    KeySynthesizer::leftWindowsKey, KeySynthesizer::rightWindowsKey }; ///< The modifier keys
+
+
+//****************************************************************************************************************************************************
+/// \return The default key synthesizer. On Windows, the input is sent to the system, otherwise it is captured in memory.
+//****************************************************************************************************************************************************
+KeySynthesizer &defaultSynthesizer() {
+#ifdef Q_OS_WINDOWS
+    static WindowsKeySynthesizer synthesizer;
+#else
+    static MemoryKeySynthesizer synthesizer;
+#endif // #ifdef Q_OS_WINDOWS
+    return synthesizer;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \return A reference to the key synthesizer currently in use.
+//****************************************************************************************************************************************************
+KeySynthesizer &KeySynthesizer::instance() {
+    return currentSynthesizer ? *currentSynthesizer : defaultSynthesizer();
+}
+
+
+//****************************************************************************************************************************************************
+/// \note This function must be called from the main thread. The caller keeps ownership of the synthesizer, which
+/// must outlive its use.
+///
+/// \param[in] synthesizer The key synthesizer. If null, the default key synthesizer is used.
+//****************************************************************************************************************************************************
+void KeySynthesizer::setInstance(KeySynthesizer *synthesizer) {
+    currentSynthesizer = synthesizer;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+//****************************************************************************************************************************************************
+void KeySynthesizer::keyDownAndUp(quint16 virtualKey) {
+    this->keyDown(virtualKey);
+    this->keyUp(virtualKey);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The list of modifier keys that were pressed.
+//****************************************************************************************************************************************************
+QList<quint16> KeySynthesizer::releaseModifierKeys() {
+    QList<quint16> result;
+    for (quint16 const key: kModifierKeys)
+        if (this->isKeyPressed(key)) {
+            result.append(key);
+            this->keyUp(key);
+        }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keys The modifier keys.
+//****************************************************************************************************************************************************
+void KeySynthesizer::restoreModifierKeys(QList<quint16> const &keys) {
+    for (quint16 const key: keys)
+        this->keyDown(key);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] count The number of characters to erase.
+//****************************************************************************************************************************************************
+void KeySynthesizer::eraseChars(qint32 count) {
+    QList<quint16> const pressedModifiers = this->releaseModifierKeys();
+    this->backspaces(count);
+    this->restoreModifierKeys(pressedModifiers);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Line feeds are typed using the return key, as unicode key events do not handle them properly (the problem
+/// actually comes from the SendInput() function of the Windows API).
+///
+/// \param[in] text The text.
+/// \param[in] delayMs The delay between two key strokes, in milliseconds.
+//****************************************************************************************************************************************************
+void KeySynthesizer::typeText(QString const &text, qint32 delayMs) {
+    for (QChar const c: text) {
+        QList<quint16> const pressedModifiers = this->releaseModifierKeys();
+        if (c == QChar::LineFeed)
+            this->keyDownAndUp(returnKey);
+        else
+            this->unicodeKeyDownAndUp(c.unicode());
+        this->restoreModifierKeys(pressedModifiers);
+        if (delayMs > 0)
+            QThread::msleep(static_cast<quint32>(delayMs));
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] count The number of characters to move by.
+//****************************************************************************************************************************************************
+void KeySynthesizer::moveCursorLeft(qint32 count) {
+    if (count < 1)
+        return;
+    QList<quint16> const pressedModifiers = this->releaseModifierKeys();
+    for (qint32 i = 0; i < count; ++i)
+        this->keyDownAndUp(leftKey);
+    this->restoreModifierKeys(pressedModifiers);
+}
+
+
+#ifdef Q_OS_WINDOWS
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+/// \return true if and only if the key is currently pressed.
+//****************************************************************************************************************************************************
+bool WindowsKeySynthesizer::isKeyPressed(quint16 virtualKey) const {
+    return GetKeyState(virtualKey) < 0;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+//****************************************************************************************************************************************************
+void WindowsKeySynthesizer::keyDown(quint16 virtualKey) {
+    xmilib::synthesizeKeyDown(virtualKey);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+//****************************************************************************************************************************************************
+void WindowsKeySynthesizer::keyUp(quint16 virtualKey) {
+    xmilib::synthesizeKeyUp(virtualKey);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+//****************************************************************************************************************************************************
+void WindowsKeySynthesizer::keyDownAndUp(quint16 virtualKey) {
+    xmilib::synthesizeKeyDownAndUp(virtualKey);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] c The character.
+//****************************************************************************************************************************************************
+void WindowsKeySynthesizer::unicodeKeyDownAndUp(char16_t c) {
+    xmilib::synthesizeUnicodeKeyDownAndUp(c);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] count The number of backspaces.
+//****************************************************************************************************************************************************
+void WindowsKeySynthesizer::backspaces(qint32 count) {
+    xmilib::synthesizeBackspaces(count);
+}
+
+
+#endif // #ifdef Q_OS_WINDOWS
@@ -0,0 +1,93 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of key synthesizer classes
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_KEY_SYNTHESIZER_H
+#define BEEFTEXT_KEY_SYNTHESIZER_H
+
+
+//****************************************************************************************************************************************************
+/// \brief Abstract interface for the synthesis of keyboard input
+///
+/// Keys are identified by their Windows virtual key code, so that the interface does not depend on the Windows API
+/// and can be replaced by an in-memory implementation (see MemoryKeySynthesizer). All the keyboard input generated
+/// by the application goes through the synthesizer returned by instance().
+///
+/// The sequences of keys used to perform a substitution (erasing the keyword, typing the snippet, moving the cursor)
+/// are built by the non-virtual member functions of the class, so that they are the same for every implementation.
+//****************************************************************************************************************************************************
+class KeySynthesizer {
+public: // static data members
+    static quint16 constexpr backspaceKey = 0x08; ///< The virtual key code for backspace (VK_BACK)
+    static quint16 constexpr returnKey = 0x0d; ///< The virtual key code for return (VK_RETURN)
+    static quint16 constexpr shiftKey = 0x10; ///< The virtual key code for shift (VK_SHIFT)
+    static quint16 constexpr controlKey = 0x11; ///< The virtual key code for control (VK_CONTROL)
+    static quint16 constexpr leftKey = 0x25; ///< The virtual key code for the left arrow key (VK_LEFT)
+    static quint16 constexpr insertKey = 0x2d; ///< The virtual key code for insert (VK_INSERT)
+    static quint16 constexpr vKey = 0x56; ///< The virtual key code for the V key
+    static quint16 constexpr leftWindowsKey = 0x5b; ///< The virtual key code for the left Windows key (VK_LWIN)
+    static quint16 constexpr rightWindowsKey = 0x5c; ///< The virtual key code for the right Windows key (VK_RWIN)
+    static quint16 constexpr leftShiftKey = 0xa0; ///< The virtual key code for left shift (VK_LSHIFT)
+    static quint16 constexpr rightShiftKey = 0xa1; ///< The virtual key code for right shift (VK_RSHIFT)
+    static quint16 constexpr leftControlKey = 0xa2; ///< The virtual key code for left control (VK_LCONTROL)
+    static quint16 constexpr rightControlKey = 0xa3; ///< The virtual key code for right control (VK_RCONTROL)
+    static quint16 constexpr leftAltKey = 0xa4; ///< The virtual key code for left alt (VK_LMENU)
+    static quint16 constexpr rightAltKey = 0xa5; ///< The virtual key code for right alt (VK_RMENU)
+
+public: // static member functions
+    static KeySynthesizer &instance(); ///< Return the key synthesizer currently in use
+    static void setInstance(KeySynthesizer *synthesizer); ///< Set the key synthesizer to use
+
+public: // member functions
+    KeySynthesizer() = default; ///< Default constructor
+    KeySynthesizer(KeySynthesizer const &) = delete; ///< Disabled copy constructor
+    KeySynthesizer(KeySynthesizer &&) = delete; ///< Disabled move constructor
+    virtual ~KeySynthesizer() = default; ///< Default destructor
+    KeySynthesizer &operator=(KeySynthesizer const &) = delete; ///< Disabled assignment operator
+    KeySynthesizer &operator=(KeySynthesizer &&) = delete; ///< Disabled move assignment operator
+    virtual bool isKeyPressed(quint16 virtualKey) const = 0; ///< Check whether a key is currently pressed
+    virtual void keyDown(quint16 virtualKey) = 0; ///< Synthesize a key press
+    virtual void keyUp(quint16 virtualKey) = 0; ///< Synthesize a key release
+    virtual void keyDownAndUp(quint16 virtualKey); ///< Synthesize a key press followed by a key release
+    virtual void unicodeKeyDownAndUp(char16_t c) = 0; ///< Synthesize the typing of a unicode character
+    virtual void backspaces(qint32 count) = 0; ///< Synthesize the typing of backspace a given number of times
+    QList<quint16> releaseModifierKeys(); ///< Synthesize the release of the modifier keys that are pressed, and return them
+    void restoreModifierKeys(QList<quint16> const &keys); ///< Synthesize the press of modifier keys released by releaseModifierKeys()
+    void eraseChars(qint32 count); ///< Erase the characters before the cursor
+    void typeText(QString const &text, qint32 delayMs = 0); ///< Synthesize the typing of a text
+    void moveCursorLeft(qint32 count); ///< Move the cursor to the left by a number of characters
+};
+
+
+#ifdef Q_OS_WINDOWS
+
+
+//****************************************************************************************************************************************************
+/// \brief Key synthesizer using the Windows API
+//****************************************************************************************************************************************************
+class WindowsKeySynthesizer : public KeySynthesizer {
+public: // member functions
+    WindowsKeySynthesizer() = default; ///< Default constructor
+    WindowsKeySynthesizer(WindowsKeySynthesizer const &) = delete; ///< Disabled copy constructor
+    WindowsKeySynthesizer(WindowsKeySynthesizer &&) = delete; ///< Disabled move constructor
+    ~WindowsKeySynthesizer() override = default; ///< Default destructor
+    WindowsKeySynthesizer &operator=(WindowsKeySynthesizer const &) = delete; ///< Disabled assignment operator
+    WindowsKeySynthesizer &operator=(WindowsKeySynthesizer &&) = delete; ///< Disabled move assignment operator
+    bool isKeyPressed(quint16 virtualKey) const override; ///< Check whether a key is currently pressed
+    void keyDown(quint16 virtualKey) override; ///< Synthesize a key press
+    void keyUp(quint16 virtualKey) override; ///< Synthesize a key release
+    void keyDownAndUp(quint16 virtualKey) override; ///< Synthesize a key press followed by a key release
+    void unicodeKeyDownAndUp(char16_t c) override; ///< Synthesize the typing of a unicode character
+    void backspaces(qint32 count) override; ///< Synthesize the typing of backspace a given number of times
+};
+
+
+#endif // #ifdef Q_OS_WINDOWS
+
+
+#endif // #ifndef BEEFTEXT_KEY_SYNTHESIZER_H
@@ -0,0 +1,101 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of keystroke queue class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "KeystrokeQueue.h"
+
+
+static_assert(0 == (KeystrokeQueue::capacity & (KeystrokeQueue::capacity - 1)), "The capacity of the keystroke queue must be a power of 2.");
+
+
+//****************************************************************************************************************************************************
+/// \brief If events were dropped since the last successful push, a combo breaker event is pushed before the event, and
+/// both events are published at once, so the consumer never sees the events that follow the gap without the combo
+/// breaker.
+///
+/// \param[in] event The event.
+/// \return true if and only if the event was pushed.
+/// \return false if the queue is full. In this case the event is dropped.
+//****************************************************************************************************************************************************
+bool KeystrokeQueue::push(KeystrokeEvent const &event) {
+    quint32 const writeCount = writeCount_.load(std::memory_order_relaxed);
+    quint32 const requiredCount = overflowed_ ? 2 : 1;
+    if (capacity - (writeCount - readCount_.load(std::memory_order_acquire)) < requiredCount) {
+        overflowed_ = true;
+        return false;
+    }
+    quint32 newWriteCount = writeCount;
+    if (overflowed_) {
+        KeystrokeEvent breaker;
+        breaker.type = EKeystrokeEventType::ComboBreaker;
+        events_[newWriteCount++ & (capacity - 1)] = breaker;
+        overflowed_ = false;
+    }
+    events_[newWriteCount++ & (capacity - 1)] = event;
+    writeCount_.store(newWriteCount, std::memory_order_release);
+    writeCount_.notify_one();
+    return true;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[out] outEvent The event. If the function returns false, the value of this parameter is undetermined.
+/// \return true if and only if an event was popped.
+/// \return false if the queue is empty.
+//****************************************************************************************************************************************************
+bool KeystrokeQueue::pop(KeystrokeEvent &outEvent) {
+    quint32 const readCount = readCount_.load(std::memory_order_relaxed);
+    if (readCount == writeCount_.load(std::memory_order_acquire))
+        return false;
+    outEvent = events_[readCount & (capacity - 1)];
+    readCount_.store(readCount + 1, std::memory_order_release);
+    return true;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void KeystrokeQueue::waitForEvent() const {
+    writeCount_.wait(readCount_.load(std::memory_order_relaxed), std::memory_order_acquire);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if some events were dropped since the last successful push.
+//****************************************************************************************************************************************************
+bool KeystrokeQueue::isOverflowed() const {
+    return overflowed_;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void KeystrokeQueue::markProcessed() {
+    processedCount_.fetch_add(1, std::memory_order_release);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the queue is full, i.e. the next push would fail. After an overflow, the queue is full
+/// until there is room for the combo breaker and the event.
+//****************************************************************************************************************************************************
+bool KeystrokeQueue::isFull() const {
+    quint32 const freeCount = capacity - (writeCount_.load(std::memory_order_relaxed) - readCount_.load(std::memory_order_acquire));
+    return freeCount < (overflowed_ ? 2u : 1u);
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the consumer has processed all the events pushed so far.
+//****************************************************************************************************************************************************
+bool KeystrokeQueue::isIdle() const {
+    return processedCount_.load(std::memory_order_acquire) == writeCount_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,86 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of keystroke queue class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_KEYSTROKE_QUEUE_H
+#define BEEFTEXT_KEYSTROKE_QUEUE_H
+
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+
+//****************************************************************************************************************************************************
+/// \brief Enumeration for the types of keystroke events
+//****************************************************************************************************************************************************
+enum class EKeystrokeEventType : quint8 {
+    Character = 0, ///< A character was typed
+    Backspace = 1, ///< Backspace was typed
+    ComboBreaker = 2, ///< A combo breaker was typed, or the typed text must be discarded
+    SubstitutionShortcut = 3, ///< The manual substitution shortcut was triggered
+    Stop = 4, ///< The consumer must stop processing events
+};
+
+
+//****************************************************************************************************************************************************
+/// \brief A keystroke event
+///
+/// The preferences affecting the processing of the event are captured when the event is produced, so that the
+/// consumer does not have to access the preferences manager.
+//****************************************************************************************************************************************************
+struct KeystrokeEvent {
+    EKeystrokeEventType type { EKeystrokeEventType::ComboBreaker }; ///< The type of event
+    QChar character; ///< The typed character, for events of type EKeystrokeEventType::Character
+    bool useAutomaticSubstitution { true }; ///< The value of the 'Use automatic substitution' preference
+    bool comboTriggersOnSpace { false }; ///< The value of the 'Combo triggers on space' preference
+};
+
+
+typedef std::vector<KeystrokeEvent> KeystrokeRecording; ///< Type definition for a recorded stream of keystroke events
+
+
+//****************************************************************************************************************************************************
+/// \brief A lock-free single-producer/single-consumer queue of keystroke events
+///
+/// Events are stored in a fixed-size ring, so pushing and popping events never allocate memory. The producer must
+/// always be the same thread (the thread running the keyboard hook), and so must the consumer. If the queue is full,
+/// the event is dropped and the queue is flagged as overflowed. The next event successfully pushed is then preceded by
+/// a combo breaker event, so that the consumer discards its typed text exactly where events were lost. The consumer
+/// reports the events it has finished processing using markProcessed(), so that the producer can wait for the queue
+/// to be idle.
+//****************************************************************************************************************************************************
+class KeystrokeQueue {
+public: // static data members
+    static quint32 constexpr capacity = 1024; ///< The capacity of the queue. Must be a power of 2
+
+public: // member functions
+    KeystrokeQueue() = default; ///< Default constructor
+    KeystrokeQueue(KeystrokeQueue const &) = delete; ///< Disabled copy constructor
+    KeystrokeQueue(KeystrokeQueue &&) = delete; ///< Disabled move constructor
+    ~KeystrokeQueue() = default; ///< Default destructor
+    KeystrokeQueue &operator=(KeystrokeQueue const &) = delete; ///< Disabled assignment operator
+    KeystrokeQueue &operator=(KeystrokeQueue &&) = delete; ///< Disabled move assignment operator
+    bool push(KeystrokeEvent const &event); ///< Push an event at the end of the queue. Must be called from the producer thread
+    bool pop(KeystrokeEvent &outEvent); ///< Pop the event at the front of the queue. Must be called from the consumer thread
+    void waitForEvent() const; ///< Block until the queue is not empty. Must be called from the consumer thread
+    bool isOverflowed() const; ///< Check whether events were dropped since the last successful push. Must be called from the producer thread
+    void markProcessed(); ///< Report that the last popped event has been processed. Must be called from the consumer thread
+    bool isFull() const; ///< Check whether the queue is full. Must be called from the producer thread
+    bool isIdle() const; ///< Check whether all pushed events have been processed. Must be called from the producer thread
+
+private: // data members
+    std::array<KeystrokeEvent, capacity> events_; ///< The storage for the events
+    alignas(64) std::atomic<quint32> readCount_ { 0 }; ///< The number of events popped so far
+    alignas(64) std::atomic<quint32> writeCount_ { 0 }; ///< The number of events pushed so far
+    alignas(64) std::atomic<quint32> processedCount_ { 0 }; ///< The number of events processed by the consumer so far
+    bool overflowed_ { false }; ///< Were some events dropped since the last successful push. Only accessed by the producer thread
+};
+
+
+#endif // #ifndef BEEFTEXT_KEYSTROKE_QUEUE_H
@@ -0,0 +1,191 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of keystroke replayer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "KeystrokeReplayer.h"
+#include <XMiLib/Exception.h>
+
+
+using namespace xmilib;
+
+
+namespace {
+
+
+QString const kKeyEvents = "events"; ///< The JSON key for the list of events
+QString const kKeyType = "type"; ///< The JSON key for the type of an event
+QString const kKeyCharacter = "character"; ///< The JSON key for the character of an event
+QString const kKeyUseAutomaticSubstitution = "useAutomaticSubstitution"; ///< The JSON key for the 'Use automatic substitution' preference of an event
+QString const kKeyComboTriggersOnSpace = "comboTriggersOnSpace"; ///< The JSON key for the 'Combo triggers on space' preference of an event
+QStringList const kTypeNames = { "character", "backspace", "comboBreaker", "substitutionShortcut" }; ///< The names of the event types, in the order of the EKeystrokeEventType enumeration
+
+
+//****************************************************************************************************************************************************
+/// \param[in] event The event.
+/// \return The JSON object for the event.
+//****************************************************************************************************************************************************
+QJsonObject eventToJsonObject(KeystrokeEvent const &event) {
+    QJsonObject result;
+    result[kKeyType] = kTypeNames[static_cast<qint32>(event.type)];
+    if (EKeystrokeEventType::Character == event.type)
+        result[kKeyCharacter] = QString(event.character);
+    result[kKeyUseAutomaticSubstitution] = event.useAutomaticSubstitution;
+    result[kKeyComboTriggersOnSpace] = event.comboTriggersOnSpace;
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] object The JSON object.
+/// \return The event.
+/// \throw Exception if the object is not a valid event.
+//****************************************************************************************************************************************************
+KeystrokeEvent eventFromJsonObject(QJsonObject const &object) {
+    qint32 const typeIndex = qint32(kTypeNames.indexOf(object[kKeyType].toString()));
+    if (typeIndex < 0)
+        throw Exception("The recording contains an event with an invalid type.");
+    KeystrokeEvent result;
+    result.type = static_cast<EKeystrokeEventType>(typeIndex);
+    if (EKeystrokeEventType::Character == result.type) {
+        QString const character = object[kKeyCharacter].toString();
+        if (character.size() != 1)
+            throw Exception("The recording contains a character event with an invalid character.");
+        result.character = character[0];
+    }
+    result.useAutomaticSubstitution = object[kKeyUseAutomaticSubstitution].toBool(true);
+    result.comboTriggersOnSpace = object[kKeyComboTriggersOnSpace].toBool(false);
+    return result;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief The text is converted into events the same way the input manager converts the text produced by key strokes.
+///
+/// \param[in] text The typed text. Backspace characters are converted to backspace events.
+/// \param[in] comboTriggersOnSpace The value of the 'Combo triggers on space' preference.
+/// \return The recording.
+//****************************************************************************************************************************************************
+KeystrokeRecording KeystrokeReplayer::recordingFromText(QString const &text, bool comboTriggersOnSpace) {
+    KeystrokeRecording result;
+    result.reserve(text.size());
+    for (QChar const c: text) {
+        KeystrokeEvent event;
+        event.comboTriggersOnSpace = comboTriggersOnSpace;
+        if (QChar('\b') == c)
+            event.type = EKeystrokeEventType::Backspace;
+        else if ((!c.isPrint()) || (c.isSpace() && !comboTriggersOnSpace))
+            event.type = EKeystrokeEventType::ComboBreaker;
+        else {
+            event.type = EKeystrokeEventType::Character;
+            event.character = c;
+        }
+        result.push_back(event);
+    }
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] path The path of the file.
+/// \param[out] outRecording The recording. If the function returns false, the value of this parameter is undetermined.
+/// \param[out] outErrorMsg If the function returns false and this parameter is not null, the string pointed to
+/// contains a description of the error.
+/// \return true if and only if the recording was successfully loaded.
+//****************************************************************************************************************************************************
+bool KeystrokeReplayer::loadRecording(QString const &path, KeystrokeRecording &outRecording, QString *outErrorMsg) {
+    try {
+        outRecording.clear();
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            throw Exception(QString("Could not open file for reading: '%1'").arg(QDir::toNativeSeparators(path)));
+        QJsonParseError error {};
+        QJsonDocument const doc = QJsonDocument::fromJson(file.readAll(), &error);
+        if (QJsonParseError::NoError != error.error)
+            throw Exception(QString("The recording is not a valid JSON document: %1").arg(error.errorString()));
+        QJsonValue const eventsValue = doc.object()[kKeyEvents];
+        if (!eventsValue.isArray())
+            throw Exception("The recording does not contain a valid list of events.");
+        QJsonArray const events = eventsValue.toArray();
+        outRecording.reserve(events.size());
+        for (QJsonValue const &value: events) {
+            if (!value.isObject())
+                throw Exception("The recording contains an invalid event.");
+            outRecording.push_back(eventFromJsonObject(value.toObject()));
+        }
+        return true;
+    }
+    catch (Exception const &e) {
+        if (outErrorMsg)
+            *outErrorMsg = e.qwhat();
+        return false;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] recording The recording.
+/// \param[in] path The path of the file.
+/// \param[out] outErrorMsg If the function returns false and this parameter is not null, the string pointed to
+/// contains a description of the error.
+/// \return true if and only if the recording was successfully saved.
+//****************************************************************************************************************************************************
+bool KeystrokeReplayer::saveRecording(KeystrokeRecording const &recording, QString const &path, QString *outErrorMsg) {
+    try {
+        QJsonArray events;
+        for (KeystrokeEvent const &event: recording)
+            if (EKeystrokeEventType::Stop != event.type)
+                events.append(eventToJsonObject(event));
+        QJsonObject rootObject;
+        rootObject[kKeyEvents] = events;
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            throw Exception(QString("Could not open file for writing: '%1'").arg(QDir::toNativeSeparators(path)));
+        QByteArray const data = QJsonDocument(rootObject).toJson(QJsonDocument::Compact);
+        if (data.size() != file.write(data))
+            throw Exception(QString("Error writing to file: %1").arg(QDir::toNativeSeparators(path)));
+        return true;
+    }
+    catch (Exception const &e) {
+        if (outErrorMsg)
+            *outErrorMsg = e.qwhat();
+        return false;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] recording The recording. The caller keeps ownership of the recording, which must outlive the replayer.
+//****************************************************************************************************************************************************
+KeystrokeReplayer::KeystrokeReplayer(KeystrokeRecording const &recording)
+    : recording_(recording) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[out] outEvent The event. If the function returns false, the value of this parameter is undetermined.
+/// \return true if and only if an event was retrieved.
+/// \return false if all the events of the recording have been replayed.
+//****************************************************************************************************************************************************
+bool KeystrokeReplayer::nextEvent(KeystrokeEvent &outEvent) {
+    if (position_ >= qsizetype(recording_.size()))
+        return false;
+    outEvent = recording_[position_++];
+    return true;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void KeystrokeReplayer::rewind() {
+    position_ = 0;
+}
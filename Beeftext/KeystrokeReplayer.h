@@ -0,0 +1,46 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of keystroke replayer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_KEYSTROKE_REPLAYER_H
+#define BEEFTEXT_KEYSTROKE_REPLAYER_H
+
+
+#include "KeystrokeSource.h"
+
+
+//****************************************************************************************************************************************************
+/// \brief A keystroke source that replays recorded keystroke events in place of the keyboard hook
+///
+/// The replayer does not push the events itself: it is consumed by the producer of a keystroke queue (see
+/// InputManager::replay() and feedKeystrokeQueue()). Combined with a MemoryKeySynthesizer, the replayer makes it
+/// possible to exercise the substitution pipeline without a Windows desktop.
+//****************************************************************************************************************************************************
+class KeystrokeReplayer : public KeystrokeSource {
+public: // static member functions
+    static KeystrokeRecording recordingFromText(QString const &text, bool comboTriggersOnSpace = false); ///< Create a recording from typed text
+    static bool loadRecording(QString const &path, KeystrokeRecording &outRecording, QString *outErrorMsg = nullptr); ///< Load a recording from a file
+    static bool saveRecording(KeystrokeRecording const &recording, QString const &path, QString *outErrorMsg = nullptr); ///< Save a recording to a file
+
+public: // member functions
+    explicit KeystrokeReplayer(KeystrokeRecording const &recording); ///< Default constructor
+    KeystrokeReplayer(KeystrokeReplayer const &) = delete; ///< Disabled copy constructor
+    KeystrokeReplayer(KeystrokeReplayer &&) = delete; ///< Disabled move constructor
+    ~KeystrokeReplayer() override = default; ///< Default destructor
+    KeystrokeReplayer &operator=(KeystrokeReplayer const &) = delete; ///< Disabled assignment operator
+    KeystrokeReplayer &operator=(KeystrokeReplayer &&) = delete; ///< Disabled move assignment operator
+    bool nextEvent(KeystrokeEvent &outEvent) override; ///< Retrieve the next event of the recording
+    void rewind(); ///< Restart the replay from the first event of the recording
+
+private: // data members
+    KeystrokeRecording const &recording_; ///< The recording
+    qsizetype position_ { 0 }; ///< The index in the recording of the next event to replay
+};
+
+
+#endif // #ifndef BEEFTEXT_KEYSTROKE_REPLAYER_H
@@ -0,0 +1,69 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of keystroke source class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "KeystrokeSource.h"
+
+
+namespace {
+
+
+//****************************************************************************************************************************************************
+/// \brief The substitutions are performed by the main thread in response to queued signals emitted by the consumer,
+/// and they may themselves push events in the queue, so the function loops until the queue is idle after processing
+/// the pending events.
+///
+/// \param[in] queue The keystroke queue.
+//****************************************************************************************************************************************************
+void waitForIdleConsumer(KeystrokeQueue const &queue) {
+    do {
+        while (!queue.isIdle())
+            QThread::yieldCurrentThread();
+        QCoreApplication::processEvents();
+    } while (!queue.isIdle());
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief The events are pushed as fast as the consumer can process them. After each batch of events, the function
+/// waits for the consumer to be idle and processes the pending events of the event loop, so that the substitutions
+/// triggered by the batch are performed before the next batch is pushed. With a batch size of 1, the result is
+/// deterministic.
+///
+/// \note The consumer of the queue must be running. Events of type EKeystrokeEventType::Stop are skipped.
+///
+/// \param[in] source The keystroke source.
+/// \param[in] queue The keystroke queue.
+/// \param[in] batchSize The number of events pushed between two synchronizations with the consumer. Values smaller
+/// than 1 are replaced by 1.
+/// \return The number of events pushed in the queue.
+//****************************************************************************************************************************************************
+qint64 feedKeystrokeQueue(KeystrokeSource &source, KeystrokeQueue &queue, qint32 batchSize) {
+    batchSize = qMax(1, batchSize);
+    qint32 batchCount = 0;
+    qint64 result = 0;
+    KeystrokeEvent event;
+    while (source.nextEvent(event)) {
+        if (EKeystrokeEventType::Stop == event.type)
+            continue;
+        while (queue.isFull()) // contrary to the keyboard hook, the producer can wait for the consumer
+            QThread::yieldCurrentThread();
+        queue.push(event);
+        ++result;
+        if (++batchCount >= batchSize) {
+            waitForIdleConsumer(queue);
+            batchCount = 0;
+        }
+    }
+    waitForIdleConsumer(queue);
+    return result;
+}
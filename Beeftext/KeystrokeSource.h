@@ -0,0 +1,38 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of keystroke source class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_KEYSTROKE_SOURCE_H
+#define BEEFTEXT_KEYSTROKE_SOURCE_H
+
+
+#include "KeystrokeQueue.h"
+
+
+//****************************************************************************************************************************************************
+/// \brief Abstract interface for the sources of keystroke events that are not captured by the keyboard hook
+///
+/// A source only produces events. The events are pushed in a keystroke queue by the producer of the queue, using
+/// feedKeystrokeQueue(). In the application, the producer is the input manager (see InputManager::replay()).
+//****************************************************************************************************************************************************
+class KeystrokeSource {
+public: // member functions
+    KeystrokeSource() = default; ///< Default constructor
+    KeystrokeSource(KeystrokeSource const &) = delete; ///< Disabled copy constructor
+    KeystrokeSource(KeystrokeSource &&) = delete; ///< Disabled move constructor
+    virtual ~KeystrokeSource() = default; ///< Default destructor
+    KeystrokeSource &operator=(KeystrokeSource const &) = delete; ///< Disabled assignment operator
+    KeystrokeSource &operator=(KeystrokeSource &&) = delete; ///< Disabled move assignment operator
+    virtual bool nextEvent(KeystrokeEvent &outEvent) = 0; ///< Retrieve the next event of the source
+};
+
+
+qint64 feedKeystrokeQueue(KeystrokeSource &source, KeystrokeQueue &queue, qint32 batchSize); ///< Push the events of a source in a keystroke queue. Must be called from the producer thread of the queue
+
+
+#endif // #ifndef BEEFTEXT_KEYSTROKE_SOURCE_H
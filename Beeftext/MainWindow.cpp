@@ -19,6 +19,7 @@
 #include "BeeftextConstants.h"
 #include "BeeftextGlobals.h"
 #include "InputManager.h"
+#include "SubstitutionTracer.h"
 #include <XMiLib/Exception.h>
 
 
@@ -35,12 +36,15 @@ MainWindow::MainWindow() {
     PreferencesManager const &prefs = PreferencesManager::instance();
     this->restoreWindowGeometry();
     ui_.actionOpenLogFile->setEnabled(prefs.writeDebugLogFile());
+    ui_.actionRecordSubstitutionTrace->setChecked(SubstitutionTracer::instance().isEnabled()); // recording may have been enabled from the command line
     connect(&InputManager::instance(), &InputManager::appEnableDisableShortcutTriggered, this, &MainWindow::onActionEnableDisableBeeftext);
     connect(ui_.actionVisitBeeftextWiki, &QAction::triggered, []() { QDesktopServices::openUrl(QUrl(constants::kBeeftextWikiHomeUrl)); });
     connect(ui_.actionGettingStarted, &QAction::triggered, []() { QDesktopServices::openUrl(QUrl(constants::kGettingStartedUrl)); });
     connect(ui_.actionShowReleaseNotes, &QAction::triggered, []() { QDesktopServices::openUrl(QUrl(constants::kBeeftextReleasesPagesUrl)); });
     connect(ui_.actionReportBug, &QAction::triggered, []() { QDesktopServices::openUrl(QUrl(constants::kBeeftextIssueTrackerUrl)); });
     connect(&InputManager::instance(), &InputManager::comboMenuShortcutTriggered, this, &MainWindow::onShowComboMenu);
+    connect(&InputManager::instance(), &InputManager::hookLatencyModeChanged, this, &MainWindow::setupSystemTrayIcon,
+        Qt::QueuedConnection); // the signal is emitted from the keyboard hook
     connect(&prefs, &PreferencesManager::writeDebugLogFileChanged, this, &MainWindow::onWriteDebugLogFileChanged);
 #ifdef NDEBUG
     ui_.menu_Advanced->removeAction(ui_.actionShowLogWindow);
@@ -127,7 +131,11 @@ void MainWindow::setupSystemTrayIcon() {
     QIcon const icon(enabled ? ":/MainWindow/Resources/BeeftextIcon.ico"
                              : ":/MainWindow/Resources/BeeftextIconGrayscale.ico");
     systemTrayIcon_.setIcon(icon);
-    systemTrayIcon_.setToolTip(constants::kApplicationName + (enabled ? "" : pausedIndicator));
+    HookLatencyMonitor const &hookLatencyMonitor = InputManager::instance().hookLatencyMonitor();
+    QString const slowKeyboardIndicator = hookLatencyMonitor.isDegraded()
+        ? tr(" - Slow keyboard processing (99th percentile: %1 ms)").arg(hookLatencyMonitor.percentile(0.99) / 1000.0, 0, 'f', 1)
+        : QString();
+    systemTrayIcon_.setToolTip(constants::kApplicationName + (enabled ? "" : pausedIndicator) + slowKeyboardIndicator);
     systemTrayIcon_.show();
     QGuiApplication::setWindowIcon(icon);
 
@@ -316,6 +324,41 @@ void MainWindow::onActionShowLogWindow() {
 }
 
 
+//****************************************************************************************************************************************************
+/// \param[in] checked Is the action checked.
+//****************************************************************************************************************************************************
+void MainWindow::onActionRecordSubstitutionTrace(bool checked) {
+    SubstitutionTracer &tracer = SubstitutionTracer::instance();
+    if (checked == tracer.isEnabled())
+        return;
+    if (checked)
+        tracer.clear();
+    tracer.setEnabled(checked);
+    globals::debugLog().addInfo(QString("Substitution trace recording %1.").arg(checked ? "started" : "stopped"));
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void MainWindow::onActionSaveSubstitutionTrace() {
+    SubstitutionTracer const &tracer = SubstitutionTracer::instance();
+    if (0 == tracer.spanCount()) {
+        QMessageBox::information(this, tr("Substitution Trace"), tr("The substitution trace is empty. Enable "
+            "recording, perform some substitutions, and try again."));
+        return;
+    }
+    QString const path = QFileDialog::getSaveFileName(this, tr("Save Substitution Trace"),
+        QDir(QStandardPaths::writableLocation(QStandardPaths::DesktopLocation)).absoluteFilePath("BeeftextTrace.json"),
+        globals::jsonFileDialogFilter());
+    if (path.isEmpty())
+        return;
+    QString errMsg;
+    if (!tracer.saveChromeTrace(path, &errMsg))
+        QMessageBox::critical(this, tr("Error"), errMsg);
+}
+
+
 //****************************************************************************************************************************************************
 //
 //****************************************************************************************************************************************************
@@ -66,6 +66,8 @@ private slots:
     void onActionShowPreferencesDialog(); ///< Slot for the 'Show Preferences dialog' action
     static void onActionOpenLogFile(); ///< Slot for the 'Open Log File' action
     static void onActionShowLogWindow(); ///< Slot for the 'Show Log Window action.
+    static void onActionRecordSubstitutionTrace(bool checked); ///< Slot for the 'Record Substitution Trace' action.
+    void onActionSaveSubstitutionTrace(); ///< Slot for the 'Save Substitution Trace' action.
     void onActionBackup(); ///< Slot for the 'Backup' action.
     void onActionRestore(); ///< Slot for the 'Restore' action.
     void onActionGenerateCheatSheet(); ///< Slot for the 'Generate Cheat Sheet' action.
@@ -0,0 +1,176 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of memory key synthesizer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "MemoryKeySynthesizer.h"
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+MemoryKeySynthesizer::MemoryKeySynthesizer()
+    : pasteTextProvider_([]() -> QString { return QString(); }) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+/// \return true if and only if the key is currently pressed.
+//****************************************************************************************************************************************************
+bool MemoryKeySynthesizer::isKeyPressed(quint16 virtualKey) const {
+    return (virtualKey < pressedKeys_.size()) && pressedKeys_[virtualKey];
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::keyDown(quint16 virtualKey) {
+    events_.push_back({ EEventType::KeyDown, virtualKey });
+    if (virtualKey < pressedKeys_.size())
+        pressedKeys_[virtualKey] = true;
+    switch (virtualKey) {
+    case backspaceKey:
+        this->erase(1);
+        break;
+    case returnKey:
+        this->insert(QString(QChar::LineFeed));
+        break;
+    case leftKey:
+        cursorPos_ = qMax(0, cursorPos_ - 1);
+        break;
+    case vKey:
+        if (this->isControlPressed())
+            this->insert(pasteTextProvider_());
+        break;
+    case insertKey:
+        if (this->isShiftPressed())
+            this->insert(pasteTextProvider_());
+        break;
+    default:
+        break;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::keyUp(quint16 virtualKey) {
+    events_.push_back({ EEventType::KeyUp, virtualKey });
+    if (virtualKey < pressedKeys_.size())
+        pressedKeys_[virtualKey] = false;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] c The character.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::unicodeKeyDownAndUp(char16_t c) {
+    events_.push_back({ EEventType::Unicode, c });
+    this->insert(QString(QChar(c)));
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] count The number of backspaces.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::backspaces(qint32 count) {
+    if (count <= 0)
+        return;
+    events_.push_back({ EEventType::Backspaces, static_cast<quint16>(qMin<qint32>(count, 0xffff)) });
+    this->erase(count);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] provider The function returning the text inserted when pasting.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::setPasteTextProvider(PasteTextProvider const &provider) {
+    pasteTextProvider_ = provider ? provider : []() -> QString { return QString(); };
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] text The text.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::setText(QString const &text) {
+    text_ = text;
+    cursorPos_ = qint32(text_.size());
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The content of the simulated text field.
+//****************************************************************************************************************************************************
+QString MemoryKeySynthesizer::text() const {
+    return text_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The position of the cursor in the simulated text field.
+//****************************************************************************************************************************************************
+qint32 MemoryKeySynthesizer::cursorPosition() const {
+    return cursorPos_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The log of the synthesized events.
+//****************************************************************************************************************************************************
+std::vector<MemoryKeySynthesizer::Event> const &MemoryKeySynthesizer::events() const {
+    return events_;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::clear() {
+    pressedKeys_.fill(false);
+    events_.clear();
+    text_.clear();
+    cursorPos_ = 0;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if a shift key is pressed.
+//****************************************************************************************************************************************************
+bool MemoryKeySynthesizer::isShiftPressed() const {
+    return pressedKeys_[shiftKey] || pressedKeys_[leftShiftKey] || pressedKeys_[rightShiftKey];
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if a control key is pressed.
+//****************************************************************************************************************************************************
+bool MemoryKeySynthesizer::isControlPressed() const {
+    return pressedKeys_[controlKey] || pressedKeys_[leftControlKey] || pressedKeys_[rightControlKey];
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] text The text.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::insert(QString const &text) {
+    text_.insert(cursorPos_, text);
+    cursorPos_ += qint32(text.size());
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] count The number of characters to erase.
+//****************************************************************************************************************************************************
+void MemoryKeySynthesizer::erase(qint32 count) {
+    qint32 const erased = qMin(count, cursorPos_);
+    text_.remove(cursorPos_ - erased, erased);
+    cursorPos_ -= erased;
+}
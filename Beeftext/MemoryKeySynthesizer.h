@@ -0,0 +1,75 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of memory key synthesizer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_MEMORY_KEY_SYNTHESIZER_H
+#define BEEFTEXT_MEMORY_KEY_SYNTHESIZER_H
+
+
+#include "KeySynthesizer.h"
+#include <array>
+#include <functional>
+
+
+//****************************************************************************************************************************************************
+/// \brief A key synthesizer that captures the synthesized input in memory
+///
+/// The synthesizer keeps a log of the synthesized events, and applies them to a simulated text field:
+/// characters are inserted at the cursor position, backspace erases the character before the cursor, return inserts
+/// a line feed, and the left arrow key moves the cursor. Control+V and Shift+Insert insert the text returned by the
+/// paste text provider. The class does not depend on the Windows API.
+//****************************************************************************************************************************************************
+class MemoryKeySynthesizer : public KeySynthesizer {
+public: // data types
+    enum class EEventType {
+        KeyDown, ///< A key was pressed
+        KeyUp, ///< A key was released
+        Unicode, ///< A unicode character was typed
+        Backspaces, ///< Backspace was typed a given number of times
+    }; ///< Enumeration for the types of synthesized events
+    struct Event {
+        EEventType type { EEventType::KeyDown }; ///< The type of event
+        quint16 value { 0 }; ///< The virtual key code, the character, or the number of backspaces, depending on the type
+    }; ///< Type definition for synthesized events
+    typedef std::function<QString()> PasteTextProvider; ///< Type definition for the function returning the text inserted when pasting
+
+public: // member functions
+    MemoryKeySynthesizer(); ///< Default constructor
+    MemoryKeySynthesizer(MemoryKeySynthesizer const &) = delete; ///< Disabled copy constructor
+    MemoryKeySynthesizer(MemoryKeySynthesizer &&) = delete; ///< Disabled move constructor
+    ~MemoryKeySynthesizer() override = default; ///< Default destructor
+    MemoryKeySynthesizer &operator=(MemoryKeySynthesizer const &) = delete; ///< Disabled assignment operator
+    MemoryKeySynthesizer &operator=(MemoryKeySynthesizer &&) = delete; ///< Disabled move assignment operator
+    bool isKeyPressed(quint16 virtualKey) const override; ///< Check whether a key is currently pressed
+    void keyDown(quint16 virtualKey) override; ///< Synthesize a key press
+    void keyUp(quint16 virtualKey) override; ///< Synthesize a key release
+    void unicodeKeyDownAndUp(char16_t c) override; ///< Synthesize the typing of a unicode character
+    void backspaces(qint32 count) override; ///< Synthesize the typing of backspace a given number of times
+    void setPasteTextProvider(PasteTextProvider const &provider); ///< Set the function returning the text inserted when pasting
+    void setText(QString const &text); ///< Set the content of the simulated text field and put the cursor at its end
+    QString text() const; ///< Return the content of the simulated text field
+    qint32 cursorPosition() const; ///< Return the position of the cursor in the simulated text field
+    std::vector<Event> const &events() const; ///< Return the log of the synthesized events
+    void clear(); ///< Clear the simulated text field, the event log, and release all keys
+
+private: // member functions
+    bool isShiftPressed() const; ///< Check whether a shift key is pressed
+    bool isControlPressed() const; ///< Check whether a control key is pressed
+    void insert(QString const &text); ///< Insert text at the cursor position
+    void erase(qint32 count); ///< Erase characters before the cursor position
+
+private: // data members
+    std::array<bool, 256> pressedKeys_ {}; ///< The state of each key
+    std::vector<Event> events_; ///< The log of the synthesized events
+    QString text_; ///< The content of the simulated text field
+    qint32 cursorPos_ { 0 }; ///< The position of the cursor in the simulated text field
+    PasteTextProvider pasteTextProvider_; ///< The function returning the text inserted when pasting
+};
+
+
+#endif // #ifndef BEEFTEXT_MEMORY_KEY_SYNTHESIZER_H
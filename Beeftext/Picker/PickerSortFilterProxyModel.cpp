@@ -10,7 +10,7 @@
 #include "stdafx.h"
 #include "PickerSortFilterProxyModel.h"
 #include "Emoji/Emoji.h"
-#include "Combo/Combo.h"
+#include "Combo/ComboManager.h"
 #include "BeeftextConstants.h"
 
 
@@ -44,19 +44,35 @@ bool PickerSortFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelInd
     SpCombo const combo(isEmoji ? nullptr : index.data(constants::PointerRole).value<SpCombo>());
     bool const ok = isEmoji ? !!emoji.get() : !!combo.get();
     Q_ASSERT(ok);
-    if ((!ok) || ((!isEmoji) && (!combo->isUsable())))
+    if (!ok)
         return false;
 
-    QString const comboName = model->data(index, Qt::DisplayRole).toString();
-    QString const keyword = isEmoji ? emoji->shortcode() : combo->keyword();
-    QString const snippet = isEmoji ? emoji->value() : combo->snippet();
-    QString const description = isEmoji ? QString() : combo->description();
-    SpGroup const group = isEmoji ? nullptr : combo->group();
+    // for combos, the searchable data is read from the snapshot, that does not need to query the combo and its group
+    ComboSnapshot::SearchEntry const *entry = isEmoji ? nullptr : this->comboSnapshot().searchEntry(combo.get());
+    ComboSnapshot::SearchEntry liveEntry;
+    if ((!isEmoji) && (!entry)) { // the combo was added after the snapshot was published
+        liveEntry.name = combo->displayName();
+        liveEntry.keyword = combo->keyword();
+        liveEntry.snippet = combo->snippet();
+        liveEntry.description = combo->description();
+        SpGroup const group = combo->group();
+        liveEntry.groupName = group ? group->name() : QString();
+        liveEntry.usable = combo->isUsable();
+        entry = &liveEntry;
+    }
+    if (entry && (!entry->usable))
+        return false;
+
+    QString const comboName = isEmoji ? model->data(index, Qt::DisplayRole).toString() : entry->name;
+    QString const keyword = isEmoji ? emoji->shortcode() : entry->keyword;
+    QString const snippet = isEmoji ? emoji->value() : entry->snippet;
+    QString const description = isEmoji ? QString() : entry->description;
+    QString const groupName = isEmoji ? QString() : entry->groupName;
     for (QString const &word: this->filterRegularExpression().pattern().replace("\\ ", " ")
         .split(QRegularExpression("\\s"), Qt::SkipEmptyParts)) {
         QRegularExpression const rx(word, QRegularExpression::CaseInsensitiveOption);
         if ((!comboName.contains(rx)) && (!keyword.contains(rx)) && (!snippet.contains(rx))
-            && (!(group && group->name().contains(rx))) && (!description.contains(rx)))
+            && (!groupName.contains(rx)) && (!description.contains(rx)))
             return false;
     }
     return true;
@@ -82,3 +98,15 @@ bool PickerSortFilterProxyModel::lessThan(const QModelIndex &sourceLeft, const Q
                             (rEmoji ? rEmoji->lastUseDateTime() : originTime);
     return lTime < rTime;
 }
+
+
+//****************************************************************************************************************************************************
+/// \return The latest combo snapshot. The snapshot is only retrieved from the combo manager when its epoch has
+/// changed.
+//****************************************************************************************************************************************************
+ComboSnapshot const &PickerSortFilterProxyModel::comboSnapshot() const {
+    ComboManager const &comboManager = ComboManager::instance();
+    if ((!snapshot_) || (snapshot_->epoch() != comboManager.snapshotEpoch()))
+        snapshot_ = comboManager.snapshot();
+    return *snapshot_;
+}
@@ -11,6 +11,9 @@
 #define BEEFTEXT_PICKER_SORT_FILTER_PROXY_MODEL_H
 
 
+#include "Combo/ComboSnapshot.h"
+
+
 //****************************************************************************************************************************************************
 /// \brief A sort/filter proxy model for the combo picker window
 //****************************************************************************************************************************************************
@@ -24,6 +27,12 @@ public: // member functions
     PickerSortFilterProxyModel &operator=(PickerSortFilterProxyModel &&) = delete; ///< Disabled move assignment operator
     bool filterAcceptsRow(int sourceRow, const QModelIndex &) const override; ///< Check if a row should be included or discarded
     bool lessThan(const QModelIndex &sourceLeft, const QModelIndex &sourceRight) const override; ///< Sort function for the filter
+
+private: // member functions
+    ComboSnapshot const &comboSnapshot() const; ///< Return the latest combo snapshot
+
+private: // data members
+    mutable SpComboSnapshot snapshot_; ///< The combo snapshot used for filtering, refreshed when its epoch is outdated
 };
 
 
@@ -296,7 +296,7 @@ void PickerWindow::triggerSelectedItem() {
     else
         QTimer::singleShot(delay, [emoji]() {
             if ((!isBeeftextTheForegroundApplication()) &&
-                !EmojiManager::instance().isExcludedApplication(getActiveExecutableFileName())) {
+                !EmojiManager::instance().isForegroundApplicationExcluded()) {
                 performTextSubstitution(0, emoji->value(), -1, ETriggerSource::ComboPicker);
                 emoji->setlastUseDateTime(QDateTime::currentDateTime());
             }
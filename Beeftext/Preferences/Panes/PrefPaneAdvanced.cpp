@@ -14,6 +14,7 @@
 #include "Backup/BackupManager.h"
 #include "BeeftextGlobals.h"
 #include "BeeftextUtils.h"
+#include "InputManager.h"
 #include <XMiLib/Exception.h>
 
 
@@ -30,6 +31,8 @@ PrefPaneAdvanced::PrefPaneAdvanced(QWidget *parent)
 
     // We update the GUI when the combo list is saved to properly enable/disable the 'Restore Backup' button
     connect(&ComboManager::instance(), &ComboManager::comboListWasSaved, this, &PrefPaneAdvanced::updateGui);
+    connect(&InputManager::instance(), &InputManager::hookLatencyModeChanged, this, &PrefPaneAdvanced::updateGui,
+        Qt::QueuedConnection); // the signal is emitted from the keyboard hook
 
     connect(ui_.buttonChangeComboListFolder, &QPushButton::clicked, this, &PrefPaneAdvanced::onChangeComboListFolder);
     connect(ui_.buttonChangeCustomBackupLocation, &QPushButton::clicked, this, &PrefPaneAdvanced::onChangeCustomBackupLocation);
@@ -93,6 +96,15 @@ void PrefPaneAdvanced::updateGui() const {
     QWidgetList widgets = { ui_.editCustomBackupLocation, ui_.buttonChangeCustomBackupLocation };
     for (QWidget *widget: widgets)
         widget->setEnabled(prefs_.useCustomBackupLocation());
+
+    HookLatencyMonitor const &hookLatencyMonitor = InputManager::instance().hookLatencyMonitor();
+    if (!hookLatencyMonitor.totalSampleCount())
+        ui_.labelKeyboardProcessingTime->setText(tr("Keyboard processing time: not measured yet."));
+    else
+        ui_.labelKeyboardProcessingTime->setText((hookLatencyMonitor.isDegraded()
+            ? tr("Keyboard processing time: 99% of key strokes in %1 ms or less. Keyboard processing is slow, so key "
+                "strokes are processed after they reach the application.")
+            : tr("Keyboard processing time: 99% of key strokes in %1 ms or less.")).arg(hookLatencyMonitor.percentile(0.99) / 1000.0, 0, 'f', 1));
 }
 
 
@@ -158,6 +158,38 @@ T PreferencesManager::readSettings(QString const &key, T const &defaultValue) co
 }
 
 
+//****************************************************************************************************************************************************
+/// \brief The snapshot is immutable, so its values can be read from any thread without synchronization.
+///
+/// \note std::atomic<std::shared_ptr> is not lock-free: the standard libraries guard the pointer and the reference
+/// count update with an internal spin lock. The lock is only held while a pointer is copied and a reference count is
+/// updated, never while a snapshot is built or the settings are accessed, so a reader, e.g. the keyboard hook, can
+/// only be delayed by a concurrent load or store, for a bounded time. A reader releasing the last reference to a
+/// replaced snapshot frees it.
+///
+/// \return The current snapshot of the preferences.
+//****************************************************************************************************************************************************
+PreferencesManager::SpSnapshot PreferencesManager::snapshot() const {
+    return snapshot_.load(std::memory_order_acquire);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The current snapshot is copied, modified and published in place of the current one. Readers holding the
+/// previous snapshot are not affected. Preferences are only modified from the main thread, so no compare-and-swap is
+/// required.
+///
+/// \param[in] member The member of the snapshot to modify.
+/// \param[in] value The new value.
+//****************************************************************************************************************************************************
+template<typename T>
+void PreferencesManager::publishValue(T Snapshot::*member, std::type_identity_t<T> const &value) const {
+    std::shared_ptr<Snapshot> const snapshot = std::make_shared<Snapshot>(*this->snapshot());
+    (*snapshot).*member = value;
+    snapshot_.store(snapshot, std::memory_order_release);
+}
+
+
 //****************************************************************************************************************************************************
 /// \param[in] modRegKey The registry key for the shortcut's  modifiers.
 /// \param[in] vKeyRegKey The registry key for the shortcut's virtual key.
@@ -193,41 +225,56 @@ SpShortcut readShortcutFromPreferences(QSettings const &settings, QString const
 //****************************************************************************************************************************************************
 //
 //****************************************************************************************************************************************************
-void PreferencesManager::Cache::init() {
-    // Cache often accessed values
-    useAutomaticSubstitution = ::readSettings<bool>(settings_, kKeyUseAutomaticSubstitution, kDefaultUseAutomaticSubstitution);
-    comboTriggersOnSpace = ::readSettings<bool>(settings_, kKeyComboTriggersOnSpace, kDefaultComboTriggersOnSpace);
-    keepFinalSpaceCharacter = ::readSettings<bool>(settings_, kKeyKeepFinalSpaceCharacter, kDefaultKeepFinalSpaceCharacter);
-    cacheComboTriggerShortcut();
-    comboPickerEnabled = ::readSettings<bool>(settings_, kKeyComboPickerEnabled, kDefaultComboPickerEnabled);
-    cacheComboPickerShortcut();
-    defaultMatchingMode = this->readDefaultMatchingModeFromPreferences();
-    defaultCaseSensitivity = this->readDefaultCaseSensitivityFromPreferences();
-    emojiShortcodesEnabled = ::readSettings<bool>(settings_, kKeyEmojiShortcodesEnabled, kDefaultEmojiShortcodesEnabled);
-    showEmojisInPickerWindow = ::readSettings<bool>(settings_, kKeyShowEmojisInPickerWindow, kDefaultShowEmojisInPickerWindow);
-    enableAppEnableDisableShortcut = ::readSettings<bool>(settings_, kKeyEnableAppEnableDisableShortcut, kDefaultEnableAppEnableDisableShortcut);
-    cacheAppEnableDisableShortcut();
-    cacheThemePrefs();
-    emojiLeftDelimiter = ::readSettings<QString>(settings_, kKeyEmojiLeftDelimiter, kDefaultEmojiLeftDelimiter);
-    emojiRightDelimiter = ::readSettings<QString>(settings_, kKeyEmojiRightDelimiter, kDefaultEmojiRightDelimiter);
-    beeftextEnabled = ::readSettings<bool>(settings_, kKeyBeeftextEnabled, kDefaultBeeftextEnabled);
-    useShiftInsertForPasting = ::readSettings<bool>(settings_, kKeyUseShiftInsertForPasting, kDefaultUseShiftInsertForPasting);
+void PreferencesManager::Snapshot::init(QSettings &settings) {
+    useAutomaticSubstitution = ::readSettings<bool>(settings, kKeyUseAutomaticSubstitution, kDefaultUseAutomaticSubstitution);
+    comboTriggersOnSpace = ::readSettings<bool>(settings, kKeyComboTriggersOnSpace, kDefaultComboTriggersOnSpace);
+    keepFinalSpaceCharacter = ::readSettings<bool>(settings, kKeyKeepFinalSpaceCharacter, kDefaultKeepFinalSpaceCharacter);
+    this->readComboTriggerShortcut(settings);
+    comboPickerEnabled = ::readSettings<bool>(settings, kKeyComboPickerEnabled, kDefaultComboPickerEnabled);
+    this->readComboPickerShortcut(settings);
+    defaultMatchingMode = readDefaultMatchingModeFromPreferences(settings);
+    defaultCaseSensitivity = readDefaultCaseSensitivityFromPreferences(settings);
+    emojiShortcodesEnabled = ::readSettings<bool>(settings, kKeyEmojiShortcodesEnabled, kDefaultEmojiShortcodesEnabled);
+    showEmojisInPickerWindow = ::readSettings<bool>(settings, kKeyShowEmojisInPickerWindow, kDefaultShowEmojisInPickerWindow);
+    enableAppEnableDisableShortcut = ::readSettings<bool>(settings, kKeyEnableAppEnableDisableShortcut, kDefaultEnableAppEnableDisableShortcut);
+    this->readAppEnableDisableShortcut(settings);
+    this->readThemePrefs(settings);
+    emojiLeftDelimiter = ::readSettings<QString>(settings, kKeyEmojiLeftDelimiter, kDefaultEmojiLeftDelimiter);
+    emojiRightDelimiter = ::readSettings<QString>(settings, kKeyEmojiRightDelimiter, kDefaultEmojiRightDelimiter);
+    beeftextEnabled = ::readSettings<bool>(settings, kKeyBeeftextEnabled, kDefaultBeeftextEnabled);
+    useShiftInsertForPasting = ::readSettings<bool>(settings, kKeyUseShiftInsertForPasting, kDefaultUseShiftInsertForPasting);
+    playSoundOnCombo = ::readSettings<bool>(settings, kKeyPlaySoundOnCombo, kDefaultPlaySoundOnCombo);
+    useCustomSound = ::readSettings<bool>(settings, kKeyUseCustomSound, kDefaultUseCustomSound);
+    customSoundPath = ::readSettings<QString>(settings, kKeyCustomSoundPath, QString());
+    delayBetweenKeystrokesMs = qBound<qint32>(kMinValueDelayBetweenKeystrokesMs, ::readSettings<qint32>(settings,
+        kKeyDelayBetweenKeystrokes, kDefaultDelayBetweenKeystrokesMs), kMaxValueDelayBetweenKeystrokesMs);
+    useLegacyCopyPaste = ::readSettings<bool>(settings, kKeyUseLegacyCopyPaste, kDefaultUseLegacyCopyPaste);
+    restoreClipboardAfterSubstitution = ::readSettings<bool>(settings, kKeyRestoreClipboardAfterSubstitution, kDefaultRestoreClipboardAfterSubstitution);
+    useCustomPowershellVersion = ::readSettings<bool>(settings, kKeyUseCustomPowershellVersion, kDefaultUseCustomPowershellVersion);
+    customPowershellPath = ::readSettings<QString>(settings, kKeyCustomPowershellPath, QString());
+    autoCheckForUpdates = ::readSettings<bool>(settings, kKeyAutoCheckForUpdates, kDefaultAutoCheckForUpdates);
+    warnAboutShortComboKeywords = ::readSettings<bool>(settings, kKeyWarnAboutShortComboKeyword, kDefaultWarnAboutShortComboKeyword);
+    warnAboutEmptyComboKeywords = ::readSettings<bool>(settings, kKeyWarnAboutEmptyComboKeyword, kDefaultWarnAboutEmptyComboKeyword);
+    autoBackup = ::readSettings<bool>(settings, kKeyAutoBackup, kDefaultAutoBackup);
+    useCustomBackupLocation = ::readSettings<bool>(settings, kKeyUseCustomBackupLocation, kDefaultUseCustomBackupLocation);
+    customBackupLocation = ::readSettings<QString>(settings, kKeyCustomBackupLocation, globals::defaultBackupFolderPath());
+    writeDebugLogFile = ::readSettings<bool>(settings, kKeyWriteDebugLogFile, kDefaultWriteDebugLogFile);
 }
 
 
 //****************************************************************************************************************************************************
 // 
 //****************************************************************************************************************************************************
-void PreferencesManager::Cache::cacheComboTriggerShortcut() {
-    comboTriggerShortcut = readShortcutFromPreferences(settings_, kKeyComboTriggerShortcut);
+void PreferencesManager::Snapshot::readComboTriggerShortcut(QSettings &settings) {
+    comboTriggerShortcut = readShortcutFromPreferences(settings, kKeyComboTriggerShortcut);
     if (comboTriggerShortcut)
         return;
-    comboTriggerShortcut = readShortcutFromPreferencesDeprecated(settings_, kKeyComboTriggerShortcutModifiersDeprecated, kKeyComboTriggerShortcutKeyCodeDeprecated, kKeyComboTriggerShortcutScanCodeDeprecated);
+    comboTriggerShortcut = readShortcutFromPreferencesDeprecated(settings, kKeyComboTriggerShortcutModifiersDeprecated, kKeyComboTriggerShortcutKeyCodeDeprecated, kKeyComboTriggerShortcutScanCodeDeprecated);
     if (comboTriggerShortcut) {
-        settings_.setValue(kKeyComboTriggerShortcut, comboTriggerShortcut->toCombined());
-        settings_.remove(kKeyComboTriggerShortcutModifiersDeprecated);
-        settings_.remove(kKeyComboTriggerShortcutKeyCodeDeprecated);
-        settings_.remove(kKeyComboTriggerShortcutScanCodeDeprecated);
+        settings.setValue(kKeyComboTriggerShortcut, comboTriggerShortcut->toCombined());
+        settings.remove(kKeyComboTriggerShortcutModifiersDeprecated);
+        settings.remove(kKeyComboTriggerShortcutKeyCodeDeprecated);
+        settings.remove(kKeyComboTriggerShortcutScanCodeDeprecated);
         return;
     }
     comboTriggerShortcut = kDefaultComboTriggerShortcut;
@@ -237,16 +284,16 @@ void PreferencesManager::Cache::cacheComboTriggerShortcut() {
 //****************************************************************************************************************************************************
 //
 //****************************************************************************************************************************************************
-void PreferencesManager::Cache::cacheComboPickerShortcut() {
-    comboPickerShortcut = readShortcutFromPreferences(settings_, kKeyComboPickerShortcut);
+void PreferencesManager::Snapshot::readComboPickerShortcut(QSettings &settings) {
+    comboPickerShortcut = readShortcutFromPreferences(settings, kKeyComboPickerShortcut);
     if (comboPickerShortcut)
         return;
-    comboPickerShortcut = readShortcutFromPreferencesDeprecated(settings_, kKeyComboPickerShortcutModifiersDeprecated, kKeyComboPickerShortcutKeyCodeDeprecated, kKeyComboPickerShortcutScanCodeDeprecated);
+    comboPickerShortcut = readShortcutFromPreferencesDeprecated(settings, kKeyComboPickerShortcutModifiersDeprecated, kKeyComboPickerShortcutKeyCodeDeprecated, kKeyComboPickerShortcutScanCodeDeprecated);
     if (comboPickerShortcut) {
-        settings_.setValue(kKeyComboPickerShortcut, comboPickerShortcut->toCombined());
-        settings_.remove(kKeyComboPickerShortcutModifiersDeprecated);
-        settings_.remove(kKeyComboPickerShortcutKeyCodeDeprecated);
-        settings_.remove(kKeyComboPickerShortcutScanCodeDeprecated);
+        settings.setValue(kKeyComboPickerShortcut, comboPickerShortcut->toCombined());
+        settings.remove(kKeyComboPickerShortcutModifiersDeprecated);
+        settings.remove(kKeyComboPickerShortcutKeyCodeDeprecated);
+        settings.remove(kKeyComboPickerShortcutScanCodeDeprecated);
         return;
     }
     comboPickerShortcut = defaultComboPickerShortcut();
@@ -256,18 +303,18 @@ void PreferencesManager::Cache::cacheComboPickerShortcut() {
 //****************************************************************************************************************************************************
 //
 //****************************************************************************************************************************************************
-void PreferencesManager::Cache::cacheAppEnableDisableShortcut() {
-    appEnableDisableShortcut = readShortcutFromPreferences(settings_, kKeyAppEnableShortcut);
+void PreferencesManager::Snapshot::readAppEnableDisableShortcut(QSettings &settings) {
+    appEnableDisableShortcut = readShortcutFromPreferences(settings, kKeyAppEnableShortcut);
     if (appEnableDisableShortcut)
         return;
     // Does the shortcut exists in deprecated form?
-    appEnableDisableShortcut = readShortcutFromPreferencesDeprecated(settings_, kKeyAppEnableShortcutModifiersDeprecated, kKeyAppEnableShortcutKeyCodeDeprecated, kKeyAppEnableShortcutScanCodeDeprecated);
+    appEnableDisableShortcut = readShortcutFromPreferencesDeprecated(settings, kKeyAppEnableShortcutModifiersDeprecated, kKeyAppEnableShortcutKeyCodeDeprecated, kKeyAppEnableShortcutScanCodeDeprecated);
     // if so we upgrade to the new form and remove the deprecated version
     if (appEnableDisableShortcut) {
-        settings_.setValue(kKeyAppEnableShortcut, appEnableDisableShortcut->toCombined());
-        settings_.remove(kKeyAppEnableShortcutModifiersDeprecated);
-        settings_.remove(kKeyAppEnableShortcutKeyCodeDeprecated);
-        settings_.remove(kKeyAppEnableShortcutScanCodeDeprecated);
+        settings.setValue(kKeyAppEnableShortcut, appEnableDisableShortcut->toCombined());
+        settings.remove(kKeyAppEnableShortcutModifiersDeprecated);
+        settings.remove(kKeyAppEnableShortcutKeyCodeDeprecated);
+        settings.remove(kKeyAppEnableShortcutScanCodeDeprecated);
         return;
     }
     appEnableDisableShortcut = kDefaultAppEnableDisableShortcut;
@@ -277,20 +324,20 @@ void PreferencesManager::Cache::cacheAppEnableDisableShortcut() {
 //****************************************************************************************************************************************************
 //
 //****************************************************************************************************************************************************
-void PreferencesManager::Cache::cacheThemePrefs() {
-    qint32 const intValue = ::readSettings<qint32>(settings_, kKeyTheme, static_cast<qint32>(kDefaultTheme));
+void PreferencesManager::Snapshot::readThemePrefs(QSettings &settings) {
+    qint32 const intValue = ::readSettings<qint32>(settings, kKeyTheme, static_cast<qint32>(kDefaultTheme));
     theme = ((intValue < 0) || (intValue >= static_cast<qint32>(ETheme::Count))) ? kDefaultTheme
         : static_cast<ETheme>(intValue);
 
-    useCustomTheme = ::readSettings<bool>(settings_, kKeyUseCustomTheme, kDefaultUseCustomTheme);
+    useCustomTheme = ::readSettings<bool>(settings, kKeyUseCustomTheme, kDefaultUseCustomTheme);
 }
 
 
 //****************************************************************************************************************************************************
 /// \return The default matching mode read from the preferences
 //****************************************************************************************************************************************************
-EMatchingMode PreferencesManager::Cache::readDefaultMatchingModeFromPreferences() const {
-    EMatchingMode const mode = static_cast<EMatchingMode>(::readSettings<qint32>(settings_, kKeyDefaultMatchingMode, static_cast<qint32>(EMatchingMode::Strict)));
+EMatchingMode PreferencesManager::Snapshot::readDefaultMatchingModeFromPreferences(QSettings &settings) {
+    EMatchingMode const mode = static_cast<EMatchingMode>(::readSettings<qint32>(settings, kKeyDefaultMatchingMode, static_cast<qint32>(EMatchingMode::Strict)));
     switch (mode) {
     case EMatchingMode::Strict:
     case EMatchingMode::Loose:
@@ -304,8 +351,8 @@ EMatchingMode PreferencesManager::Cache::readDefaultMatchingModeFromPreferences(
 //****************************************************************************************************************************************************
 /// \return The default case sensitivity read from the preferences.
 //****************************************************************************************************************************************************
-ECaseSensitivity PreferencesManager::Cache::readDefaultCaseSensitivityFromPreferences() const {
-    ECaseSensitivity const sensitivity = intToCaseSensitivity(::readSettings<qint32>(settings_, kKeyDefaultCaseSensitivity, caseSensitivityToInt(kDefaultDefaultCaseSensitivity)));
+ECaseSensitivity PreferencesManager::Snapshot::readDefaultCaseSensitivityFromPreferences(QSettings &settings) {
+    ECaseSensitivity const sensitivity = intToCaseSensitivity(::readSettings<qint32>(settings, kKeyDefaultCaseSensitivity, caseSensitivityToInt(kDefaultDefaultCaseSensitivity)));
     switch (sensitivity) {
     case ECaseSensitivity::CaseSensitive:
     case ECaseSensitivity::CaseInsensitive:
@@ -336,7 +383,6 @@ PreferencesManager::PreferencesManager() {
     settings_ = isInPortableMode()
         ? std::make_unique<QSettings>(globals::portableModeSettingsFilePath(), QSettings::IniFormat)
         : std::make_unique<QSettings>(constants::kOrganizationName, constants::kApplicationName);
-    cache_ = std::make_unique<Cache>(*settings_);
     this->init();
 }
 
@@ -353,8 +399,14 @@ QSettings &PreferencesManager::settings() {
 //****************************************************************************************************************************************************
 //
 //****************************************************************************************************************************************************
-void PreferencesManager::init() const {
-    cache_->init();
+void PreferencesManager::init() {
+    std::shared_ptr<Snapshot> const snapshot = std::make_shared<Snapshot>();
+    snapshot->init(*settings_);
+    snapshot_.store(snapshot, std::memory_order_release);
+    Combo::invalidateMatchDescriptors();
+    emit defaultMatchingOptionsChanged();
+    emit emojiPreferencesChanged();
+    emit shortcutPreferencesChanged();
     applyThemePreferences(this->useCustomTheme(), this->theme());
     this->applyLocalePreference();
 }
@@ -429,7 +481,7 @@ bool PreferencesManager::save(QString const &path) const {
 /// \param[in] path The path of the file to load from.
 /// \return true if and only if the operation was completed successfully.
 //****************************************************************************************************************************************************
-bool PreferencesManager::load(QString const &path) const {
+bool PreferencesManager::load(QString const &path) {
     try {
         QFile file(path);
         if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -552,7 +604,7 @@ void PreferencesManager::toJsonDocument(QJsonDocument &outDoc) const {
 //****************************************************************************************************************************************************
 /// \param[in] doc The JSON document.
 //****************************************************************************************************************************************************
-void PreferencesManager::fromJsonDocument(QJsonDocument const &doc) const {
+void PreferencesManager::fromJsonDocument(QJsonDocument const &doc) {
     QJsonObject const object = doc.object();
     settings_->setValue(kKeyAppEnableShortcutKeyCodeDeprecated, objectValue<quint32>(object, kKeyAppEnableShortcutKeyCodeDeprecated));
     settings_->setValue(kKeyAppEnableShortcutModifiersDeprecated, objectValue<quint32>(object, kKeyAppEnableShortcutModifiersDeprecated));
@@ -748,6 +800,7 @@ bool PreferencesManager::autoStartAtLogin() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setPlaySoundOnCombo(bool value) const {
     settings_->setValue(kKeyPlaySoundOnCombo, value);
+    this->publishValue(&Snapshot::playSoundOnCombo, value);
 }
 
 
@@ -755,7 +808,7 @@ void PreferencesManager::setPlaySoundOnCombo(bool value) const {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::playSoundOnCombo() const {
-    return this->readSettings<bool>(kKeyPlaySoundOnCombo, kDefaultPlaySoundOnCombo);
+    return this->snapshot()->playSoundOnCombo;
 }
 
 
@@ -764,6 +817,7 @@ bool PreferencesManager::playSoundOnCombo() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setUseCustomSound(bool value) const {
     settings_->setValue(kKeyUseCustomSound, value);
+    this->publishValue(&Snapshot::useCustomSound, value);
 }
 
 
@@ -771,7 +825,7 @@ void PreferencesManager::setUseCustomSound(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::useCustomSound() const {
-    return this->readSettings<bool>(kKeyUseCustomSound, kDefaultUseCustomSound);
+    return this->snapshot()->useCustomSound;
 }
 
 
@@ -780,6 +834,7 @@ bool PreferencesManager::useCustomSound() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setCustomSoundPath(QString const &path) const {
     settings_->setValue(kKeyCustomSoundPath, path);
+    this->publishValue(&Snapshot::customSoundPath, path);
 }
 
 
@@ -787,7 +842,7 @@ void PreferencesManager::setCustomSoundPath(QString const &path) const {
 /// \return The path of the custom sound file.
 //****************************************************************************************************************************************************
 QString PreferencesManager::customSoundPath() const {
-    return this->readSettings<QString>(kKeyCustomSoundPath, QString());
+    return this->snapshot()->customSoundPath;
 }
 
 
@@ -798,6 +853,7 @@ void PreferencesManager::setAutoCheckForUpdates(bool value) {
     if (this->autoCheckForUpdates() == value)
         return;
     settings_->setValue(kKeyAutoCheckForUpdates, value);
+    this->publishValue(&Snapshot::autoCheckForUpdates, value);
     emit autoCheckForUpdatesChanged(value);
 }
 
@@ -806,7 +862,7 @@ void PreferencesManager::setAutoCheckForUpdates(bool value) {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::autoCheckForUpdates() const {
-    return this->readSettings<bool>(kKeyAutoCheckForUpdates, kDefaultAutoCheckForUpdates);
+    return this->snapshot()->autoCheckForUpdates;
 }
 
 
@@ -816,7 +872,7 @@ bool PreferencesManager::autoCheckForUpdates() const {
 void PreferencesManager::setUseCustomTheme(bool value) const {
     if (this->useCustomTheme() != value) {
         settings_->setValue(kKeyUseCustomTheme, value);
-        cache_->useCustomTheme = value;
+        this->publishValue(&Snapshot::useCustomTheme, value);
         applyThemePreferences(value, this->theme());
     }
 }
@@ -826,7 +882,7 @@ void PreferencesManager::setUseCustomTheme(bool value) const {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::useCustomTheme() const {
-    return cache_->useCustomTheme;
+    return this->snapshot()->useCustomTheme;
 }
 
 
@@ -834,9 +890,12 @@ bool PreferencesManager::useCustomTheme() const {
 /// As the getter for this value is polled frequently (at every keystroke), it is cached
 /// \param[in] value The new value for the preference
 //****************************************************************************************************************************************************
-void PreferencesManager::setUseAutomaticSubstitution(bool value) const {
-    cache_->useAutomaticSubstitution = value;
+void PreferencesManager::setUseAutomaticSubstitution(bool value) {
+    if (this->useAutomaticSubstitution() == value)
+        return;
+    this->publishValue(&Snapshot::useAutomaticSubstitution, value);
     settings_->setValue(kKeyUseAutomaticSubstitution, value);
+    emit shortcutPreferencesChanged();
 }
 
 
@@ -844,7 +903,7 @@ void PreferencesManager::setUseAutomaticSubstitution(bool value) const {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::useAutomaticSubstitution() const {
-    return cache_->useAutomaticSubstitution;
+    return this->snapshot()->useAutomaticSubstitution;
 }
 
 
@@ -852,7 +911,9 @@ bool PreferencesManager::useAutomaticSubstitution() const {
 /// \param[in] value The value for the preference.
 //****************************************************************************************************************************************************
 void PreferencesManager::setComboTriggersOnSpace(bool value) const {
-    cache_->comboTriggersOnSpace = value;
+    if (this->comboTriggersOnSpace() == value)
+        return;
+    this->publishValue(&Snapshot::comboTriggersOnSpace, value);
     settings_->setValue(kKeyComboTriggersOnSpace, value);
 }
 
@@ -861,7 +922,7 @@ void PreferencesManager::setComboTriggersOnSpace(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::comboTriggersOnSpace() const {
-    return cache_->comboTriggersOnSpace;
+    return this->snapshot()->comboTriggersOnSpace;
 }
 
 
@@ -869,7 +930,7 @@ bool PreferencesManager::comboTriggersOnSpace() const {
 /// \param[in] value The value for the preference.
 //****************************************************************************************************************************************************
 void PreferencesManager::setKeepFinalSpaceCharacter(bool value) const {
-    cache_->keepFinalSpaceCharacter = value;
+    this->publishValue(&Snapshot::keepFinalSpaceCharacter, value);
     settings_->setValue(kKeyKeepFinalSpaceCharacter, value);
 }
 
@@ -878,7 +939,7 @@ void PreferencesManager::setKeepFinalSpaceCharacter(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::keepFinalSpaceCharacter() const {
-    return cache_->keepFinalSpaceCharacter;
+    return this->snapshot()->keepFinalSpaceCharacter;
 }
 
 
@@ -887,6 +948,7 @@ bool PreferencesManager::keepFinalSpaceCharacter() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setWarnAboutShortComboKeywords(bool value) const {
     settings_->setValue(kKeyWarnAboutShortComboKeyword, value);
+    this->publishValue(&Snapshot::warnAboutShortComboKeywords, value);
 }
 
 
@@ -894,7 +956,7 @@ void PreferencesManager::setWarnAboutShortComboKeywords(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::warnAboutShortComboKeywords() const {
-    return this->readSettings<bool>(kKeyWarnAboutShortComboKeyword, kDefaultWarnAboutShortComboKeyword);
+    return this->snapshot()->warnAboutShortComboKeywords;
 }
 
 
@@ -903,6 +965,7 @@ bool PreferencesManager::warnAboutShortComboKeywords() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setWarnAboutEmptyComboKeywords(bool value) const {
     settings_->setValue(kKeyWarnAboutEmptyComboKeyword, value);
+    this->publishValue(&Snapshot::warnAboutEmptyComboKeywords, value);
 }
 
 
@@ -911,7 +974,7 @@ void PreferencesManager::setWarnAboutEmptyComboKeywords(bool value) const {
 //
 //****************************************************************************************************************************************************
 bool PreferencesManager::warnAboutEmptyComboKeywords() const {
-    return this->readSettings<bool>(kKeyWarnAboutEmptyComboKeyword, kDefaultWarnAboutEmptyComboKeyword);
+    return this->snapshot()->warnAboutEmptyComboKeywords;
 }
 
 
@@ -954,14 +1017,15 @@ QString PreferencesManager::defaultComboListFolderPath() {
 //****************************************************************************************************************************************************
 /// \param[in] shortcut The shortcut
 //****************************************************************************************************************************************************
-void PreferencesManager::setComboTriggerShortcut(SpShortcut const &shortcut) const {
+void PreferencesManager::setComboTriggerShortcut(SpShortcut const &shortcut) {
     SpShortcut const newShortcut = shortcut ? shortcut : kDefaultComboTriggerShortcut;
     SpShortcut currentShortcut = this->comboTriggerShortcut();
     if (!currentShortcut)
         currentShortcut = kDefaultComboTriggerShortcut;
     if (*newShortcut != *currentShortcut) {
         settings_->setValue(kKeyComboTriggerShortcut, newShortcut->toCombined());
-        cache_->comboTriggerShortcut = newShortcut;
+        this->publishValue(&Snapshot::comboTriggerShortcut, newShortcut);
+        emit shortcutPreferencesChanged();
     }
 }
 
@@ -970,7 +1034,7 @@ void PreferencesManager::setComboTriggerShortcut(SpShortcut const &shortcut) con
 /// \return The shortcut
 //****************************************************************************************************************************************************
 SpShortcut PreferencesManager::comboPickerShortcut() const {
-    return cache_->comboPickerShortcut;
+    return this->snapshot()->comboPickerShortcut;
 }
 
 
@@ -989,6 +1053,7 @@ SpShortcut PreferencesManager::defaultComboPickerShortcut() {
 //****************************************************************************************************************************************************
 void PreferencesManager::setAutoBackup(bool value) const {
     settings_->setValue(kKeyAutoBackup, value);
+    this->publishValue(&Snapshot::autoBackup, value);
 }
 
 
@@ -996,7 +1061,7 @@ void PreferencesManager::setAutoBackup(bool value) const {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::autoBackup() const {
-    return this->readSettings<bool>(kKeyAutoBackup, kDefaultAutoBackup);
+    return this->snapshot()->autoBackup;
 }
 
 
@@ -1006,6 +1071,7 @@ bool PreferencesManager::autoBackup() const {
 void PreferencesManager::setUseCustomBackupLocation(bool value) const {
     QString const oldPath = globals::backupFolderPath();
     settings_->setValue(kKeyUseCustomBackupLocation, value);
+    this->publishValue(&Snapshot::useCustomBackupLocation, value);
     QString const newPath = globals::backupFolderPath();
     if (QDir(oldPath).canonicalPath() != globals::backupFolderPath())
         BackupManager::moveBackupFolder(oldPath, newPath);
@@ -1016,7 +1082,7 @@ void PreferencesManager::setUseCustomBackupLocation(bool value) const {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::useCustomBackupLocation() const {
-    return this->readSettings<bool>(kKeyUseCustomBackupLocation, kDefaultUseCustomBackupLocation);
+    return this->snapshot()->useCustomBackupLocation;
 }
 
 
@@ -1026,6 +1092,7 @@ bool PreferencesManager::useCustomBackupLocation() const {
 void PreferencesManager::setCustomBackupLocation(QString const &path) const {
     QString const oldPath = globals::backupFolderPath();
     settings_->setValue(kKeyCustomBackupLocation, path);
+    this->publishValue(&Snapshot::customBackupLocation, path);
     QString const newPath = globals::backupFolderPath();
     if (QDir(oldPath).canonicalPath() != globals::backupFolderPath())
         BackupManager::moveBackupFolder(oldPath, newPath);
@@ -1036,7 +1103,7 @@ void PreferencesManager::setCustomBackupLocation(QString const &path) const {
 /// \return The custom backup location.
 //****************************************************************************************************************************************************
 QString PreferencesManager::customBackupLocation() const {
-    return this->readSettings<QString>(kKeyCustomBackupLocation, globals::defaultBackupFolderPath());
+    return this->snapshot()->customBackupLocation;
 }
 
 
@@ -1048,6 +1115,7 @@ void PreferencesManager::setWriteDebugLogFile(bool value) {
     if (value == currentValue)
         return;
     settings_->setValue(kKeyWriteDebugLogFile, value);
+    this->publishValue(&Snapshot::writeDebugLogFile, value);
     emit writeDebugLogFileChanged(value);
 }
 
@@ -1056,7 +1124,7 @@ void PreferencesManager::setWriteDebugLogFile(bool value) {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::writeDebugLogFile() const {
-    return this->readSettings<bool>(kKeyWriteDebugLogFile, kDefaultWriteDebugLogFile);
+    return this->snapshot()->writeDebugLogFile;
 }
 
 
@@ -1088,16 +1156,19 @@ SpShortcut PreferencesManager::defaultComboTriggerShortcut() {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::emojiShortcodesEnabled() const {
-    return cache_->emojiShortcodesEnabled;
+    return this->snapshot()->emojiShortcodesEnabled;
 }
 
 
 //****************************************************************************************************************************************************
 /// \param[in] value The value for the preference
 //****************************************************************************************************************************************************
-void PreferencesManager::setEmojiShortcodeEnabled(bool value) const {
-    cache_->emojiShortcodesEnabled = value;
+void PreferencesManager::setEmojiShortcodeEnabled(bool value) {
+    if (this->emojiShortcodesEnabled() == value)
+        return;
+    this->publishValue(&Snapshot::emojiShortcodesEnabled, value);
     settings_->setValue(kKeyEmojiShortcodesEnabled, value);
+    emit emojiPreferencesChanged();
 }
 
 
@@ -1105,7 +1176,7 @@ void PreferencesManager::setEmojiShortcodeEnabled(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 QString PreferencesManager::emojiLeftDelimiter() const {
-    QString const result = cache_->emojiLeftDelimiter;
+    QString const result = this->snapshot()->emojiLeftDelimiter;
     return result.isEmpty() ? kDefaultEmojiLeftDelimiter : result;
 }
 
@@ -1113,9 +1184,12 @@ QString PreferencesManager::emojiLeftDelimiter() const {
 //****************************************************************************************************************************************************
 /// \param[in] delimiter The value for the preference.
 //****************************************************************************************************************************************************
-void PreferencesManager::setEmojiLeftDelimiter(QString const &delimiter) const {
-    cache_->emojiLeftDelimiter = delimiter;
+void PreferencesManager::setEmojiLeftDelimiter(QString const &delimiter) {
+    if (this->snapshot()->emojiLeftDelimiter == delimiter)
+        return;
+    this->publishValue(&Snapshot::emojiLeftDelimiter, delimiter);
     settings_->setValue(kKeyEmojiLeftDelimiter, delimiter);
+    emit emojiPreferencesChanged();
 }
 
 
@@ -1123,7 +1197,7 @@ void PreferencesManager::setEmojiLeftDelimiter(QString const &delimiter) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 QString PreferencesManager::emojiRightDelimiter() const {
-    QString const result = cache_->emojiRightDelimiter;
+    QString const result = this->snapshot()->emojiRightDelimiter;
     return result.isEmpty() ? kDefaultEmojiRightDelimiter : result;
 }
 
@@ -1131,9 +1205,12 @@ QString PreferencesManager::emojiRightDelimiter() const {
 //****************************************************************************************************************************************************
 /// \param[in] delimiter The value for the preference.
 //****************************************************************************************************************************************************
-void PreferencesManager::setEmojiRightDelimiter(QString const &delimiter) const {
-    cache_->emojiRightDelimiter = delimiter;
+void PreferencesManager::setEmojiRightDelimiter(QString const &delimiter) {
+    if (this->snapshot()->emojiRightDelimiter == delimiter)
+        return;
+    this->publishValue(&Snapshot::emojiRightDelimiter, delimiter);
     settings_->setValue(kKeyEmojiRightDelimiter, delimiter);
+    emit emojiPreferencesChanged();
 }
 
 
@@ -1141,7 +1218,7 @@ void PreferencesManager::setEmojiRightDelimiter(QString const &delimiter) const
 /// \param[in] show The value for the preference.
 //****************************************************************************************************************************************************
 void PreferencesManager::setShowEmojisInPickerWindow(bool show) const {
-    cache_->showEmojisInPickerWindow = show;
+    this->publishValue(&Snapshot::showEmojisInPickerWindow, show);
     settings_->setValue(kKeyShowEmojisInPickerWindow, show);
 }
 
@@ -1150,7 +1227,7 @@ void PreferencesManager::setShowEmojisInPickerWindow(bool show) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::showEmojisInPickerWindow() const {
-    return cache_->showEmojisInPickerWindow;
+    return this->snapshot()->showEmojisInPickerWindow;
 }
 
 
@@ -1158,7 +1235,7 @@ bool PreferencesManager::showEmojisInPickerWindow() const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 qint32 PreferencesManager::delayBetweenKeystrokesMs() const {
-    return qBound<qint32>(kMinValueDelayBetweenKeystrokesMs, this->readSettings<qint32>(kKeyDelayBetweenKeystrokes, kDefaultDelayBetweenKeystrokesMs), kMaxValueDelayBetweenKeystrokesMs);
+    return this->snapshot()->delayBetweenKeystrokesMs;
 }
 
 
@@ -1166,7 +1243,9 @@ qint32 PreferencesManager::delayBetweenKeystrokesMs() const {
 /// \param[in] value The value for the preference.
 //****************************************************************************************************************************************************
 void PreferencesManager::setDelayBetweenKeystrokesMs(qint32 value) const {
-    settings_->setValue(kKeyDelayBetweenKeystrokes, qBound<qint32>(kMinValueDelayBetweenKeystrokesMs, value, kMaxValueDelayBetweenKeystrokesMs));
+    qint32 const delay = qBound<qint32>(kMinValueDelayBetweenKeystrokesMs, value, kMaxValueDelayBetweenKeystrokesMs);
+    settings_->setValue(kKeyDelayBetweenKeystrokes, delay);
+    this->publishValue(&Snapshot::delayBetweenKeystrokesMs, delay);
 }
 
 
@@ -1190,7 +1269,7 @@ qint32 PreferencesManager::maxDelayBetweenKeystrokesMs() {
 /// \return the value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::comboPickerEnabled() const {
-    return cache_->comboPickerEnabled;
+    return this->snapshot()->comboPickerEnabled;
 }
 
 
@@ -1198,7 +1277,7 @@ bool PreferencesManager::comboPickerEnabled() const {
 /// \param[in] value The value for the preference.
 //****************************************************************************************************************************************************
 void PreferencesManager::setComboPickerEnabled(bool value) const {
-    cache_->comboPickerEnabled = value;
+    this->publishValue(&Snapshot::comboPickerEnabled, value);
     settings_->setValue(kKeyComboPickerEnabled, value);
 }
 
@@ -1207,16 +1286,20 @@ void PreferencesManager::setComboPickerEnabled(bool value) const {
 /// \return The trigger shortcut
 //****************************************************************************************************************************************************
 SpShortcut PreferencesManager::comboTriggerShortcut() const {
-    return cache_->comboTriggerShortcut;
+    return this->snapshot()->comboTriggerShortcut;
 }
 
 
 //****************************************************************************************************************************************************
 //\ param[in] mode The default matching mode
 //****************************************************************************************************************************************************
-void PreferencesManager::setDefaultMatchingMode(EMatchingMode mode) const {
-    cache_->defaultMatchingMode = mode;
+void PreferencesManager::setDefaultMatchingMode(EMatchingMode mode) {
+    if (this->snapshot()->defaultMatchingMode == mode)
+        return;
+    this->publishValue(&Snapshot::defaultMatchingMode, mode);
     settings_->setValue(kKeyDefaultMatchingMode, static_cast<qint32>(mode));
+    Combo::invalidateMatchDescriptors();
+    emit defaultMatchingOptionsChanged();
 }
 
 
@@ -1224,16 +1307,20 @@ void PreferencesManager::setDefaultMatchingMode(EMatchingMode mode) const {
 /// \return The default matching mode.
 //****************************************************************************************************************************************************
 EMatchingMode PreferencesManager::defaultMatchingMode() const {
-    return cache_->defaultMatchingMode;
+    return this->snapshot()->defaultMatchingMode;
 }
 
 
 //****************************************************************************************************************************************************
 /// \param[in] sensitivity The default case sensitivity.
 //****************************************************************************************************************************************************
-void PreferencesManager::setDefaultCaseSensitivity(ECaseSensitivity sensitivity) const {
-    cache_->defaultCaseSensitivity = sensitivity;
+void PreferencesManager::setDefaultCaseSensitivity(ECaseSensitivity sensitivity) {
+    if (this->snapshot()->defaultCaseSensitivity == sensitivity)
+        return;
+    this->publishValue(&Snapshot::defaultCaseSensitivity, sensitivity);
     settings_->setValue(kKeyDefaultCaseSensitivity, caseSensitivityToInt(sensitivity));
+    Combo::invalidateMatchDescriptors();
+    emit defaultMatchingOptionsChanged();
 }
 
 
@@ -1241,7 +1328,7 @@ void PreferencesManager::setDefaultCaseSensitivity(ECaseSensitivity sensitivity)
 /// \return The default case sensitivity.
 //****************************************************************************************************************************************************
 ECaseSensitivity PreferencesManager::defaultCaseSensitivity() const {
-    return cache_->defaultCaseSensitivity;
+    return this->snapshot()->defaultCaseSensitivity;
 }
 
 
@@ -1255,7 +1342,7 @@ void PreferencesManager::setComboPickerShortcut(SpShortcut const &shortcut) cons
         currentShortcut = defaultComboPickerShortcut();
     if (*newShortcut != *currentShortcut) {
         settings_->setValue(kKeyComboPickerShortcut, newShortcut->toCombined());
-        cache_->comboPickerShortcut = newShortcut;
+        this->publishValue(&Snapshot::comboPickerShortcut, newShortcut);
     }
 }
 
@@ -1271,9 +1358,12 @@ void PreferencesManager::applyLocalePreference() const {
 //****************************************************************************************************************************************************
 /// \param[in] enable The value for the preference.
 //****************************************************************************************************************************************************
-void PreferencesManager::setEnableAppEnableDisableShortcut(bool enable) const {
+void PreferencesManager::setEnableAppEnableDisableShortcut(bool enable) {
+    if (this->enableAppEnableDisableShortcut() == enable)
+        return;
     settings_->setValue(kKeyEnableAppEnableDisableShortcut, enable);
-    cache_->enableAppEnableDisableShortcut = enable;
+    this->publishValue(&Snapshot::enableAppEnableDisableShortcut, enable);
+    emit shortcutPreferencesChanged();
 }
 
 
@@ -1281,21 +1371,22 @@ void PreferencesManager::setEnableAppEnableDisableShortcut(bool enable) const {
 /// \return The value for the preference
 //****************************************************************************************************************************************************
 bool PreferencesManager::enableAppEnableDisableShortcut() const {
-    return cache_->enableAppEnableDisableShortcut;
+    return this->snapshot()->enableAppEnableDisableShortcut;
 }
 
 
 //****************************************************************************************************************************************************
 /// \param[in] shortcut The shortcut.
 //****************************************************************************************************************************************************
-void PreferencesManager::setAppEnableDisableShortcut(SpShortcut const &shortcut) const {
+void PreferencesManager::setAppEnableDisableShortcut(SpShortcut const &shortcut) {
     SpShortcut const newShortcut = shortcut ? shortcut : kDefaultAppEnableDisableShortcut;
     SpShortcut currentShortcut = this->appEnableDisableShortcut();
     if (!currentShortcut)
         currentShortcut = kDefaultAppEnableDisableShortcut;
     if (*newShortcut != *currentShortcut) {
         settings_->setValue(kKeyAppEnableShortcut, shortcut->toCombined());
-        cache_->appEnableDisableShortcut = newShortcut;
+        this->publishValue(&Snapshot::appEnableDisableShortcut, newShortcut);
+        emit shortcutPreferencesChanged();
     }
 }
 
@@ -1304,7 +1395,7 @@ void PreferencesManager::setAppEnableDisableShortcut(SpShortcut const &shortcut)
 /// \return The shortcut.
 //****************************************************************************************************************************************************
 SpShortcut PreferencesManager::appEnableDisableShortcut() const {
-    return cache_->appEnableDisableShortcut;
+    return this->snapshot()->appEnableDisableShortcut;
 }
 
 
@@ -1320,10 +1411,10 @@ SpShortcut PreferencesManager::defaultAppEnableDisableShortcut() {
 /// \param[in] enabled Is Beeftext enabled?
 //****************************************************************************************************************************************************
 void PreferencesManager::setBeeftextEnabled(bool enabled) const {
-    if (cache_->beeftextEnabled == enabled)
+    if (this->snapshot()->beeftextEnabled == enabled)
         return;
     settings_->setValue(kKeyBeeftextEnabled, enabled);
-    cache_->beeftextEnabled = enabled;
+    this->publishValue(&Snapshot::beeftextEnabled, enabled);
 }
 
 
@@ -1331,7 +1422,7 @@ void PreferencesManager::setBeeftextEnabled(bool enabled) const {
 /// \return true if and only if Beeftext is enabled.
 //****************************************************************************************************************************************************
 bool PreferencesManager::beeftextEnabled() const {
-    return cache_->beeftextEnabled;
+    return this->snapshot()->beeftextEnabled;
 }
 
 
@@ -1340,6 +1431,7 @@ bool PreferencesManager::beeftextEnabled() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setUseLegacyCopyPaste(bool value) const {
     settings_->setValue(kKeyUseLegacyCopyPaste, value);
+    this->publishValue(&Snapshot::useLegacyCopyPaste, value);
     ClipboardManager::setClipboardManagerType(value ? ClipboardManager::EType::Legacy :
         ClipboardManager::EType::Default);
 }
@@ -1349,7 +1441,7 @@ void PreferencesManager::setUseLegacyCopyPaste(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::useLegacyCopyPaste() const {
-    return readSettings<bool>(kKeyUseLegacyCopyPaste, kDefaultUseLegacyCopyPaste);
+    return this->snapshot()->useLegacyCopyPaste;
 }
 
 
@@ -1358,6 +1450,7 @@ bool PreferencesManager::useLegacyCopyPaste() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setRestoreClipboardAfterSubstitution(bool value) {
     settings_->setValue(kKeyRestoreClipboardAfterSubstitution, value);
+    this->publishValue(&Snapshot::restoreClipboardAfterSubstitution, value);
 }
 
 
@@ -1365,7 +1458,7 @@ void PreferencesManager::setRestoreClipboardAfterSubstitution(bool value) {
 // return The value for the 'Restore clipboard after substitution' preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::restoreClipboardAfterSubstitution() const {
-    return readSettings<bool>(kKeyRestoreClipboardAfterSubstitution, kDefaultRestoreClipboardAfterSubstitution);
+    return this->snapshot()->restoreClipboardAfterSubstitution;
 }
 
 
@@ -1390,6 +1483,7 @@ bool PreferencesManager::alreadyConvertedRichTextCombos() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setUseCustomPowershellVersion(bool value) const {
     settings_->setValue(kKeyUseCustomPowershellVersion, value);
+    this->publishValue(&Snapshot::useCustomPowershellVersion, value);
 }
 
 
@@ -1397,7 +1491,7 @@ void PreferencesManager::setUseCustomPowershellVersion(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::useCustomPowershellVersion() const {
-    return readSettings<bool>(kKeyUseCustomPowershellVersion, kDefaultUseCustomPowershellVersion);
+    return this->snapshot()->useCustomPowershellVersion;
 }
 
 
@@ -1406,6 +1500,7 @@ bool PreferencesManager::useCustomPowershellVersion() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setCustomPowershellPath(QString const &path) const {
     settings_->setValue(kKeyCustomPowershellPath, path);
+    this->publishValue(&Snapshot::customPowershellPath, path);
 }
 
 
@@ -1413,7 +1508,7 @@ void PreferencesManager::setCustomPowershellPath(QString const &path) const {
 /// \return The path of the custom PowerShell executable.
 //****************************************************************************************************************************************************
 QString PreferencesManager::customPowershellPath() const {
-    return readSettings<QString>(kKeyCustomPowershellPath, QString());
+    return this->snapshot()->customPowershellPath;
 }
 
 
@@ -1421,8 +1516,10 @@ QString PreferencesManager::customPowershellPath() const {
 /// \param[in] theme The theme.
 //****************************************************************************************************************************************************
 void PreferencesManager::setTheme(ETheme theme) const {
+    if (this->theme() == theme)
+        return;
     settings_->setValue(kKeyTheme, static_cast<qint32>(theme));
-    cache_->theme = theme;
+    this->publishValue(&Snapshot::theme, theme);
     applyThemePreferences(this->useCustomTheme(), theme);
 }
 
@@ -1431,7 +1528,7 @@ void PreferencesManager::setTheme(ETheme theme) const {
 /// \return The theme.
 //****************************************************************************************************************************************************
 ETheme PreferencesManager::theme() const {
-    return cache_->theme;
+    return this->snapshot()->theme;
 }
 
 
@@ -1456,7 +1553,7 @@ QByteArray PreferencesManager::comboPickerWindowGeometry() const {
 //****************************************************************************************************************************************************
 void PreferencesManager::setUseShiftInsertForPasting(bool value) const {
     settings_->setValue(kKeyUseShiftInsertForPasting, value);
-    cache_->useShiftInsertForPasting = value;
+    this->publishValue(&Snapshot::useShiftInsertForPasting, value);
 }
 
 
@@ -1464,7 +1561,7 @@ void PreferencesManager::setUseShiftInsertForPasting(bool value) const {
 /// \return The value for the preference.
 //****************************************************************************************************************************************************
 bool PreferencesManager::useShiftInsertForPasting() const {
-    return cache_->useShiftInsertForPasting;
+    return this->snapshot()->useShiftInsertForPasting;
 }
 
 
@@ -16,6 +16,8 @@
 #include "Combo/MatchingMode.h"
 #include "Combo/CaseSensitivity.h"
 #include <XMiLib/VersionNumber/VersionNumber.h>
+#include <atomic>
+#include <type_traits>
 
 
 //****************************************************************************************************************************************************
@@ -34,12 +36,12 @@ public: // member functions
     PreferencesManager &operator=(PreferencesManager const &) = delete; ///< Disabled assignment operator
     PreferencesManager &operator=(PreferencesManager &&) = delete; ///< Disabled move assignment operator
     QSettings &settings(); ///< Returns a reference the settings for the application.
-    void init() const; ///< Initialize the preferences manager.
+    void init(); ///< Initialize the preferences manager.
     void reset(); ///< Reset the preferences to their default values
     bool save(QString const &path) const; ///< Save the preference to a JSON file.
-    bool load(QString const &path) const; ///< Load the preference from a JSON file.
+    bool load(QString const &path); ///< Load the preference from a JSON file.
     void toJsonDocument(QJsonDocument &outDoc) const; ///< Copy the preferences to a JSON document.
-    void fromJsonDocument(QJsonDocument const &doc) const; ///< Load the preferences from a JSON document.
+    void fromJsonDocument(QJsonDocument const &doc); ///< Load the preferences from a JSON document.
     void resetWarnings() const; ///< Reset the warnings
     void setAlreadyLaunched() const; ///< Set the value for the 'First Launch' preference to false
     bool alreadyLaunched() const; ///< Test whether this is the first time the application is launched
@@ -66,7 +68,7 @@ public: // member functions
     bool autoCheckForUpdates() const; ///< Set the value for the 'Auto check for updates preference
     void setUseCustomTheme(bool value) const; ///< Set the value for the 'Use custom theme' preference
     bool useCustomTheme() const; ///< Get the value for the 'Use custom theme' preference
-    void setUseAutomaticSubstitution(bool value) const; ///< Set the value for the 'Use automatic substitution' preference
+    void setUseAutomaticSubstitution(bool value); ///< Set the value for the 'Use automatic substitution' preference
     bool useAutomaticSubstitution() const; ///< Get the value for the 'Use automatic substitution' preference
     void setComboTriggersOnSpace(bool value) const; ///< Set the value for the 'Combo triggers on space' preference.
     bool comboTriggersOnSpace() const; ///< Set the value for the 'Combo triggers on space' preference.
@@ -79,11 +81,11 @@ public: // member functions
     bool setComboListFolderPath(QString const &path) const; ///< Set the path of the folder for saving the combo list
     QString comboListFolderPath() const; ///< Get the path of the folder for saving the combo list
     static QString defaultComboListFolderPath(); ///< Get the default combo list folder path
-    void setComboTriggerShortcut(SpShortcut const &shortcut) const; ///< Set the combo trigger shortcut
+    void setComboTriggerShortcut(SpShortcut const &shortcut); ///< Set the combo trigger shortcut
     SpShortcut comboTriggerShortcut() const; ///< Retrieve the combo trigger shortcut
-    void setDefaultMatchingMode(EMatchingMode mode) const; ///< Set the value for the 'Default matching mode' preference.
+    void setDefaultMatchingMode(EMatchingMode mode); ///< Set the value for the 'Default matching mode' preference.
     EMatchingMode defaultMatchingMode() const; ///< Get the value for the 'Default matching mode' preference.
-    void setDefaultCaseSensitivity(ECaseSensitivity sensitivity) const; ///< Set the value for the 'Default case sensitivity' preference
+    void setDefaultCaseSensitivity(ECaseSensitivity sensitivity); ///< Set the value for the 'Default case sensitivity' preference
     ECaseSensitivity defaultCaseSensitivity() const; ///< Set the value for the 'Default case sensitivity' preference
     void setAutoBackup(bool value) const; ///< Set the value for the 'Auto backup' preference
     bool autoBackup() const; ///< Get the value for the 'Auto backup' preference
@@ -97,11 +99,11 @@ public: // member functions
     void setLastComboImportExportPath(QString const &path) const; ///< Retrieve the path of the last imported and exported path
     static SpShortcut defaultComboTriggerShortcut(); ///< Reset the combo trigger shortcut to its default value
     bool emojiShortcodesEnabled() const; ///< Are emoji shortcodes enabled
-    void setEmojiShortcodeEnabled(bool value) const; ///< Set if the emoji shortcodes are enabled
+    void setEmojiShortcodeEnabled(bool value); ///< Set if the emoji shortcodes are enabled
     QString emojiLeftDelimiter() const; ///< Get the left delimiter for emojis.
-    void setEmojiLeftDelimiter(QString const &delimiter) const; ///< Set the left delimiter for emojis.
+    void setEmojiLeftDelimiter(QString const &delimiter); ///< Set the left delimiter for emojis.
     QString emojiRightDelimiter() const; ///< Get the right delimiter for emojis.
-    void setEmojiRightDelimiter(QString const &delimiter) const; ///< Set the right delimiter for emojis.
+    void setEmojiRightDelimiter(QString const &delimiter); ///< Set the right delimiter for emojis.
     void setShowEmojisInPickerWindow(bool show) const; ///< Set the value for the 'Show Emojis in picker window.
     bool showEmojisInPickerWindow() const; ///< Get the value for the 'Show Emojis in picker window.
     qint32 delayBetweenKeystrokesMs() const; ///< Get the 'delay between keystrokes' when not using the clipboard for combo substitution
@@ -113,9 +115,9 @@ public: // member functions
     void setComboPickerShortcut(SpShortcut const &shortcut) const; ///< Set the combo picker shortcut.
     SpShortcut comboPickerShortcut() const; ///< Retrieve the combo picker shortcut.
     static SpShortcut defaultComboPickerShortcut(); ///< Return the default combo picker shortcut.
-    void setEnableAppEnableDisableShortcut(bool enable) const; ///< Get the value for the 'Enable app enable/disable' shortcut.
+    void setEnableAppEnableDisableShortcut(bool enable); ///< Get the value for the 'Enable app enable/disable' shortcut.
     bool enableAppEnableDisableShortcut() const; ///< Get the value for the 'Enable app enable/disable' shortcut.
-    void setAppEnableDisableShortcut(SpShortcut const &shortcut) const; ///< Set the shortcut short to enable/disable the application.
+    void setAppEnableDisableShortcut(SpShortcut const &shortcut); ///< Set the shortcut short to enable/disable the application.
     SpShortcut appEnableDisableShortcut() const; ///< Retrieve the shortcut to enable/disable the application.
     static SpShortcut defaultAppEnableDisableShortcut(); ///< Return the default combo shortcut to enable/disable the application.
     void setBeeftextEnabled(bool enabled) const; ///< Set if beeftext is enabled.
@@ -143,58 +145,78 @@ public: // member functions
 signals:
     void autoCheckForUpdatesChanged(bool value); ///< Signal emitted when the 'Auto check for updates' preference value changed
     void writeDebugLogFileChanged(bool value); ///< Signal emitted when the 'Write debug log file' preference value changed.s
+    void defaultMatchingOptionsChanged(); ///< Signal emitted when the default matching mode or the default case sensitivity changed.
+    void emojiPreferencesChanged(); ///< Signal emitted when the emoji shortcodes were enabled or disabled, or when their delimiters changed.
+    void shortcutPreferencesChanged(); ///< Signal emitted when a preference affecting the shortcuts processed by the input manager may have changed.
+
+private: // data types
+    class Snapshot {
+    public: // member functions
+        Snapshot() = default; ///< Default constructor.
+        Snapshot(Snapshot const &) = default; ///< Default copy-constructor.
+        Snapshot(Snapshot &&) = delete; ///< Disabled assignment copy-constructor.
+        ~Snapshot() = default; ///< Destructor.
+        Snapshot &operator=(Snapshot const &) = delete; ///< Disabled assignment operator.
+        Snapshot &operator=(Snapshot &&) = delete; ///< Disabled move assignment operator.
+        void init(QSettings &settings); ///< Initialize the snapshot from the settings.
+
+    public: // data members
+        bool useAutomaticSubstitution { true }; ///< Value for the 'use automatic substitution' preference value
+        bool comboTriggersOnSpace { false }; ///< Value for the 'combo trigger on space' preference.
+        bool keepFinalSpaceCharacter { false }; ///< Value for the 'keep final space character' preference.
+        SpShortcut comboTriggerShortcut; ///< Value for the 'combo trigger shortcut' preference
+        bool comboPickerEnabled { true }; ///< Value for the 'Combo picker enabled' preference.
+        SpShortcut comboPickerShortcut; ///< Value for the 'combo picker shortcut' preference
+        EMatchingMode defaultMatchingMode { EMatchingMode::Strict }; ///< Value for the 'Default matching mode' preference.
+        ECaseSensitivity defaultCaseSensitivity { ECaseSensitivity::CaseSensitive }; ///< Valur for the 'Default case sensitivity' preference.
+        bool enableAppEnableDisableShortcut { true }; ///< Value for the 'app enable/disable shortcut' preference.
+        SpShortcut appEnableDisableShortcut; ///< Value for the 'app enable/disable shortcut' preference.
+        bool emojiShortcodesEnabled { false }; ///< Value for the 'emoji shortcodes enabled' preference
+        QString emojiLeftDelimiter; ///< Value for the 'emoji left delimiter' preference.
+        QString emojiRightDelimiter; ///< Value for the 'emoji right delimiter' preference.
+        bool showEmojisInPickerWindow { false }; ///< Value for the 'Show emojis in picker window' preference.
+        bool beeftextEnabled { true }; ///< Value for the 'Beeftext enabled' preference.
+        bool useCustomTheme { true }; ///< Value for the 'Use custom theme' preference.
+        ETheme theme { ETheme::Light }; ///< Value for the 'Theme' preference.
+        bool useShiftInsertForPasting { false }; ///< Value for use 'Use Shift+Insert for pasting' preference.
+        bool playSoundOnCombo { true }; ///< Value for the 'Play sound on combo' preference.
+        bool useCustomSound { false }; ///< Value for the 'Use custom sound' preference.
+        QString customSoundPath; ///< Value for the 'Custom sound path' preference.
+        qint32 delayBetweenKeystrokesMs { 12 }; ///< Value for the 'Delay between keystrokes' preference.
+        bool useLegacyCopyPaste { false }; ///< Value for the 'Use legacy copy/paste' preference.
+        bool restoreClipboardAfterSubstitution { true }; ///< Value for the 'Restore clipboard after substitution' preference.
+        bool useCustomPowershellVersion { false }; ///< Value for the 'Use custom PowerShell version' preference.
+        QString customPowershellPath; ///< Value for the 'Custom PowerShell path' preference.
+        bool autoCheckForUpdates { true }; ///< Value for the 'Auto check for updates' preference.
+        bool warnAboutShortComboKeywords { true }; ///< Value for the 'Warn about short combo keyword' preference.
+        bool warnAboutEmptyComboKeywords { true }; ///< Value for the 'Warn about empty combo keyword' preference.
+        bool autoBackup { true }; ///< Value for the 'Auto backup' preference.
+        bool useCustomBackupLocation { false }; ///< Value for the 'Use custom backup location' preference.
+        QString customBackupLocation; ///< Value for the 'Custom backup location' preference.
+        bool writeDebugLogFile { true }; ///< Value for the 'Write debug log file' preference.
+
+    private: // member functions
+        void readComboTriggerShortcut(QSettings &settings); ///< Read the combo trigger shortcut
+        void readComboPickerShortcut(QSettings &settings); ///< Read the combo picker shortcut
+        void readAppEnableDisableShortcut(QSettings &settings); ///< Read the app enable/disable shortcut.
+        void readThemePrefs(QSettings &settings); ///< Read the theme preferences.
+        static EMatchingMode readDefaultMatchingModeFromPreferences(QSettings &settings); ///< Get the value for the 'Default matching mode' preference.
+        static ECaseSensitivity readDefaultCaseSensitivityFromPreferences(QSettings &settings); ///< Get the value for the 'Default case sensitivity' preference.
+    }; ///< An immutable snapshot of the preferences, that can be read from any thread without waiting for a snapshot to be built.
+    typedef std::shared_ptr<Snapshot const> SpSnapshot; ///< Type definition for shared pointer to Snapshot
 
 private: // member functions
     PreferencesManager(); ///< Default constructor
     void applyLocalePreference() const; ///< Apply the preference for the locale
     template<typename T>
     T readSettings(QString const &key, T const &defaultValue = T()) const; ///< Read a value of a given type read from the settings
+    SpSnapshot snapshot() const; ///< Return the current snapshot of the preferences
+    template<typename T>
+    void publishValue(T Snapshot::*member, std::type_identity_t<T> const &value) const; ///< Publish a new snapshot with a modified value
 
 private: // data members
-    class Cache {
-    public: // member functions
-        explicit Cache(QSettings &settings)
-            : settings_(settings) {} ///< Default constructor.
-        Cache(Cache const &) = delete; ///< Disabled copy-constructor.
-        Cache(Cache &&) = delete; ///< Disabled assignment copy-constructor.
-        ~Cache() = default; ///< Destructor.
-        Cache &operator=(Cache const &) = delete; ///< Disabled assignment operator.
-        Cache &operator=(Cache &&) = delete; ///< Disabled move assignment operator.
-        void init(); ///< Initialize the cache.
-
-    public: // data members
-        bool useAutomaticSubstitution { true }; ///< Cached value for the 'use automatic substitution' preference value
-        bool comboTriggersOnSpace { false }; ///< Cached value for the 'combo trigger on space' preference.
-        bool keepFinalSpaceCharacter { false }; ///< Cached value for the 'keep final space character' preference.
-        SpShortcut comboTriggerShortcut; ///< Cached value for the 'combo trigger shortcut' preference
-        bool comboPickerEnabled { true }; ///< Cached value for the 'Combo picker enabled' preference.
-        SpShortcut comboPickerShortcut; ///< Cached value for the 'combo picker shortcut' preference
-        EMatchingMode defaultMatchingMode { EMatchingMode::Strict }; ///< Cached value for the 'Default matching mode' preference.
-        ECaseSensitivity defaultCaseSensitivity { ECaseSensitivity::CaseSensitive }; ///< Cached valur for the 'Default case sensitivity' preference.
-        bool enableAppEnableDisableShortcut { true }; ///< Cached value for the 'app enable/disable shortcut' preference.
-        SpShortcut appEnableDisableShortcut; ///< Cached value for the 'app enable/disable shortcut' preference.
-        bool emojiShortcodesEnabled { false }; ///< Cached value for the 'emoji shortcodes enabled' preference
-        QString emojiLeftDelimiter; ///< Cached value for the 'emoji left delimiter' preference.
-        QString emojiRightDelimiter; ///< Cached value for the 'emoji right delimiter' preference.
-        bool showEmojisInPickerWindow { false }; ///< Cached value for the 'Show emojis in picker window' preference.
-        bool beeftextEnabled { true }; ///< Cached value for the 'Beeftext enabled' preference.
-        bool useCustomTheme { true }; ///< Cached value for the 'Use custom theme' preference.
-        ETheme theme { ETheme::Light }; ///< Cached value for the 'Theme' preference.
-        bool useShiftInsertForPasting { false }; ///< Cached value for use 'Use Shift+Insert for pasting' preference.
-
-    private: // member functions
-        void cacheComboTriggerShortcut(); ///< Read the combo trigger shortcut and cache it for faster access
-        void cacheComboPickerShortcut(); ///< Read the combo picker shortcut and cache it for faster access
-        void cacheAppEnableDisableShortcut(); ///< Read the app enable/disable shortcut and cache it for faster access.
-        void cacheThemePrefs(); ///< Read the theme and cache it for faster access.
-        EMatchingMode readDefaultMatchingModeFromPreferences() const; ///< Get the value for the 'Default matching mode' preference.
-        ECaseSensitivity readDefaultCaseSensitivityFromPreferences() const; ///< Get the value for the 'Default case sensitivity' preference.
-
-    private: // data members
-        QSettings &settings_; ///< The settings
-    }; ///< A cache for fast access to critical preferences.
     std::unique_ptr<QSettings> settings_ { nullptr }; ///< The Qt settings instance.
-    std::unique_ptr<Cache> cache_ { nullptr }; ///< The cache (implemented as pimpl).
+    mutable std::atomic<SpSnapshot> snapshot_; ///< The current snapshot of the preferences. Never null once the manager is initialized. Not lock-free (see snapshot())
 };
 
 
@@ -14,11 +14,21 @@
 using namespace xmilib;
 
 
+namespace {
+
+
+qint32 constexpr kMemoCapacity = 32; ///< The maximum number of process names whose filter result is memoized
+
+
+} // anonymous namespace
+
+
 //****************************************************************************************************************************************************
 /// \param[in] description A description of the list to be displayed in the edition dialog.
 //****************************************************************************************************************************************************
 ProcessListManager::ProcessListManager(QString description)
     : description_(description) {
+    this->compile();
 }
 
 
@@ -37,8 +47,10 @@ void ProcessListManager::setFilePath(QString const &filePath) {
 //****************************************************************************************************************************************************
 bool ProcessListManager::load() {
     processList_.clear();
-    if (!QFile(filePath_).exists())
+    if (!QFile(filePath_).exists()) {
+        this->compile();
         return true;
+    }
 
     QString errorMsg;
     bool const result = loadStringListFromJsonFile(filePath_, processList_, &errorMsg);
@@ -46,6 +58,7 @@ bool ProcessListManager::load() {
         globals::debugLog().addError(QString("%1(): %2").arg(__FUNCTION__).arg(errorMsg));
         processList_.clear();
     }
+    this->compile();
     return result;
 }
 
@@ -63,14 +76,27 @@ bool ProcessListManager::save() const {
 
 
 //****************************************************************************************************************************************************
+/// \brief The function is called for every keystroke, with the same process name most of the time, so the results
+/// are memoized for the most recently used process names.
+///
 /// \param[in] processName The name of the executable, including its extension (e.g. "putty.exe")
 /// \return true if and only if the application support pasting using the Ctrl+V shortcut
 //****************************************************************************************************************************************************
 bool ProcessListManager::filter(QString const &processName) const {
-    std::function<bool(QString const &)> const predicate = [&](QString const &str) -> bool {
-        return QRegularExpression(QRegularExpression::wildcardToRegularExpression(str), QRegularExpression::CaseInsensitiveOption).match(processName).hasMatch();
-    };
-    return processList_.end() != std::find_if(processList_.begin(), processList_.end(), predicate);
+    QHash<QString, MemoEntry>::iterator const it = memo_.find(processName);
+    if (it != memo_.end()) {
+        it->lastUse = ++memoClock_;
+        return it->result;
+    }
+
+    bool const result = this->match(processName);
+    if (memo_.size() >= kMemoCapacity) { // we evict the least recently used entry
+        QHash<QString, MemoEntry>::iterator const lru = std::min_element(memo_.begin(), memo_.end(),
+            [](MemoEntry const &lhs, MemoEntry const &rhs) -> bool { return lhs.lastUse < rhs.lastUse; });
+        memo_.erase(lru);
+    }
+    memo_.insert(processName, { result, ++memoClock_ });
+    return result;
 }
 
 
@@ -91,6 +117,7 @@ bool ProcessListManager::runDialog(QWidget *parent) {
     if (QDialog::Accepted != dlg.exec())
         return false;
     processList_ = dlg.stringList();
+    this->compile();
     bool const result = this->save();
     if (!result)
         QMessageBox::critical(nullptr, QObject::tr("Error"), QObject::tr("The file could not be saved."));
@@ -103,6 +130,7 @@ bool ProcessListManager::runDialog(QWidget *parent) {
 //****************************************************************************************************************************************************
 void ProcessListManager::clear() {
     processList_.clear();
+    this->compile();
 }
 
 
@@ -111,6 +139,7 @@ void ProcessListManager::clear() {
 //****************************************************************************************************************************************************
 void ProcessListManager::addProcess(QString const &process) {
     processList_.append(process);
+    this->compile();
 }
 
 
@@ -119,5 +148,35 @@ void ProcessListManager::addProcess(QString const &process) {
 //****************************************************************************************************************************************************
 void ProcessListManager::addProcesses(QStringList const &processes) {
     processList_.append(processes);
+    this->compile();
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Each wildcard entry is converted to an anchored regular expression, and the expressions are combined as
+/// alternatives, so that a process name is tested against the whole list in a single match.
+//****************************************************************************************************************************************************
+void ProcessListManager::compile() {
+    memo_.clear();
+    QStringList patterns;
+    patterns.reserve(processList_.size());
+    for (QString const &process: processList_)
+        patterns.append(QString("(?:%1)").arg(QRegularExpression::wildcardToRegularExpression(process)));
+    regExp_ = patterns.isEmpty() ? QRegularExpression() :
+        QRegularExpression(patterns.join('|'), QRegularExpression::CaseInsensitiveOption);
+    if (!regExp_.isValid()) {
+        globals::debugLog().addError(QString("%1(): %2").arg(__FUNCTION__).arg(regExp_.errorString()));
+        regExp_ = QRegularExpression();
+    }
+    regExp_.optimize();
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] processName The name of the executable, including its extension (e.g. "putty.exe")
+/// \return true if and only if the process name matches one of the entries of the process list.
+//****************************************************************************************************************************************************
+bool ProcessListManager::match(QString const &processName) const {
+    return (!regExp_.pattern().isEmpty()) && regExp_.match(processName).hasMatch();
 }
 
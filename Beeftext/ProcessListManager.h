@@ -31,10 +31,23 @@ public: // member functions
     void addProcess(QString const &process); ///< Add an entry to the process list
     void addProcesses(QStringList const &processes); ///< Add an entry to the process list
 
+private: // data types
+    struct MemoEntry {
+        bool result { false }; ///< The result of the filter for the process name
+        quint64 lastUse { 0 }; ///< The value of the memo clock when the entry was last used
+    }; ///< Type definition for an entry in the memo of filter results
+
+private: // member functions
+    void compile(); ///< Compile the process list into a single regular expression and clear the memo
+    bool match(QString const &processName) const; ///< Check whether a process name matches the compiled process list
+
 private: // data members
     QString description_; ///< The description of the list, to be displayed in the edition dialog.
     QString filePath_; ///< The path of the process list file used for I/O.
     QStringList processList_; ///< The list of sensitive applications
+    QRegularExpression regExp_; ///< The regular expression combining all the entries of the process list
+    mutable QHash<QString, MemoEntry> memo_; ///< The memo of the filter results, indexed by process name
+    mutable quint64 memoClock_ { 0 }; ///< The clock used to find the least recently used entry of the memo
 };
 
 
@@ -73,10 +73,7 @@ QKeyCombination Shortcut::keyCombination() const {
 /// \return true if and only if the shortcut is valid
 //****************************************************************************************************************************************************
 bool Shortcut::isValid() const {
-    Qt::KeyboardModifiers const mods = keyCombination_.keyboardModifiers();
-    Qt::Key const key = keyCombination_.key();
-    return (mods.testFlag(Qt::ControlModifier) || mods.testFlag(Qt::AltModifier) || mods.testFlag(Qt::MetaModifier)) &&
-           (key != 0) && (key != Qt::Key_unknown);
+    return isValidKeyCombination(keyCombination_);
 }
 
 
@@ -146,3 +143,15 @@ SpShortcut Shortcut::fromKeyCombination(QKeyCombination const &keyCombination) {
 SpShortcut Shortcut::fromCombined(qint32 combined) {
     return std::make_shared<Shortcut>(combined);
 }
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keyCombination The key combination.
+/// \return true if and only if the key combination is a valid shortcut.
+//****************************************************************************************************************************************************
+bool Shortcut::isValidKeyCombination(QKeyCombination const &keyCombination) {
+    Qt::KeyboardModifiers const mods = keyCombination.keyboardModifiers();
+    Qt::Key const key = keyCombination.key();
+    return (mods.testFlag(Qt::ControlModifier) || mods.testFlag(Qt::AltModifier) || mods.testFlag(Qt::MetaModifier)) &&
+           (key != 0) && (key != Qt::Key_unknown);
+}
@@ -44,6 +44,7 @@ public: // static member functions
     static SpShortcut fromString(QString const &str); ///< Create a SpShortcut from a string (e.g. 'Ctrl+Shift+F2').
     static SpShortcut fromKeyCombination(QKeyCombination const &keyCombination); ///< Create a SpShortcut from a key combination.
     static SpShortcut fromCombined(qint32 combined); ///< Create a SpShortcut from a packed integer.
+    static bool isValidKeyCombination(QKeyCombination const &keyCombination); ///< Check whether a key combination is a valid shortcut
 
 private: // data members
     QKeyCombination keyCombination_; ///< The key combination for the shortcut
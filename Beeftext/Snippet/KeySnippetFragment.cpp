@@ -10,7 +10,7 @@
 #include "stdafx.h"
 #include "KeySnippetFragment.h"
 #include "Preferences/PreferencesManager.h"
-#include <XMiLib/SystemUtils.h>
+#include "KeySynthesizer.h"
 
 
 namespace {
@@ -95,8 +95,9 @@ QString KeySnippetFragment::toString() const {
 //****************************************************************************************************************************************************
 void KeySnippetFragment::render() const {
     PreferencesManager const &prefs = PreferencesManager::instance();
+    KeySynthesizer &synthesizer = KeySynthesizer::instance();
     for (qint32 i = 0; i < repeatCount_; ++i) {
-        xmilib::synthesizeKeyDownAndUp(key_);
+        synthesizer.keyDownAndUp(key_);
         if (i != repeatCount_ - 1)
             QThread::msleep(prefs.delayBetweenKeystrokesMs());
     }
@@ -13,94 +13,167 @@
 #include "ShortcutSnippetFragment.h"
 #include "DelaySnippetFragment.h"
 #include "KeySnippetFragment.h"
-#include "BeeftextConstants.h"
+#include "SubstitutionTracer.h"
 
 
 namespace {
 
 
 qint32 constexpr kDelayBetweenFragmentsMs = 100; ///< THe delay between fragments in milliseconds
+QString const kVariableStart = "#{"; ///< The opening of a variable.
+QString const kDelayVariable = "delay:"; ///< The prefix of the delay variable.
+QString const kKeyVariable = "key:"; ///< The prefix of the key variable.
+QString const kShortcutVariable = "shortcut:"; ///< The prefix of the shortcut variable.
 
 
+//****************************************************************************************************************************************************
+/// \brief Return the end of the run of ASCII digits starting at a given position.
+///
+/// \param[in] str The string.
+/// \param[in] pos The position.
+/// \return The position of the first character that is not a digit.
+//****************************************************************************************************************************************************
+qsizetype skipDigits(QString const &str, qsizetype pos) {
+    while ((pos < str.size()) && (str[pos] >= '0') && (str[pos] <= '9'))
+        ++pos;
+    return pos;
 }
 
 
 //****************************************************************************************************************************************************
-/// \brief split a string into snippet fragment at the #{key:} variable.
+/// \brief Return the end of the run of ASCII word characters (letters, digits and underscore) starting at a given position.
+///
 /// \param[in] str The string.
-/// \return the text split into fragments
+/// \param[in] pos The position.
+/// \return The position of the first character that is not a word character.
 //****************************************************************************************************************************************************
-ListSpSnippetFragment splitForKeyVariable(QString const &str) {
-    ListSpSnippetFragment result;
-    QString s(str);
-    QRegularExpression const rx(QString(R"((.*)%1(.*))").arg(constants::kKeyVariableRegExpStr), QRegularExpression::DotMatchesEverythingOption);
-    QRegularExpressionMatch match;
-    while ((match = rx.match(s)).hasMatch()) {
-        QString const after = match.captured(4);
-        if (!after.isEmpty())
-            result.prepend(std::make_shared<TextSnippetFragment>(after));
-        bool ok = true;
-        QString const repeatStr = match.captured(3);
-        qint32 repeatCount = 1;
-        if (!repeatStr.isEmpty())
-            repeatCount = repeatStr.toInt(&ok);
-        if (ok)
-            result.prepend(std::make_shared<KeySnippetFragment>(match.captured(2), repeatCount));
-        s = match.captured(1);
-    }
-    if (!s.isEmpty())
-        result.prepend(std::make_shared<TextSnippetFragment>(s));
-    return result;
+qsizetype skipWordCharacters(QString const &str, qsizetype pos) {
+    while ((pos < str.size()) && ((str[pos] < QChar(0x80)) && (str[pos].isLetterOrNumber() || (str[pos] == '_'))))
+        ++pos;
+    return pos;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Lex a #{delay:} variable, whose parameter is a number of milliseconds.
+///
+/// \param[in] str The string.
+/// \param[in] paramStart The position of the parameter of the variable.
+/// \param[out] outFragment The fragment. Null if the variable is valid but does not produce a fragment.
+/// \return The position following the variable, or -1 if the text is not a #{delay:} variable.
+//****************************************************************************************************************************************************
+qsizetype lexDelayVariable(QString const &str, qsizetype paramStart, SpSnippetFragment &outFragment) {
+    qsizetype const end = skipDigits(str, paramStart);
+    if ((end == paramStart) || (end >= str.size()) || (str[end] != '}'))
+        return -1;
+    bool ok = false;
+    qint32 const delay = QStringView(str).mid(paramStart, end - paramStart).toInt(&ok);
+    if (ok && (delay > 0))
+        outFragment = std::make_shared<DelaySnippetFragment>(delay);
+    return end + 1;
 }
 
 
 //****************************************************************************************************************************************************
-/// \brief split a string into snippet fragment at the #{shortcut:} variable.
+/// \brief Lex a #{key:} variable, whose parameter is a key name optionally followed by a colon and a repeat count.
+///
 /// \param[in] str The string.
-/// \return the text split into fragments
+/// \param[in] paramStart The position of the parameter of the variable.
+/// \param[out] outFragment The fragment. Null if the variable is valid but does not produce a fragment.
+/// \return The position following the variable, or -1 if the text is not a #{key:} variable.
 //****************************************************************************************************************************************************
-ListSpSnippetFragment splitForShortcutVariable(QString const &str) {
-    ListSpSnippetFragment result;
-    QString s(str);
-    QRegularExpression const rx(QString(R"((.*)%1(.*))").arg(constants::kShortcutVariableRegExpStr), QRegularExpression::DotMatchesEverythingOption);
-    QRegularExpressionMatch match;
-    while ((match = rx.match(s)).hasMatch()) {
-        QString const after = match.captured(3);
-        if (!after.isEmpty())
-            result = splitForKeyVariable(after) + result;
-
-        SpShortcut const shortcut = Shortcut::fromString(match.captured(2));
-        if (shortcut)
-            result.prepend(std::make_shared<ShortcutSnippetFragment>(shortcut));
-        s = match.captured(1);
+qsizetype lexKeyVariable(QString const &str, qsizetype paramStart, SpSnippetFragment &outFragment) {
+    qsizetype const nameEnd = skipWordCharacters(str, paramStart);
+    if ((nameEnd == paramStart) || (nameEnd >= str.size()))
+        return -1;
+    qint32 repeatCount = 1;
+    bool ok = true;
+    qsizetype end = nameEnd;
+    if (str[nameEnd] == ':') {
+        end = skipDigits(str, nameEnd + 1);
+        if (end == nameEnd + 1)
+            return -1;
+        repeatCount = QStringView(str).mid(nameEnd + 1, end - nameEnd - 1).toInt(&ok);
     }
-    if (!s.isEmpty())
-        result = splitForKeyVariable(s) + result;
-    return result;
+    if ((end >= str.size()) || (str[end] != '}'))
+        return -1;
+    if (ok)
+        outFragment = std::make_shared<KeySnippetFragment>(str.mid(paramStart, nameEnd - paramStart), repeatCount);
+    return end + 1;
 }
 
 
 //****************************************************************************************************************************************************
+/// \brief Lex a #{shortcut:} variable, whose parameter is a shortcut in the native text format.
+///
+/// \param[in] str The string.
+/// \param[in] paramStart The position of the parameter of the variable.
+/// \param[out] outFragment The fragment. Null if the variable is valid but does not produce a fragment.
+/// \return The position following the variable, or -1 if the text is not a #{shortcut:} variable.
+//****************************************************************************************************************************************************
+qsizetype lexShortcutVariable(QString const &str, qsizetype paramStart, SpSnippetFragment &outFragment) {
+    qsizetype const end = str.indexOf('}', paramStart + 1); // the parameter contains at least one character
+    if (end < 0)
+        return -1;
+    SpShortcut const shortcut = Shortcut::fromString(str.mid(paramStart, end - paramStart));
+    if (shortcut)
+        outFragment = std::make_shared<ShortcutSnippetFragment>(shortcut);
+    return end + 1;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] str The string.
+/// \param[in] start The position of the opening #{ of the variable.
+/// \param[out] outFragment The fragment. Null if the variable is valid but does not produce a fragment.
+/// \return The position following the variable, or -1 if the text at start is not a fragment variable.
+//****************************************************************************************************************************************************
+qsizetype lexFragmentVariable(QString const &str, qsizetype start, SpSnippetFragment &outFragment) {
+    outFragment.reset();
+    QStringView const view = QStringView(str).mid(start + kVariableStart.size());
+    qsizetype const paramStart = start + kVariableStart.size();
+    if (view.startsWith(kDelayVariable))
+        return lexDelayVariable(str, paramStart + kDelayVariable.size(), outFragment);
+    if (view.startsWith(kKeyVariable))
+        return lexKeyVariable(str, paramStart + kKeyVariable.size(), outFragment);
+    if (view.startsWith(kShortcutVariable))
+        return lexShortcutVariable(str, paramStart + kShortcutVariable.size(), outFragment);
+    return -1;
+}
+
+
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The string is scanned once, from left to right. Each #{delay:}, #{key:} or #{shortcut:} variable ends at
+/// the first closing brace that follows it, and splits the surrounding text into text fragments. Invalid variables are
+/// left in the text. Valid variables that do not produce a fragment (e.g. a zero delay, or an unknown shortcut) are
+/// removed from the text.
+///
 /// \param[in] str The string to split.
 /// \return the list of fragments
 //****************************************************************************************************************************************************
 ListSpSnippetFragment splitStringIntoSnippetFragments(QString const &str) {
+    TraceSpan const span("splitStringIntoSnippetFragments");
     ListSpSnippetFragment result;
-    QString s(str);
-    QRegularExpression const rx(QString(R"((.*)%1(.*))").arg(constants::kDelayVariableRegExpStr), QRegularExpression::DotMatchesEverythingOption);
-    QRegularExpressionMatch match;
-    while ((match = rx.match(s)).hasMatch()) {
-        QString const after = match.captured(3);
-        if (!after.isEmpty())
-            result = splitForShortcutVariable(after) + result;
-        bool ok = false;
-        qint32 const delay = match.captured(2).toInt(&ok);
-        if (ok && (delay > 0))
-            result.prepend(std::make_shared<DelaySnippetFragment>(delay));
-        s = match.captured(1);
+    qsizetype textStart = 0;
+    qsizetype pos = 0;
+    SpSnippetFragment fragment;
+    while ((pos = str.indexOf(kVariableStart, pos)) >= 0) {
+        qsizetype const end = lexFragmentVariable(str, pos, fragment);
+        if (end < 0) {
+            pos += kVariableStart.size();
+            continue;
+        }
+        if (pos > textStart)
+            result.append(std::make_shared<TextSnippetFragment>(str.mid(textStart, pos - textStart)));
+        if (fragment)
+            result.append(fragment);
+        textStart = pos = end;
     }
-    if (!s.isEmpty())
-        result = splitForShortcutVariable(s) + result;
+    if (textStart < str.size())
+        result.append(std::make_shared<TextSnippetFragment>(str.mid(textStart)));
     return result;
 }
 
@@ -111,14 +184,20 @@ ListSpSnippetFragment splitStringIntoSnippetFragments(QString const &str) {
 /// \note this function does not disable the keyboard hook before operating.
 //****************************************************************************************************************************************************
 void renderSnippetFragmentList(ListSpSnippetFragment const &fragments) {
+    TraceSpan const span("renderSnippetFragmentList");
     qsizetype const count = fragments.size();
     for (qsizetype i = 0; i < fragments.size(); ++i) {
         SpSnippetFragment const &fragment = fragments[i];
         if (!fragment)
             continue;
-        fragment->render();
-        if (i != count - 1)
+        {
+            TraceSpan const renderSpan("SnippetFragment::render");
+            fragment->render();
+        }
+        if (i != count - 1) {
+            TraceSpan const delaySpan("delayBetweenFragments");
             QThread::msleep(kDelayBetweenFragmentsMs);
+        }
     }
 }
 
@@ -0,0 +1,221 @@
+﻿/// \file
+/// \author 
+///
+/// \brief Implementation of snippet template class.
+///  
+/// Copyright (c) . All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information. 
+
+
+#include "stdafx.h"
+#include "SnippetTemplate.h"
+#include "Combo/ComboVariable.h"
+
+
+namespace {
+
+
+QString const kDateTimeVariable = "dateTime"; ///< The dateTime variable.
+QString const kCustomDateTimeVariable = "dateTime:"; ///< The prefix of the custom dateTime variable.
+QString const kInputVariable = "input:"; ///< The prefix of the input variable.
+QString const kEnvVarVariable = "envVar:"; ///< The prefix of the envVar variable.
+QString const kPowershellVariable = "powershell:"; ///< The prefix of the powershell variable.
+QString const kKeyVariable = "key:"; ///< The prefix of the key variable.
+QString const kShortcutVariable = "shortcut:"; ///< The prefix of the shortcut variable.
+QString const kDelayVariable = "delay:"; ///< The prefix of the delay variable.
+QString const kTimeShiftUnits = "yMwdhmsz"; ///< The units of time shifts in the dateTime variable.
+QList<QPair<QString, ECaseChange>> const kComboReferencePrefixes = {
+    { "combo:", ECaseChange::NoChange }, { "upper:", ECaseChange::ToUpper }, { "lower:", ECaseChange::ToLower },
+    { "trim:", ECaseChange::Trim } }; ///< The prefixes of the variables referencing a combo, and the associated change.
+QList<QPair<QString, ESnippetNodeType>> const kSimpleVariables = {
+    { "clipboard", ESnippetNodeType::Clipboard }, { "discordemoji", ESnippetNodeType::DiscordEmoji },
+    { "date", ESnippetNodeType::Date }, { "time", ESnippetNodeType::Time }, { kDateTimeVariable, ESnippetNodeType::DateTime },
+    { "cursor", ESnippetNodeType::Cursor } }; ///< The variables without parameter.
+
+
+//****************************************************************************************************************************************************
+/// \brief Parse the parameter of a #{dateTime:} variable, e.g. '+1d-4w:yyyy-MM-dd' or 'yyyy-MM-dd'.
+///
+/// \param[in] parameter The parameter of the variable.
+/// \param[out] outShifts The time shifts.
+/// \return The format string.
+//****************************************************************************************************************************************************
+QString parseDateTimeParameter(QString const &parameter, QList<SnippetTemplate::TimeShift> &outShifts) {
+    outShifts.clear();
+    qsizetype const size = parameter.size();
+    qsizetype pos = 0;
+    QList<SnippetTemplate::TimeShift> shifts;
+    // the parameter starts with a list of shifts only if the list is immediately followed by a colon
+    while ((pos < size) && (('+' == parameter[pos]) || ('-' == parameter[pos]))) {
+        qsizetype const digitStart = pos + 1;
+        qsizetype digitEnd = digitStart;
+        while ((digitEnd < size) && parameter[digitEnd].isDigit())
+            ++digitEnd;
+        if ((digitEnd == digitStart) || (digitEnd >= size) || (!kTimeShiftUnits.contains(parameter[digitEnd])))
+            return parameter;
+        bool ok = false;
+        qint64 const value = parameter.mid(digitStart, digitEnd - digitStart).toLongLong(&ok);
+        if (ok) // shifts with an invalid value are ignored
+            shifts.append({ parameter[digitEnd].toLatin1(), '-' == parameter[pos] ? -value : value });
+        pos = digitEnd + 1;
+    }
+    if ((0 == pos) || (pos >= size) || (':' != parameter[pos]))
+        return parameter;
+    outShifts = shifts;
+    return parameter.mid(pos + 1);
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief Unrecognized variables are kept in the literal text. Variables that are not closed on the same line are not
+/// variables.
+///
+/// \param[in] snippet The snippet.
+//****************************************************************************************************************************************************
+SnippetTemplate::SnippetTemplate(QString const &snippet) {
+    qsizetype const size = snippet.size();
+    qsizetype literalStart = 0;
+    qsizetype pos = 0;
+    while (pos < size) {
+        qsizetype const start = snippet.indexOf("#{", pos);
+        if (start < 0)
+            break;
+        qsizetype end = start + 2;
+        while ((end < size) && (snippet[end] != QChar::LineFeed) && !((snippet[end] == '}') && (snippet[end - 1] != '\\')))
+            ++end;
+        if ((end >= size) || (snippet[end] == QChar::LineFeed)) {
+            // no variable starting before the end of the line can be closed, so we can skip the whole line
+            pos = end + 1;
+            continue;
+        }
+        this->appendLiteral(snippet.mid(literalStart, start - literalStart));
+        QString variable = snippet.mid(start + 2, end - start - 2);
+        variable.replace("\\}", "}");
+        this->appendVariable(variable);
+        literalStart = pos = end + 1;
+    }
+    this->appendLiteral(snippet.mid(literalStart));
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The nodes of the template.
+//****************************************************************************************************************************************************
+std::vector<SnippetTemplate::Node> const &SnippetTemplate::nodes() const {
+    return nodes_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The total length of the literal runs, which can be used to reserve memory for the evaluated snippet.
+//****************************************************************************************************************************************************
+qsizetype SnippetTemplate::literalLength() const {
+    return literalLength_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if the variables of the template, excluding combo references, always evaluate to the same
+/// text.
+//****************************************************************************************************************************************************
+bool SnippetTemplate::isPure() const {
+    return pure_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The keywords referenced by the template, in order of first appearance and without duplicates.
+//****************************************************************************************************************************************************
+QStringList const &SnippetTemplate::referencedKeywords() const {
+    return referencedKeywords_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] text The text.
+//****************************************************************************************************************************************************
+void SnippetTemplate::appendLiteral(QString const &text) {
+    if (text.isEmpty())
+        return;
+    literalLength_ += text.size();
+    if ((!nodes_.empty()) && (ESnippetNodeType::Literal == nodes_.back().type))
+        nodes_.back().text += text;
+    else
+        nodes_.push_back({ ESnippetNodeType::Literal, text });
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] variable The variable, without the enclosing #{}, and with escaped closing braces resolved.
+//****************************************************************************************************************************************************
+void SnippetTemplate::appendVariable(QString const &variable) {
+    Node node { ESnippetNodeType::Literal, QString("#{%1}").arg(variable) };
+    for (QPair<QString, ESnippetNodeType> const &simpleVariable: kSimpleVariables)
+        if (variable == simpleVariable.first) {
+            node.type = simpleVariable.second;
+            this->classifyNode(node);
+            nodes_.push_back(node);
+            return;
+        }
+
+    auto const hasPrefix = [&](QString const &prefix, ESnippetNodeType type) -> bool {
+        if (!variable.startsWith(prefix))
+            return false;
+        node.type = type;
+        node.parameter = variable.mid(prefix.size());
+        return true;
+    };
+
+    if (hasPrefix(kCustomDateTimeVariable, ESnippetNodeType::DateTime))
+        node.parameter = parseDateTimeParameter(node.parameter, node.timeShifts);
+    else {
+        bool isComboReference = false;
+        for (QPair<QString, ECaseChange> const &prefix: kComboReferencePrefixes)
+            if (hasPrefix(prefix.first, ESnippetNodeType::ComboReference)) {
+                node.parameter = resolveEscapingInVariableParameter(node.parameter);
+                node.caseChange = prefix.second;
+                isComboReference = true;
+                break;
+            }
+        if ((!isComboReference) && (!hasPrefix(kInputVariable, ESnippetNodeType::Input))
+            && (!hasPrefix(kEnvVarVariable, ESnippetNodeType::EnvVar))
+            && (!hasPrefix(kPowershellVariable, ESnippetNodeType::Powershell))
+            && (!hasPrefix(kKeyVariable, ESnippetNodeType::Key)) && (!hasPrefix(kShortcutVariable, ESnippetNodeType::Shortcut))
+            && (!hasPrefix(kDelayVariable, ESnippetNodeType::Delay))) {
+            this->appendLiteral(node.text); // we could not recognize the variable, so we keep it in the text
+            return;
+        }
+    }
+    this->classifyNode(node);
+    nodes_.push_back(node);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Update the purity and the referenced keywords of the template with a variable node.
+///
+/// \param[in] node The node.
+//****************************************************************************************************************************************************
+void SnippetTemplate::classifyNode(Node const &node) {
+    switch (node.type) {
+    case ESnippetNodeType::Clipboard:
+    case ESnippetNodeType::DiscordEmoji:
+    case ESnippetNodeType::Date:
+    case ESnippetNodeType::Time:
+    case ESnippetNodeType::DateTime:
+    case ESnippetNodeType::Input:
+    case ESnippetNodeType::EnvVar:
+    case ESnippetNodeType::Powershell:
+        pure_ = false;
+        break;
+    case ESnippetNodeType::ComboReference:
+        if (!referencedKeywords_.contains(node.parameter))
+            referencedKeywords_.append(node.parameter);
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,104 @@
+﻿/// \file
+/// \author 
+///
+/// \brief Declaration of snippet template class.
+///  
+/// Copyright (c) . All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information. 
+
+
+#ifndef BEEFTEXT_SNIPPET_TEMPLATE_H
+#define BEEFTEXT_SNIPPET_TEMPLATE_H
+
+
+#include <memory>
+#include <vector>
+
+
+//****************************************************************************************************************************************************
+/// \brief Enumeration for the types of nodes in a snippet template
+//****************************************************************************************************************************************************
+enum class ESnippetNodeType {
+    Literal = 0, ///< Literal text, including the unrecognized variables
+    Clipboard = 1, ///< The #{clipboard} variable
+    DiscordEmoji = 2, ///< The #{discordemoji} variable
+    Date = 3, ///< The #{date} variable
+    Time = 4, ///< The #{time} variable
+    DateTime = 5, ///< The #{dateTime} and #{dateTime:} variables
+    ComboReference = 6, ///< The #{combo:}, #{upper:}, #{lower:} and #{trim:} variables
+    Input = 7, ///< The #{input:} variable
+    EnvVar = 8, ///< The #{envVar:} variable
+    Powershell = 9, ///< The #{powershell:} variable
+    Key = 10, ///< The #{key:} variable, evaluated when the snippet is split into fragments
+    Shortcut = 11, ///< The #{shortcut:} variable, evaluated when the snippet is split into fragments
+    Delay = 12, ///< The #{delay:} variable, evaluated when the snippet is split into fragments
+    Cursor = 13, ///< The #{cursor} variable, evaluated when the substitution is performed
+};
+
+
+//****************************************************************************************************************************************************
+/// \brief Enumeration for the changes applied to the text of a referenced combo
+//****************************************************************************************************************************************************
+enum class ECaseChange {
+    NoChange = 0, ///< The text is inserted unchanged (#{combo:})
+    ToUpper = 1, ///< The text is converted to upper case (#{upper:})
+    ToLower = 2, ///< The text is converted to lower case (#{lower:})
+    Trim = 3, ///< The whitespaces at the start and end of the text are removed (#{trim:})
+};
+
+
+//****************************************************************************************************************************************************
+/// \brief A snippet compiled into a flat list of literal runs and typed variable nodes
+///
+/// The snippet is parsed once, in a single pass, and the parameters of the variables are pre-parsed, so evaluating
+/// the snippet is a linear walk of the nodes. Adjacent literal runs are merged. A variable is delimited by #{ and the
+/// first } that is not escaped by a backslash, on the same line. Escaped closing braces are resolved in the variable.
+///
+/// A template is pure if none of its variables depends on the clipboard, the date and time, user input, the
+/// environment or an external script, so that evaluating it twice gives the same text. The combos referenced by the
+/// template are not taken into account, as they are only resolved when the template is evaluated.
+//****************************************************************************************************************************************************
+class SnippetTemplate {
+public: // data types
+    struct TimeShift {
+        char unit { 'd' }; ///< The unit of the shift, one of 'yMwdhmsz'
+        qint64 value { 0 }; ///< The signed value of the shift
+    }; ///< Type definition for a time shift in a #{dateTime:} variable
+
+    struct Node {
+        ESnippetNodeType type { ESnippetNodeType::Literal }; ///< The type of node
+        QString text; ///< For literals, the text. For variables, the source text of the variable, inserted as is when the variable cannot be evaluated
+        QString parameter; ///< The parameter of the variable: keyword, input description, variable name, script, format or key
+        ECaseChange caseChange { ECaseChange::NoChange }; ///< For combo references, the change applied to the text of the combo
+        QList<TimeShift> timeShifts; ///< For #{dateTime:} variables, the time shifts
+    }; ///< Type definition for a node of the template
+
+public: // member functions
+    explicit SnippetTemplate(QString const &snippet); ///< Default constructor
+    SnippetTemplate(SnippetTemplate const &) = delete; ///< Disabled copy-constructor
+    SnippetTemplate(SnippetTemplate &&) = delete; ///< Disabled assignment copy-constructor
+    ~SnippetTemplate() = default; ///< Destructor
+    SnippetTemplate &operator=(SnippetTemplate const &) = delete; ///< Disabled assignment operator
+    SnippetTemplate &operator=(SnippetTemplate &&) = delete; ///< Disabled move assignment operator
+    std::vector<Node> const &nodes() const; ///< Return the nodes of the template
+    qsizetype literalLength() const; ///< Return the total length of the literal runs
+    bool isPure() const; ///< Check whether the variables of the template, excluding combo references, always evaluate to the same text
+    QStringList const &referencedKeywords() const; ///< Return the keywords referenced by the #{combo:}, #{upper:}, #{lower:} and #{trim:} variables
+
+private: // member functions
+    void appendLiteral(QString const &text); ///< Append literal text to the template
+    void appendVariable(QString const &variable); ///< Append a variable to the template
+    void classifyNode(Node const &node); ///< Update the purity and the referenced keywords of the template with a variable node
+
+private: // data members
+    std::vector<Node> nodes_; ///< The nodes of the template
+    qsizetype literalLength_ { 0 }; ///< The total length of the literal runs
+    bool pure_ { true }; ///< Is the template pure
+    QStringList referencedKeywords_; ///< The keywords referenced by the template, without duplicates
+};
+
+
+typedef std::shared_ptr<SnippetTemplate const> SpSnippetTemplate; ///< Type definition for shared pointer to snippet template
+
+
+#endif // #ifndef BEEFTEXT_SNIPPET_TEMPLATE_H
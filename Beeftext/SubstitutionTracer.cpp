@@ -0,0 +1,144 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of substitution tracer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "SubstitutionTracer.h"
+#include <XMiLib/Exception.h>
+#include <chrono>
+
+
+using namespace xmilib;
+
+
+//****************************************************************************************************************************************************
+/// \return A reference to the only allowed instance of the class.
+//****************************************************************************************************************************************************
+SubstitutionTracer &SubstitutionTracer::instance() {
+    static SubstitutionTracer instance;
+    return instance;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The current time of the tracer clock, in nanoseconds. The clock is monotonic and shared by all threads.
+//****************************************************************************************************************************************************
+qint64 SubstitutionTracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+//****************************************************************************************************************************************************
+/// \return true if and only if recording is enabled.
+//****************************************************************************************************************************************************
+bool SubstitutionTracer::isEnabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] enabled Should recording be enabled.
+//****************************************************************************************************************************************************
+void SubstitutionTracer::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] name The name of the span. It must be a string literal.
+/// \param[in] startNs The start time of the span, obtained using now().
+/// \param[in] endNs The end time of the span, obtained using now().
+//****************************************************************************************************************************************************
+void SubstitutionTracer::addSpan(char const *name, qint64 startNs, qint64 endNs) {
+    if (!this->isEnabled())
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_[nextSpan_] = { name, startNs, qMax<qint64>(0, endNs - startNs), quint64(quintptr(QThread::currentThreadId())) };
+    nextSpan_ = (nextSpan_ + 1) % capacity;
+    spanCount_ = qMin(spanCount_ + 1, capacity);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void SubstitutionTracer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nextSpan_ = 0;
+    spanCount_ = 0;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of recorded spans.
+//****************************************************************************************************************************************************
+qint32 SubstitutionTracer::spanCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return spanCount_;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] path The path of the file.
+/// \param[out] outErrorMsg If the function returns false and this parameter is not null, the string pointed to
+/// contains a description of the error.
+/// \return true if and only if the trace was successfully saved.
+//****************************************************************************************************************************************************
+bool SubstitutionTracer::saveChromeTrace(QString const &path, QString *outErrorMsg) const {
+    try {
+        QJsonArray events;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            qint32 const first = (nextSpan_ - spanCount_ + capacity) % capacity;
+            for (qint32 i = 0; i < spanCount_; ++i) {
+                Span const &span = spans_[(first + i) % capacity];
+                QJsonObject event;
+                event["name"] = QString::fromLatin1(span.name);
+                event["cat"] = "substitution";
+                event["ph"] = "X"; // complete event, i.e. a span with a duration
+                event["ts"] = double(span.startNs) / 1000.0; // the trace event format uses microseconds
+                event["dur"] = double(span.durationNs) / 1000.0;
+                event["pid"] = qint64(QCoreApplication::applicationPid());
+                event["tid"] = qint64(span.threadId);
+                events.append(event);
+            }
+        }
+        QJsonObject rootObject;
+        rootObject["traceEvents"] = events;
+        rootObject["displayTimeUnit"] = "ms";
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+            throw Exception(QString("Could not open file for writing: '%1'").arg(QDir::toNativeSeparators(path)));
+        QByteArray const data = QJsonDocument(rootObject).toJson(QJsonDocument::Compact);
+        if (data.size() != file.write(data))
+            throw Exception(QString("Error writing to file: %1").arg(QDir::toNativeSeparators(path)));
+        return true;
+    }
+    catch (Exception const &e) {
+        if (outErrorMsg)
+            *outErrorMsg = e.qwhat();
+        return false;
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] name The name of the span. It must be a string literal.
+//****************************************************************************************************************************************************
+TraceSpan::TraceSpan(char const *name)
+    : name_(name), startNs_(SubstitutionTracer::instance().isEnabled() ? SubstitutionTracer::now() : -1) {
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+TraceSpan::~TraceSpan() {
+    if (startNs_ >= 0)
+        SubstitutionTracer::instance().addSpan(name_, startNs_, SubstitutionTracer::now());
+}
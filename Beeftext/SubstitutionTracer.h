@@ -0,0 +1,90 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of substitution tracer class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_SUBSTITUTION_TRACER_H
+#define BEEFTEXT_SUBSTITUTION_TRACER_H
+
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+
+//****************************************************************************************************************************************************
+/// \brief A recorder for the duration of the stages of a substitution
+///
+/// Spans are stored in a fixed-size ring buffer, so the most recent spans are kept, and recording a span never
+/// allocates memory. Span names must be string literals. The recorded spans can be saved in the Chrome trace event
+/// format, and opened in chrome://tracing or https://ui.perfetto.dev. Spans recorded by the matcher thread and the
+/// main thread share the same clock, so the time spent in the queued signal between them is the gap between the
+/// matching span and the substitution span.
+///
+/// Recording is disabled by default. When it is disabled, a span only costs an atomic load. This class can be used
+/// from any thread.
+//****************************************************************************************************************************************************
+class SubstitutionTracer {
+public: // static data members
+    static qint32 constexpr capacity = 4096; ///< The number of spans kept in the ring buffer
+
+public: // static member functions
+    static SubstitutionTracer &instance(); ///< Return the only allowed instance of the class
+    static qint64 now(); ///< Return the current time of the tracer clock, in nanoseconds
+
+public: // member functions
+    SubstitutionTracer(SubstitutionTracer const &) = delete; ///< Disabled copy constructor
+    SubstitutionTracer(SubstitutionTracer &&) = delete; ///< Disabled move constructor
+    ~SubstitutionTracer() = default; ///< Default destructor
+    SubstitutionTracer &operator=(SubstitutionTracer const &) = delete; ///< Disabled assignment operator
+    SubstitutionTracer &operator=(SubstitutionTracer &&) = delete; ///< Disabled move assignment operator
+    bool isEnabled() const; ///< Check whether recording is enabled
+    void setEnabled(bool enabled); ///< Enable or disable recording
+    void addSpan(char const *name, qint64 startNs, qint64 endNs); ///< Record a span
+    void clear(); ///< Remove all recorded spans
+    qint32 spanCount() const; ///< Return the number of recorded spans
+    bool saveChromeTrace(QString const &path, QString *outErrorMsg = nullptr) const; ///< Save the recorded spans in Chrome trace event format
+
+private: // data types
+    struct Span {
+        char const *name { nullptr }; ///< The name of the span
+        qint64 startNs { 0 }; ///< The start time of the span, in nanoseconds
+        qint64 durationNs { 0 }; ///< The duration of the span, in nanoseconds
+        quint64 threadId { 0 }; ///< The identifier of the thread that recorded the span
+    }; ///< Type definition for spans
+
+private: // member functions
+    SubstitutionTracer() = default; ///< Default constructor
+
+private: // data members
+    std::atomic<bool> enabled_ { false }; ///< Is recording enabled
+    mutable std::mutex mutex_; ///< The mutex protecting the ring buffer
+    std::array<Span, capacity> spans_ {}; ///< The ring buffer of spans
+    qint32 nextSpan_ { 0 }; ///< The position of the next span in the ring buffer
+    qint32 spanCount_ { 0 }; ///< The number of spans in the ring buffer
+};
+
+
+//****************************************************************************************************************************************************
+/// \brief A span recorded by the substitution tracer when it goes out of scope
+//****************************************************************************************************************************************************
+class TraceSpan {
+public: // member functions
+    explicit TraceSpan(char const *name); ///< Default constructor
+    TraceSpan(TraceSpan const &) = delete; ///< Disabled copy constructor
+    TraceSpan(TraceSpan &&) = delete; ///< Disabled move constructor
+    ~TraceSpan(); ///< Destructor
+    TraceSpan &operator=(TraceSpan const &) = delete; ///< Disabled assignment operator
+    TraceSpan &operator=(TraceSpan &&) = delete; ///< Disabled move assignment operator
+
+private: // data members
+    char const *name_; ///< The name of the span
+    qint64 startNs_ { -1 }; ///< The start time of the span, or -1 if recording was disabled when the span started
+};
+
+
+#endif // #ifndef BEEFTEXT_SUBSTITUTION_TRACER_H
@@ -0,0 +1,112 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of functions counting the heap allocations made by the tests
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "AllocationCounter.h"
+#include <cstdlib>
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#endif // #if defined(_MSC_VER) && defined(_DEBUG)
+
+
+namespace {
+
+
+thread_local bool isCountingAllocations = false; ///< Are the heap allocations of the current thread counted
+thread_local qint64 allocationCount = 0; ///< The number of heap allocations counted in the current thread
+
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+//****************************************************************************************************************************************************
+/// \brief The debug CRT calls the hook for every allocation and reallocation, whether it is made using operator new,
+/// malloc() or realloc().
+//****************************************************************************************************************************************************
+int crtAllocationHook(int allocType, void *, size_t, int blockType, long, unsigned char const *, int) {
+    if (isCountingAllocations && (_CRT_BLOCK != blockType) && ((_HOOK_ALLOC == allocType) || (_HOOK_REALLOC == allocType)))
+        ++allocationCount;
+    return TRUE;
+}
+#endif // #if defined(_MSC_VER) && defined(_DEBUG)
+
+
+} // anonymous namespace
+
+
+#ifdef __GLIBC__
+//****************************************************************************************************************************************************
+// With glibc, the allocation functions defined by the executable replace those of the C library for the whole process,
+// including operator new and the Qt containers. The allocations are forwarded to the implementation of glibc.
+//****************************************************************************************************************************************************
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+
+void *malloc(std::size_t size) noexcept {
+    if (isCountingAllocations)
+        ++allocationCount;
+    return __libc_malloc(size);
+}
+
+void *realloc(void *ptr, std::size_t size) noexcept {
+    if (isCountingAllocations)
+        ++allocationCount;
+    return __libc_realloc(ptr, size);
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+    if (isCountingAllocations)
+        ++allocationCount;
+    return __libc_calloc(count, size);
+}
+} // extern "C"
+#endif // #ifdef __GLIBC__
+
+
+//****************************************************************************************************************************************************
+/// \brief Allocations made using malloc() and realloc() can be counted with glibc and with the debug CRT of MSVC.
+/// Replacing operator new is not enough, as the Qt containers allocate their data using malloc() and realloc().
+///
+/// \return true if and only if the heap allocations can be counted in the current configuration.
+//****************************************************************************************************************************************************
+bool isAllocationCountingSupported() {
+#if defined(__GLIBC__) || (defined(_MSC_VER) && defined(_DEBUG))
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void installAllocationCounter() {
+#if defined(_MSC_VER) && defined(_DEBUG)
+    _CrtSetAllocHook(crtAllocationHook);
+#endif // #if defined(_MSC_VER) && defined(_DEBUG)
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void startCountingAllocations() {
+    allocationCount = 0;
+    isCountingAllocations = true;
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The number of heap allocations made by the current thread since startCountingAllocations() was called.
+//****************************************************************************************************************************************************
+qint64 stopCountingAllocations() {
+    isCountingAllocations = false;
+    return allocationCount;
+}
@@ -0,0 +1,20 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of functions counting the heap allocations made by the tests
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_ALLOCATION_COUNTER_H
+#define BEEFTEXT_ALLOCATION_COUNTER_H
+
+
+bool isAllocationCountingSupported(); ///< Check whether the heap allocations can be counted in the current configuration
+void installAllocationCounter(); ///< Install the allocation counter. Must be called before counting allocations
+void startCountingAllocations(); ///< Start counting the heap allocations made by the current thread
+qint64 stopCountingAllocations(); ///< Stop counting the heap allocations made by the current thread and return their number
+
+
+#endif // #ifndef BEEFTEXT_ALLOCATION_COUNTER_H
@@ -0,0 +1,225 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the tests of the combo keyword index and of the combo matcher
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "Combo/ComboMatcher.h"
+#include "BeeftextConstants.h"
+#include "BeeftextGlobals.h"
+#include "Preferences/PreferencesManager.h"
+#include <QtTest>
+
+
+namespace {
+
+
+qint32 constexpr kBufferCapacity = 16; ///< The capacity of the typed text buffer used by the tests
+QString const kUpperLongI = QString::fromUcs4(U"\U00010400"); ///< DESERET CAPITAL LETTER LONG I, a character outside the Basic Multilingual Plane
+QString const kLowerLongI = QString::fromUcs4(U"\U00010428"); ///< DESERET SMALL LETTER LONG I, the case-folded form of kUpperLongI
+
+
+//****************************************************************************************************************************************************
+/// \param[in] keyword The keyword.
+/// \return A case-sensitive loose matching combo.
+//****************************************************************************************************************************************************
+SpCombo looseCombo(QString const &keyword) {
+    return Combo::create(keyword, keyword, "snippet", QString(), EMatchingMode::Loose, ECaseSensitivity::CaseSensitive);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] index The keyword index.
+/// \param[in] text The typed text.
+/// \return The loose matching combos whose keyword is a suffix of the text, the longest first.
+//****************************************************************************************************************************************************
+VecSpCombo looseCandidates(ComboKeywordIndex const &index, QString const &text) {
+    ComboKeywordIndex::Candidates result;
+    index.appendCandidates(index.stateForText(text), result);
+    return result.combos;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The typed text and the matcher are updated the way the combo matcher thread does.
+//****************************************************************************************************************************************************
+struct TypingState {
+    ComboKeywordIndex const &index; ///< The keyword index
+    TypedTextBuffer text { kBufferCapacity }; ///< The typed text
+    ComboMatcher matcher; ///< The matcher
+    void type(QString const &str); ///< Type a string
+    void backspace(qint32 count); ///< Type backspace several times
+    VecSpCombo matches(); ///< Return the combos matching the typed text
+};
+
+
+//****************************************************************************************************************************************************
+/// \param[in] str The string.
+//****************************************************************************************************************************************************
+void TypingState::type(QString const &str) {
+    for (QChar const c: str) {
+        matcher.synchronize(index, text);
+        text.append(c);
+        matcher.advance(index, c);
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] count The number of backspaces.
+//****************************************************************************************************************************************************
+void TypingState::backspace(qint32 count) {
+    for (qint32 i = 0; i < count; ++i) {
+        if (text.isEmpty()) {
+            text.removeLast();
+            continue;
+        }
+        matcher.synchronize(index, text);
+        text.removeLast();
+        matcher.backspace(index, text);
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \return The combos matching the typed text.
+//****************************************************************************************************************************************************
+VecSpCombo TypingState::matches() {
+    matcher.synchronize(index, text);
+    VecSpCombo result;
+    for (SpCombo const &combo: matcher.candidates(index, text.view(), text.isTruncated()).combos)
+        if (combo && index.isMatch(combo.get(), text.view()))
+            result.push_back(combo);
+    return result;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief Tests of the combo keyword index and of the combo matcher
+///
+/// The tests run in portable mode with the default preferences (see BEEFTEXT_BENCHMARK).
+//****************************************************************************************************************************************************
+class TestComboMatching : public QObject {
+Q_OBJECT
+private slots:
+    void initTestCase(); ///< Reset the preferences
+    void strictMatchAfterTruncation(); ///< Test strict matching once the characters discarded from the typed text have been erased
+    void incrementalLinks(); ///< Test the cost and result of the incremental update of the failure links of the automaton
+    void surrogatePairs(); ///< Test case-insensitive matching of keywords containing characters outside the Basic Multilingual Plane
+};
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestComboMatching::initTestCase() {
+    QGuiApplication::setOrganizationName(constants::kOrganizationName);
+    QGuiApplication::setApplicationName(constants::kApplicationName);
+    QDir().mkpath(globals::appDataDir());
+    QFile::remove(globals::portableModeSettingsFilePath());
+    (void) PreferencesManager::instance();
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief More characters than the capacity of the buffer are typed, then more backspaces than the capacity, so the
+/// whole typed text is erased and a strict keyword typed afterwards must match.
+//****************************************************************************************************************************************************
+void TestComboMatching::strictMatchAfterTruncation() {
+    SpCombo const combo = Combo::create("combo", "abc", "snippet", QString(), EMatchingMode::Strict,
+        ECaseSensitivity::CaseSensitive);
+    ComboKeywordIndex index;
+    index.build({ combo }, EMatchingMode::Strict, ECaseSensitivity::CaseSensitive);
+    TypingState state { index };
+
+    state.type("abc");
+    QCOMPARE(state.matches().size(), std::size_t(1));
+
+    state.backspace(3);
+    state.type(QString(kBufferCapacity + 4, 'x'));
+    QVERIFY(state.text.isTruncated());
+    state.backspace(kBufferCapacity);
+    QVERIFY(state.text.isEmpty());
+    QVERIFY(state.text.isTruncated());
+    state.type("abc");
+    QVERIFY(state.matches().empty()); // the text typed since the last reset still starts with 4 erased characters
+
+    state.backspace(3 + 4);
+    QVERIFY(!state.text.isTruncated());
+    state.type("abc");
+    VecSpCombo const matches = state.matches();
+    QCOMPARE(matches.size(), std::size_t(1));
+    QVERIFY(matches.front() == combo);
+}
+
+
+
+//****************************************************************************************************************************************************
+/// \brief The automaton contains several hundred nodes, but the insertion of a trigger must only visit the few nodes
+/// whose failure link may point to the new nodes.
+//****************************************************************************************************************************************************
+void TestComboMatching::incrementalLinks() {
+    QString const letters = "acdef"; // no filler keyword contains 'b' or 'z'
+    VecSpCombo combos;
+    for (qint32 i = 0; i < 625; ++i) {
+        QString keyword = "k";
+        for (qint32 j = 0, n = i; j < 4; ++j, n /= 5)
+            keyword += letters[n % 5];
+        combos.push_back(looseCombo(keyword));
+    }
+    SpCombo const kaz = looseCombo("kaz");
+    SpCombo const kbz = looseCombo("kbz");
+    combos.push_back(kaz);
+    combos.push_back(kbz);
+    ComboKeywordIndex index;
+    index.build(combos, EMatchingMode::Loose, ECaseSensitivity::CaseSensitive);
+
+    SpCombo const z = looseCombo("z");
+    index.addCombo(z);
+    QCOMPARE(index.linkVisitCount(), 2); // the nodes for "kaz" and "kbz", that were failing to the root
+    SpCombo const bz = looseCombo("bz");
+    index.addCombo(bz);
+    QCOMPARE(index.linkVisitCount(), 3); // the node for "kb", that was failing to the root, then the nodes for "kaz" and "kbz", that were failing to "z"
+
+    QVERIFY(looseCandidates(index, "kbz") == VecSpCombo({ kbz, bz, z }));
+    QVERIFY(looseCandidates(index, "kaz") == VecSpCombo({ kaz, z }));
+    QVERIFY(looseCandidates(index, "kacd") == VecSpCombo());
+}
+
+
+
+//****************************************************************************************************************************************************
+/// \brief The characters encoded as surrogate pairs must be case-folded as a whole, both by the hash tables of the
+/// strict matching combos and by the automaton, including when the low surrogate is erased and typed again.
+//****************************************************************************************************************************************************
+void TestComboMatching::surrogatePairs() {
+    SpCombo const strict = Combo::create("strict", "a" + kUpperLongI, "snippet", QString(), EMatchingMode::Strict,
+        ECaseSensitivity::CaseInsensitive);
+    SpCombo const loose = Combo::create("loose", "x" + kUpperLongI + "y", "snippet", QString(), EMatchingMode::Loose,
+        ECaseSensitivity::CaseInsensitive);
+    ComboKeywordIndex index;
+    index.build({ strict, loose }, EMatchingMode::Strict, ECaseSensitivity::CaseInsensitive);
+
+    TypingState strictState { index };
+    strictState.type("A" + kLowerLongI);
+    QVERIFY(strictState.matches() == VecSpCombo({ strict }));
+
+    TypingState looseState { index };
+    looseState.type("zzX" + kLowerLongI);
+    looseState.backspace(1); // the low surrogate is erased, and the high surrogate is kept by the matcher
+    looseState.type(kLowerLongI.right(1) + "Y");
+    QVERIFY(looseState.matches() == VecSpCombo({ loose }));
+    QVERIFY(looseCandidates(index, "zzx" + kUpperLongI + "y") == VecSpCombo({ loose }));
+    QVERIFY(looseCandidates(index, "x" + kLowerLongI) == VecSpCombo());
+}
+
+
+QTEST_MAIN(TestComboMatching)
+#include "TestComboMatching.moc"
@@ -0,0 +1,147 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the unit tests for the foreground application tracker
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "ForegroundApplicationTracker.h"
+#include "FakeForegroundProcessProvider.h"
+#include <QtTest>
+
+
+namespace {
+
+
+quintptr constexpr kNotepadWindow = 1; ///< A window of the notepad process
+quintptr constexpr kExplorerWindow = 2; ///< A window of the explorer process
+quintptr constexpr kOtherNotepadWindow = 3; ///< Another window of the notepad process
+quint32 constexpr kNotepadProcessId = 10; ///< The identifier of the notepad process
+quint32 constexpr kExplorerProcessId = 20; ///< The identifier of the explorer process
+QString const kNotepad = "notepad.exe"; ///< The executable file name of the notepad process
+QString const kExplorer = "explorer.exe"; ///< The executable file name of the explorer process
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief Unit tests for the caching of ForegroundApplicationTracker, using a fake foreground process provider
+//****************************************************************************************************************************************************
+class TestForegroundApplicationTracker : public QObject {
+Q_OBJECT
+private slots:
+    void init(); ///< Create the tracker and its provider before each test
+    void cleanup(); ///< Destroy the tracker and its provider after each test
+    void windowChange(); ///< Test that the process is only queried when the foreground window changes
+    void sameProcessWindowChange(); ///< Test that the executable file name is reused for another window of the same process
+    void nullNameRetry(); ///< Test that a name that could not be retrieved is queried again on the next window change
+    void invalidate(); ///< Test that invalidate() forces the information to be queried again
+
+private: // data members
+    FakeForegroundProcessProvider *provider_ { nullptr }; ///< The provider, owned by the tracker
+    std::unique_ptr<ForegroundApplicationTracker> tracker_; ///< The tracker
+};
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestForegroundApplicationTracker::init() {
+    std::unique_ptr<FakeForegroundProcessProvider> provider = std::make_unique<FakeForegroundProcessProvider>();
+    provider->setWindowProcessId(kNotepadWindow, kNotepadProcessId);
+    provider->setWindowProcessId(kExplorerWindow, kExplorerProcessId);
+    provider->setWindowProcessId(kOtherNotepadWindow, kNotepadProcessId);
+    provider->setExecutableFileName(kNotepadProcessId, kNotepad);
+    provider->setExecutableFileName(kExplorerProcessId, kExplorer);
+    provider_ = provider.get();
+    tracker_ = std::make_unique<ForegroundApplicationTracker>(std::move(provider));
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestForegroundApplicationTracker::cleanup() {
+    tracker_.reset();
+    provider_ = nullptr;
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestForegroundApplicationTracker::windowChange() {
+    provider_->setForegroundWindow(kNotepadWindow);
+    QCOMPARE(tracker_->executableFileName(), kNotepad);
+    QCOMPARE(tracker_->processId(), kNotepadProcessId);
+    for (qint32 i = 0; i < 10; ++i)
+        QCOMPARE(tracker_->executableFileName(), kNotepad);
+    QCOMPARE(provider_->foregroundWindowQueryCount(), 12); // the foreground window is queried on every call
+    QCOMPARE(provider_->processIdQueryCount(), 1);
+    QCOMPARE(provider_->executableFileNameQueryCount(), 1);
+
+    provider_->setForegroundWindow(kExplorerWindow);
+    QCOMPARE(tracker_->executableFileName(), kExplorer);
+    QCOMPARE(tracker_->processId(), kExplorerProcessId);
+    QCOMPARE(provider_->processIdQueryCount(), 2);
+    QCOMPARE(provider_->executableFileNameQueryCount(), 2);
+
+    provider_->setForegroundWindow(0);
+    QVERIFY(tracker_->executableFileName().isNull());
+    QCOMPARE(tracker_->processId(), quint32(0));
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestForegroundApplicationTracker::sameProcessWindowChange() {
+    provider_->setForegroundWindow(kNotepadWindow);
+    QCOMPARE(tracker_->executableFileName(), kNotepad);
+    provider_->setForegroundWindow(kOtherNotepadWindow);
+    QCOMPARE(tracker_->executableFileName(), kNotepad);
+    QCOMPARE(tracker_->processId(), kNotepadProcessId);
+    QCOMPARE(provider_->processIdQueryCount(), 2);
+    QCOMPARE(provider_->executableFileNameQueryCount(), 1);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestForegroundApplicationTracker::nullNameRetry() {
+    provider_->setExecutableFileName(kNotepadProcessId, QString()); // e.g. the process is elevated
+    provider_->setForegroundWindow(kNotepadWindow);
+    QVERIFY(tracker_->executableFileName().isNull());
+    QVERIFY(tracker_->executableFileName().isNull()); // the result is cached until the foreground window changes
+    QCOMPARE(provider_->executableFileNameQueryCount(), 1);
+
+    provider_->setExecutableFileName(kNotepadProcessId, kNotepad);
+    provider_->setForegroundWindow(kOtherNotepadWindow);
+    QCOMPARE(tracker_->executableFileName(), kNotepad); // same process, but the name is retrieved again
+    QCOMPARE(provider_->executableFileNameQueryCount(), 2);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestForegroundApplicationTracker::invalidate() {
+    provider_->setForegroundWindow(kNotepadWindow);
+    QCOMPARE(tracker_->executableFileName(), kNotepad);
+    QString const renamed = "renamed.exe";
+    provider_->setExecutableFileName(kNotepadProcessId, renamed);
+    QCOMPARE(tracker_->executableFileName(), kNotepad);
+    tracker_->invalidate();
+    QCOMPARE(tracker_->executableFileName(), renamed);
+    QCOMPARE(provider_->processIdQueryCount(), 2);
+    QCOMPARE(provider_->executableFileNameQueryCount(), 2);
+}
+
+
+QTEST_APPLESS_MAIN(TestForegroundApplicationTracker)
+#include "TestForegroundApplicationTracker.moc"
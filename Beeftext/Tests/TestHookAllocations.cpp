@@ -0,0 +1,147 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the test checking that the processing of key strokes does not allocate memory
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "InputManager.h"
+#include "ForegroundApplicationTracker.h"
+#include "BeeftextConstants.h"
+#include "BeeftextGlobals.h"
+#include "Preferences/PreferencesManager.h"
+#include "AllocationCounter.h"
+#include <QtTest>
+
+
+namespace {
+
+
+qint32 constexpr kMaxAttemptCount = 3; ///< The number of replays attempted if the foreground application changes during a replay
+
+
+//****************************************************************************************************************************************************
+/// \param[in] virtualKey The virtual key code.
+/// \param[in] shift Is the shift key pressed.
+/// \param[in] control Is the control key pressed.
+/// \return The key stroke.
+//****************************************************************************************************************************************************
+InputManager::KeyStroke keyStroke(quint32 virtualKey, bool shift = false, bool control = false) {
+    InputManager::KeyStroke result = { virtualKey, MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC), { 0 }};
+    if (shift)
+        result.keyboardState[VK_SHIFT] = result.keyboardState[VK_LSHIFT] = 0x80;
+    if (control)
+        result.keyboardState[VK_CONTROL] = result.keyboardState[VK_LCONTROL] = 0x80;
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The recording covers the paths of the keyboard hook processing: printable characters with and without
+/// shift, spaces, backspace, return, combo breaker keys, ignored modifier keys, and key combinations that are
+/// checked against the shortcuts.
+///
+/// \return A recording of key strokes.
+//****************************************************************************************************************************************************
+QList<InputManager::KeyStroke> recordedKeyStrokes() {
+    QList<InputManager::KeyStroke> result;
+    for (QChar const c: QString("Hello World, this is a test of Beeftext 1234."))
+        if (c.isLetter())
+            result.append(keyStroke(c.toUpper().unicode(), c.isUpper()));
+        else if (c.isDigit())
+            result.append(keyStroke(c.unicode()));
+        else if (c == ' ')
+            result.append(keyStroke(VK_SPACE));
+        else if (c == ',')
+            result.append(keyStroke(VK_OEM_COMMA));
+        else if (c == '.')
+            result.append(keyStroke(VK_OEM_PERIOD));
+    for (InputManager::KeyStroke const &stroke: { keyStroke(VK_BACK), keyStroke(VK_BACK), keyStroke(VK_RETURN),
+        keyStroke(VK_LEFT), keyStroke(VK_HOME), keyStroke(VK_DELETE), keyStroke(VK_LSHIFT, true), keyStroke(VK_CAPITAL),
+        keyStroke('C', false, true), keyStroke('V', true, true), keyStroke(VK_SPACE, false, true), keyStroke(VK_F5) })
+        result.append(stroke);
+    return result;
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] queue The keystroke queue.
+//****************************************************************************************************************************************************
+void drainQueue(KeystrokeQueue &queue) {
+    KeystrokeEvent event;
+    while (queue.pop(event))
+        queue.markProcessed();
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief Test that replays recorded key strokes through the processing of the keyboard hook, up to the keystroke
+/// queue, and fails if the heap is touched
+///
+/// The test runs in portable mode with the default preferences, and the keyboard and mouse hooks are not installed
+/// (see BEEFTEXT_BENCHMARK).
+//****************************************************************************************************************************************************
+class TestHookAllocations : public QObject {
+Q_OBJECT
+private slots:
+    void initTestCase(); ///< Reset the preferences
+    void replay(); ///< Replay the recorded key strokes and count the heap allocations
+};
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookAllocations::initTestCase() {
+    if (!isAllocationCountingSupported())
+        QSKIP("Heap allocations made using malloc() and realloc() can only be counted with the debug CRT.");
+    QGuiApplication::setOrganizationName(constants::kOrganizationName);
+    QGuiApplication::setApplicationName(constants::kApplicationName);
+    QDir().mkpath(globals::appDataDir());
+    QFile::remove(globals::portableModeSettingsFilePath());
+    (void) PreferencesManager::instance();
+    installAllocationCounter();
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The key strokes are first replayed without counting allocations, so that the foreground application and the
+/// result of the excluded applications filter are cached. If the foreground application changes during the counted
+/// replay, the replay is attempted again.
+//****************************************************************************************************************************************************
+void TestHookAllocations::replay() {
+    InputManager &inputManager = InputManager::instance();
+    KeystrokeQueue &queue = inputManager.keystrokeQueue();
+    ForegroundApplicationTracker &foregroundApplication = ForegroundApplicationTracker::instance();
+    QList<InputManager::KeyStroke> const keyStrokes = recordedKeyStrokes();
+    for (InputManager::KeyStroke const &stroke: keyStrokes) {
+        inputManager.processKeyStroke(stroke);
+        drainQueue(queue);
+    }
+
+    for (qint32 attempt = 0; attempt < kMaxAttemptCount; ++attempt) {
+        quint32 const processId = foregroundApplication.processId();
+        qint64 count = 0;
+        for (InputManager::KeyStroke const &stroke: keyStrokes) {
+            startCountingAllocations();
+            inputManager.processKeyStroke(stroke);
+            count += stopCountingAllocations();
+            drainQueue(queue);
+        }
+        if (processId != foregroundApplication.processId())
+            continue;
+        QCOMPARE(count, qint64(0));
+        return;
+    }
+    QSKIP("The foreground application kept changing during the replay.");
+}
+
+
+QTEST_MAIN(TestHookAllocations)
+#include "TestHookAllocations.moc"
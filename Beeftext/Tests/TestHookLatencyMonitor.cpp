@@ -0,0 +1,189 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the unit tests for the hook latency monitor
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "HookLatencyMonitor.h"
+#include <QtTest>
+
+
+namespace {
+
+
+qint64 constexpr kThresholdUs = 1000; ///< The threshold used by the tests, in microseconds
+qint64 constexpr kRecoveryThresholdUs = 250; ///< The recovery threshold used by the tests, in microseconds
+qint64 constexpr kFastUs = 10; ///< A duration under the recovery threshold, in microseconds
+qint64 constexpr kMediumUs = 500; ///< A duration between the recovery threshold and the threshold, in microseconds
+qint64 constexpr kSlowUs = 5000; ///< A duration over the threshold, in microseconds
+
+
+//****************************************************************************************************************************************************
+/// \param[in] monitor The monitor.
+/// \param[in] durationUs The duration of the samples, in microseconds.
+/// \param[in] count The number of samples.
+/// \return The number of samples that made the monitor enter or leave degraded mode.
+//****************************************************************************************************************************************************
+qint32 addSamples(HookLatencyMonitor &monitor, qint64 durationUs, qint32 count) {
+    qint32 result = 0;
+    for (qint32 i = 0; i < count; ++i)
+        if (monitor.addSample(durationUs))
+            ++result;
+    return result;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief Unit tests for the histogram and the degraded mode logic of HookLatencyMonitor
+//****************************************************************************************************************************************************
+class TestHookLatencyMonitor : public QObject {
+Q_OBJECT
+private slots:
+    void percentiles(); ///< Test the percentiles computed from the histogram
+    void window(); ///< Test the eviction of old samples from the histogram
+    void minSampleCount(); ///< Test that the monitor does not degrade before enough samples have been added
+    void degrade(); ///< Test that the monitor degrades when the 99th percentile exceeds the threshold
+    void noDegradeUnderThreshold(); ///< Test that the monitor does not degrade when the 99th percentile is under the threshold
+    void recover(); ///< Test that the monitor leaves degraded mode when the 99th percentile is under the recovery threshold
+    void hysteresis(); ///< Test that the monitor stays degraded when the 99th percentile is between the two thresholds
+    void reset(); ///< Test the reset of the monitor
+    void degradationDisabled(); ///< Test that the monitor keeps statistics but never degrades when degraded mode is disabled
+};
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::percentiles() {
+    HookLatencyMonitor monitor;
+    QCOMPARE(monitor.percentile(0.99), qint64(0));
+    addSamples(monitor, kFastUs, 1000);
+    QCOMPARE(monitor.percentile(0.5), kFastUs); // the upper bound of the bucket is capped by the longest duration
+    QCOMPARE(monitor.percentile(0.99), kFastUs);
+    monitor.addSample(1000);
+    QCOMPARE(monitor.maxDuration(), qint64(1000));
+    QCOMPARE(monitor.percentile(0.99), qint64(16)); // 10 us is in the bucket [8, 16[
+    QCOMPARE(monitor.percentile(1.0), qint64(1000));
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::window() {
+    HookLatencyMonitor monitor;
+    addSamples(monitor, kFastUs, HookLatencyMonitor::windowSize + 10);
+    QCOMPARE(monitor.sampleCount(), HookLatencyMonitor::windowSize);
+    QCOMPARE(monitor.totalSampleCount(), quint64(HookLatencyMonitor::windowSize + 10));
+    addSamples(monitor, 1000, HookLatencyMonitor::windowSize);
+    QCOMPARE(monitor.percentile(0.01), qint64(1000)); // all the fast samples have been evicted
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::minSampleCount() {
+    HookLatencyMonitor monitor(kThresholdUs, kRecoveryThresholdUs);
+    QCOMPARE(addSamples(monitor, kSlowUs, HookLatencyMonitor::minSampleCount - 1), 0);
+    QVERIFY(!monitor.isDegraded());
+    QVERIFY(monitor.addSample(kSlowUs));
+    QVERIFY(monitor.isDegraded());
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::degrade() {
+    HookLatencyMonitor monitor(kThresholdUs, kRecoveryThresholdUs);
+    addSamples(monitor, kFastUs, 990);
+    QVERIFY(!monitor.isDegraded());
+    QCOMPARE(addSamples(monitor, kSlowUs, 10), 0); // 10 slow calls out of 1000 do not exceed the 99th percentile
+    QVERIFY(!monitor.isDegraded());
+    QCOMPARE(addSamples(monitor, kSlowUs, 10), 1);
+    QVERIFY(monitor.isDegraded());
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::noDegradeUnderThreshold() {
+    HookLatencyMonitor monitor(kThresholdUs, kRecoveryThresholdUs);
+    QCOMPARE(addSamples(monitor, kMediumUs, 4 * HookLatencyMonitor::windowSize), 0);
+    QVERIFY(!monitor.isDegraded());
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::recover() {
+    HookLatencyMonitor monitor(kThresholdUs, kRecoveryThresholdUs);
+    addSamples(monitor, kSlowUs, 200); // a burst of slow calls, e.g. at boot time
+    QVERIFY(monitor.isDegraded());
+    QCOMPARE(addSamples(monitor, kFastUs, 500), 0); // the slow calls are still more than 1% of the window
+    QVERIFY(monitor.isDegraded());
+    QCOMPARE(addSamples(monitor, kFastUs, HookLatencyMonitor::windowSize), 1);
+    QVERIFY(!monitor.isDegraded());
+    QVERIFY(monitor.percentile(0.99) < kRecoveryThresholdUs);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::hysteresis() {
+    HookLatencyMonitor monitor(kThresholdUs, kRecoveryThresholdUs);
+    addSamples(monitor, kSlowUs, 200);
+    QVERIFY(monitor.isDegraded());
+    QCOMPARE(addSamples(monitor, kMediumUs, 4 * HookLatencyMonitor::windowSize), 0);
+    QVERIFY(monitor.isDegraded());
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::reset() {
+    HookLatencyMonitor monitor(kThresholdUs, kRecoveryThresholdUs);
+    addSamples(monitor, kSlowUs, 200);
+    QVERIFY(monitor.isDegraded());
+    monitor.reset();
+    QVERIFY(!monitor.isDegraded());
+    QCOMPARE(monitor.sampleCount(), 0);
+    QCOMPARE(monitor.totalSampleCount(), quint64(0));
+    QCOMPARE(monitor.maxDuration(), qint64(0));
+    QCOMPARE(monitor.percentile(0.99), qint64(0));
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestHookLatencyMonitor::degradationDisabled() {
+    HookLatencyMonitor monitor(kThresholdUs, kRecoveryThresholdUs);
+    addSamples(monitor, kSlowUs, 200);
+    QVERIFY(monitor.isDegraded());
+    monitor.setDegradationEnabled(false);
+    QVERIFY(!monitor.isDegradationEnabled());
+    QVERIFY(!monitor.isDegraded());
+    QCOMPARE(addSamples(monitor, kSlowUs, HookLatencyMonitor::windowSize), 0);
+    QVERIFY(!monitor.isDegraded());
+    QCOMPARE(monitor.percentile(0.99), kSlowUs); // the statistics are still available
+    monitor.setDegradationEnabled(true);
+    QVERIFY(monitor.addSample(kSlowUs));
+    QVERIFY(monitor.isDegraded());
+}
+
+
+QTEST_APPLESS_MAIN(TestHookLatencyMonitor)
+#include "TestHookLatencyMonitor.moc"
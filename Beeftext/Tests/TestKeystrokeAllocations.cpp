@@ -0,0 +1,140 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the test checking that the portable processing of key strokes does not allocate memory
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "KeystrokeQueue.h"
+#include "Combo/TypedTextBuffer.h"
+#include "AllocationCounter.h"
+#include <QtTest>
+
+
+namespace {
+
+
+QString const kTypedText = "Hello World, this is a test of Beeftext 1234."; ///< The text typed by the tests
+qint32 constexpr kRoundCount = 3; ///< The number of times the queue is filled and drained
+
+
+//****************************************************************************************************************************************************
+/// \param[in] c The character.
+/// \return The keystroke event for the character.
+//****************************************************************************************************************************************************
+KeystrokeEvent characterEvent(QChar c) {
+    KeystrokeEvent result;
+    result.type = c.isSpace() ? EKeystrokeEventType::ComboBreaker : EKeystrokeEventType::Character;
+    result.character = c;
+    return result;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief Test that pushing keystroke events in the keystroke queue, popping them, and applying them to the typed text
+/// buffer of the matcher thread do not touch the heap
+///
+/// These steps are run for every key stroke, by the keyboard hook and by the combo matcher thread. Contrary to the
+/// hook allocation test, this test does not depend on the Windows API.
+//****************************************************************************************************************************************************
+class TestKeystrokeAllocations : public QObject {
+Q_OBJECT
+private slots:
+    void initTestCase(); ///< Install the allocation counter
+    void queue(); ///< Count the heap allocations made by pushing and popping events in the keystroke queue
+    void typedTextBuffer(); ///< Count the heap allocations made by applying events to the typed text buffer
+};
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestKeystrokeAllocations::initTestCase() {
+    if (!isAllocationCountingSupported())
+        QSKIP("Heap allocations made using malloc() and realloc() cannot be counted in this configuration.");
+    installAllocationCounter();
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The queue is filled past its capacity, so that the overflow path is exercised too. From the second round on,
+/// the first event pushed is preceded by the combo breaker marking the events dropped in the previous round.
+//****************************************************************************************************************************************************
+void TestKeystrokeAllocations::queue() {
+    std::unique_ptr<KeystrokeQueue> const queue = std::make_unique<KeystrokeQueue>();
+    KeystrokeEvent event;
+    qint64 count = 0;
+    for (qint32 round = 0; round < kRoundCount; ++round) {
+        startCountingAllocations();
+        quint32 pushedCount = 0;
+        for (quint32 i = 0; i <= KeystrokeQueue::capacity; ++i)
+            if (queue->push(characterEvent(kTypedText[i % kTypedText.size()])))
+                ++pushedCount;
+        bool const isFull = queue->isFull();
+        bool const overflowed = queue->isOverflowed();
+        EKeystrokeEventType firstType = EKeystrokeEventType::Stop;
+        quint32 poppedCount = 0;
+        while (queue->pop(event)) {
+            if (0 == poppedCount)
+                firstType = event.type;
+            queue->markProcessed();
+            ++poppedCount;
+        }
+        bool const isIdle = queue->isIdle();
+        count += stopCountingAllocations();
+        QCOMPARE(pushedCount, round > 0 ? KeystrokeQueue::capacity - 1 : KeystrokeQueue::capacity);
+        QCOMPARE(poppedCount, KeystrokeQueue::capacity);
+        QVERIFY(firstType == (round > 0 ? EKeystrokeEventType::ComboBreaker : EKeystrokeEventType::Character));
+        QVERIFY(isFull);
+        QVERIFY(overflowed);
+        QVERIFY(isIdle);
+    }
+    QCOMPARE(count, qint64(0));
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief More characters than the capacity of the buffer are typed, so that the buffer wraps around.
+//****************************************************************************************************************************************************
+void TestKeystrokeAllocations::typedTextBuffer() {
+    TypedTextBuffer buffer(16);
+    qint64 count = 0;
+    for (qint32 round = 0; round < kRoundCount; ++round) {
+        startCountingAllocations();
+        for (QChar const c: kTypedText) {
+            KeystrokeEvent const event = characterEvent(c);
+            if (EKeystrokeEventType::Character == event.type)
+                buffer.append(event.character);
+            else
+                buffer.clear();
+        }
+        buffer.removeLast();
+        QStringView const view = buffer.view();
+        bool const isTruncated = buffer.isTruncated();
+        count += stopCountingAllocations();
+        QCOMPARE(view.toString(), QString("1234"));
+        QVERIFY(!isTruncated);
+        buffer.clear();
+    }
+
+    startCountingAllocations();
+    for (QChar const c: kTypedText)
+        if (!c.isSpace())
+            buffer.append(c);
+    bool const isTruncated = buffer.isTruncated();
+    QStringView const view = buffer.view();
+    count += stopCountingAllocations();
+    QVERIFY(isTruncated);
+    QCOMPARE(view.toString(), QString("testofBeeftext1234.").right(16));
+    QCOMPARE(count, qint64(0));
+}
+
+
+QTEST_APPLESS_MAIN(TestKeystrokeAllocations)
+#include "TestKeystrokeAllocations.moc"
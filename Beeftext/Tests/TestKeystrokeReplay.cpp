@@ -0,0 +1,277 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the test replaying key strokes through the keystroke queue
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "KeystrokeReplayer.h"
+#include "MemoryKeySynthesizer.h"
+#include "Combo/TypedTextBuffer.h"
+#include <QtTest>
+
+
+namespace {
+
+
+QString const kKeyword = "btw"; ///< The keyword of the substitution
+QString const kSnippet = "by the way "; ///< The snippet of the substitution, including the space that triggered it
+
+
+//****************************************************************************************************************************************************
+/// \brief A keystroke source that types the replayed characters in the text field of a memory key synthesizer before
+/// they reach the queue, as the keyboard hook sees the key strokes the user types in the foreground application.
+//****************************************************************************************************************************************************
+class TypingSource : public KeystrokeSource {
+public: // member functions
+    TypingSource(KeystrokeSource &source, MemoryKeySynthesizer &synthesizer); ///< Default constructor
+    TypingSource(TypingSource const &) = delete; ///< Disabled copy constructor
+    TypingSource(TypingSource &&) = delete; ///< Disabled move constructor
+    ~TypingSource() override = default; ///< Default destructor
+    TypingSource &operator=(TypingSource const &) = delete; ///< Disabled assignment operator
+    TypingSource &operator=(TypingSource &&) = delete; ///< Disabled move assignment operator
+    bool nextEvent(KeystrokeEvent &outEvent) override; ///< Retrieve the next event of the source
+
+private: // data members
+    KeystrokeSource &source_; ///< The source of the typed events
+    MemoryKeySynthesizer &synthesizer_; ///< The synthesizer containing the text field
+};
+
+
+//****************************************************************************************************************************************************
+/// \param[in] source The source of the typed events.
+/// \param[in] synthesizer The synthesizer containing the text field.
+//****************************************************************************************************************************************************
+TypingSource::TypingSource(KeystrokeSource &source, MemoryKeySynthesizer &synthesizer)
+    : source_(source)
+    , synthesizer_(synthesizer) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[out] outEvent The event.
+/// \return true if and only if an event was retrieved.
+//****************************************************************************************************************************************************
+bool TypingSource::nextEvent(KeystrokeEvent &outEvent) {
+    if (!source_.nextEvent(outEvent))
+        return false;
+    if (EKeystrokeEventType::Character == outEvent.type)
+        synthesizer_.unicodeKeyDownAndUp(outEvent.character.unicode());
+    else if (EKeystrokeEventType::Backspace == outEvent.type)
+        synthesizer_.backspaces(1);
+    return true;
+}
+
+
+} // anonymous namespace
+
+
+//****************************************************************************************************************************************************
+/// \brief A minimal consumer of the keystroke queue, that plays the role of the combo matcher thread
+///
+/// The consumer keeps track of the typed text, and requests the substitution of kKeyword when it is followed by a
+/// space. The combo matcher is not part of the portable sources, so it cannot be used by the test.
+//****************************************************************************************************************************************************
+class TestConsumerThread : public QThread {
+Q_OBJECT
+public: // member functions
+    explicit TestConsumerThread(KeystrokeQueue &queue); ///< Default constructor
+    TestConsumerThread(TestConsumerThread const &) = delete; ///< Disabled copy constructor
+    TestConsumerThread(TestConsumerThread &&) = delete; ///< Disabled move constructor
+    ~TestConsumerThread() override = default; ///< Default destructor
+    TestConsumerThread &operator=(TestConsumerThread const &) = delete; ///< Disabled assignment operator
+    TestConsumerThread &operator=(TestConsumerThread &&) = delete; ///< Disabled move assignment operator
+
+signals:
+    void substitutionRequested(); ///< Signal emitted when the keyword has been typed, followed by a space
+
+protected: // member functions
+    void run() override; ///< Process the events of the queue until a stop event is received
+
+private: // data members
+    KeystrokeQueue &queue_; ///< The keystroke queue
+    TypedTextBuffer buffer_; ///< The typed text
+};
+
+
+//****************************************************************************************************************************************************
+/// \param[in] queue The keystroke queue.
+//****************************************************************************************************************************************************
+TestConsumerThread::TestConsumerThread(KeystrokeQueue &queue)
+    : queue_(queue) {
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The signal is emitted before the event is marked as processed, so that the substitution is performed before
+/// feedKeystrokeQueue() pushes the next event.
+//****************************************************************************************************************************************************
+void TestConsumerThread::run() {
+    KeystrokeEvent event;
+    while (true) {
+        queue_.waitForEvent();
+        while (queue_.pop(event)) {
+            switch (event.type) {
+            case EKeystrokeEventType::Stop:
+                queue_.markProcessed();
+                return;
+            case EKeystrokeEventType::Character:
+                if (event.character.isSpace()) {
+                    if (buffer_.view() == kKeyword)
+                        emit substitutionRequested();
+                    buffer_.clear();
+                }
+                else
+                    buffer_.append(event.character);
+                break;
+            case EKeystrokeEventType::Backspace:
+                buffer_.removeLast();
+                break;
+            default:
+                buffer_.clear();
+                break;
+            }
+            queue_.markProcessed();
+        }
+    }
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief Test that replays key strokes through the keystroke queue and checks the text produced by a substitution
+///
+/// The test exercises the recording of key strokes, the keystroke queue and the key synthesis of substitutions. It
+/// does not depend on the Windows API.
+//****************************************************************************************************************************************************
+class TestKeystrokeReplay : public QObject {
+Q_OBJECT
+private slots:
+    void init(); ///< Install the memory key synthesizer before each test
+    void cleanup(); ///< Restore the default key synthesizer after each test
+    void substitution(); ///< Test the text produced by a substitution triggered by replayed key strokes
+    void recordingFile(); ///< Test that a recording is identical after being saved and loaded
+    void modifierKeys(); ///< Test that the modifier keys are released while the substitution is typed
+
+private: // member functions
+    QString replay(KeystrokeRecording const &recording); ///< Replay a recording and return the resulting text
+
+private: // data members
+    MemoryKeySynthesizer synthesizer_; ///< The key synthesizer
+};
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestKeystrokeReplay::init() {
+    synthesizer_.clear();
+    KeySynthesizer::setInstance(&synthesizer_);
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestKeystrokeReplay::cleanup() {
+    KeySynthesizer::setInstance(nullptr);
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief The substitution is performed by the main thread, in response to the queued signal of the consumer, like
+/// the substitutions of the application.
+///
+/// \param[in] recording The recording.
+/// \return The content of the text field of the synthesizer after the replay.
+//****************************************************************************************************************************************************
+QString TestKeystrokeReplay::replay(KeystrokeRecording const &recording) {
+    std::unique_ptr<KeystrokeQueue> const queue = std::make_unique<KeystrokeQueue>();
+    TestConsumerThread consumer(*queue);
+    QObject::connect(&consumer, &TestConsumerThread::substitutionRequested, this, []() {
+        KeySynthesizer &synthesizer = KeySynthesizer::instance();
+        synthesizer.eraseChars(qint32(kKeyword.size()) + 1);
+        synthesizer.typeText(kSnippet);
+    }, Qt::QueuedConnection);
+    consumer.start();
+    KeystrokeReplayer replayer(recording);
+    TypingSource source(replayer, synthesizer_);
+    qint64 const count = feedKeystrokeQueue(source, *queue, 1);
+    KeystrokeEvent stopEvent;
+    stopEvent.type = EKeystrokeEventType::Stop;
+    queue->push(stopEvent);
+    consumer.wait();
+    if (count != qint64(recording.size()))
+        return QString();
+    return synthesizer_.text();
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestKeystrokeReplay::substitution() {
+    QString const expected = "see you by the way ok";
+    QCOMPARE(this->replay(KeystrokeReplayer::recordingFromText("see you btx\bw ok", true)), expected);
+    QCOMPARE(synthesizer_.cursorPosition(), qint32(expected.size()));
+
+    synthesizer_.clear();
+    QCOMPARE(this->replay(KeystrokeReplayer::recordingFromText("abtw btwx ok", true)), QString("abtw btwx ok"));
+}
+
+
+//****************************************************************************************************************************************************
+//
+//****************************************************************************************************************************************************
+void TestKeystrokeReplay::recordingFile() {
+    QTemporaryDir const dir;
+    QVERIFY(dir.isValid());
+    QString const path = dir.filePath("recording.json");
+    KeystrokeRecording const recording = KeystrokeReplayer::recordingFromText("\tsee you btw ok\b", true);
+    QString errorMsg;
+    QVERIFY2(KeystrokeReplayer::saveRecording(recording, path, &errorMsg), qPrintable(errorMsg));
+    KeystrokeRecording loaded;
+    QVERIFY2(KeystrokeReplayer::loadRecording(path, loaded, &errorMsg), qPrintable(errorMsg));
+    QCOMPARE(loaded.size(), recording.size());
+    for (std::size_t i = 0; i < recording.size(); ++i) {
+        QVERIFY(loaded[i].type == recording[i].type);
+        QCOMPARE(loaded[i].character, recording[i].character);
+        QCOMPARE(loaded[i].comboTriggersOnSpace, recording[i].comboTriggersOnSpace);
+    }
+    QCOMPARE(this->replay(loaded), QString("see you by the way o"));
+}
+
+
+//****************************************************************************************************************************************************
+/// \brief If the user still holds shift when the substitution is typed, the keyword must be erased and the snippet
+/// typed with shift released, and the key must be pressed again afterwards.
+//****************************************************************************************************************************************************
+void TestKeystrokeReplay::modifierKeys() {
+    synthesizer_.keyDown(KeySynthesizer::leftShiftKey);
+    QCOMPARE(this->replay(KeystrokeReplayer::recordingFromText("btw ", true)), kSnippet);
+    QVERIFY(synthesizer_.isKeyPressed(KeySynthesizer::leftShiftKey));
+    bool isShiftPressed = true;
+    bool isSubstituting = false; // the events synthesized before the backspaces are the key strokes typed by the user
+    qint32 typedCount = 0;
+    for (MemoryKeySynthesizer::Event const &event: synthesizer_.events()) {
+        bool const isKeyEvent = (MemoryKeySynthesizer::EEventType::KeyDown == event.type)
+            || (MemoryKeySynthesizer::EEventType::KeyUp == event.type);
+        if (isKeyEvent && (KeySynthesizer::leftShiftKey == event.value))
+            isShiftPressed = (MemoryKeySynthesizer::EEventType::KeyDown == event.type);
+        if (MemoryKeySynthesizer::EEventType::Backspaces == event.type)
+            isSubstituting = true;
+        if (!isSubstituting)
+            continue;
+        if ((MemoryKeySynthesizer::EEventType::Backspaces == event.type) || (MemoryKeySynthesizer::EEventType::Unicode == event.type))
+            QVERIFY(!isShiftPressed);
+        if (MemoryKeySynthesizer::EEventType::Unicode == event.type)
+            ++typedCount;
+    }
+    QCOMPARE(typedCount, qint32(kSnippet.size()));
+}
+
+
+QTEST_GUILESS_MAIN(TestKeystrokeReplay)
+#include "TestKeystrokeReplay.moc"
@@ -16,10 +16,12 @@
 #include "Emoji/EmojiManager.h"
 #include "Update/UpdateManager.h"
 #include "I18nManager.h"
+#include "InputManager.h"
 #include "Preferences/PreferencesManager.h"
 #include "Picker/PickerWindow.h"
 #include "Combo/ComboManager.h"
 #include "LastUse/ComboLastUseFile.h"
+#include "SubstitutionTracer.h"
 #include <XMiLib/SingleInstanceApp.h>
 #include <XMiLib/SystemUtils.h>
 #include <XMiLib/Exception.h>
@@ -33,6 +35,8 @@ void ensureAppDataDirsExist(); ///< Make sure the application data folder exists
 void ensureMainWindowHasAHandle(MainWindow &mainWindow); ///< Ensure that the main window has a Win32 handle
 void removeFileMarkedForDeletion(); ///< Remove the software update file that may have been marker for deletion
 void setupPickerWindowShortcut(); ///< Setup the combo picker shortcut
+QString substitutionTracePathFromCommandLine(); ///< Retrieve the path of the substitution trace file from the command line
+void saveSubstitutionTrace(QString const &path); ///< Save the substitution trace
 
 
 //****************************************************************************************************************************************************
@@ -76,6 +80,9 @@ int main(int argc, char *argv[]) {
         QGuiApplication::setQuitOnLastWindowClosed(false);
         QGuiApplication::setOrganizationName(constants::kOrganizationName);
         QGuiApplication::setApplicationName(constants::kApplicationName);
+        QString const substitutionTracePath = substitutionTracePathFromCommandLine();
+        if (!substitutionTracePath.isEmpty())
+            SubstitutionTracer::instance().setEnabled(true);
 
         ensureAppDataDirsExist();
         PreferencesManager const &prefs = PreferencesManager::instance();
@@ -116,6 +123,9 @@ int main(int argc, char *argv[]) {
         setupPickerWindowShortcut();
         qint32 const returnCode = QApplication::exec();
         saveComboLastUseDateTimes(comboManager.comboListRef());
+        if (!substitutionTracePath.isEmpty())
+            saveSubstitutionTrace(substitutionTracePath);
+        debugLog.addInfo(QString("Keyboard hook callback durations: %1").arg(InputManager::instance().hookLatencyMonitor().summary()));
         debugLog.addInfo(QString("Application exited with return code %1").arg(returnCode));
         I18nManager::instance().unloadTranslation(); // required to avoid crash because otherwise the app instance could be destroyed before the translators
         return returnCode;
@@ -227,3 +237,29 @@ void setupPickerWindowShortcut() {
     QMessageBox::critical(nullptr, QObject::tr("Error"), QObject::tr("The shortcut for the combo picker window "
                                                                      "could not be registered. The combo picker has been turned off."));
 }
+
+
+//****************************************************************************************************************************************************
+/// \return The path passed to the --trace-substitutions command line option, or an empty string if the option is
+/// not present.
+//****************************************************************************************************************************************************
+QString substitutionTracePathFromCommandLine() {
+    QCommandLineParser parser;
+    QCommandLineOption const option("trace-substitutions", "Record the substitutions and save the trace on exit.", "path");
+    parser.addOption(option);
+    (void) parser.parse(QCoreApplication::arguments()); // unknown arguments are ignored
+    return parser.value(option);
+}
+
+
+//****************************************************************************************************************************************************
+/// \param[in] path The path of the trace file.
+//****************************************************************************************************************************************************
+void saveSubstitutionTrace(QString const &path) {
+    DebugLog &debugLog = globals::debugLog();
+    QString errMsg;
+    if (SubstitutionTracer::instance().saveChromeTrace(path, &errMsg))
+        debugLog.addInfo(QString("The substitution trace was saved to %1").arg(QDir::toNativeSeparators(path)));
+    else
+        debugLog.addError(QString("The substitution trace could not be saved: %1").arg(errMsg));
+}